@@ -116,6 +116,9 @@ namespace scene
 					NewVertices=new CSpecificVertexList<video::S3DVertexTangents>;
 					break;
 				}
+				default:
+					// compact vertices have no floats to access, they are kept in SCompactMeshBuffer
+					return;
 			}
 			if (Vertices)
 			{
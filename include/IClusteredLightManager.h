@@ -0,0 +1,72 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+#define __I_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+
+#include "ISceneManager.h"
+#include "ILightManager.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Light manager which switches on the most relevant lights for each scene node
+/** After the lights of a frame are created, the view frustum of the active
+camera is divided into a grid of clusters, with tiles on screen and slices
+along the view direction, and each point and spot light is put into the
+clusters its radius touches. Before a scene node is rendered the lights of
+the clusters touched by its bounding box are collected, and those which
+reach the box and shine brightest on it are switched on, all others are
+switched off. Directional lights and lights without radius are candidates
+for every node.
+
+So a scene may contain far more lights than the driver can handle at once,
+as long as each node is reached by few of them. Lights are switched with
+ISceneNode::setVisible() and are visible again after the frame, nodes in
+the shadow pass are not handled.
+
+Create it with ISceneManager::createClusteredLightManager() and register it
+with ISceneManager::setLightManager(). It does not grab the scene manager
+and must not be used with other scene managers.
+*/
+class IClusteredLightManager : public ILightManager
+{
+public:
+
+	//! Set the number of clusters
+	/** \param tilesX Number of tiles across the screen.
+	\param tilesY Number of tiles down the screen.
+	\param slices Number of slices between the near and far plane of the
+	camera, they grow exponentially with distance for perspective cameras. */
+	virtual void setClusterGrid(u32 tilesX, u32 tilesY, u32 slices) = 0;
+
+	//! Get the number of tiles across the screen
+	virtual u32 getClusterTilesX() const = 0;
+
+	//! Get the number of tiles down the screen
+	virtual u32 getClusterTilesY() const = 0;
+
+	//! Get the number of slices along the view direction
+	virtual u32 getClusterSlices() const = 0;
+
+	//! Set the maximal number of lights switched on for a scene node
+	/** \param count Maximal number of lights, 0 uses
+	IVideoDriver::getMaximalDynamicLightAmount(). Larger values are
+	clamped to it when the driver reports a limit. */
+	virtual void setMaxLightsPerNode(u32 count) = 0;
+
+	//! Get the maximal number of lights switched on for a scene node
+	virtual u32 getMaxLightsPerNode() const = 0;
+
+	//! Get the number of light references stored in the clusters of the current frame
+	/** A light touching several clusters is counted for each of them. */
+	virtual u32 getClusterLightCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,50 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_FRAME_UPDATER_H_INCLUDED__
+#define __I_FRAME_UPDATER_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+
+namespace irr
+{
+
+//! Application work which runs on a worker thread while a frame is drawn
+/** Register it with IrrlichtDevice::setFrameUpdater(). Every call of
+IrrlichtDevice::run() then waits until the update started by the last call
+is done, calls apply() and starts update() for the next frame on a worker
+thread. So the simulation of frame N+1 runs while the application animates,
+culls and draws frame N, and every frame shows the state of the update
+before.
+
+update() must not use the scene, the GUI or the video driver, they belong
+to the drawing thread and are not thread safe. It should simulate into
+state of its own, a second copy of what the scene shows, which apply()
+copies into the scene nodes. apply() is called on the thread of run() while
+no update is running, so it may use the whole engine.
+
+Only this application work is pipelined. Scene node animation, culling
+and drawing stay on the thread of run(), and the engine keeps no snapshot of
+the render lists: many scene nodes build their geometry in render(), e.g.
+billboards, particle systems and skinned meshes, and the video drivers can
+only draw from the thread which created them. To move animation off the
+drawing thread, compute it in update() and set the results in apply().
+*/
+class IFrameUpdater : public virtual IReferenceCounted
+{
+public:
+
+	//! Simulates the next frame, called on a worker thread
+	/** \param timeMs Time of the device timer when the update was
+	started. */
+	virtual void update(u32 timeMs) = 0;
+
+	//! Copies the result of the last update into the scene
+	/** Called by IrrlichtDevice::run() before the next update starts. */
+	virtual void apply() = 0;
+};
+
+} // end namespace irr
+
+#endif
+
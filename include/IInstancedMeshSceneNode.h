@@ -0,0 +1,105 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class IMesh;
+
+
+//! A scene node drawing many copies of one static mesh
+/** Each instance has a transformation relative to the node and a color,
+which is multiplied with the vertex colors of the mesh. Compared to one
+IMeshSceneNode per copy there is only one node to animate, register and
+cull. The instances are culled in spatial groups against the view
+frustum of the active camera, unless the automatic culling of the node
+is EAC_OFF. The visible instances are merged into a few mesh buffers per
+mesh buffer of the mesh, which are only rebuilt when the set of visible
+instances changes.
+
+Mesh buffers with 32 bit indices or triangle strips and fans can't be
+merged, their instances are drawn one by one and without instance color.
+Transparent instances are not sorted against each other.
+*/
+class IInstancedMeshSceneNode : public ISceneNode
+{
+public:
+
+	//! Constructor
+	IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Sets the mesh which is drawn for every instance
+	/** \param mesh Mesh to display. */
+	virtual void setMesh(IMesh* mesh) = 0;
+
+	//! Get the mesh which is drawn for every instance.
+	virtual IMesh* getMesh(void) = 0;
+
+	//! Adds an instance
+	/** \param transformation Transformation of the instance relative to the node.
+	\param color Multiplied with the vertex colors of the mesh.
+	\return Index of the new instance. */
+	virtual u32 addInstance(const core::matrix4& transformation,
+		video::SColor color = video::SColor(255,255,255,255)) = 0;
+
+	//! Adds an instance
+	/** \param position Position relative to the node.
+	\param rotation Rotation in degrees.
+	\param scale Scale of the instance.
+	\param color Multiplied with the vertex colors of the mesh.
+	\return Index of the new instance. */
+	virtual u32 addInstance(const core::vector3df& position,
+		const core::vector3df& rotation = core::vector3df(0,0,0),
+		const core::vector3df& scale = core::vector3df(1,1,1),
+		video::SColor color = video::SColor(255,255,255,255)) = 0;
+
+	//! Removes an instance
+	/** The last instance takes the index of the removed one. */
+	virtual void removeInstance(u32 index) = 0;
+
+	//! Removes all instances
+	virtual void clearInstances() = 0;
+
+	//! Get the number of instances
+	virtual u32 getInstanceCount() const = 0;
+
+	//! Sets the transformation of an instance relative to the node
+	virtual void setInstanceTransformation(u32 index, const core::matrix4& transformation) = 0;
+
+	//! Get the transformation of an instance relative to the node
+	virtual const core::matrix4& getInstanceTransformation(u32 index) const = 0;
+
+	//! Sets the color of an instance
+	virtual void setInstanceColor(u32 index, video::SColor color) = 0;
+
+	//! Get the color of an instance
+	virtual video::SColor getInstanceColor(u32 index) const = 0;
+
+	//! Get the number of instances which passed the culling of the last frame
+	virtual u32 getVisibleInstanceCount() const = 0;
+
+	//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+	/** \param readonly Flag if the materials shall be read-only. */
+	virtual void setReadOnlyMaterials(bool readonly) = 0;
+
+	//! Check if the scene node should not copy the materials of the mesh but use them in a read only style
+	virtual bool isReadOnlyMaterials() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
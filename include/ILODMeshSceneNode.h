@@ -0,0 +1,89 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_LOD_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_LOD_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class IMesh;
+
+
+//! A scene node drawing one of several versions of a static mesh by projected size
+/** The levels are ordered from the most to the least detailed mesh. Each
+level has a minimal screen size, which is the diameter of the bounding
+sphere of the node divided by the height of the screen. Every frame the
+first level whose screen size is reached is drawn for the active camera,
+nothing is drawn when the node is smaller than all levels.
+
+setMesh() creates the levels with IMeshManipulator::createMeshLODChain(),
+addLevel() allows custom meshes. The materials are copied from the first
+level and used for the mesh buffers with the same index of all levels.
+*/
+class ILODMeshSceneNode : public ISceneNode
+{
+public:
+
+	//! Constructor
+	ILODMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Sets the most detailed mesh and creates simplified levels of it
+	/** Replaces all levels. The full mesh is drawn down to screenSize,
+	below that each level is drawn down to the screen size of the previous
+	one multiplied with the square root of reduction, so the number of
+	triangles per screen area stays about the same. The last level is
+	drawn down to any size.
+	\param mesh Most detailed mesh.
+	\param levelCount Maximal number of simplified levels.
+	\param reduction Fraction of the triangles of the previous level to keep.
+	\param screenSize Screen size down to which the full mesh is drawn. */
+	virtual void setMesh(IMesh* mesh, u32 levelCount=4, f32 reduction=0.5f, f32 screenSize=0.25f) = 0;
+
+	//! Adds a level
+	/** \param mesh Mesh of the level.
+	\param minScreenSize The level is drawn down to this screen size,
+	the levels are kept sorted by it.
+	\return Index of the new level. */
+	virtual u32 addLevel(IMesh* mesh, f32 minScreenSize) = 0;
+
+	//! Removes all levels
+	virtual void clearLevels() = 0;
+
+	//! Get the number of levels
+	virtual u32 getLevelCount() const = 0;
+
+	//! Get the mesh of a level
+	virtual IMesh* getLevelMesh(u32 level) const = 0;
+
+	//! Get the screen size down to which a level is drawn
+	virtual f32 getLevelScreenSize(u32 level) const = 0;
+
+	//! Get the level drawn in the last frame, -1 if none was drawn
+	virtual s32 getCurrentLevel() const = 0;
+
+	//! Get the screen size of the node in the last frame
+	virtual f32 getCurrentScreenSize() const = 0;
+
+	//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+	/** \param readonly Flag if the materials shall be read-only. */
+	virtual void setReadOnlyMaterials(bool readonly) = 0;
+
+	//! Check if the scene node should not copy the materials of the mesh but use them in a read only style
+	virtual bool isReadOnlyMaterials() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
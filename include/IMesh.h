@@ -57,7 +57,10 @@ namespace scene
 		EAMT_SKINNED,
 
 		//! generic non-animated mesh
-		EAMT_STATIC
+		EAMT_STATIC,
+
+		//! non-animated mesh with clusters of triangles, SClusteredMesh
+		EAMT_CLUSTERED
 	};
 
 
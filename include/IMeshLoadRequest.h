@@ -0,0 +1,45 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_MESH_LOAD_REQUEST_H_INCLUDED__
+#define __I_MESH_LOAD_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IAnimatedMesh;
+
+//! Handle of a mesh loaded in the background, see ISceneManager::getMeshAsync()
+/** The request is done once the loaded mesh was added to the mesh cache by
+ISceneManager::commitLoadedMeshes(), which ISceneManager::drawAll() calls
+every frame. Before that the mesh must not be used. Drop the request when
+it is no longer needed, also if it is not done yet. */
+class IMeshLoadRequest : public virtual IReferenceCounted
+{
+public:
+
+	//! Returns true if loading is finished, also if it failed.
+	virtual bool isDone() const = 0;
+
+	//! Returns the loaded mesh.
+	/** \return 0 if the request is not done yet or if loading failed.
+	The request holds a reference to the mesh until it is dropped, so
+	the mesh stays valid even if it is removed from the mesh cache.
+	The pointer should not be dropped. See IReferenceCounted::drop() for
+	more information. */
+	virtual IAnimatedMesh* getMesh() const = 0;
+
+	//! Returns the name of the mesh in the mesh cache.
+	virtual const io::path& getName() const = 0;
+};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -52,6 +52,18 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) = 0;
 
+	//! Returns true if createMesh() may run on the worker thread of ISceneManager::getMeshAsync().
+	/** Such a loader must not create scene nodes, use the mesh cache or
+	open other files than the one it gets. It may ask the video driver for
+	textures, which are forwarded to the thread using the driver, and look
+	for texture files with IFileSystem::existFile(). Files of other
+	loaders are loaded by getMeshAsync() at once.
+	\return False unless the loader overrides it. */
+	virtual bool isThreadSafe() const
+	{
+		return false;
+	}
+
 	//! Set a new texture loader which this meshloader can use when searching for textures.
 	/** NOTE: Not all meshloaders do support this interface. Meshloaders which
 	support it will return a non-null value in getMeshTextureLoader from the start. Setting a
@@ -19,6 +19,7 @@ namespace scene
 {
 
 	struct SMesh;
+	struct SClusteredMesh;
 
 	//! An interface for easy manipulation of meshes.
 	/** Scale, set alpha value, flip surfaces, and so on. This exists for
@@ -102,6 +103,20 @@ namespace scene
 				bool recalculateNormals=false, bool smooth=false,
 				bool angleWeighted=false) const=0;
 
+		//! Set the number of threads for recalculating normals and tangents of meshes
+		/** recalculateNormals(), recalculateTangents() and
+		createMeshWithTangents() then process the mesh buffers of a mesh
+		in parallel, each buffer on one thread. The results are the same
+		for any number of threads. Only calls from the thread which set
+		the count use the other threads, calls from other threads, like
+		those of mesh loaders in the background, run serially.
+		\param count Number of threads including the calling one, 0 uses
+		one per processor. Default is 1. */
+		virtual void setThreadCount(u32 count) = 0;
+
+		//! Get the number of threads for recalculating normals and tangents of meshes
+		virtual u32 getThreadCount() const = 0;
+
 		//! Scales the actual mesh, not a scene node.
 		/** \param mesh Mesh on which the operation is performed.
 		\param factor Scale factor for each axis. */
@@ -274,6 +289,21 @@ namespace scene
 		information. */
 		virtual IMesh* createMeshWith1TCoords(IMesh* mesh) const = 0;
 
+		//! Creates a copy of the mesh with quantized video::S3DVertexCompact vertices.
+		/** The positions are stored in 16 bit steps of the bounding box
+		of each mesh buffer, normals in two bytes of an octahedral map
+		and texture coordinates as half floats, which makes the vertices
+		16 bytes instead of 36. The second texture coordinates and the
+		tangents are lost. Only mesh buffers with 16 bit indices and one
+		of the float vertex types are converted, other mesh buffers are
+		shared with the source mesh. createMeshWith1TCoords() converts
+		the mesh back to S3DVertex vertices.
+		\param mesh Input mesh
+		\return Mesh with SCompactMeshBuffer mesh buffers. If you no
+		longer need the mesh, you should call IMesh::drop(). See
+		IReferenceCounted::drop() for more information. */
+		virtual IMesh* createMeshCompact(IMesh* mesh) const = 0;
+
 		//! Creates a copy of a mesh with all vertices unwelded
 		/** \param mesh Input mesh
 		\return Mesh consisting only of unique faces. All vertices
@@ -321,6 +351,104 @@ namespace scene
 		\return A new mesh optimized for the vertex cache. */
 		virtual IMesh* createForsythOptimizedMesh(const IMesh *mesh) const = 0;
 
+		//! Reorders triangles and vertices for the vertex cache and less overdraw
+		/** The triangles are sorted for a vertex cache of cacheSize
+		vertices with the Tipsify algorithm from "Fast Triangle
+		Reordering for Vertex Locality and Reduced Overdraw" by Sander,
+		Nehab and Barczak. This order is split into clusters, which are
+		drawn from the outside of the mesh to the inside, so surfaces
+		which are likely in front are drawn first from every direction.
+		At last the vertices are stored in the order of their first use,
+		which keeps the vertex fetches close together. Unused vertices
+		are removed.
+
+		Only triangle lists with 16 bit indices are optimized, other
+		mesh buffers are shared with the source mesh. The function is
+		thread-safe.
+		\param mesh Source mesh for the operation.
+		\param cacheSize Number of vertices in the simulated vertex
+		cache. 16 fits most hardware and the vertex cache of the
+		Burning's video driver.
+		\param overdrawThreshold Clusters end where their ratio of cache
+		misses per triangle gets down to this factor times the ratio of
+		the whole run. Larger values make more and smaller clusters,
+		which reduces overdraw at the cost of more cache misses. 0
+		keeps the cache order.
+		\return New mesh with the same materials. If you no longer need
+		the mesh, you should call IMesh::drop(). See
+		IReferenceCounted::drop() for more information. */
+		virtual IMesh* createMeshOptimized(IMesh* mesh, u32 cacheSize=16, f32 overdrawThreshold=1.05f) const = 0;
+
+		//! Creates a copy of the mesh with fewer triangles
+		/** Edges are collapsed in the order of the quadric error metric
+		of Garland and Heckbert until the ratio of triangles is left, or
+		no more edges can be collapsed. Collapses move a vertex onto a
+		neighbouring vertex, so the remaining vertices keep position,
+		normal and texture coordinates. Vertices on open borders only move
+		along the border, vertices on seams, where vertices with the same
+		position have different attributes, only move along the seam
+		together with all their vertices. Collapses which would turn
+		triangles over are skipped. Welding the mesh first with createMeshWelded()
+		gives better results for meshes with duplicated vertices.
+
+		Only triangle lists with 16 bit indices are simplified, other
+		mesh buffers are shared with the source mesh. The function is
+		thread-safe.
+		\param mesh Source mesh for the operation.
+		\param ratio Fraction of the triangles of each mesh buffer to keep.
+		\return New mesh with the same mesh buffers and materials. If you
+		no longer need the mesh, you should call IMesh::drop(). See
+		IReferenceCounted::drop() for more information. */
+		virtual IMesh* createMeshSimplified(IMesh* mesh, f32 ratio) const = 0;
+
+		//! Creates successively simplified copies of the mesh for levels of detail
+		/** Every level is created with createMeshSimplified() from the
+		previous one. The chain ends early when a level would keep more
+		than 90 percent of the triangles of the previous level.
+		\param mesh Source mesh for the operation, not part of the chain.
+		\param outLevels The levels are appended here, from the most to
+		the least detailed. Call IMesh::drop() on them when they are no
+		longer needed.
+		\param maxLevels Maximal number of levels to create.
+		\param reduction Fraction of the triangles of the previous level
+		to keep, between 0 and 1.
+		\return Number of levels appended. */
+		virtual u32 createMeshLODChain(IMesh* mesh, core::array<IMesh*>& outLevels,
+			u32 maxLevels=4, f32 reduction=0.5f) const = 0;
+
+		//! Creates a copy of the mesh with its triangles grouped into clusters
+		/** Clusters grow from a seed triangle over shared vertices,
+		taking the candidate closest to the cluster center, where
+		candidates whose normals deviate from the average normal of the
+		cluster count as farther away. Clusters are seeded along a space
+		filling curve over the triangle centers, so a cluster without
+		connected candidates continues with a triangle nearby. The
+		triangles of each cluster are stored one after the other and
+		the vertices in the order of their first use. Every cluster gets
+		its bounding box and the cone of its normals, see SMeshCluster.
+
+		An IMeshSceneNode with the returned mesh culls the clusters of
+		large mesh buffers against the view frustum and, with back face
+		culling, when they face away from the camera. Small clusters cost
+		more culling time than they save, so this pays off for buffers
+		with many thousands of triangles, as in CAD models. The other
+		functions of the manipulator return meshes without clusters.
+
+		Only triangle lists with one of the float vertex types are
+		clustered, with 16 or 32 bit indices. Other mesh buffers and
+		those with no more triangles than a cluster are shared with the
+		source mesh and get no clusters. The function is thread-safe.
+		\param mesh Source mesh for the operation.
+		\param maxTriangles Maximal number of triangles per cluster.
+		\param coneWeight How much farther a candidate counts when its
+		normal is perpendicular to the average normal of the cluster.
+		Larger values make clusters flatter, so more of them can be
+		culled as back facing. 0 only looks at the distance.
+		\return New mesh with the same materials. If you no longer need
+		the mesh, you should call IMesh::drop(). See
+		IReferenceCounted::drop() for more information. */
+		virtual SClusteredMesh* createMeshClustered(IMesh* mesh, u32 maxTriangles=128, f32 coneWeight=1.f) const = 0;
+
 		//! Optimize the mesh with an algorithm tuned for heightmaps.
 		/**
 		This differs from usual simplification methods in two ways:
@@ -423,6 +551,9 @@ protected:
 						func(verts[i]);
 					}
 					break;
+				default:
+					// compact vertices can't be changed in place
+					return false;
 				}
 				if (boundingBoxUpdate)
 				{
@@ -12,6 +12,39 @@ namespace irr
 {
 namespace scene
 {
+namespace quake3
+{
+	//! A leaf of the bsp tree of a level
+	struct SLeaf
+	{
+		//! Visibility cluster of the leaf, -1 for leaves in solid space
+		s32 Cluster;
+
+		//! Bounding box in mesh space
+		core::aabbox3df Box;
+
+		//! First entry of the leaf in IQ3LevelMesh::getLeafFaces()
+		u32 FirstFace;
+
+		//! Number of faces of the leaf
+		u32 FaceCount;
+	};
+
+	//! Indices of one face of the level in a mesh buffer of the E_Q3_MESH_GEOMETRY mesh
+	struct SFaceIndices
+	{
+		//! Mesh buffer of getMesh(quake3::E_Q3_MESH_GEOMETRY)
+		u32 MeshBuffer;
+
+		//! First index of the face in the mesh buffer
+		u32 FirstIndex;
+
+		//! Number of indices of the face
+		u32 IndexCount;
+	};
+
+} // end namespace quake3
+
 	//! Interface for a Mesh which can be loaded directly from a Quake3 .bsp-file.
 	/** The Mesh tries to load all textures of the map.*/
 	class IQ3LevelMesh : public IAnimatedMesh
@@ -37,6 +70,31 @@ namespace scene
 
 		//! returns the requested brush entity
 		virtual IMesh* getBrushEntityMesh(quake3::IEntity &ent) const = 0;
+
+		//! Returns the visibility cluster at a position.
+		/** The leaves of the bsp tree are grouped into clusters, and the
+		level stores which clusters can potentially be seen from each other.
+		\param pos Position in mesh space.
+		\return Cluster index, or -1 if the position is in solid space or
+		the level has no bsp tree. */
+		virtual s32 getClusterAt(const core::vector3df& pos) const = 0;
+
+		//! Checks if a cluster is potentially visible from another one.
+		/** \param from Cluster of the viewer. All clusters are visible
+		from -1 and from any cluster if the level has no visibility data.
+		\param target Cluster to test, -1 is never visible.
+		\return False if nothing of target can be seen from from. */
+		virtual bool isClusterVisible(s32 from, s32 target) const = 0;
+
+		//! Get the leaves of the bsp tree of the main level geometry
+		virtual const core::array<quake3::SLeaf>& getLeafs() const = 0;
+
+		//! Get the faces of the leaves, as indices into getFaceIndices().
+		/** A face can be part of several leaves. */
+		virtual const core::array<u32>& getLeafFaces() const = 0;
+
+		//! Get where the faces of the E_Q3_MESH_GEOMETRY mesh are stored in its mesh buffers
+		virtual const core::array<quake3::SFaceIndices>& getFaceIndices() const = 0;
 	};
 
 } // end namespace scene
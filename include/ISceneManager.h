@@ -17,6 +17,7 @@
 #include "ESceneNodeAnimatorTypes.h"
 #include "EMeshWriterEnums.h"
 #include "SceneParameters.h"
+#include "SRenderSortKey.h"
 #include "IGeometryCreator.h"
 #include "ISkinnedMesh.h"
 #include "IXMLWriter.h"
@@ -107,18 +108,23 @@ namespace scene
 	class IBillboardTextSceneNode;
 	class ICameraSceneNode;
 	class IDummyTransformationSceneNode;
+	class IInstancedMeshSceneNode;
+	class ILODMeshSceneNode;
 	class ILightManager;
+	class IClusteredLightManager;
 	class ILightSceneNode;
 	class IMesh;
 	class IMeshBuffer;
 	class IMeshCache;
 	class IMeshLoader;
+	class IMeshLoadRequest;
 	class IMeshManipulator;
 	class IMeshSceneNode;
 	class IMeshWriter;
 	class IMetaTriangleSelector;
 	class IOctreeSceneNode;
 	class IParticleSystemSceneNode;
+	class IQ3LevelMesh;
 	class ISceneCollisionManager;
 	class ISceneLoader;
 	class ISceneNode;
@@ -273,6 +279,15 @@ namespace scene
 		 *      lightmapper.</TD>
 		 *  </TR>
 		 *  <TR>
+		 *    <TD>Irrlicht Binary Mesh (.irrbin)</TD>
+		 *    <TD>A binary format for static and skinned meshes,
+		 *      native to Irrlicht and written by the irr binary mesh
+		 *      writer. Vertices, indices and animation keys are
+		 *      stored as they are in memory, so it loads quickly and
+		 *      is suited as a cache for meshes converted from other
+		 *      formats.</TD>
+		 *  </TR>
+		 *  <TR>
 		 *    <TD>LightWave (.lwo)</TD>
 		 *    <TD>Native to NewTek's LightWave 3D, the LWO format is well
 		 *      known and supported by many exporters. This loader will
@@ -402,6 +417,51 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Loads a mesh on a background thread.
+		/** Works like getMesh(const io::path&, const io::path&), but
+		returns at once. The file is opened on the calling thread and
+		parsed by the mesh loaders on a worker thread, one file after the
+		other. The textures the loaders ask for are created on the thread
+		using the video driver, see video::ITextureCallForwarder, so the
+		loader waits for the next commitLoadedMeshes() call whenever it
+		asks for a texture. commitLoadedMeshes() also adds the loaded meshes to the
+		mesh cache, so the meshes of the cache are only changed on the
+		calling thread. Meshes which are in the cache already give a
+		request which is done at once, loading a file again which is still
+		loading gives the same request.
+
+		Only one scene manager of a video driver can load in the
+		background, the others load at once like getMesh(). Without thread
+		support the mesh is also loaded before this returns.
+
+		Only files whose loaders are all thread safe (see
+		IMeshLoader::isThreadSafe()) are parsed on the worker. Others, like
+		.obj files with their material files or COLLADA files creating
+		scene nodes, are loaded at once like with getMesh(), the request
+		is done then. While meshes are loading, the worker looks for
+		texture files with the file system, so don't change the archives
+		or the working directory of the file system, and don't change the
+		thread count of the mesh manipulator, which the loaders use
+		serially on the worker. getMesh() and addExternalMeshLoader() wait
+		until the file being parsed is done. Messages of the loaders are
+		logged on the worker thread. Files in uncompressed archives share
+		the file of the archive, so they are read completely on the
+		calling thread first.
+		\param filename Filename of the mesh to load.
+		\param alternativeCacheName Name of the mesh in the cache instead of the filename.
+		\return The request, never 0. Drop it when it is no longer needed.
+		See IReferenceCounted::drop() for more information. */
+		virtual IMeshLoadRequest* getMeshAsync(const io::path& filename, const io::path& alternativeCacheName=io::path("")) = 0;
+
+		//! Adds the meshes loaded in the background to the mesh cache.
+		/** Also creates the textures the loaders of getMeshAsync() are
+		waiting for. Called by drawAll(), call it yourself if you load
+		meshes without drawing. Must be called on the thread which calls
+		getMeshAsync().
+		\param waitForAll Blocks until all requests are done if true.
+		\return Number of requests which are not done yet. */
+		virtual u32 commitLoadedMeshes(bool waitForAll=false) = 0;
+
 		//! Get interface to the mesh cache which is shared between all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -517,6 +577,74 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Adds a scene node for rendering many copies of a static mesh.
+		/** Instances are added to the returned node with
+		IInstancedMeshSceneNode::addInstance(). This is much cheaper than
+		adding one mesh scene node per copy, see IInstancedMeshSceneNode.
+		\param mesh: Pointer to the loaded static mesh drawn for every instance.
+		Can be 0, the mesh can be set later with IInstancedMeshSceneNode::setMesh().
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
+		//! Adds a scene node drawing simplified versions of a static mesh when it gets small on screen.
+		/** The levels are created with IMeshManipulator::createMeshLODChain(),
+		see ILODMeshSceneNode::setMesh() for the screen sizes at which they
+		are switched.
+		\param mesh: Pointer to the loaded static mesh, the most detailed level.
+		Can be 0, the mesh can be set later with ILODMeshSceneNode::setMesh().
+		\param levelCount: Maximal number of simplified levels.
+		\param reduction: Fraction of the triangles of the previous level to keep.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual ILODMeshSceneNode* addLODMeshSceneNode(IMesh* mesh, u32 levelCount=4, f32 reduction=0.5f,
+			ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
+		//! Merges static mesh scene nodes into a few large mesh buffers.
+		/** Level geometry often consists of thousands of small nodes, and
+		each of their mesh buffers costs a draw call. This method appends the
+		mesh buffers of the given nodes which share material and vertex type
+		into one buffer, transformed to world space. To keep culling
+		effective, the nodes are sorted into the cubes of a grid first and only
+		buffers of nodes whose box center lies in the same cube are merged.
+		Every cube becomes one mesh scene node below the returned node.
+
+		The merged nodes are made invisible, but stay in the scene graph, so
+		triangle selectors and ids still work. Remove them if they are not
+		needed anymore. Nodes are skipped and stay untouched if they are
+		invisible, have children or animators, or have a mesh buffer
+		with 32 bit indices or primitives other than triangles.
+		Transparent buffers are only sorted per cube afterwards.
+		\param nodes: Nodes to merge, the nodes must not move afterwards.
+		\param chunkSize: Edge length of the grid cubes in world units.
+		\param parent: Parent of the created node. Can be NULL, then the root
+		scene node is used. Its transformation is taken into account and must
+		not change afterwards.
+		\param id: Id of the created node.
+		\return Node whose children draw the merged buffers, or 0 if no node
+		could be merged. This pointer should not be dropped. See
+		IReferenceCounted::drop() for more information. */
+		virtual ISceneNode* addStaticBatchSceneNode(const core::array<IMeshSceneNode*>& nodes,
+			f32 chunkSize=256.f, ISceneNode* parent=0, s32 id=-1) = 0;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		/** Looks really good when the Material type EMT_TRANSPARENT_REFLECTION
 		is used.
@@ -901,6 +1029,30 @@ namespace scene
 												ISceneNode* parent=0, s32 id=-1
 												) = 0;
 
+		//! Adds a scene node which draws the main geometry of a quake3 level with the visibility data of the level.
+		/** Only the faces of the bsp leaves whose cluster is potentially
+		visible from the cluster of the active camera are drawn, and of
+		those only the leaves inside the view frustum unless automatic
+		culling is switched off. Compared to a mesh scene node with
+		getMesh(quake3::E_Q3_MESH_GEOMETRY) this draws far fewer triangles
+		inside of the level. Levels without bsp tree are drawn completely.
+		\param mesh The level. The node keeps its own copy of the vertices
+		of the geometry, so the level may be removed from the mesh cache.
+		\param parent Parent of the scene node. Can be NULL if no parent.
+		\param id Id of the node. This id can be used to identify the scene node.
+		\param position Position of the space relative to its parent
+		where the scene node will be placed.
+		\param rotation Initial rotation of the scene node.
+		\param scale Initial scale of the scene node.
+		\return Pointer to the created scene node, or 0 if mesh is 0 or
+		the bsp loader was not compiled in. This pointer should not be
+		dropped. See IReferenceCounted::drop() for more information. */
+		virtual IMeshSceneNode* addQuake3LevelSceneNode(IQ3LevelMesh* mesh,
+			ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
 
 		//! Adds an empty scene node to the scene graph.
 		/** Can be used for doing advanced transformations
@@ -1098,6 +1250,25 @@ namespace scene
 				core::array<scene::ISceneNode*>& outNodes,
 				ISceneNode* start=0) = 0;
 
+		//! Enables an index for the lookups of scene nodes by id, name and type.
+		/** Without the index getSceneNodeFromId, getSceneNodeFromName,
+		getSceneNodeFromType and getSceneNodesFromType walk the scene graph
+		on every call. With the index they return the same nodes with a
+		few hash lookups. Adding and removing nodes and changing names and
+		ids with ISceneNode::setName and ISceneNode::setID update the index
+		in place. Added nodes are indexed by the next lookup, which moves
+		the entries of the nodes behind them when they are not added to the
+		last subtree of the graph. So the index pays off for graphs which
+		are searched more often than nodes are added. Searches starting at
+		nodes which are not attached to the root scene node still walk their
+		subtree. Disabled by default.
+		\param enabled True to create the index, false to delete it. */
+		virtual void setSceneNodeLookupIndexEnabled(bool enabled) = 0;
+
+		//! Check if the lookups of scene nodes use an index.
+		/** \return True if enabled with setSceneNodeLookupIndexEnabled. */
+		virtual bool isSceneNodeLookupIndexEnabled() const = 0;
+
 		//! Get the current active camera.
 		/** \return The active camera is returned. Note that this can
 		be NULL, if there was no camera created yet.
@@ -1130,7 +1301,9 @@ namespace scene
 		and will use ESNRP_SHADOW for this. See scene::E_SCENE_NODE_RENDER_PASS for details.
 		Note: This is _not_ a bitfield. If you want to register a note for several render passes, then 
 		call this function once for each pass.
-		\return scene will be rendered ( passed culling ) */
+		\return scene will be rendered ( passed culling ). When the render lists are built
+		with several threads (see scene::RENDER_LIST_THREADS) culling happens after all
+		nodes are registered and this returns 1 for every pass which would be culled. */
 		virtual u32 registerNodeForRendering(ISceneNode* node,
 			E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) = 0;
 
@@ -1475,6 +1648,26 @@ namespace scene
 		pass currently is active they can render the correct part of their geometry. */
 		virtual E_SCENE_NODE_RENDER_PASS getSceneNodeRenderPass() const = 0;
 
+		//! Set how the nodes of a render pass are sorted before drawing.
+		/** Each node gets a 64 bit key built from the layout, the nodes
+		are drawn in ascending key order. The default for ESNRP_SOLID is
+		material type (8 bits) and texture (16 bits) to reduce state
+		changes. Appending ERSKF_DEPTH draws nodes with the same state
+		front to back, which saves fill rate with a depth buffer. It is
+		not the default as drivers without depth precision, e.g. Burning's
+		Video with orthogonal projection, depend on the drawing order.
+		The transparent passes default to the inverse depth (32 bits),
+		which draws them back to front.
+		\param pass ESNRP_SOLID, ESNRP_TRANSPARENT or ESNRP_TRANSPARENT_EFFECT,
+		other passes are not sorted.
+		\param layout Fields of the key, see SRenderSortKeyLayout. */
+		virtual void setRenderSortKeyLayout(E_SCENE_NODE_RENDER_PASS pass, const SRenderSortKeyLayout& layout) = 0;
+
+		//! Get the layout of the sort key of a render pass.
+		/** \param pass ESNRP_SOLID, ESNRP_TRANSPARENT or ESNRP_TRANSPARENT_EFFECT.
+		\return Layout of the pass, an empty layout for the other passes. */
+		virtual const SRenderSortKeyLayout& getRenderSortKeyLayout(E_SCENE_NODE_RENDER_PASS pass) const = 0;
+
 		//! Get the default scene node factory which can create all built in scene nodes
 		/** \return Pointer to the default scene node factory
 		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
@@ -1665,6 +1858,18 @@ namespace scene
 			current callbacks manager and restore the default behavior. */
 		virtual void setLightManager(ILightManager* lightManager) = 0;
 
+		//! Creates a light manager which switches on the most relevant lights for each scene node.
+		/** Lights are sorted into a grid of view space clusters of the
+		active camera, each node gets the lights of the clusters its
+		bounding box touches which shine brightest on it. Register it with
+		setLightManager(). See IClusteredLightManager for details.
+		\param maxLightsPerNode Maximal number of lights switched on for
+		a node, 0 uses IVideoDriver::getMaximalDynamicLightAmount().
+		\return The light manager. If you no longer need it, you should
+		call IClusteredLightManager::drop(). See
+		IReferenceCounted::drop() for more information. */
+		virtual IClusteredLightManager* createClusteredLightManager(u32 maxLightsPerNode=0) = 0;
+
 		//! Get current render pass.
 		virtual E_SCENE_NODE_RENDER_PASS getCurrentRenderPass() const =0;
 
@@ -29,6 +29,35 @@ namespace scene
 	//! Typedef for list of scene node animators
 	typedef core::list<ISceneNodeAnimator*> ISceneNodeAnimatorList;
 
+	//! Changes of a scene graph which affect the lookups of nodes by id, name or type
+	enum E_SCENE_NODE_LOOKUP_CHANGE
+	{
+		//! The node and its children were attached to the graph.
+		ESNLC_ADDED = 0,
+
+		//! The node and its children are about to be detached from the graph.
+		ESNLC_REMOVED,
+
+		//! The name or the id of the node changed.
+		ESNLC_CHANGED
+	};
+
+	//! Result of the frustum test of a node before it registers, see scene::SCENE_NODE_BVH_CULLING
+	enum E_SCENE_NODE_PRE_CULLING
+	{
+		//! The node was not tested or is partially outside, it is culled as usual.
+		ESNPC_NONE = 0,
+
+		//! The bounding box of the node intersects the view frustum, so EAC_BOX would not cull it.
+		ESNPC_VISIBLE,
+
+		//! The node is outside of the view frustum, but some of its children are not.
+		ESNPC_CULLED,
+
+		//! The node and all of its children are outside of the view frustum.
+		ESNPC_SUBTREE_CULLED
+	};
+
 	//! Scene node interface.
 	/** A scene node is a node in the hierarchical scene graph. Every scene
 	node may have children, which are also scene nodes. Children move
@@ -49,7 +78,10 @@ namespace scene
 			: RelativeTranslation(position), RelativeRotation(rotation), RelativeScale(scale),
 				Parent(0), SceneManager(mgr), TriangleSelector(0), ID(id),
 				AutomaticCullingState(EAC_BOX), DebugDataVisible(EDS_OFF),
-				IsVisible(true), IsDebugObject(false)
+				IsVisible(true), IsDebugObject(false),
+				AbsoluteTransformationVersion(0), ParentTransformationVersion(0),
+				FrameTransformationVersion(0), PrevFrameTransformationVersion(0),
+				TransformationDirty(true), PreCulling(ESNPC_NONE)
 		{
 			if (parent)
 				parent->addChild(this);
@@ -78,7 +110,8 @@ namespace scene
 		/** Nodes may register themselves in the render pipeline during this call,
 		precalculate the geometry which should be renderered, and prevent their
 		children from being able to register themselves if they are clipped by simply
-		not calling their OnRegisterSceneNode method.
+		not calling their OnRegisterSceneNode method. Children whose whole subtree
+		was culled before the registration (see getPreCulling()) are skipped here.
 		If you are implementing your own scene node, you should overwrite this method
 		with an implementation code looking like this:
 		\code
@@ -94,7 +127,10 @@ namespace scene
 			{
 				ISceneNodeList::Iterator it = Children.begin();
 				for (; it != Children.end(); ++it)
-					(*it)->OnRegisterSceneNode();
+				{
+					if ((*it)->PreCulling != ESNPC_SUBTREE_CULLED)
+						(*it)->OnRegisterSceneNode();
+				}
 			}
 		}
 
@@ -127,6 +163,8 @@ namespace scene
 
 				// update absolute position
 				updateAbsolutePosition();
+				PrevFrameTransformationVersion = FrameTransformationVersion;
+				FrameTransformationVersion = AbsoluteTransformationVersion;
 
 				// perform the post render process on all children
 
@@ -154,6 +192,7 @@ namespace scene
 		virtual void setName(const c8* name)
 		{
 			Name = name;
+			notifyLookupChange(this, ESNLC_CHANGED);
 		}
 
 
@@ -162,6 +201,7 @@ namespace scene
 		virtual void setName(const core::stringc& name)
 		{
 			Name = name;
+			notifyLookupChange(this, ESNLC_CHANGED);
 		}
 
 
@@ -213,10 +253,43 @@ namespace scene
 		}
 
 
+		//! Returns if the absolute transformation was recalculated in the current frame.
+		/** True if updateAbsolutePosition() changed the absolute
+		transformation between the end of the OnAnimate() call of the
+		previous frame and the end of the last one, either because the
+		relative transformation of this node or of one of its parents
+		changed. Nodes which did not move return false. */
+		bool isAbsoluteTransformationUpdated() const
+		{
+			return FrameTransformationVersion != PrevFrameTransformationVersion;
+		}
+
+
+		//! Returns a number which changes every time the absolute transformation is recalculated.
+		/** Can be stored to find out if a node moved since then. */
+		u32 getAbsoluteTransformationVersion() const
+		{
+			return AbsoluteTransformationVersion;
+		}
+
+
+		//! Forces the next updateAbsolutePosition() to recalculate the absolute transformation.
+		/** updateAbsolutePosition() only recalculates the transformation
+		when the relative translation, rotation or scale or the parent
+		transformation changed. Nodes which override
+		getRelativeTransformation() with other data have to call this when
+		that data changes. */
+		void setTransformationDirty()
+		{
+			TransformationDirty = true;
+		}
+
+
 		//! Returns the relative transformation of the scene node.
 		/** The relative transformation is stored internally as 3
 		vectors: translation, rotation and scale. To get the relative
 		transformation matrix, it is calculated from these values.
+		If you override this, see setTransformationDirty().
 		\return The relative transformation matrix. */
 		virtual core::matrix4 getRelativeTransformation() const
 		{
@@ -285,6 +358,7 @@ namespace scene
 		virtual void setID(s32 id)
 		{
 			ID = id;
+			notifyLookupChange(this, ESNLC_CHANGED);
 		}
 
 
@@ -304,6 +378,8 @@ namespace scene
 				child->remove(); // remove from old parent
 				Children.push_back(child);
 				child->Parent = this;
+				child->TransformationDirty = true;
+				notifyLookupChange(child, ESNLC_ADDED);
 			}
 		}
 
@@ -320,7 +396,9 @@ namespace scene
 			for (; it != Children.end(); ++it)
 				if ((*it) == child)
 				{
+					notifyLookupChange(child, ESNLC_REMOVED);
 					(*it)->Parent = 0;
+					(*it)->TransformationDirty = true;
 					(*it)->drop();
 					Children.erase(it);
 					return true;
@@ -339,7 +417,9 @@ namespace scene
 			ISceneNodeList::Iterator it = Children.begin();
 			for (; it != Children.end(); ++it)
 			{
+				notifyLookupChange(*it, ESNLC_REMOVED);
 				(*it)->Parent = 0;
+				(*it)->TransformationDirty = true;
 				(*it)->drop();
 			}
 
@@ -559,6 +639,24 @@ namespace scene
 		}
 
 
+		//! Gets the result of the frustum test before the registration of the current frame.
+		/** Set by the scene manager when scene::SCENE_NODE_BVH_CULLING is
+		enabled, ESNPC_NONE otherwise. Nodes with EAC_OFF are never culled.
+		\return The result of the test. */
+		E_SCENE_NODE_PRE_CULLING getPreCulling() const
+		{
+			return PreCulling;
+		}
+
+
+		//! Sets the result of the frustum test before the registration.
+		/** Only used by the scene manager. */
+		void setPreCulling(E_SCENE_NODE_PRE_CULLING state)
+		{
+			PreCulling = state;
+		}
+
+
 		//! Sets if debug data like bounding boxes should be drawn.
 		/** A bitwise OR of the types from @ref irr::scene::E_DEBUG_SCENE_TYPE.
 		Please note that not all scene nodes support all debug data types.
@@ -661,16 +759,33 @@ namespace scene
 
 		//! Updates the absolute position based on the relative and the parents position
 		/** Note: This does not recursively update the parents absolute positions, so if you have a deeper
-			hierarchy you might want to update the parents first.*/
+			hierarchy you might want to update the parents first.
+			The transformation is only recalculated if the relative translation, rotation or scale
+			changed since the last update, if the parent was recalculated since then or after
+			setTransformationDirty(). So static nodes cost no matrix products per frame.*/
 		virtual void updateAbsolutePosition()
 		{
+			if (!TransformationDirty &&
+				(Parent ? Parent->AbsoluteTransformationVersion == ParentTransformationVersion : true) &&
+				equalsExact(RelativeTranslation, UpdatedTranslation) &&
+				equalsExact(RelativeRotation, UpdatedRotation) &&
+				equalsExact(RelativeScale, UpdatedScale))
+				return;
+
 			if (Parent)
 			{
 				AbsoluteTransformation =
 					Parent->getAbsoluteTransformation() * getRelativeTransformation();
+				ParentTransformationVersion = Parent->AbsoluteTransformationVersion;
 			}
 			else
 				AbsoluteTransformation = getRelativeTransformation();
+
+			UpdatedTranslation = RelativeTranslation;
+			UpdatedRotation = RelativeRotation;
+			UpdatedScale = RelativeScale;
+			TransformationDirty = false;
+			++AbsoluteTransformationVersion;
 		}
 
 
@@ -728,6 +843,7 @@ namespace scene
 				return;
 			Name = in->getAttributeAsString("Name", Name);
 			ID = in->getAttributeAsInt("Id", ID);
+			notifyLookupChange(this, ESNLC_CHANGED);
 
 			setPosition(in->getAttributeAsVector3d("Position", RelativeTranslation));
 			setRotation(in->getAttributeAsVector3d("Rotation", RelativeRotation));
@@ -783,6 +899,8 @@ namespace scene
 			DebugDataVisible = toCopyFrom->DebugDataVisible;
 			IsVisible = toCopyFrom->IsVisible;
 			IsDebugObject = toCopyFrom->IsDebugObject;
+			TransformationDirty = true;
+			notifyLookupChange(this, ESNLC_CHANGED);
 
 			if (newManager)
 				SceneManager = newManager;
@@ -809,6 +927,30 @@ namespace scene
 			}
 		}
 
+		//! exact compare, small steps must not be swallowed by a tolerance
+		static bool equalsExact(const core::vector3df& a, const core::vector3df& b)
+		{
+			return a.X == b.X && a.Y == b.Y && a.Z == b.Z;
+		}
+
+		//! Tells the root of the graph about a change of the node.
+		/** Used by the scene manager to keep its index of the nodes up to
+		date, see ISceneManager::setSceneNodeLookupIndexEnabled. Nodes
+		which write Name or ID directly outside of their constructor have to
+		call this with ESNLC_CHANGED. */
+		void notifyLookupChange(ISceneNode* node, E_SCENE_NODE_LOOKUP_CHANGE change)
+		{
+			ISceneNode* root = this;
+			while (root->Parent)
+				root = root->Parent;
+			root->onLookupChange(node, change);
+		}
+
+		//! Called on the root of the graph by notifyLookupChange.
+		virtual void onLookupChange(ISceneNode* node, E_SCENE_NODE_LOOKUP_CHANGE change)
+		{
+		}
+
 		//! Sets the new scene manager for this node and all children.
 		//! Called by addChild when moving nodes between scene managers
 		void setSceneManager(ISceneManager* newManager)
@@ -864,6 +1006,27 @@ namespace scene
 
 		//! Is debug object?
 		bool IsDebugObject;
+
+		//! Relative translation, rotation and scale of the last recalculation of AbsoluteTransformation
+		core::vector3df UpdatedTranslation;
+		core::vector3df UpdatedRotation;
+		core::vector3df UpdatedScale;
+
+		//! Incremented on every recalculation of AbsoluteTransformation
+		u32 AbsoluteTransformationVersion;
+
+		//! AbsoluteTransformationVersion of the parent used by the last recalculation
+		u32 ParentTransformationVersion;
+
+		//! AbsoluteTransformationVersion at the end of the last and the previous OnAnimate
+		u32 FrameTransformationVersion;
+		u32 PrevFrameTransformationVersion;
+
+		//! Recalculate the absolute transformation on the next update
+		bool TransformationDirty;
+
+		//! Frustum test before the registration of the current frame
+		E_SCENE_NODE_PRE_CULLING PreCulling;
 	};
 
 
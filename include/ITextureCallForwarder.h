@@ -0,0 +1,63 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_TEXTURE_CALL_FORWARDER_H_INCLUDED__
+#define __I_TEXTURE_CALL_FORWARDER_H_INCLUDED__
+
+namespace irr
+{
+namespace video
+{
+
+//! A texture function of IVideoDriver called on a thread which must not use the driver
+/** Created by the driver, see ITextureCallForwarder. */
+class ITextureCall
+{
+public:
+
+	//! Destructor
+	virtual ~ITextureCall() {}
+
+	//! Executes the texture function and stores its result.
+	/** Must be called on the thread which uses the driver. */
+	virtual void run() = 0;
+};
+
+
+//! Forwards the texture calls of other threads to the thread which uses the driver
+/** Textures can only be created on the thread rendering with the driver,
+but mesh loaders running on other threads (see
+scene::ISceneManager::getMeshAsync()) still ask the driver for their
+textures. While a forwarder is set with
+IVideoDriver::setTextureCallForwarder(), the driver passes
+IVideoDriver::getTexture(), findTexture(), addTexture(),
+makeNormalMapTexture() and the texture creation flags of each thread for
+which isForwardingThread() returns true to forward() instead of executing
+them.
+
+The texture creation flags of the forwarding threads start as a copy of
+the flags of the driver when the forwarder is set. Changing them does not
+change the flags of the driver thread, and forwarded calls are executed
+with them. */
+class ITextureCallForwarder
+{
+public:
+
+	//! Destructor
+	virtual ~ITextureCallForwarder() {}
+
+	//! Returns true if the texture calls of the calling thread have to be forwarded
+	virtual bool isForwardingThread() const = 0;
+
+	//! Lets the thread using the driver execute call->run()
+	/** Called on the forwarding thread, must not return before run() is
+	done. */
+	virtual void forward(ITextureCall* call) = 0;
+};
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
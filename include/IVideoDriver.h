@@ -47,6 +47,7 @@ namespace video
 	class IImageWriter;
 	class IMaterialRenderer;
 	class IGPUProgrammingServices;
+	class ITextureCallForwarder;
 	class IRenderTarget;
 
 	//! enumeration for geometry transformation states
@@ -1004,6 +1005,17 @@ namespace video
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws the vertices of a mesh buffer with other indices
+		/** The vertices come from the hardware buffer of the mesh buffer
+		when it has one, the indices are sent with the call. This draws
+		parts of a mesh buffer without a second hardware buffer for its
+		vertices, as for the visible clusters of an SClusteredMesh.
+		\param mb Buffer with the vertices and the primitive type.
+		\param indices Indices into the vertices of the buffer, of the
+		index type of the buffer.
+		\param primitiveCount Amount of primitives in the indices. */
+		virtual void drawMeshBufferIndices(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -1142,6 +1154,14 @@ namespace video
 		\return The current texture creation flag enabled mode. */
 		virtual bool getTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag) const =0;
 
+		//! Sets the forwarder for texture calls made on other threads.
+		/** See ITextureCallForwarder. Only one forwarder can be set at a
+		time, set 0 before setting another one. The forwarding threads
+		must not call the texture functions while the forwarder changes.
+		\param forwarder The new forwarder or 0.
+		\return False if another forwarder is set already. */
+		virtual bool setTextureCallForwarder(ITextureCallForwarder* forwarder) =0;
+
 		//! Creates a software images from a file.
 		/** No hardware texture will be created for those images. This
 		method is useful for example if you want to read a heightmap
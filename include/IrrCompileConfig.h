@@ -372,6 +372,18 @@ tool <http://developer.nvidia.com/object/nvperfhud_home.html>. */
 #undef _IRR_COMPILE_WITH_OCTREE_SCENENODE_
 #endif
 
+//! Define _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_ to support InstancedMeshSceneNodes
+#define _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+#ifdef NO_IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+#undef _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+#endif
+
+//! Define _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_ to support LODMeshSceneNodes
+#define _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+#ifdef NO_IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+#undef _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+#endif
+
 //! Define _IRR_COMPILE_WITH_TERRAIN_SCENENODE_ to support TerrainSceneNodes
 #define _IRR_COMPILE_WITH_TERRAIN_SCENENODE_
 #ifdef NO_IRR_COMPILE_WITH_TERRAIN_SCENENODE_
@@ -531,6 +543,11 @@ B3D, MS3D or X meshes */
 #ifdef NO_IRR_COMPILE_WITH_SMF_LOADER_
 #undef _IRR_COMPILE_WITH_SMF_LOADER_
 #endif
+//! Define _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_ if you want to load binary .irrbin mesh files
+#define _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#ifdef NO_IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#undef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#endif
 
 //! Define _IRR_COMPILE_WITH_IRR_WRITER_ if you want to write static .irrMesh files
 #define _IRR_COMPILE_WITH_IRR_WRITER_
@@ -562,6 +579,11 @@ B3D, MS3D or X meshes */
 #ifdef NO_IRR_COMPILE_WITH_B3D_WRITER_
 #undef _IRR_COMPILE_WITH_B3D_WRITER_
 #endif
+//! Define _IRR_COMPILE_WITH_IRR_BINARY_WRITER_ if you want to write binary .irrbin mesh files
+#define _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#ifdef NO_IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#undef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#endif
 
 //! Define _IRR_COMPILE_WITH_BMP_LOADER_ if you want to load .bmp files
 //! Disabling this loader will also disable the built-in font
@@ -21,6 +21,7 @@ namespace irr
 	class ILogger;
 	class IEventReceiver;
 	class IRandomizer;
+	class IFrameUpdater;
 
 	namespace io {
 		class IFileSystem;
@@ -211,6 +212,19 @@ namespace irr
 		/** \return Pointer to the current event receiver. Returns 0 if there is none. */
 		virtual IEventReceiver* getEventReceiver() = 0;
 
+		//! Sets application work which runs on a worker thread while a frame is drawn
+		/** While an updater is set, every call of run() waits for the
+		update of the last call, applies it and starts the update of the
+		next frame, see IFrameUpdater. Scene animation, culling and
+		drawing are not moved to other threads. Setting another updater
+		waits for a running update, its result is not applied.
+		\param updater New updater, 0 switches the pipelined updates off. */
+		virtual void setFrameUpdater(IFrameUpdater* updater) = 0;
+
+		//! Get the current frame updater.
+		/** \return Pointer to the current updater. Returns 0 if there is none. */
+		virtual IFrameUpdater* getFrameUpdater() const = 0;
+
 		//! Sends a user created event to the engine.
 		/** Is is usually not necessary to use this. However, if you
 		are using an own input library for example for doing joystick
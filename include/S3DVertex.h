@@ -8,6 +8,7 @@
 #include "vector3d.h"
 #include "vector2d.h"
 #include "SColor.h"
+#include "aabbox3d.h"
 
 namespace irr
 {
@@ -28,7 +29,14 @@ enum E_VERTEX_TYPE
 	/** Usually used for tangent space normal mapping. 
 		Usually tangent and binormal get send to shaders as texture coordinate sets 1 and 2.
 	*/
-	EVT_TANGENTS
+	EVT_TANGENTS,
+
+	//! Vertex with quantized position, normal and texture coordinates, video::S3DVertexCompact.
+	/** Saves memory and bandwidth for large static geometry. Positions
+		are relative to the bounding box of the mesh buffer, so draw them
+		with IVideoDriver::drawMeshBuffer().
+	*/
+	EVT_COMPACT
 };
 
 //! Array holding the built in vertex type names
@@ -37,6 +45,7 @@ const char* const sBuiltInVertexTypeNames[] =
 	"standard",
 	"2tcoords",
 	"tangents",
+	"compact",
 	0
 };
 
@@ -260,6 +269,168 @@ struct S3DVertexTangents : public S3DVertex
 
 
 
+//! Vertex with quantized position, normal and texture coordinates.
+/** Takes 16 bytes instead of the 36 bytes of S3DVertex. The position is
+stored in 16 bit steps of the bounding box of its mesh buffer, the normal in
+octahedral encoding with 8 bit per component, which keeps it within two
+thirds of a degree, and the texture coordinates as half floats. Changing the
+bounding box of the mesh buffer moves the vertices with it.
+*/
+struct S3DVertexCompact
+{
+	//! default constructor
+	S3DVertexCompact() {}
+
+	//! constructor, encodes the vertex into the box
+	S3DVertexCompact(const S3DVertex& vertex, const core::aabbox3df& box)
+		: Color(vertex.Color)
+	{
+		setPosition(vertex.Pos, box);
+		setNormal(vertex.Normal);
+		setTCoords(vertex.TCoords);
+	}
+
+	//! Position, 0 is the minimum edge of the box and 65535 the maximum edge
+	u16 Pos[3];
+
+	//! Normal in octahedral encoding, scaled to -127 to 127
+	s8 Normal[2];
+
+	//! Color
+	SColor Color;
+
+	//! Texture coordinates as half floats
+	u16 TCoords[2];
+
+	//! Stores the position in 16 bit steps of the box
+	void setPosition(const core::vector3df& pos, const core::aabbox3df& box)
+	{
+		const core::vector3df extent = box.getExtent();
+		const f32 p[3] = { pos.X - box.MinEdge.X, pos.Y - box.MinEdge.Y, pos.Z - box.MinEdge.Z };
+		const f32 e[3] = { extent.X, extent.Y, extent.Z };
+		for (u32 i=0; i<3; ++i)
+			Pos[i] = e[i] > 0.f ? (u16)core::clamp(core::round32(p[i] / e[i] * 65535.f), 0, 65535) : 0;
+	}
+
+	//! Returns the position in the box
+	core::vector3df getPosition(const core::aabbox3df& box) const
+	{
+		const core::vector3df scale = box.getExtent() / 65535.f;
+		return core::vector3df(box.MinEdge.X + Pos[0] * scale.X,
+			box.MinEdge.Y + Pos[1] * scale.Y,
+			box.MinEdge.Z + Pos[2] * scale.Z);
+	}
+
+	//! Stores the normal, choosing the nearest of the encoded directions
+	void setNormal(const core::vector3df& normal)
+	{
+		const f32 length = fabsf(normal.X) + fabsf(normal.Y) + fabsf(normal.Z);
+		if (length == 0.f)
+		{
+			Normal[0] = Normal[1] = 0;
+			return;
+		}
+
+		// project onto the octahedron and fold the lower half over
+		f32 x = normal.X / length;
+		f32 y = normal.Y / length;
+		if (normal.Z < 0.f)
+		{
+			const f32 fx = (1.f - fabsf(y)) * (x < 0.f ? -1.f : 1.f);
+			y = (1.f - fabsf(x)) * (y < 0.f ? -1.f : 1.f);
+			x = fx;
+		}
+
+		// rounding each component is not always closest on the sphere
+		const core::vector3df direction = core::vector3df(normal).normalize();
+		f32 best = -2.f;
+		const s32 bx = core::floor32(x * 127.f);
+		const s32 by = core::floor32(y * 127.f);
+		for (s32 i=0; i<4; ++i)
+		{
+			S3DVertexCompact candidate;
+			candidate.Normal[0] = (s8)core::clamp(bx + (i & 1), -127, 127);
+			candidate.Normal[1] = (s8)core::clamp(by + (i >> 1), -127, 127);
+			const f32 match = candidate.getNormal().dotProduct(direction);
+			if (match > best)
+			{
+				best = match;
+				Normal[0] = candidate.Normal[0];
+				Normal[1] = candidate.Normal[1];
+			}
+		}
+	}
+
+	//! Returns the normal with length 1
+	core::vector3df getNormal() const
+	{
+		f32 x = Normal[0] / 127.f;
+		f32 y = Normal[1] / 127.f;
+		const f32 z = 1.f - fabsf(x) - fabsf(y);
+		if (z < 0.f)
+		{
+			const f32 fx = (1.f - fabsf(y)) * (x < 0.f ? -1.f : 1.f);
+			y = (1.f - fabsf(x)) * (y < 0.f ? -1.f : 1.f);
+			x = fx;
+		}
+		return core::vector3df(x, y, z).normalize();
+	}
+
+	//! Stores the texture coordinates as half floats
+	void setTCoords(const core::vector2df& tcoords)
+	{
+		TCoords[0] = core::f32_to_f16(tcoords.X);
+		TCoords[1] = core::f32_to_f16(tcoords.Y);
+	}
+
+	//! Returns the texture coordinates
+	core::vector2df getTCoords() const
+	{
+		return core::vector2df(core::f16_to_f32(TCoords[0]), core::f16_to_f32(TCoords[1]));
+	}
+
+	//! Returns the vertex with floats, positioned in the box
+	S3DVertex getVertex(const core::aabbox3df& box) const
+	{
+		return S3DVertex(getPosition(box), getNormal(), Color, getTCoords());
+	}
+
+	bool operator==(const S3DVertexCompact& other) const
+	{
+		return Pos[0] == other.Pos[0] && Pos[1] == other.Pos[1] && Pos[2] == other.Pos[2] &&
+			Normal[0] == other.Normal[0] && Normal[1] == other.Normal[1] &&
+			Color == other.Color &&
+			TCoords[0] == other.TCoords[0] && TCoords[1] == other.TCoords[1];
+	}
+
+	bool operator!=(const S3DVertexCompact& other) const
+	{
+		return !(*this == other);
+	}
+
+	bool operator<(const S3DVertexCompact& other) const
+	{
+		u32 i;
+		for (i=0; i<3; ++i)
+			if (Pos[i] != other.Pos[i])
+				return Pos[i] < other.Pos[i];
+		for (i=0; i<2; ++i)
+			if (Normal[i] != other.Normal[i])
+				return Normal[i] < other.Normal[i];
+		if (Color != other.Color)
+			return Color < other.Color;
+		if (TCoords[0] != other.TCoords[0])
+			return TCoords[0] < other.TCoords[0];
+		return TCoords[1] < other.TCoords[1];
+	}
+
+	static E_VERTEX_TYPE getType()
+	{
+		return EVT_COMPACT;
+	}
+};
+
+
 inline u32 getVertexPitchFromType(E_VERTEX_TYPE vertexType)
 {
 	switch (vertexType)
@@ -268,6 +439,8 @@ inline u32 getVertexPitchFromType(E_VERTEX_TYPE vertexType)
 		return sizeof(video::S3DVertex2TCoords);
 	case video::EVT_TANGENTS:
 		return sizeof(video::S3DVertexTangents);
+	case video::EVT_COMPACT:
+		return sizeof(video::S3DVertexCompact);
 	default:
 		return sizeof(video::S3DVertex);
 	}
@@ -0,0 +1,88 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_CLUSTERED_MESH_H_INCLUDED__
+#define __S_CLUSTERED_MESH_H_INCLUDED__
+
+#include "SMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+	//! Cluster of neighbouring triangles in a mesh buffer
+	/** The triangles of a cluster are stored one after the other in the
+	indices of the mesh buffer. Besides the bounding box, a cluster has a
+	cone which contains the normals of all its triangles. A viewer inside
+	the cone behind the apex sees the back faces of all these triangles,
+	so with back face culling the cluster is invisible from there. */
+	struct SMeshCluster
+	{
+		SMeshCluster() : IndexStart(0), IndexCount(0), ConeCutoff(1.f) {}
+
+		//! returns if the cluster shows only back faces to a viewer at this position
+		bool isBackFacingFrom(const core::vector3df& viewer) const
+		{
+			if (ConeCutoff >= 1.f)
+				return false;
+			return (ConeApex - viewer).normalize().dotProduct(ConeAxis) >= ConeCutoff;
+		}
+
+		//! returns if the cluster shows only back faces when viewed along the normalized direction
+		/** This is the test for orthogonal projections. */
+		bool isBackFacingAlong(const core::vector3df& direction) const
+		{
+			return ConeCutoff < 1.f && direction.dotProduct(ConeAxis) >= ConeCutoff;
+		}
+
+		//! first index of the triangles of the cluster
+		u32 IndexStart;
+		//! number of indices, three per triangle
+		u32 IndexCount;
+		//! box around the vertices of the triangles
+		core::aabbox3df BoundingBox;
+		//! apex of the cone of back facing view positions
+		core::vector3df ConeApex;
+		//! normalized average direction of the triangle normals
+		core::vector3df ConeAxis;
+		//! sine of the largest angle between a triangle normal and the axis
+		/** 1 when the normals spread too far for culling. */
+		f32 ConeCutoff;
+	};
+
+	//! Mesh whose mesh buffers are split into clusters of triangles
+	/** Created by IMeshManipulator::createMeshClustered(). An
+	IMeshSceneNode with this mesh culls the clusters of each mesh buffer
+	against the view frustum and, with back face culling, by their cones,
+	and draws the visible ones only. */
+	struct SClusteredMesh : public SMesh
+	{
+		SClusteredMesh()
+		{
+			#ifdef _DEBUG
+			setDebugName("SClusteredMesh");
+			#endif
+		}
+
+		//! clean mesh
+		virtual void clear() _IRR_OVERRIDE_
+		{
+			SMesh::clear();
+			Clusters.clear();
+		}
+
+		//! returns EAMT_CLUSTERED
+		virtual E_ANIMATED_MESH_TYPE getMeshType() const _IRR_OVERRIDE_
+		{
+			return EAMT_CLUSTERED;
+		}
+
+		//! clusters of each mesh buffer, empty for buffers which are drawn as a whole
+		core::array<core::array<SMeshCluster> > Clusters;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,452 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_COMPACT_MESH_BUFFER_H_INCLUDED__
+#define __S_COMPACT_MESH_BUFFER_H_INCLUDED__
+
+#include "irrArray.h"
+#include "IMeshBuffer.h"
+
+namespace irr
+{
+namespace scene
+{
+	//! Implementation of the IMeshBuffer interface with video::S3DVertexCompact vertices
+	/** The positions of the vertices are stored relative to the bounding
+	box, which therefore has to be set before the vertices are encoded and
+	is kept by recalculateBoundingBox(). Create these buffers with
+	IMeshManipulator::createMeshCompact().
+
+	The compact vertices have no floats the position, normal and texture
+	coordinate accessors of IMeshBuffer could return, so these decode all
+	vertices into a copy on first use and return its values. Changes made
+	through the references of the non-const accessors are encoded into the
+	vertices again by the next setDirty() or recalculateBoundingBox(), which
+	grow the box around positions outside of it. setPosition(), setNormal()
+	and setTCoords() encode a single vertex right away. The copy takes 36
+	bytes per vertex, more than twice the compact vertices, and is kept until
+	freeDecoded() is called or the buffer is destroyed. Like all changes of a
+	mesh buffer, decoding is not thread safe. */
+	struct SCompactMeshBuffer : public IMeshBuffer
+	{
+		//! constructor
+		SCompactMeshBuffer()
+			: ChangedID_Vertex(1), ChangedID_Index(1)
+			, MappingHintVertex(EHM_NEVER), MappingHintIndex(EHM_NEVER)
+			, PrimitiveType(EPT_TRIANGLES), DecodedID(0), DecodedWritten(false)
+		{
+			#ifdef _DEBUG
+			setDebugName("SCompactMeshBuffer");
+			#endif
+		}
+
+		//! returns the material of this meshbuffer
+		virtual const video::SMaterial& getMaterial() const _IRR_OVERRIDE_
+		{
+			return Material;
+		}
+
+		//! returns the material of this meshbuffer
+		virtual video::SMaterial& getMaterial() _IRR_OVERRIDE_
+		{
+			return Material;
+		}
+
+		//! returns pointer to vertices
+		virtual const void* getVertices() const _IRR_OVERRIDE_
+		{
+			return Vertices.const_pointer();
+		}
+
+		//! returns pointer to vertices
+		virtual void* getVertices() _IRR_OVERRIDE_
+		{
+			return Vertices.pointer();
+		}
+
+		//! returns amount of vertices
+		virtual u32 getVertexCount() const _IRR_OVERRIDE_
+		{
+			return Vertices.size();
+		}
+
+		//! returns pointer to indices
+		virtual const u16* getIndices() const _IRR_OVERRIDE_
+		{
+			return Indices.const_pointer();
+		}
+
+		//! returns pointer to indices
+		virtual u16* getIndices() _IRR_OVERRIDE_
+		{
+			return Indices.pointer();
+		}
+
+		//! returns amount of indices
+		virtual u32 getIndexCount() const _IRR_OVERRIDE_
+		{
+			return Indices.size();
+		}
+
+		//! Get type of index data which is stored in this meshbuffer.
+		virtual video::E_INDEX_TYPE getIndexType() const _IRR_OVERRIDE_
+		{
+			return video::EIT_16BIT;
+		}
+
+		//! returns the box the vertex positions are stored in
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_
+		{
+			return BoundingBox;
+		}
+
+		//! set the box the vertex positions are stored in, which moves the vertices
+		virtual void setBoundingBox(const core::aabbox3df& box) _IRR_OVERRIDE_
+		{
+			BoundingBox = box;
+			DecodedID = 0;
+		}
+
+		//! returns which type of vertex data is stored.
+		virtual video::E_VERTEX_TYPE getVertexType() const _IRR_OVERRIDE_
+		{
+			return video::EVT_COMPACT;
+		}
+
+		//! fits the bounding box to the vertices and encodes them into it again
+		virtual void recalculateBoundingBox() _IRR_OVERRIDE_
+		{
+			if (Vertices.empty())
+			{
+				BoundingBox.reset(0,0,0);
+				Decoded.clear();
+				DecodedWritten = false;
+				DecodedID = 0;
+				return;
+			}
+
+			const bool keepDecoded = !Decoded.empty();
+			getDecoded();
+			storeDecoded(true);
+			++ChangedID_Vertex;
+			if (!keepDecoded)
+				Decoded.clear();
+		}
+
+		//! returns position of vertex i
+		virtual const core::vector3df& getPosition(u32 i) const _IRR_OVERRIDE_
+		{
+			return getDecoded()[i].Pos;
+		}
+
+		//! returns position of vertex i, changes are stored in the vertex by setDirty()
+		virtual core::vector3df& getPosition(u32 i) _IRR_OVERRIDE_
+		{
+			DecodedWritten = true;
+			return getDecoded()[i].Pos;
+		}
+
+		//! returns normal of vertex i
+		virtual const core::vector3df& getNormal(u32 i) const _IRR_OVERRIDE_
+		{
+			return getDecoded()[i].Normal;
+		}
+
+		//! returns normal of vertex i, changes are stored in the vertex by setDirty()
+		virtual core::vector3df& getNormal(u32 i) _IRR_OVERRIDE_
+		{
+			DecodedWritten = true;
+			return getDecoded()[i].Normal;
+		}
+
+		//! returns texture coord of vertex i
+		virtual const core::vector2df& getTCoords(u32 i) const _IRR_OVERRIDE_
+		{
+			return getDecoded()[i].TCoords;
+		}
+
+		//! returns texture coord of vertex i, changes are stored in the vertex by setDirty()
+		virtual core::vector2df& getTCoords(u32 i) _IRR_OVERRIDE_
+		{
+			DecodedWritten = true;
+			return getDecoded()[i].TCoords;
+		}
+
+		//! encodes the position of vertex i, the box grows when the position is outside of it
+		/** Call setDirty() when done with the changes. */
+		void setPosition(u32 i, const core::vector3df& pos)
+		{
+			storeWritten();
+			if (BoundingBox.isPointInside(pos))
+			{
+				Vertices[i].setPosition(pos, BoundingBox);
+				if (isDecoded())
+					Decoded[i].Pos = Vertices[i].getPosition(BoundingBox);
+				return;
+			}
+
+			// all vertices move with the box
+			const bool keepDecoded = !Decoded.empty();
+			getDecoded()[i].Pos = pos;
+			storeDecoded(false);
+			if (!keepDecoded)
+				Decoded.clear();
+		}
+
+		//! encodes the normal of vertex i
+		/** Call setDirty() when done with the changes. */
+		void setNormal(u32 i, const core::vector3df& normal)
+		{
+			storeWritten();
+			Vertices[i].setNormal(normal);
+			if (isDecoded())
+				Decoded[i].Normal = Vertices[i].getNormal();
+		}
+
+		//! encodes the texture coordinates of vertex i
+		/** Call setDirty() when done with the changes. */
+		void setTCoords(u32 i, const core::vector2df& tcoords)
+		{
+			storeWritten();
+			Vertices[i].setTCoords(tcoords);
+			if (isDecoded())
+				Decoded[i].TCoords = Vertices[i].getTCoords();
+		}
+
+		//! Append compact vertices stored in the same box and their indices
+		virtual void append(const void* const vertices, u32 numVertices, const u16* const indices, u32 numIndices) _IRR_OVERRIDE_
+		{
+			if (vertices == getVertices())
+				return;
+
+			storeWritten();
+			const u32 vertexCount = getVertexCount();
+			u32 i;
+
+			Vertices.reallocate(vertexCount+numVertices);
+			for (i=0; i<numVertices; ++i)
+				Vertices.push_back(reinterpret_cast<const video::S3DVertexCompact*>(vertices)[i]);
+
+			Indices.reallocate(getIndexCount()+numIndices);
+			for (i=0; i<numIndices; ++i)
+				Indices.push_back(indices[i]+vertexCount);
+
+			DecodedID = 0;
+		}
+
+		//! append the meshbuffer to the current buffer
+		/** The box grows around the new vertices and all vertices are
+		encoded into it again. Vertices beyond the 16 bit indices are not
+		appended. */
+		virtual void append(const IMeshBuffer* const other) _IRR_OVERRIDE_
+		{
+			if (this==other)
+				return;
+
+			const u32 vertexCount = getVertexCount();
+			const u32 numVertices = other->getVertexCount();
+			if (vertexCount+numVertices > 65536)
+			{
+				_IRR_DEBUG_BREAK_IF(true);
+				return;
+			}
+
+			const bool keepDecoded = !Decoded.empty();
+			core::array<video::S3DVertex>& decoded = getDecoded();
+			decoded.reallocate(vertexCount+numVertices);
+			const void* vertices = other->getVertices();
+			u32 i;
+			for (i=0; i<numVertices; ++i)
+			{
+				video::SColor color;
+				switch (other->getVertexType())
+				{
+				case video::EVT_2TCOORDS:
+					color = reinterpret_cast<const video::S3DVertex2TCoords*>(vertices)[i].Color;
+					break;
+				case video::EVT_TANGENTS:
+					color = reinterpret_cast<const video::S3DVertexTangents*>(vertices)[i].Color;
+					break;
+				case video::EVT_COMPACT:
+					color = reinterpret_cast<const video::S3DVertexCompact*>(vertices)[i].Color;
+					break;
+				default:
+					color = reinterpret_cast<const video::S3DVertex*>(vertices)[i].Color;
+					break;
+				}
+				decoded.push_back(video::S3DVertex(other->getPosition(i), other->getNormal(i), color, other->getTCoords(i)));
+			}
+
+			const u32 numIndices = other->getIndexCount();
+			Indices.reallocate(getIndexCount()+numIndices);
+			if (other->getIndexType()==video::EIT_32BIT)
+			{
+				const u32* indices = reinterpret_cast<const u32*>(other->getIndices());
+				for (i=0; i<numIndices; ++i)
+					Indices.push_back((u16)(indices[i]+vertexCount));
+			}
+			else
+			{
+				const u16* indices = other->getIndices();
+				for (i=0; i<numIndices; ++i)
+					Indices.push_back((u16)(indices[i]+vertexCount));
+			}
+
+			storeDecoded(vertexCount==0);
+			++ChangedID_Vertex;
+			++ChangedID_Index;
+			if (!keepDecoded)
+				Decoded.clear();
+		}
+
+		//! get the current hardware mapping hint
+		virtual E_HARDWARE_MAPPING getHardwareMappingHint_Vertex() const _IRR_OVERRIDE_
+		{
+			return MappingHintVertex;
+		}
+
+		//! get the current hardware mapping hint
+		virtual E_HARDWARE_MAPPING getHardwareMappingHint_Index() const _IRR_OVERRIDE_
+		{
+			return MappingHintIndex;
+		}
+
+		//! set the hardware mapping hint, for driver
+		virtual void setHardwareMappingHint( E_HARDWARE_MAPPING NewMappingHint, E_BUFFER_TYPE buffer=EBT_VERTEX_AND_INDEX ) _IRR_OVERRIDE_
+		{
+			if (buffer==EBT_VERTEX_AND_INDEX || buffer==EBT_VERTEX)
+				MappingHintVertex=NewMappingHint;
+			if (buffer==EBT_VERTEX_AND_INDEX || buffer==EBT_INDEX)
+				MappingHintIndex=NewMappingHint;
+		}
+
+		//! Describe what kind of primitive geometry is used by the meshbuffer
+		virtual void setPrimitiveType(E_PRIMITIVE_TYPE type) _IRR_OVERRIDE_
+		{
+			PrimitiveType = type;
+		}
+
+		//! Get the kind of primitive geometry which is used by the meshbuffer
+		virtual E_PRIMITIVE_TYPE getPrimitiveType() const _IRR_OVERRIDE_
+		{
+			return PrimitiveType;
+		}
+
+		//! flags the mesh as changed, reloads hardware buffers and stores changes of the decoded copy
+		virtual void setDirty(E_BUFFER_TYPE buffer=EBT_VERTEX_AND_INDEX) _IRR_OVERRIDE_
+		{
+			if (buffer==EBT_VERTEX_AND_INDEX || buffer==EBT_VERTEX)
+			{
+				storeWritten();
+				++ChangedID_Vertex;
+			}
+			if (buffer==EBT_VERTEX_AND_INDEX || buffer==EBT_INDEX)
+				++ChangedID_Index;
+		}
+
+		//! Get the currently used ID for identification of changes.
+		/** This shouldn't be used for anything outside the VideoDriver. */
+		virtual u32 getChangedID_Vertex() const _IRR_OVERRIDE_ {return ChangedID_Vertex;}
+
+		//! frees the decoded copy of the vertices made by the position, normal and texture coordinate accessors
+		/** Call this when done with these accessors, e.g. after collision
+		or picking setup. The next access decodes the vertices again. */
+		void freeDecoded()
+		{
+			storeWritten();
+			Decoded.clear();
+			DecodedID = 0;
+		}
+
+		//! Get the currently used ID for identification of changes.
+		/** This shouldn't be used for anything outside the VideoDriver. */
+		virtual u32 getChangedID_Index() const _IRR_OVERRIDE_ {return ChangedID_Index;}
+
+		//! Material of this meshBuffer
+		video::SMaterial Material;
+
+		//! Array of vertices, stored relative to the bounding box
+		core::array<video::S3DVertexCompact> Vertices;
+
+		//! Array of indices
+		core::array<u16> Indices;
+
+		//! ID used for hardware buffer management
+		u32 ChangedID_Vertex;
+
+		//! ID used for hardware buffer management
+		u32 ChangedID_Index;
+
+		//! Bounding box, the vertex positions are stored relative to it
+		core::aabbox3df BoundingBox;
+
+		//! hardware mapping hint
+		E_HARDWARE_MAPPING MappingHintVertex;
+		E_HARDWARE_MAPPING MappingHintIndex;
+
+		//! Primitive type used for rendering (triangles, lines, ...)
+		E_PRIMITIVE_TYPE PrimitiveType;
+
+	private:
+
+		//! the copy matches the vertices
+		bool isDecoded() const
+		{
+			return DecodedID == ChangedID_Vertex && Decoded.size() == Vertices.size();
+		}
+
+		//! decodes the vertices when they changed since the last call
+		core::array<video::S3DVertex>& getDecoded() const
+		{
+			if (!isDecoded())
+			{
+				Decoded.set_used(Vertices.size());
+				for (u32 i=0; i<Vertices.size(); ++i)
+					Decoded[i] = Vertices[i].getVertex(BoundingBox);
+				DecodedID = ChangedID_Vertex;
+			}
+			return Decoded;
+		}
+
+		//! encodes the decoded copy, fitting the box to it or growing the box around it
+		void storeDecoded(bool fitBox)
+		{
+			if (!Decoded.empty())
+			{
+				if (fitBox)
+					BoundingBox.reset(Decoded[0].Pos);
+				for (u32 i=0; i<Decoded.size(); ++i)
+					BoundingBox.addInternalPoint(Decoded[i].Pos);
+			}
+
+			Vertices.set_used(Decoded.size());
+			for (u32 i=0; i<Decoded.size(); ++i)
+				Vertices[i] = video::S3DVertexCompact(Decoded[i], BoundingBox);
+
+			// decode again, the copy has the values before quantization
+			DecodedWritten = false;
+			DecodedID = 0;
+		}
+
+		//! encodes the changes made through the non-const accessors
+		void storeWritten()
+		{
+			if (DecodedWritten && isDecoded())
+				storeDecoded(false);
+			DecodedWritten = false;
+		}
+
+		//! decoded copy of the vertices for the accessors
+		mutable core::array<video::S3DVertex> Decoded;
+		mutable u32 DecodedID;
+
+		//! a reference into the copy was handed out by a non-const accessor
+		bool DecodedWritten;
+	};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -47,6 +47,10 @@ namespace irr
 #endif
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
+			BurningVideoThreads(0),
+			BurningVideoTiledTextures(false),
+			BurningVideoGuardBand(false),
+			BurningVideoSimd(true),
 			UsePerformanceTimer(true),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
@@ -80,6 +84,10 @@ namespace irr
 			LoggingLevel = other.LoggingLevel;
 			DisplayAdapter = other.DisplayAdapter;
 			DriverMultithreaded = other.DriverMultithreaded;
+			BurningVideoThreads = other.BurningVideoThreads;
+			BurningVideoTiledTextures = other.BurningVideoTiledTextures;
+			BurningVideoGuardBand = other.BurningVideoGuardBand;
+			BurningVideoSimd = other.BurningVideoSimd;
 			UsePerformanceTimer = other.UsePerformanceTimer;
 			return *this;
 		}
@@ -288,6 +296,45 @@ namespace irr
 			So far only supported on D3D. */
 		bool DriverMultithreaded;
 
+		//! Number of threads used by the Burning's Video rasterizer.
+		/** Default is 0, which rasterizes on the calling thread only. Values
+			greater than 1 enable the tile binned rasterizer: triangles of larger
+			draw calls are sorted into horizontal bands of the render target and
+			the bands are filled in parallel. The output is identical to the
+			single threaded rasterizer. Only supported by EDT_BURNINGSVIDEO. */
+		u32 BurningVideoThreads;
+
+		//! Texel layout of the textures sampled by Burning's Video.
+		/** Default is false, mipmap levels are sampled in row major order. When
+			true every texture additionally keeps its levels in 4x4 texel tiles,
+			so the 2x2 footprint of a bilinear fetch mostly stays in one cache line.
+			This helps magnified textures and surfaces seen at steep angles, and
+			doubles the texture memory. ITexture::lock still returns the row major
+			data; the tiles are rebuilt on unlock and regenerateMipMapLevels.
+			Only supported by EDT_BURNINGSVIDEO. */
+		bool BurningVideoTiledTextures;
+
+		//! Clipping of triangles crossing the left, right, top or bottom frustum plane in Burning's Video.
+		/** Default is false, such triangles are clipped against the frustum
+			and the resulting polygon is drawn as triangle fan. When true,
+			triangles reaching less than a few viewport sizes outside are drawn
+			unclipped and the rasterizer skips the pixels outside the viewport.
+			Only triangles crossing the near or far plane or reaching further
+			out are still clipped. Mipmap selection then happens once for the
+			whole triangle, so edges of the screen can pick other levels.
+			The driver attributes "ClipTrianglesInside", "ClipTrianglesOutside",
+			"ClipTrianglesGuardBand" and "ClipTrianglesClipped" count the
+			triangles of the last frame per path.
+			Only supported by EDT_BURNINGSVIDEO. */
+		bool BurningVideoGuardBand;
+
+		//! Use of vector instructions in Burning's Video.
+		/** Default is true, textured scanlines and vertex processing use
+			SSE2 when the CPU has it. The output is identical to the scalar
+			code, which runs when false, e.g. to compare both.
+			Only supported by EDT_BURNINGSVIDEO. */
+		bool BurningVideoSimd;
+
 		//! Enables use of high performance timers on Windows platform.
 		/** When performance timers are not used, standard GetTickCount()
 		is used instead which usually has worse resolution, but also less
@@ -0,0 +1,121 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_RENDER_SORT_KEY_H_INCLUDED__
+#define __S_RENDER_SORT_KEY_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Values which can be packed into the sort key of a render pass
+	enum E_RENDER_SORT_KEY_FIELD
+	{
+		//! Material type of the first material, groups nodes by material renderer
+		ERSKF_MATERIAL_TYPE = 0,
+
+		//! First texture of the first material, groups nodes by texture
+		/** Textures are numbered in the order they show up in the pass, so
+		this does not sort by texture pointer. */
+		ERSKF_TEXTURE,
+
+		//! Distance of the node position to the camera, front to back
+		ERSKF_DEPTH,
+
+		//! Distance of the node position to the camera, back to front
+		ERSKF_DEPTH_INVERSE,
+
+		//! Not used as field, counts the fields
+		ERSKF_COUNT
+	};
+
+	//! Layout of the 64 bit key by which the nodes of a render pass are sorted.
+	/** The first field is stored in the highest bits and so sorts first.
+	Values which do not fit into the bits of their field are clamped
+	(material type), wrapped (texture) or quantized (depth). Nodes with
+	the same key are drawn in the order they were registered, so an empty
+	layout keeps the registration order.
+	\code
+	scene::SRenderSortKeyLayout layout;
+	layout.addField(scene::ERSKF_TEXTURE, 16);
+	layout.addField(scene::ERSKF_DEPTH, 24);
+	smgr->setRenderSortKeyLayout(scene::ESNRP_SOLID, layout);
+	\endcode
+	*/
+	struct SRenderSortKeyLayout
+	{
+		//! Maximal number of fields
+		enum { MAX_FIELDS = 8 };
+
+		SRenderSortKeyLayout() : FieldCount(0) {}
+
+		//! Appends a field below the fields which were added before.
+		/** \param field Value stored in the field.
+		\param bits Width of the field, depth is at most 32 bits wide.
+		\return False if there are no bits or fields left, the layout is not changed then. */
+		bool addField(E_RENDER_SORT_KEY_FIELD field, u32 bits)
+		{
+			if (field >= ERSKF_COUNT || bits == 0 || FieldCount == MAX_FIELDS ||
+				getBitCount() + bits > 64)
+				return false;
+
+			if ((field == ERSKF_DEPTH || field == ERSKF_DEPTH_INVERSE) && bits > 32)
+				return false;
+
+			Field[FieldCount] = field;
+			Bits[FieldCount] = bits;
+			FieldCount += 1;
+			return true;
+		}
+
+		//! Returns true if the layout contains the field
+		bool hasField(E_RENDER_SORT_KEY_FIELD field) const
+		{
+			for (u32 i=0; i<FieldCount; ++i)
+				if (Field[i] == field)
+					return true;
+			return false;
+		}
+
+		//! Returns the number of bits used by all fields
+		u32 getBitCount() const
+		{
+			u32 bits = 0;
+			for (u32 i=0; i<FieldCount; ++i)
+				bits += Bits[i];
+			return bits;
+		}
+
+		bool operator==(const SRenderSortKeyLayout& other) const
+		{
+			if (FieldCount != other.FieldCount)
+				return false;
+			for (u32 i=0; i<FieldCount; ++i)
+				if (Field[i] != other.Field[i] || Bits[i] != other.Bits[i])
+					return false;
+			return true;
+		}
+
+		bool operator!=(const SRenderSortKeyLayout& other) const
+		{
+			return !(*this == other);
+		}
+
+		//! Fields from the highest to the lowest bits
+		E_RENDER_SORT_KEY_FIELD Field[MAX_FIELDS];
+
+		//! Width of the fields
+		u32 Bits[MAX_FIELDS];
+
+		//! Number of used entries in Field and Bits
+		u32 FieldCount;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // __S_RENDER_SORT_KEY_H_INCLUDED__
+
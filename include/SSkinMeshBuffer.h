@@ -181,6 +181,8 @@ struct SSkinMeshBuffer : public IMeshBuffer
 				}
 				break;
 			}
+			default:
+				break;
 		}
 	}
 
@@ -29,6 +29,60 @@ namespace scene
 	**/
 	const c8* const ALLOW_ZWRITE_ON_TRANSPARENT = "Allow_ZWrite_On_Transparent";
 
+	//! Name of the parameter for building the render lists with several threads
+	/** Usually the scene manager culls every node in
+	registerNodeForRendering() while the scene graph is traversed. If this
+	parameter is larger than 1, the culling and the sorting into the solid,
+	transparent, effect, shadow and gui lists is done after the traversal
+	with the given number of threads. The lists of each thread are merged
+	in traversal order, so nodes are drawn in the same order as without
+	threads. Default is 0, which culls on the calling thread.
+	The threads call these methods of the registered nodes concurrently:
+	getAutomaticCulling(), getBoundingBox(), getTransformedBoundingBox(),
+	getAbsoluteTransformation(), getMaterialCount() and getMaterial(). They
+	also call IVideoDriver::getOcclusionQueryResult() and
+	IVideoDriver::needsTransparentRenderPass(). Custom scene nodes and
+	drivers must not modify anything in them when this parameter is used.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::RENDER_LIST_THREADS, 4);
+	\endcode
+	**/
+	const c8* const RENDER_LIST_THREADS = "Render_List_Threads";
+
+	//! Flag to reject nodes with a bounding volume hierarchy before they register
+	/** With this flag the scene manager keeps a tree of the world space
+	bounding boxes of all nodes in the scene graph. Only the boxes of nodes
+	which moved or changed their bounding box are refitted each frame.
+	Before the registration the tree is tested against the view frustum and
+	the result is stored in each node, see ISceneNode::getPreCulling().
+	OnRegisterSceneNode is not called for subtrees which are completely
+	outside, so anything nodes do there is skipped while they are invisible.
+	It is always called for particle systems, nodes with EAC_OFF and their
+	parents. Nodes which remain are tested with their automatic culling
+	mode as usual, except that the EAC_BOX test is already done by the tree.
+	This helps scenes with many nodes of which most are invisible.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::SCENE_NODE_BVH_CULLING, true);
+	\endcode
+	**/
+	const c8* const SCENE_NODE_BVH_CULLING = "SceneNode_BVH_Culling";
+
+	//! Name of the parameter for building stencil shadow volumes with several threads
+	/** Shadow volume scene nodes keep the volume of each light as long as
+	neither their mesh nor the position of the light relative to the node
+	changes. If this parameter is larger than 1, the volumes which have to
+	be rebuilt are built by the given number of threads before the shadow
+	pass, split by node and light. Default is 0, which builds them on the
+	calling thread while drawing.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::SHADOW_VOLUME_THREADS, 4);
+	\endcode
+	**/
+	const c8* const SHADOW_VOLUME_THREADS = "Shadow_Volume_Threads";
+
 	//! Deprecated, use IMeshLoader::getMeshTextureLoader()->setTexturePath instead.
 	/** Was used for changing the texture path of the built-in csm loader like this:
 	\code
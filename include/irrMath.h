@@ -674,6 +674,62 @@ namespace core
 		return x - floorf ( x );
 	}
 
+	//! Converts a float to a 16 bit half float, rounded to the nearest even value
+	/** Values beyond the range of half floats become infinity. */
+	inline u16 f32_to_f16(f32 value)
+	{
+		inttofloat v;
+		v.f = value;
+		const u32 sign = (v.u >> 16) & 0x8000;
+		const u32 bits = v.u & 0x7fffffff;
+
+		// infinity, NaN and overflow
+		if (bits >= 0x47800000)
+			return (u16)(sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 : 0));
+
+		// denormals, from 2^-25 on
+		if (bits < 0x38800000)
+		{
+			if (bits < 0x33000000)
+				return (u16)sign;
+			const u32 mantissa = (bits & 0x7fffff) | 0x800000;
+			const u32 shift = 126 - (bits >> 23);
+			u32 half = mantissa >> shift;
+			const u32 rest = mantissa & ((1 << shift) - 1);
+			if (rest > (1u << (shift - 1)) || (rest == (1u << (shift - 1)) && (half & 1)))
+				++half;
+			return (u16)(sign | half);
+		}
+
+		// rebias the exponent, a carry of the rounding may give infinity
+		u32 half = (bits - 0x38000000) >> 13;
+		const u32 rest = bits & 0x1fff;
+		if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+			++half;
+		return (u16)(sign | half);
+	}
+
+	//! Converts a 16 bit half float to a float
+	inline f32 f16_to_f32(u16 value)
+	{
+		const u32 sign = (u32)(value & 0x8000) << 16;
+		const u32 exponent = (value >> 10) & 0x1f;
+		const u32 mantissa = value & 0x3ff;
+
+		inttofloat v;
+		if (exponent == 0x1f)
+			v.u = sign | 0x7f800000 | (mantissa << 13);
+		else if (exponent)
+			v.u = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		else
+		{
+			// denormals are multiples of 2^-24
+			v.f = mantissa * (1.f / 16777216.f);
+			v.u |= sign;
+		}
+		return v.f;
+	}
+
 } // end namespace core
 } // end namespace irr
 
@@ -71,6 +71,7 @@
 #include "IEventReceiver.h"
 #include "IFileList.h"
 #include "IFileSystem.h"
+#include "IFrameUpdater.h"
 #include "IGeometryCreator.h"
 #include "IGPUProgrammingServices.h"
 #include "IGUIButton.h"
@@ -104,6 +105,8 @@
 #include "IImageLoader.h"
 #include "IImageWriter.h"
 #include "IIndexBuffer.h"
+#include "IInstancedMeshSceneNode.h"
+#include "ILODMeshSceneNode.h"
 #include "ILightSceneNode.h"
 #include "ILogger.h"
 #include "IMaterialRenderer.h"
@@ -112,6 +115,7 @@
 #include "IMeshBuffer.h"
 #include "IMeshCache.h"
 #include "IMeshLoader.h"
+#include "IMeshLoadRequest.h"
 #include "IMeshManipulator.h"
 #include "IMeshSceneNode.h"
 #include "IMeshWriter.h"
@@ -152,6 +156,7 @@
 #include "ITerrainSceneNode.h"
 #include "ITextSceneNode.h"
 #include "ITexture.h"
+#include "ITextureCallForwarder.h"
 #include "ITimer.h"
 #include "ITriangleSelector.h"
 #include "IVertexBuffer.h"
@@ -162,6 +167,7 @@
 #include "IXMLReader.h"
 #include "IXMLWriter.h"
 #include "ILightManager.h"
+#include "IClusteredLightManager.h"
 #include "Keycodes.h"
 #include "line2d.h"
 #include "line3d.h"
@@ -169,6 +175,7 @@
 #include "plane3d.h"
 #include "position2d.h"
 #include "quaternion.h"
+#include "radixsort.h"
 #include "rect.h"
 #include "S3DVertex.h"
 #include "SAnimatedMesh.h"
@@ -184,6 +191,9 @@
 #include "SMeshBufferLightMap.h"
 #include "SMeshBufferTangents.h"
 #include "SParticle.h"
+#include "SRenderSortKey.h"
+#include "SCompactMeshBuffer.h"
+#include "SClusteredMesh.h"
 #include "SSharedMeshBuffer.h"
 #include "SSkinMeshBuffer.h"
 #include "SVertexIndex.h"
@@ -0,0 +1,89 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_RADIXSORT_H_INCLUDED__
+#define __IRR_RADIXSORT_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! Sorts an array with size 'size' by an unsigned 64 bit key member using radix sort.
+/** The sort is stable: elements with the same key keep their order. It
+needs linear time and a second buffer 'temp' of the same size. Bytes in
+which all keys are equal are skipped, so short keys are sorted in fewer
+passes.
+\param array_ Elements to sort, contains the result afterwards.
+\param temp Buffer with at least 'size' elements, contents are undefined afterwards.
+\param size Number of elements.
+\param key Member of T which holds the sort key, e.g. &SEntry::SortKey */
+template<class T>
+inline void radixsort(T* array_, T* temp, u32 size, u64 T::*key)
+{
+	// insertion sort is faster for a few elements and stable as well
+	if (size < 32)
+	{
+		for (u32 i=1; i<size; ++i)
+		{
+			const T t = array_[i];
+			u32 j = i;
+			for (; j>0 && t.*key < array_[j-1].*key; --j)
+				array_[j] = array_[j-1];
+			array_[j] = t;
+		}
+		return;
+	}
+
+	u32 histogram[8][256];
+	for (u32 b=0; b<8; ++b)
+		for (u32 d=0; d<256; ++d)
+			histogram[b][d] = 0;
+
+	for (u32 i=0; i<size; ++i)
+	{
+		const u64 k = array_[i].*key;
+		for (u32 b=0; b<8; ++b)
+			histogram[b][(k >> (b*8)) & 0xFF] += 1;
+	}
+
+	T* src = array_;
+	T* dst = temp;
+	for (u32 b=0; b<8; ++b)
+	{
+		u32* count = histogram[b];
+
+		// all keys have the same digit, nothing to do
+		if (count[(src[0].*key >> (b*8)) & 0xFF] == size)
+			continue;
+
+		u32 offset = 0;
+		for (u32 d=0; d<256; ++d)
+		{
+			const u32 c = count[d];
+			count[d] = offset;
+			offset += c;
+		}
+
+		for (u32 i=0; i<size; ++i)
+			dst[count[(src[i].*key >> (b*8)) & 0xFF]++] = src[i];
+
+		T* t = src;
+		src = dst;
+		dst = t;
+	}
+
+	if (src != array_)
+	{
+		for (u32 i=0; i<size; ++i)
+			array_[i] = src[i];
+	}
+}
+
+} // end namespace core
+} // end namespace irr
+
+#endif
+
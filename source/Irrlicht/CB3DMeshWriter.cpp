@@ -237,6 +237,20 @@ bool CB3DMeshWriter::writeMesh(io::IWriteFile* file, IMesh* const mesh, s32 flag
                     }
                 }
                 break;
+                case EVT_COMPACT:
+                {
+                    S3DVertexCompact *v = (S3DVertexCompact *) mb->getVertices();
+                    const SColorf col(v[j].Color);
+                    writeColor(file, col);
+
+                    const core::vector2df uv1 = v[j].getTCoords();
+                    writeVector2(file, uv1);
+                    if (texcoordsCount == 2)
+                    {
+                        writeVector2(file, core::vector2df(0.f, 0.f));
+                    }
+                }
+                break;
             }
         }
     }
@@ -692,6 +692,7 @@ REALINLINE void CBurningShader_Raster_Reference::scanline2()
 	// apply top-left fill-convention, left
 	pShader.xStart = fill_convention_left( line.x[0] );
 	pShader.xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(pShader.xStart, pShader.xEnd, x);
 
 	pShader.dx = pShader.xEnd - pShader.xStart;
 	if ( pShader.dx < 0 )
@@ -758,6 +759,7 @@ REALINLINE void CBurningShader_Raster_Reference::scanline ()
 	// apply top-left fill-convention, left
 	pShader.xStart = fill_convention_left( line.x[0] );
 	pShader.xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(pShader.xStart, pShader.xEnd, x);
 
 	pShader.dx = pShader.xEnd - pShader.xStart;
 	if ( pShader.dx < 0 )
@@ -935,6 +937,7 @@ void CBurningShader_Raster_Reference::drawTriangle(const s4DVertex* burning_rest
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 		subPixel = ( (f32) yStart ) - a->Pos.y;
 
@@ -1051,6 +1054,7 @@ void CBurningShader_Raster_Reference::drawTriangle(const s4DVertex* burning_rest
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 
 		subPixel = ( (f32) yStart ) - b->Pos.y;
@@ -0,0 +1,377 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CClusteredLightManager.h"
+#include "ILightSceneNode.h"
+#include "ICameraSceneNode.h"
+#include "IVideoDriver.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CClusteredLightManager::CClusteredLightManager(ISceneManager* mgr, u32 maxLightsPerNode)
+	: SceneManager(mgr), LightList(0), CurrentRenderPass(ESNRP_NONE),
+	Near(1.f), Far(1.f), DepthScale(0.f), Orthogonal(false), GridValid(false),
+	TilesX(16), TilesY(8), Slices(16), MaxLightsPerNode(maxLightsPerNode), Stamp(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CClusteredLightManager");
+	#endif
+}
+
+
+void CClusteredLightManager::setClusterGrid(u32 tilesX, u32 tilesY, u32 slices)
+{
+	TilesX = core::max_(tilesX, 1u);
+	TilesY = core::max_(tilesY, 1u);
+	Slices = core::max_(slices, 1u);
+}
+
+
+void CClusteredLightManager::OnPreRender(core::array<ISceneNode*>& lightList)
+{
+	LightList = &lightList;
+	Lights.set_used(0);
+	GlobalLights.set_used(0);
+	ClusterItems.set_used(0);
+	Selected.set_used(0);
+	GridValid = false;
+}
+
+
+void CClusteredLightManager::OnPostRender()
+{
+	// switched off lights would not register in the next frame
+	for (u32 i=0; i<Lights.size(); ++i)
+	{
+		if (!Lights[i].On)
+			Lights[i].Node->setVisible(true);
+	}
+
+	Lights.set_used(0);
+	Selected.set_used(0);
+	LightList = 0;
+}
+
+
+void CClusteredLightManager::OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	CurrentRenderPass = renderPass;
+}
+
+
+void CClusteredLightManager::OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	if (renderPass != ESNRP_LIGHT)
+		return;
+
+	collectLights();
+	buildClusters();
+
+	// all driver lights exist now, nodes switch on what they need
+	for (s32 i=(s32)Lights.size()-1; i>=0; --i)
+	{
+		Lights[i].Node->setVisible(false);
+		Lights[i].On = false;
+	}
+}
+
+
+void CClusteredLightManager::OnNodePreRender(ISceneNode* node)
+{
+	if (CurrentRenderPass == ESNRP_SHADOW || Lights.empty())
+		return;
+
+	const core::aabbox3df box = node->getTransformedBoundingBox();
+	const u32 limit = getLimit();
+
+	++Stamp;
+	Candidates.set_used(0);
+
+	for (u32 i=0; i<GlobalLights.size(); ++i)
+		addCandidate(GlobalLights[i], box, limit);
+
+	core::aabbox3df viewBox(box);
+	View.transformBoxEx(viewBox);
+
+	SRange range;
+	if (GridValid && getRange(viewBox, range))
+	{
+		for (u32 z=range.Z0; z<=range.Z1; ++z)
+		{
+			for (u32 y=range.Y0; y<=range.Y1; ++y)
+			{
+				const u32 cluster = (z * TilesY + y) * TilesX;
+				const u32 first = ClusterOffsets[cluster + range.X0];
+				const u32 last = ClusterOffsets[cluster + range.X1 + 1];
+				for (u32 i=first; i<last; ++i)
+				{
+					SLightEntry& light = Lights[ClusterItems[i]];
+					if (light.Mark != Stamp)
+					{
+						light.Mark = Stamp;
+						addCandidate(ClusterItems[i], box, limit);
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		// outside of the view frustum or without camera every light is tested
+		for (u32 i=0; i<Lights.size(); ++i)
+		{
+			if (!Lights[i].Global)
+				addCandidate(i, box, limit);
+		}
+	}
+
+	// switch off first, so the driver has free hardware lights for the new ones
+	for (u32 i=0; i<Candidates.size(); ++i)
+		Lights[Candidates[i].Light].Selected = Stamp;
+
+	for (u32 i=0; i<Selected.size(); ++i)
+	{
+		SLightEntry& light = Lights[Selected[i]];
+		if (light.Selected != Stamp && light.On)
+		{
+			light.Node->setVisible(false);
+			light.On = false;
+		}
+	}
+
+	Selected.set_used(Candidates.size());
+	for (u32 i=0; i<Candidates.size(); ++i)
+	{
+		SLightEntry& light = Lights[Candidates[i].Light];
+		if (!light.On)
+		{
+			light.Node->setVisible(true);
+			light.On = true;
+		}
+		Selected[i] = Candidates[i].Light;
+	}
+}
+
+
+void CClusteredLightManager::collectLights()
+{
+	if (!LightList)
+		return;
+
+	for (u32 i=0; i<LightList->size(); ++i)
+	{
+		ISceneNode* node = (*LightList)[i];
+		if (node->getType() != ESNT_LIGHT)
+			continue;
+
+		ILightSceneNode* lightNode = static_cast<ILightSceneNode*>(node);
+		const video::SLight& data = lightNode->getLightData();
+
+		SLightEntry light;
+		light.Node = lightNode;
+		light.Position = data.Position;
+		light.Attenuation = data.Attenuation;
+		light.Radius = data.Radius;
+		light.Brightness = data.DiffuseColor.r * 0.299f + data.DiffuseColor.g * 0.587f + data.DiffuseColor.b * 0.114f;
+		light.Mark = 0;
+		light.Selected = 0;
+		light.Global = data.Type == video::ELT_DIRECTIONAL || data.Radius <= 0.f;
+		light.On = true;
+
+		if (light.Global)
+			GlobalLights.push_back(Lights.size());
+		Lights.push_back(light);
+	}
+}
+
+
+void CClusteredLightManager::buildClusters()
+{
+	ClusterItems.set_used(0);
+	GridValid = false;
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return;
+
+	Near = camera->getNearValue();
+	Far = camera->getFarValue();
+	Orthogonal = camera->isOrthogonal();
+	if (Far <= Near || (!Orthogonal && Near <= 0.f))
+		return;
+
+	View = camera->getViewMatrix();
+	Projection = camera->getProjectionMatrix();
+	if (Orthogonal)
+		DepthScale = Slices / (Far - Near);
+	else
+		DepthScale = Slices / logf(Far / Near);
+
+	// count the lights of each cluster, then store them in one array
+	const u32 clusterCount = TilesX * TilesY * Slices;
+	ClusterOffsets.set_used(clusterCount + 1);
+	memset(ClusterOffsets.pointer(), 0, (clusterCount + 1) * sizeof(u32));
+	LightRanges.set_used(Lights.size());
+
+	u32 total = 0;
+	for (u32 i=0; i<Lights.size(); ++i)
+	{
+		SRange& range = LightRanges[i];
+		range.X1 = 0;
+		range.X0 = 1;
+		if (Lights[i].Global)
+			continue;
+
+		core::vector3df center;
+		View.transformVect(center, Lights[i].Position);
+		const core::vector3df extent(Lights[i].Radius);
+		if (!getRange(core::aabbox3df(center - extent, center + extent), range))
+		{
+			range.X1 = 0;
+			range.X0 = 1;
+			continue;
+		}
+
+		for (u32 z=range.Z0; z<=range.Z1; ++z)
+			for (u32 y=range.Y0; y<=range.Y1; ++y)
+				for (u32 x=range.X0; x<=range.X1; ++x)
+					++ClusterOffsets[(z * TilesY + y) * TilesX + x + 1];
+
+		total += (range.X1 - range.X0 + 1) * (range.Y1 - range.Y0 + 1) * (range.Z1 - range.Z0 + 1);
+	}
+
+	for (u32 c=0; c<clusterCount; ++c)
+		ClusterOffsets[c + 1] += ClusterOffsets[c];
+
+	// fill from the back, so the offsets end up at the start of each cluster
+	ClusterItems.set_used(total);
+	for (s32 i=(s32)Lights.size()-1; i>=0; --i)
+	{
+		const SRange& range = LightRanges[i];
+		if (range.X0 > range.X1)
+			continue;
+
+		for (u32 z=range.Z0; z<=range.Z1; ++z)
+			for (u32 y=range.Y0; y<=range.Y1; ++y)
+				for (u32 x=range.X0; x<=range.X1; ++x)
+					ClusterItems[--ClusterOffsets[(z * TilesY + y) * TilesX + x + 1]] = (u32)i;
+	}
+
+	// ClusterOffsets[c+1] now holds the start of cluster c
+	for (u32 c=0; c<clusterCount; ++c)
+		ClusterOffsets[c] = ClusterOffsets[c + 1];
+	ClusterOffsets[clusterCount] = total;
+
+	GridValid = true;
+}
+
+
+bool CClusteredLightManager::getRange(const core::aabbox3df& viewBox, SRange& range) const
+{
+	const f32 zMin = core::max_(viewBox.MinEdge.Z, Near);
+	const f32 zMax = core::min_(viewBox.MaxEdge.Z, Far);
+	if (zMin > zMax)
+		return false;
+
+	// the corners of the box cut to the depth range span its projection
+	f32 xMin = FLT_MAX, xMax = -FLT_MAX;
+	f32 yMin = FLT_MAX, yMax = -FLT_MAX;
+	for (u32 i=0; i<8; ++i)
+	{
+		const core::vector3df corner(i & 1 ? viewBox.MaxEdge.X : viewBox.MinEdge.X,
+			i & 2 ? viewBox.MaxEdge.Y : viewBox.MinEdge.Y,
+			i & 4 ? zMax : zMin);
+
+		f32 clip[4];
+		Projection.transformVect(clip, corner);
+		if (clip[3] <= 0.f)
+		{
+			xMin = yMin = -1.f;
+			xMax = yMax = 1.f;
+			break;
+		}
+
+		const f32 x = clip[0] / clip[3];
+		const f32 y = clip[1] / clip[3];
+		xMin = core::min_(xMin, x);
+		xMax = core::max_(xMax, x);
+		yMin = core::min_(yMin, y);
+		yMax = core::max_(yMax, y);
+	}
+
+	if (xMax < -1.f || xMin > 1.f || yMax < -1.f || yMin > 1.f)
+		return false;
+
+	range.X0 = (u32)core::clamp(core::floor32((xMin + 1.f) * 0.5f * TilesX), 0, (s32)TilesX - 1);
+	range.X1 = (u32)core::clamp(core::floor32((xMax + 1.f) * 0.5f * TilesX), 0, (s32)TilesX - 1);
+	range.Y0 = (u32)core::clamp(core::floor32((yMin + 1.f) * 0.5f * TilesY), 0, (s32)TilesY - 1);
+	range.Y1 = (u32)core::clamp(core::floor32((yMax + 1.f) * 0.5f * TilesY), 0, (s32)TilesY - 1);
+	range.Z0 = getSlice(zMin);
+	range.Z1 = getSlice(zMax);
+	return true;
+}
+
+
+u32 CClusteredLightManager::getSlice(f32 z) const
+{
+	const f32 slice = Orthogonal ? (z - Near) * DepthScale : logf(z / Near) * DepthScale;
+	return (u32)core::clamp(core::floor32(slice), 0, (s32)Slices - 1);
+}
+
+
+void CClusteredLightManager::addCandidate(u32 index, const core::aabbox3df& box, u32 limit)
+{
+	const SLightEntry& light = Lights[index];
+
+	f32 distance = 0.f;
+	if (!light.Global)
+	{
+		const core::vector3df closest(core::clamp(light.Position.X, box.MinEdge.X, box.MaxEdge.X),
+			core::clamp(light.Position.Y, box.MinEdge.Y, box.MaxEdge.Y),
+			core::clamp(light.Position.Z, box.MinEdge.Z, box.MaxEdge.Z));
+		const f32 distanceSQ = closest.getDistanceFromSQ(light.Position);
+		if (distanceSQ > light.Radius * light.Radius)
+			return;
+		distance = sqrtf(distanceSQ);
+	}
+
+	// the brightness of the light at the closest point of the box
+	const f32 attenuation = light.Attenuation.X + (light.Attenuation.Y + light.Attenuation.Z * distance) * distance;
+	SCandidate candidate;
+	candidate.Score = light.Brightness / core::max_(attenuation, 0.0001f);
+	candidate.Light = index;
+
+	// few lights are kept, so insertion into the sorted list is enough
+	u32 i = Candidates.size();
+	if (i < limit)
+		Candidates.push_back(candidate);
+	else if (candidate.Score > Candidates[i - 1].Score)
+		--i;
+	else
+		return;
+
+	for (; i > 0 && Candidates[i - 1].Score < candidate.Score; --i)
+		Candidates[i] = Candidates[i - 1];
+	Candidates[i] = candidate;
+}
+
+
+u32 CClusteredLightManager::getLimit() const
+{
+	const video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	const u32 driverLimit = driver ? driver->getMaximalDynamicLightAmount() : 0;
+
+	u32 limit = MaxLightsPerNode ? MaxLightsPerNode : driverLimit;
+	if (driverLimit && limit > driverLimit)
+		limit = driverLimit;
+	return limit ? limit : 8;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
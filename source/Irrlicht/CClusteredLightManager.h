@@ -0,0 +1,116 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+#define __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+
+#include "IClusteredLightManager.h"
+#include "matrix4.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ILightSceneNode;
+
+	//! implementation of the IClusteredLightManager
+	class CClusteredLightManager : public IClusteredLightManager
+	{
+	public:
+
+		//! constructor
+		CClusteredLightManager(ISceneManager* mgr, u32 maxLightsPerNode);
+
+		virtual void OnPreRender(core::array<ISceneNode*>& lightList) _IRR_OVERRIDE_;
+		virtual void OnPostRender() _IRR_OVERRIDE_;
+		virtual void OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass) _IRR_OVERRIDE_;
+		virtual void OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass) _IRR_OVERRIDE_;
+		virtual void OnNodePreRender(ISceneNode* node) _IRR_OVERRIDE_;
+		virtual void OnNodePostRender(ISceneNode* node) _IRR_OVERRIDE_ {}
+
+		virtual void setClusterGrid(u32 tilesX, u32 tilesY, u32 slices) _IRR_OVERRIDE_;
+		virtual u32 getClusterTilesX() const _IRR_OVERRIDE_ { return TilesX; }
+		virtual u32 getClusterTilesY() const _IRR_OVERRIDE_ { return TilesY; }
+		virtual u32 getClusterSlices() const _IRR_OVERRIDE_ { return Slices; }
+		virtual void setMaxLightsPerNode(u32 count) _IRR_OVERRIDE_ { MaxLightsPerNode = count; }
+		virtual u32 getMaxLightsPerNode() const _IRR_OVERRIDE_ { return MaxLightsPerNode; }
+		virtual u32 getClusterLightCount() const _IRR_OVERRIDE_ { return ClusterItems.size(); }
+
+	private:
+
+		struct SLightEntry
+		{
+			ILightSceneNode* Node;
+			core::vector3df Position;
+			core::vector3df Attenuation;
+			f32 Radius;
+			f32 Brightness;
+			//! stamp of the last node it was a candidate for
+			u32 Mark;
+			//! stamp of the last node it was selected for
+			u32 Selected;
+			bool Global;
+			bool On;
+		};
+
+		//! inclusive cluster coordinates
+		struct SRange
+		{
+			u32 X0, X1, Y0, Y1, Z0, Z1;
+		};
+
+		struct SCandidate
+		{
+			f32 Score;
+			u32 Light;
+		};
+
+		//! reads the lights created in the light pass
+		void collectLights();
+
+		//! puts the lights into the clusters of the active camera
+		void buildClusters();
+
+		//! clusters touched by a view space box, false if it is outside the grid
+		bool getRange(const core::aabbox3df& viewBox, SRange& range) const;
+
+		u32 getSlice(f32 z) const;
+
+		//! scores a light for the box and keeps the best ones
+		void addCandidate(u32 light, const core::aabbox3df& box, u32 limit);
+
+		//! number of lights to switch on for a node
+		u32 getLimit() const;
+
+		ISceneManager* SceneManager;
+		core::array<ISceneNode*>* LightList;
+		E_SCENE_NODE_RENDER_PASS CurrentRenderPass;
+
+		core::array<SLightEntry> Lights;
+		core::array<u32> GlobalLights;
+		core::array<u32> ClusterOffsets;
+		core::array<u32> ClusterItems;
+		core::array<SRange> LightRanges;
+		core::array<SCandidate> Candidates;
+		core::array<u32> Selected;
+
+		core::matrix4 View;
+		core::matrix4 Projection;
+		f32 Near;
+		f32 Far;
+		f32 DepthScale;
+		bool Orthogonal;
+		bool GridValid;
+
+		u32 TilesX;
+		u32 TilesY;
+		u32 Slices;
+		u32 MaxLightsPerNode;
+		u32 Stamp;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -17,6 +17,9 @@ namespace video
 //! constructor
 CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
 : Buffer(0), Size(0,0)
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+	, HiZ(0), HiZDirty(0), HiZWidth(0), HiZHeight(0)
+#endif
 {
 	#ifdef _DEBUG
 	setDebugName("CDepthBuffer");
@@ -35,6 +38,10 @@ CDepthBuffer::~CDepthBuffer()
 		delete[] Buffer;
 		Buffer = 0;
 	}
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+	delete[] HiZ;
+	delete[] HiZDirty;
+#endif
 }
 
 
@@ -51,6 +58,20 @@ void CDepthBuffer::clear(f32 value, interlaced_control interlaced)
 #endif
 
 	memset32_interlaced(Buffer, zMaxValue.u, Pitch, Size.Height, interlaced);
+
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+	const u32 tiles = HiZWidth * HiZHeight;
+	if (interlaced.bypass)
+	{
+		memset32(HiZ, zMaxValue.u, tiles * sizeof(f32));
+		memset(HiZDirty, HIZ_VALID, tiles);
+	}
+	else
+	{
+		memset(HiZDirty, HIZ_INVALID, tiles);
+	}
+	HiZStale.set_used(0);
+#endif
 }
 
 
@@ -69,6 +90,15 @@ void CDepthBuffer::setSize(const core::dimension2d<u32>& size)
 	size_t TotalSize = Pitch * size.Height;
 	Buffer = new u8[align_next(TotalSize,16)];
 
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+	delete[] HiZ;
+	delete[] HiZDirty;
+	HiZWidth = (size.Width + (1 << SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2) - 1) >> SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	HiZHeight = (size.Height + (1 << SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2) - 1) >> SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	HiZ = new f32[align_next(HiZWidth * HiZHeight, 4)];
+	HiZDirty = new u8[align_next(HiZWidth * HiZHeight, 4)];
+#endif
+
 	clear( 1.f, interlace_disabled());
 }
 
@@ -80,6 +110,110 @@ const core::dimension2d<u32>& CDepthBuffer::getSize() const
 	return Size;
 }
 
+
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+
+//! clip the pixel rectangle to the buffer and convert it to tiles. false if outside
+static inline bool hiz_tile_rect(s32& x0, s32& y0, s32& x1, s32& y1, const core::dimension2d<u32>& size)
+{
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 >= (s32)size.Width) x1 = (s32)size.Width - 1;
+	if (y1 >= (s32)size.Height) y1 = (s32)size.Height - 1;
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	x0 >>= SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	y0 >>= SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	x1 >>= SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	y1 >>= SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	return true;
+}
+
+//! marks the tiles of the pixel rectangle [x0;x1]x[y0;y1] as written.
+//! monotonic: written only where w >= z, the old bound stays a valid lower bound
+void CDepthBuffer::hiz_touch(s32 x0, s32 y0, s32 x1, s32 y1, bool monotonic)
+{
+	if (!hiz_tile_rect(x0, y0, x1, y1, Size))
+		return;
+
+	for (s32 y = y0; y <= y1; ++y)
+	{
+		if (!monotonic)
+		{
+			memset(HiZDirty + y * HiZWidth + x0, HIZ_INVALID, x1 - x0 + 1);
+			continue;
+		}
+
+		u32 tile = y * HiZWidth + x0;
+		for (s32 x = x0; x <= x1; ++x, ++tile)
+		{
+			if (HiZDirty[tile] == HIZ_VALID)
+			{
+				HiZDirty[tile] = HIZ_STALE;
+				HiZStale.push_back(tile);
+			}
+		}
+	}
+}
+
+//! recalculate the bounds of all tiles written monotonic since the last refresh
+void CDepthBuffer::hiz_refresh()
+{
+	for (u32 i = 0; i < HiZStale.size(); ++i)
+	{
+		if (HiZDirty[HiZStale[i]] != HIZ_VALID)
+			hiz_update(HiZStale[i]);
+	}
+	HiZStale.set_used(0);
+}
+
+//! true if w fails the depth test ( w >= z ) at every pixel of the rectangle [x0;x1]x[y0;y1]
+bool CDepthBuffer::hiz_reject(s32 x0, s32 y0, s32 x1, s32 y1, f32 w)
+{
+	if (!hiz_tile_rect(x0, y0, x1, y1, Size))
+		return true;
+
+	for (s32 y = y0; y <= y1; ++y)
+	{
+		u32 tile = y * HiZWidth + x0;
+		for (s32 x = x0; x <= x1; ++x, ++tile)
+		{
+			if (HiZDirty[tile] == HIZ_INVALID)
+				hiz_update(tile);
+			if (w >= HiZ[tile])
+				return false;
+		}
+	}
+	return true;
+}
+
+//! recalculate the depth bound of a written tile
+void CDepthBuffer::hiz_update(u32 tile)
+{
+	const u32 tx = (tile % HiZWidth) << SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	const u32 ty = (tile / HiZWidth) << SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2;
+	const u32 w = core::min_(Size.Width - tx, (u32)1 << SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2);
+	const u32 h = core::min_(Size.Height - ty, (u32)1 << SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2);
+
+	const fp24* z = (const fp24*)(Buffer + ty * Pitch) + tx;
+	f32 bound = FLT_MAX;
+	for (u32 y = 0; y < h; ++y)
+	{
+		for (u32 x = 0; x < w; ++x)
+		{
+			if (z[x] < bound)
+				bound = z[x];
+		}
+		z = (const fp24*)((const u8*)z + Pitch);
+	}
+
+	HiZ[tile] = bound;
+	HiZDirty[tile] = HIZ_VALID;
+}
+
+#endif // SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+
 // -----------------------------------------------------------------
 
 //! constructor
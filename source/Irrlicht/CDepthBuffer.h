@@ -6,6 +6,7 @@
 #define __C_Z_BUFFER_H_INCLUDED__
 
 #include "IDepthBuffer.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -40,12 +41,41 @@ namespace video
 		//! returns pitch of depthbuffer (in bytes)
 		virtual u32 getPitch() const _IRR_OVERRIDE_ { return Pitch; }
 
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+		//! marks the tiles of the pixel rectangle [x0;x1]x[y0;y1] as written.
+		//! monotonic: written only where w >= z, the old bound stays a valid lower bound
+		void hiz_touch(s32 x0, s32 y0, s32 x1, s32 y1, bool monotonic);
+
+		//! recalculate the bounds of all tiles written monotonic since the last refresh
+		void hiz_refresh();
+
+		//! true if w fails the depth test ( w >= z ) at every pixel of the rectangle [x0;x1]x[y0;y1]
+		bool hiz_reject(s32 x0, s32 y0, s32 x1, s32 y1, f32 w);
+#endif
 
 	private:
 
 		u8* Buffer;
 		core::dimension2d<u32> Size;
 		u32 Pitch;
+
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+		//! recalculate the depth bound of a written tile
+		void hiz_update(u32 tile);
+
+		enum eHiZState
+		{
+			HIZ_VALID = 0,
+			HIZ_STALE = 1,	// bound is valid but may be too low
+			HIZ_INVALID = 2	// bound has to be recalculated before use
+		};
+
+		f32* HiZ; // per tile lower bound of the stored depth
+		u8* HiZDirty; // eHiZState per tile
+		core::array<u32> HiZStale; // tiles which became HIZ_STALE since the last refresh
+		u32 HiZWidth;
+		u32 HiZHeight;
+#endif
 	};
 
 
@@ -45,6 +45,19 @@ core::matrix4 CDummyTransformationSceneNode::getRelativeTransformation() const
 	return RelativeTransformationMatrix;
 }
 
+//! Updates the absolute position, also when only the relative matrix changed.
+void CDummyTransformationSceneNode::updateAbsolutePosition()
+{
+	// the matrix is handed out by reference, so changes can only be found by comparing
+	if (RelativeTransformationMatrix != UpdatedTransformationMatrix)
+	{
+		UpdatedTransformationMatrix = RelativeTransformationMatrix;
+		setTransformationDirty();
+	}
+
+	IDummyTransformationSceneNode::updateAbsolutePosition();
+}
+
 //! Creates a clone of this scene node and its children.
 ISceneNode* CDummyTransformationSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
 {
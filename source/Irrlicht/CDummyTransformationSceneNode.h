@@ -30,6 +30,9 @@ namespace scene
 		//! Returns the relative transformation of the scene node.
 		virtual core::matrix4 getRelativeTransformation() const _IRR_OVERRIDE_;
 
+		//! Updates the absolute position, also when only the relative matrix changed.
+		virtual void updateAbsolutePosition() _IRR_OVERRIDE_;
+
 		//! does nothing.
 		virtual void render() _IRR_OVERRIDE_ {}
 
@@ -52,6 +55,7 @@ namespace scene
 		virtual void setPosition(const core::vector3df& newpos) _IRR_OVERRIDE_;
 
 		core::matrix4 RelativeTransformationMatrix;
+		core::matrix4 UpdatedTransformationMatrix;
 		core::aabbox3d<f32> Box;
 	};
 
@@ -0,0 +1,779 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IFileSystem.h"
+#include "CMeshBuffer.h"
+#include "SViewFrustum.h"
+#include "radixsort.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! instances per cluster, which are culled together
+	const u32 INSTANCE_CLUSTER_SIZE = 64;
+
+	struct SMortonEntry
+	{
+		u64 SortKey;
+		u32 Index;
+	};
+
+	//! spreads 10 bits to every third bit
+	inline u32 spreadBits(u32 v)
+	{
+		v &= 0x3FF;
+		v = (v | (v << 16)) & 0x030000FF;
+		v = (v | (v << 8)) & 0x0300F00F;
+		v = (v | (v << 4)) & 0x030C30C3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	inline u32 quantize(f32 value, f32 minimum, f32 scale)
+	{
+		const f32 q = (value - minimum) * scale;
+		return q <= 0.f ? 0 : q >= 1023.f ? 1023 : (u32)q;
+	}
+
+	inline video::SColor modulate(const video::SColor& a, const video::SColor& b)
+	{
+		return video::SColor((a.getAlpha() * b.getAlpha()) / 255,
+			(a.getRed() * b.getRed()) / 255,
+			(a.getGreen() * b.getGreen()) / 255,
+			(a.getBlue() * b.getBlue()) / 255);
+	}
+
+	inline void transformVertex(video::S3DVertex& v, const core::matrix4& m, const core::matrix4* normalMatrix)
+	{
+		m.transformVect(v.Pos);
+		if (normalMatrix)
+		{
+			normalMatrix->rotateVect(v.Normal);
+			v.Normal.normalize();
+		}
+		else
+			m.rotateVect(v.Normal);
+	}
+
+	inline void transformVertex(video::S3DVertexTangents& v, const core::matrix4& m, const core::matrix4* normalMatrix)
+	{
+		transformVertex((video::S3DVertex&)v, m, normalMatrix);
+		m.rotateVect(v.Tangent);
+		m.rotateVect(v.Binormal);
+		if (normalMatrix)
+		{
+			v.Tangent.normalize();
+			v.Binormal.normalize();
+		}
+	}
+
+	//! copies the instances of src into dst, transformed into node space
+	template <class T>
+	void fillBatch(CMeshBuffer<T>* dst, const IMeshBuffer* src, const u32* instances, u32 count,
+		const core::array<core::matrix4>& transformations, const core::array<video::SColor>& colors)
+	{
+		const T* vertices = (const T*)src->getVertices();
+		const u16* indices = src->getIndices();
+		const u32 vertexCount = src->getVertexCount();
+		const u32 indexCount = src->getIndexCount();
+
+		dst->Vertices.set_used(count * vertexCount);
+		dst->Indices.set_used(count * indexCount);
+		T* v = dst->Vertices.pointer();
+		u16* index = dst->Indices.pointer();
+
+		for (u32 n=0; n<count; ++n)
+		{
+			const core::matrix4& m = transformations[instances[n]];
+			const video::SColor color = colors[instances[n]];
+			const bool modulateColor = color.color != 0xFFFFFFFF;
+
+			// scaled instances need the inverse transposed matrix for the normals
+			const bool scaled = !m.getScale().equals(core::vector3df(1.f, 1.f, 1.f));
+			const core::matrix4 normalMatrix = scaled ?
+				core::matrix4(m, core::matrix4::EM4CONST_INVERSE_TRANSPOSED) : core::matrix4(core::matrix4::EM4CONST_NOTHING);
+
+			for (u32 i=0; i<vertexCount; ++i, ++v)
+			{
+				*v = vertices[i];
+				transformVertex(*v, m, scaled ? &normalMatrix : 0);
+				if (modulateColor)
+					v->Color = modulate(v->Color, color);
+			}
+
+			const u16 base = (u16)(n * vertexCount);
+			for (u32 i=0; i<indexCount; ++i)
+				*index++ = indices[i] + base;
+		}
+
+		dst->setPrimitiveType(src->getPrimitiveType());
+		dst->recalculateBoundingBox();
+		dst->setDirty();
+	}
+}
+
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale),
+	Box(core::vector3df(0.f, 0.f, 0.f)), Mesh(0), PassCount(0), ReadOnlyMaterials(false),
+	ClustersDirty(true), BatchesDirty(true)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	clearBatches();
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! culls the instances and registers the node
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	VisibleInstances.set_used(0);
+
+	if (IsVisible && Mesh)
+	{
+		if (ClustersDirty)
+			updateClusters();
+
+		PassCount = 0;
+
+		if (!Transformations.empty())
+		{
+			video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+			int transparentCount = 0;
+			int solidCount = 0;
+
+			// count transparent and solid materials in this scene node
+			const u32 numMaterials = ReadOnlyMaterials ? Mesh->getMeshBufferCount() : Materials.size();
+			for (u32 i=0; i<numMaterials; ++i)
+			{
+				const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+
+				if (driver->needsTransparentRenderPass(material))
+					++transparentCount;
+				else
+					++solidCount;
+
+				if (solidCount && transparentCount)
+					break;
+			}
+
+			if (solidCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+			if (transparentCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+		}
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	// the instances are culled once the node itself passed the culling of the scene manager
+	if (PassCount == 1)
+	{
+		ICameraSceneNode* camera = SceneManager->getActiveCamera();
+		if (camera && AutomaticCullingState != EAC_OFF)
+		{
+			SViewFrustum frust = *camera->getViewFrustum();
+
+			// cull in node space
+			if (!AbsoluteTransformation.isIdentity())
+			{
+				core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+				frust.transform(invTrans);
+			}
+			cullInstances(&frust);
+		}
+		else
+			cullInstances(0);
+
+		updateBatches();
+	}
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	u32 batch = 0;
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (!mb)
+			continue;
+
+		const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		const bool draw = driver->needsTransparentRenderPass(material) == isTransparentPass;
+
+		if (isBatchable(mb))
+		{
+			if (draw && batch < Batches.size() && Batches[batch].MeshBuffer == i)
+				driver->setMaterial(material);
+
+			for (; batch < Batches.size() && Batches[batch].MeshBuffer == i; ++batch)
+			{
+				if (draw)
+					driver->drawMeshBuffer(Batches[batch].Buffer);
+			}
+		}
+		else if (draw && !VisibleInstances.empty())
+		{
+			driver->setMaterial(material);
+			for (u32 n=0; n<VisibleInstances.size(); ++n)
+			{
+				driver->setTransform(video::ETS_WORLD, AbsoluteTransformation * Transformations[VisibleInstances[n]]);
+				driver->drawMeshBuffer(mb);
+			}
+			driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 c=0; c<Clusters.size(); ++c)
+				driver->draw3DBox(Clusters[c].Box, video::SColor(255,190,128,128));
+		}
+	}
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		copyMaterials();
+		ClustersDirty = true;
+		BatchesDirty = true;
+	}
+}
+
+
+//! Adds an instance
+u32 CInstancedMeshSceneNode::addInstance(const core::matrix4& transformation, video::SColor color)
+{
+	Transformations.push_back(transformation);
+	Colors.push_back(color);
+	ClustersDirty = true;
+	BatchesDirty = true;
+
+	// keep the box valid until the clusters are rebuilt
+	core::aabbox3df box(Mesh ? Mesh->getBoundingBox() : core::aabbox3df(0.f, 0.f, 0.f, 0.f, 0.f, 0.f));
+	transformation.transformBoxEx(box);
+	if (Transformations.size() == 1)
+		Box = box;
+	else
+		Box.addInternalBox(box);
+
+	return Transformations.size() - 1;
+}
+
+
+//! Adds an instance
+u32 CInstancedMeshSceneNode::addInstance(const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, video::SColor color)
+{
+	core::matrix4 mat;
+	mat.setRotationDegrees(rotation);
+	mat.setTranslation(position);
+
+	if (scale != core::vector3df(1.f, 1.f, 1.f))
+	{
+		core::matrix4 smat;
+		smat.setScale(scale);
+		mat *= smat;
+	}
+
+	return addInstance(mat, color);
+}
+
+
+//! Removes an instance, the last one takes its index
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Transformations.size())
+		return;
+
+	const u32 last = Transformations.size() - 1;
+	Transformations[index] = Transformations[last];
+	Colors[index] = Colors[last];
+	Transformations.set_used(last);
+	Colors.set_used(last);
+
+	ClustersDirty = true;
+	BatchesDirty = true;
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::clearInstances()
+{
+	Transformations.clear();
+	Colors.clear();
+	Box.reset(0.f, 0.f, 0.f);
+	ClustersDirty = true;
+	BatchesDirty = true;
+}
+
+
+//! Sets the transformation of an instance relative to the node
+void CInstancedMeshSceneNode::setInstanceTransformation(u32 index, const core::matrix4& transformation)
+{
+	if (index >= Transformations.size())
+		return;
+
+	Transformations[index] = transformation;
+	ClustersDirty = true;
+	BatchesDirty = true;
+
+	core::aabbox3df box(Mesh ? Mesh->getBoundingBox() : core::aabbox3df(0.f, 0.f, 0.f, 0.f, 0.f, 0.f));
+	transformation.transformBoxEx(box);
+	Box.addInternalBox(box);
+}
+
+
+//! Sets the color of an instance
+void CInstancedMeshSceneNode::setInstanceColor(u32 index, video::SColor color)
+{
+	if (index >= Colors.size())
+		return;
+
+	Colors[index] = color;
+	BatchesDirty = true;
+}
+
+
+//! recalculates the instance boxes and groups the instances into clusters
+void CInstancedMeshSceneNode::updateClusters()
+{
+	ClustersDirty = false;
+	BatchesDirty = true;
+
+	const u32 count = Transformations.size();
+	const core::aabbox3df meshBox(Mesh ? Mesh->getBoundingBox() : core::aabbox3df(0.f, 0.f, 0.f, 0.f, 0.f, 0.f));
+
+	InstanceBoxes.set_used(count);
+	Box.reset(0.f, 0.f, 0.f);
+	for (u32 i=0; i<count; ++i)
+	{
+		InstanceBoxes[i] = meshBox;
+		Transformations[i].transformBoxEx(InstanceBoxes[i]);
+		if (i == 0)
+			Box = InstanceBoxes[i];
+		else
+			Box.addInternalBox(InstanceBoxes[i]);
+	}
+
+	// neighbours in space end up in the same cluster when sorted along a z-order curve
+	const core::vector3df extent = Box.getExtent();
+	const core::vector3df scale(extent.X > 0.f ? 1023.f / extent.X : 0.f,
+		extent.Y > 0.f ? 1023.f / extent.Y : 0.f,
+		extent.Z > 0.f ? 1023.f / extent.Z : 0.f);
+
+	core::array<SMortonEntry> keys(count);
+	core::array<SMortonEntry> temp(count);
+	keys.set_used(count);
+	temp.set_used(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		const core::vector3df center = InstanceBoxes[i].getCenter();
+		keys[i].SortKey = spreadBits(quantize(center.X, Box.MinEdge.X, scale.X)) |
+			(spreadBits(quantize(center.Y, Box.MinEdge.Y, scale.Y)) << 1) |
+			(spreadBits(quantize(center.Z, Box.MinEdge.Z, scale.Z)) << 2);
+		keys[i].Index = i;
+	}
+	core::radixsort(keys.pointer(), temp.pointer(), count, &SMortonEntry::SortKey);
+
+	ClusterOrder.set_used(count);
+	for (u32 i=0; i<count; ++i)
+		ClusterOrder[i] = keys[i].Index;
+
+	Clusters.set_used(0);
+	for (u32 start=0; start<count; start+=INSTANCE_CLUSTER_SIZE)
+	{
+		SCluster cluster;
+		cluster.Start = start;
+		cluster.Count = core::min_(INSTANCE_CLUSTER_SIZE, count - start);
+		cluster.Box = InstanceBoxes[ClusterOrder[start]];
+		for (u32 i=start+1; i<start+cluster.Count; ++i)
+			cluster.Box.addInternalBox(InstanceBoxes[ClusterOrder[i]]);
+		Clusters.push_back(cluster);
+	}
+}
+
+
+//! fills VisibleInstances
+void CInstancedMeshSceneNode::cullInstances(const SViewFrustum* frustum)
+{
+	VisibleInstances.set_used(0);
+
+	for (u32 c=0; c<Clusters.size(); ++c)
+	{
+		const SCluster& cluster = Clusters[c];
+
+		u32 planeMask = 0;
+		if (frustum)
+		{
+			bool outside = false;
+			for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT && !outside; ++p)
+			{
+				const core::EIntersectionRelation3D rel = cluster.Box.classifyPlaneRelation(frustum->planes[p]);
+				if (rel == core::ISREL3D_FRONT)
+					outside = true;
+				else if (rel != core::ISREL3D_BACK)
+					planeMask |= 1 << p;
+			}
+			if (outside)
+				continue;
+		}
+
+		for (u32 i=cluster.Start; i<cluster.Start+cluster.Count; ++i)
+		{
+			const u32 instance = ClusterOrder[i];
+
+			// only the planes which cut the cluster have to be checked
+			bool outside = false;
+			for (u32 p=0; planeMask && p<SViewFrustum::VF_PLANE_COUNT && !outside; ++p)
+			{
+				if ((planeMask & (1 << p)) &&
+					InstanceBoxes[instance].classifyPlaneRelation(frustum->planes[p]) == core::ISREL3D_FRONT)
+					outside = true;
+			}
+
+			if (!outside)
+				VisibleInstances.push_back(instance);
+		}
+	}
+}
+
+
+//! true if the buffer can be merged into batches
+bool CInstancedMeshSceneNode::isBatchable(const IMeshBuffer* mb) const
+{
+	if (mb->getIndexType() != video::EIT_16BIT || mb->getVertexCount() == 0 ||
+		mb->getVertexCount() > 65536 || mb->getIndexCount() == 0)
+		return false;
+
+	switch (mb->getPrimitiveType())
+	{
+	case EPT_POINTS:
+	case EPT_LINES:
+	case EPT_TRIANGLES:
+		break;
+	default:
+		return false;
+	}
+
+	switch (mb->getVertexType())
+	{
+	case video::EVT_STANDARD:
+	case video::EVT_2TCOORDS:
+	case video::EVT_TANGENTS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+//! merges the visible instances into Batches
+void CInstancedMeshSceneNode::updateBatches()
+{
+	if (!BatchesDirty && VisibleInstances == BatchedInstances)
+		return;
+
+	BatchesDirty = false;
+	BatchedInstances = VisibleInstances;
+
+	u32 used = 0;
+	for (u32 b=0; b<Mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = Mesh->getMeshBuffer(b);
+		if (!mb || !isBatchable(mb))
+			continue;
+
+		// as many instances as 16 bit indices can address
+		const u32 perBatch = 65536 / mb->getVertexCount();
+		for (u32 first=0; first<VisibleInstances.size(); first+=perBatch)
+		{
+			const u32 count = core::min_(perBatch, VisibleInstances.size() - first);
+
+			if (used == Batches.size())
+			{
+				SBatch batch;
+				batch.Buffer = 0;
+				Batches.push_back(batch);
+			}
+
+			SBatch& batch = Batches[used];
+			if (batch.Buffer && batch.Buffer->getVertexType() != mb->getVertexType())
+			{
+				batch.Buffer->drop();
+				batch.Buffer = 0;
+			}
+
+			if (!batch.Buffer)
+			{
+				switch (mb->getVertexType())
+				{
+				case video::EVT_2TCOORDS:
+					batch.Buffer = new SMeshBufferLightMap();
+					break;
+				case video::EVT_TANGENTS:
+					batch.Buffer = new SMeshBufferTangents();
+					break;
+				default:
+					batch.Buffer = new SMeshBuffer();
+					break;
+				}
+				batch.Buffer->setHardwareMappingHint(EHM_STREAM);
+			}
+
+			switch (mb->getVertexType())
+			{
+			case video::EVT_2TCOORDS:
+				fillBatch((SMeshBufferLightMap*)batch.Buffer, mb, VisibleInstances.const_pointer() + first, count, Transformations, Colors);
+				break;
+			case video::EVT_TANGENTS:
+				fillBatch((SMeshBufferTangents*)batch.Buffer, mb, VisibleInstances.const_pointer() + first, count, Transformations, Colors);
+				break;
+			default:
+				fillBatch((SMeshBuffer*)batch.Buffer, mb, VisibleInstances.const_pointer() + first, count, Transformations, Colors);
+				break;
+			}
+
+			batch.MeshBuffer = b;
+			used += 1;
+		}
+	}
+
+	for (u32 i=used; i<Batches.size(); ++i)
+		Batches[i].Buffer->drop();
+	Batches.set_used(used);
+}
+
+
+void CInstancedMeshSceneNode::clearBatches()
+{
+	for (u32 i=0; i<Batches.size(); ++i)
+		Batches[i].Buffer->drop();
+	Batches.clear();
+	BatchedInstances.clear();
+	BatchesDirty = true;
+}
+
+
+void CInstancedMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+void CInstancedMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	IInstancedMeshSceneNode::serializeAttributes(out, options);
+
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(Mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(Mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+
+	out->addInt("InstanceCount", Transformations.size());
+	for (u32 i=0; i<Transformations.size(); ++i)
+	{
+		out->addMatrix((core::stringc("Transformation") + core::stringc(i)).c_str(), Transformations[i]);
+		out->addColor((core::stringc("Color") + core::stringc(i)).c_str(), Colors[i]);
+	}
+}
+
+
+//! Reads attributes of the scene node.
+void CInstancedMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(Mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IMesh* newMesh = 0;
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh)
+			newMesh = newAnimatedMesh->getMesh(0);
+
+		if (newMesh)
+			setMesh(newMesh);
+	}
+
+	if (in->existsAttribute("InstanceCount"))
+	{
+		clearInstances();
+		const s32 count = in->getAttributeAsInt("InstanceCount");
+		for (s32 i=0; i<count; ++i)
+		{
+			addInstance(in->getAttributeAsMatrix((core::stringc("Transformation") + core::stringc(i)).c_str()),
+				in->getAttributeAsColor((core::stringc("Color") + core::stringc(i)).c_str()));
+		}
+	}
+
+	IInstancedMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CInstancedMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CInstancedMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->Transformations = Transformations;
+	nb->Colors = Colors;
+	nb->Box = Box;
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+
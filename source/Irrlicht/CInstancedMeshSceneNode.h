@@ -0,0 +1,161 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+	struct SViewFrustum;
+
+	//! implementation of the IInstancedMeshSceneNode
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! culls the instances and registers the node
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0) _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) _IRR_OVERRIDE_ { return Mesh; }
+
+		//! Adds an instance
+		virtual u32 addInstance(const core::matrix4& transformation, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Adds an instance
+		virtual u32 addInstance(const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Removes an instance, the last one takes its index
+		virtual void removeInstance(u32 index) _IRR_OVERRIDE_;
+
+		//! Removes all instances
+		virtual void clearInstances() _IRR_OVERRIDE_;
+
+		//! Get the number of instances
+		virtual u32 getInstanceCount() const _IRR_OVERRIDE_ { return Transformations.size(); }
+
+		//! Sets the transformation of an instance relative to the node
+		virtual void setInstanceTransformation(u32 index, const core::matrix4& transformation) _IRR_OVERRIDE_;
+
+		//! Get the transformation of an instance relative to the node
+		virtual const core::matrix4& getInstanceTransformation(u32 index) const _IRR_OVERRIDE_ { return Transformations[index]; }
+
+		//! Sets the color of an instance
+		virtual void setInstanceColor(u32 index, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Get the color of an instance
+		virtual video::SColor getInstanceColor(u32 index) const _IRR_OVERRIDE_ { return Colors[index]; }
+
+		//! Get the number of instances which passed the culling of the last frame
+		virtual u32 getVisibleInstanceCount() const _IRR_OVERRIDE_ { return VisibleInstances.size(); }
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+	protected:
+
+		//! range of ClusterOrder with the union of the instance boxes
+		struct SCluster
+		{
+			core::aabbox3df Box;
+			u32 Start;
+			u32 Count;
+		};
+
+		//! merged visible instances of one mesh buffer of the mesh
+		struct SBatch
+		{
+			IMeshBuffer* Buffer;
+			u32 MeshBuffer;
+		};
+
+		void copyMaterials();
+
+		//! recalculates the instance boxes and groups the instances into clusters
+		void updateClusters();
+
+		//! fills VisibleInstances
+		void cullInstances(const SViewFrustum* frustum);
+
+		//! merges the visible instances into Batches
+		void updateBatches();
+
+		//! true if the buffer can be merged into batches
+		bool isBatchable(const IMeshBuffer* mb) const;
+
+		void clearBatches();
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+
+		//! per instance data, relative to the node
+		core::array<core::matrix4> Transformations;
+		core::array<video::SColor> Colors;
+		core::array<core::aabbox3df> InstanceBoxes;
+
+		core::array<SCluster> Clusters;
+		core::array<u32> ClusterOrder;
+		core::aabbox3d<f32> Box;
+
+		core::array<u32> VisibleInstances;
+		core::array<u32> BatchedInstances;
+		core::array<SBatch> Batches;
+
+		IMesh* Mesh;
+
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+		bool ClustersDirty;
+		bool BatchesDirty;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,537 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+
+#include "CIrrBinaryMeshFileLoader.h"
+#include "SIrrBinaryMeshStructs.h"
+#include "os.h"
+#include "IReadFile.h"
+#include "IAttributes.h"
+#include "SAnimatedMesh.h"
+#include "SMesh.h"
+#include "SMeshBuffer.h"
+#include "SMeshBufferLightMap.h"
+#include "SMeshBufferTangents.h"
+#include "SCompactMeshBuffer.h"
+#include "CDynamicMeshBuffer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	void swapWords(void* data, u32 count)
+	{
+		u32* words = (u32*)data;
+		for (u32 i=0; i<count; ++i)
+			words[i] = os::Byteswap::byteswap(words[i]);
+	}
+}
+
+
+//! Constructor
+CIrrBinaryMeshFileLoader::CIrrBinaryMeshFileLoader(scene::ISceneManager* smgr,
+		io::IFileSystem* fs)
+	: SceneManager(smgr), FileSystem(fs), File(0), Swap(false)
+{
+
+	#ifdef _DEBUG
+	setDebugName("CIrrBinaryMeshFileLoader");
+	#endif
+
+}
+
+
+//! Returns true if the file maybe is able to be loaded by this class.
+/** This decision should be based only on the file extension (e.g. ".cob") */
+bool CIrrBinaryMeshFileLoader::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension ( filename, "irrbin" );
+}
+
+
+//! creates/loads an animated mesh from the file.
+//! \return Pointer to the created mesh. Returns 0 if loading failed.
+//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+//! See IReferenceCounted::drop() for more information.
+IAnimatedMesh* CIrrBinaryMeshFileLoader::createMesh(io::IReadFile* file)
+{
+	SIrrBinaryMeshHeader header;
+	if (file->read(&header, sizeof(header)) != sizeof(header) ||
+		header.Magic[0] != 'I' || header.Magic[1] != 'R' ||
+		header.Magic[2] != 'R' || header.Magic[3] != 'B')
+	{
+		os::Printer::log("Not an Irrlicht binary mesh", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	// everything after the magic consists of 4 byte values
+	Swap = header.ByteOrder != IRRBIN_BYTE_ORDER;
+	if (Swap)
+		swapWords(&header.ByteOrder, (sizeof(header) - sizeof(header.Magic)) / 4);
+
+	if (header.ByteOrder != IRRBIN_BYTE_ORDER || header.Version != IRRBIN_VERSION)
+	{
+		os::Printer::log("Unsupported Irrlicht binary mesh version", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	File = file;
+	IAnimatedMesh* mesh = 0;
+	if (header.Flags & IRRBIN_FLAG_SKINNED)
+		mesh = readSkinnedMesh(header.BufferCount);
+	else
+		mesh = readMesh(header);
+	File = 0;
+
+	if (!mesh)
+		os::Printer::log("Could not load Irrlicht binary mesh, file is damaged", file->getFileName(), ELL_ERROR);
+
+	return mesh;
+}
+
+
+IAnimatedMesh* CIrrBinaryMeshFileLoader::readMesh(const SIrrBinaryMeshHeader& header)
+{
+	SMesh* mesh = new SMesh();
+
+	for (u32 i=0; i<header.BufferCount; ++i)
+	{
+		SIrrBinaryMeshBufferHeader bufferHeader;
+		video::SMaterial material;
+		if (!readMeshBufferHeader(bufferHeader) || !readMaterial(material))
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		IMeshBuffer* buffer = 0;
+		if (bufferHeader.IndexType == video::EIT_32BIT)
+		{
+			if (bufferHeader.VertexType != video::EVT_COMPACT)
+			{
+				CDynamicMeshBuffer* dynamic = new CDynamicMeshBuffer((video::E_VERTEX_TYPE)bufferHeader.VertexType, video::EIT_32BIT);
+				dynamic->getVertexBuffer().set_used(bufferHeader.VertexCount);
+				dynamic->getIndexBuffer().set_used(bufferHeader.IndexCount);
+				if (readVertices(dynamic->getVertexBuffer().getData(), bufferHeader) &&
+					readIndices(dynamic->getIndexBuffer().pointer(), bufferHeader))
+					buffer = dynamic;
+				else
+					dynamic->drop();
+			}
+		}
+		else
+		{
+			switch (bufferHeader.VertexType)
+			{
+			case video::EVT_STANDARD:
+				buffer = readMeshBuffer(new SMeshBuffer(), bufferHeader);
+				break;
+			case video::EVT_2TCOORDS:
+				buffer = readMeshBuffer(new SMeshBufferLightMap(), bufferHeader);
+				break;
+			case video::EVT_TANGENTS:
+				buffer = readMeshBuffer(new SMeshBufferTangents(), bufferHeader);
+				break;
+			case video::EVT_COMPACT:
+				buffer = readMeshBuffer(new SCompactMeshBuffer(), bufferHeader);
+				break;
+			}
+		}
+
+		if (!buffer)
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		buffer->getMaterial() = material;
+		buffer->setPrimitiveType((E_PRIMITIVE_TYPE)bufferHeader.PrimitiveType);
+		buffer->setBoundingBox(core::aabbox3df(bufferHeader.BoundingBox[0], bufferHeader.BoundingBox[1], bufferHeader.BoundingBox[2],
+			bufferHeader.BoundingBox[3], bufferHeader.BoundingBox[4], bufferHeader.BoundingBox[5]));
+		mesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	mesh->setBoundingBox(core::aabbox3df(header.BoundingBox[0], header.BoundingBox[1], header.BoundingBox[2],
+		header.BoundingBox[3], header.BoundingBox[4], header.BoundingBox[5]));
+
+	SAnimatedMesh* animatedmesh = new SAnimatedMesh();
+	animatedmesh->addMesh(mesh);
+	animatedmesh->recalculateBoundingBox();
+	mesh->drop();
+
+	return animatedmesh;
+}
+
+
+template <class T>
+IMeshBuffer* CIrrBinaryMeshFileLoader::readMeshBuffer(T* buffer, const SIrrBinaryMeshBufferHeader& header)
+{
+	buffer->Vertices.set_used(header.VertexCount);
+	buffer->Indices.set_used(header.IndexCount);
+	if (!readVertices(buffer->Vertices.pointer(), header) || !readIndices(buffer->Indices.pointer(), header))
+	{
+		buffer->drop();
+		return 0;
+	}
+	return buffer;
+}
+
+
+IAnimatedMesh* CIrrBinaryMeshFileLoader::readSkinnedMesh(u32 bufferCount)
+{
+	ISkinnedMesh* mesh = SceneManager->createSkinnedMesh();
+	if (!mesh)
+		return 0;
+
+	for (u32 i=0; i<bufferCount; ++i)
+	{
+		// skinned mesh buffers have 16 bit indices and float vertices
+		SIrrBinaryMeshBufferHeader header;
+		f32 transformation[16];
+		if (!readMeshBufferHeader(header) || header.IndexType != video::EIT_16BIT ||
+			header.VertexType == video::EVT_COMPACT || !readWords(transformation, 16))
+		{
+			mesh->drop();
+			return 0;
+		}
+
+		SSkinMeshBuffer* buffer = mesh->addMeshBuffer();
+		buffer->VertexType = (video::E_VERTEX_TYPE)header.VertexType;
+		buffer->PrimitiveType = (E_PRIMITIVE_TYPE)header.PrimitiveType;
+		buffer->Transformation.setM(transformation);
+		buffer->BoundingBox = core::aabbox3df(header.BoundingBox[0], header.BoundingBox[1], header.BoundingBox[2],
+			header.BoundingBox[3], header.BoundingBox[4], header.BoundingBox[5]);
+
+		void* vertices = 0;
+		switch (buffer->VertexType)
+		{
+		case video::EVT_STANDARD:
+			buffer->Vertices_Standard.set_used(header.VertexCount);
+			vertices = buffer->Vertices_Standard.pointer();
+			break;
+		case video::EVT_2TCOORDS:
+			buffer->Vertices_2TCoords.set_used(header.VertexCount);
+			vertices = buffer->Vertices_2TCoords.pointer();
+			break;
+		default:
+			buffer->Vertices_Tangents.set_used(header.VertexCount);
+			vertices = buffer->Vertices_Tangents.pointer();
+			break;
+		}
+		buffer->Indices.set_used(header.IndexCount);
+
+		if (!readMaterial(buffer->Material) || !readVertices(vertices, header) || !readIndices(buffer->Indices.pointer(), header))
+		{
+			mesh->drop();
+			return 0;
+		}
+	}
+
+	f32 fps;
+	if (!readWords(&fps, 1) || !readJoints(mesh))
+	{
+		mesh->drop();
+		return 0;
+	}
+
+	mesh->setAnimationSpeed(fps);
+	mesh->finalize();
+
+	return mesh;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readMeshBufferHeader(SIrrBinaryMeshBufferHeader& header)
+{
+	if (!readWords(&header, sizeof(header) / 4) ||
+		header.VertexType > video::EVT_COMPACT || header.IndexType > video::EIT_32BIT ||
+		header.PrimitiveType > EPT_POINT_SPRITES)
+		return false;
+
+	const u32 indexSize = header.IndexType == video::EIT_32BIT ? sizeof(u32) : sizeof(u16);
+	return fits(header.VertexCount, video::getVertexPitchFromType((video::E_VERTEX_TYPE)header.VertexType)) &&
+		fits(header.IndexCount, indexSize);
+}
+
+
+bool CIrrBinaryMeshFileLoader::readMaterial(video::SMaterial& material)
+{
+	u32 count;
+	if (!readWords(&count, 1) || !fits(count, 3*sizeof(u32)))
+		return false;
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	io::IAttributes* attributes = FileSystem->createEmptyAttributes(driver);
+
+	// the typed attributes convert the strings back to values
+	core::stringc name;
+	core::stringc value;
+	bool result = true;
+	for (u32 i=0; result && i<count; ++i)
+	{
+		u32 type;
+		result = readWords(&type, 1) && readString(name) && readString(value);
+		if (!result)
+			break;
+
+		switch (type)
+		{
+		case io::EAT_BOOL:
+			attributes->addBool(name.c_str(), false);
+			break;
+		case io::EAT_INT:
+			attributes->addInt(name.c_str(), 0);
+			break;
+		case io::EAT_FLOAT:
+			attributes->addFloat(name.c_str(), 0.f);
+			break;
+		case io::EAT_ENUM:
+			attributes->addEnum(name.c_str(), "", 0);
+			break;
+		case io::EAT_COLOR:
+			attributes->addColor(name.c_str(), video::SColor());
+			break;
+		case io::EAT_TEXTURE:
+			attributes->addTexture(name.c_str(), 0);
+			break;
+		default:
+			attributes->addString(name.c_str(), "");
+			break;
+		}
+		attributes->setAttribute((s32)i, value.c_str());
+	}
+
+	if (result && driver)
+		driver->fillMaterialStructureFromAttributes(material, attributes);
+
+	attributes->drop();
+	return result;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readJoints(ISkinnedMesh* mesh)
+{
+	u32 jointCount;
+	if (!readWords(&jointCount, 1) || !fits(jointCount, sizeof(SIrrBinaryMeshJointHeader)))
+		return false;
+
+	// all joints exist before reading them, so children can be linked
+	for (u32 i=0; i<jointCount; ++i)
+		mesh->addJoint(0);
+
+	const core::array<ISkinnedMesh::SJoint*>& joints = mesh->getAllJoints();
+	const core::array<SSkinMeshBuffer*>& buffers = mesh->getMeshBuffers();
+	core::array<s32> parents;
+	parents.set_used(jointCount);
+	for (u32 i=0; i<jointCount; ++i)
+		parents[i] = -1;
+
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		ISkinnedMesh::SJoint* joint = joints[i];
+
+		SIrrBinaryMeshJointHeader header;
+		if (!readWords(&header, sizeof(header) / 4) || !readString(joint->Name) ||
+			!fits(header.ChildCount, sizeof(u32)) || !fits(header.AttachedMeshCount, sizeof(u32)))
+			return false;
+
+		joint->LocalMatrix.setM(header.LocalMatrix);
+		joint->GlobalInversedMatrix.setM(header.GlobalInversedMatrix);
+
+		// each joint has one parent at most
+		for (u32 j=0; j<header.ChildCount; ++j)
+		{
+			u32 child;
+			if (!readWords(&child, 1) || child >= jointCount || child == i || parents[child] != -1)
+				return false;
+			parents[child] = i;
+			joint->Children.push_back(joints[child]);
+		}
+
+		joint->AttachedMeshes.set_used(header.AttachedMeshCount);
+		if (!readWords(joint->AttachedMeshes.pointer(), header.AttachedMeshCount))
+			return false;
+		for (u32 j=0; j<header.AttachedMeshCount; ++j)
+		{
+			if (joint->AttachedMeshes[j] >= buffers.size())
+				return false;
+		}
+
+		// the keys consist of floats only
+		if (!fits(header.PositionKeyCount, sizeof(ISkinnedMesh::SPositionKey)) ||
+			!fits(header.ScaleKeyCount, sizeof(ISkinnedMesh::SScaleKey)) ||
+			!fits(header.RotationKeyCount, sizeof(ISkinnedMesh::SRotationKey)))
+			return false;
+		joint->PositionKeys.set_used(header.PositionKeyCount);
+		joint->ScaleKeys.set_used(header.ScaleKeyCount);
+		joint->RotationKeys.set_used(header.RotationKeyCount);
+		const u32 positionSize = header.PositionKeyCount * sizeof(ISkinnedMesh::SPositionKey);
+		const u32 scaleSize = header.ScaleKeyCount * sizeof(ISkinnedMesh::SScaleKey);
+		const u32 rotationSize = header.RotationKeyCount * sizeof(ISkinnedMesh::SRotationKey);
+		if (!readArray(joint->PositionKeys.pointer(), positionSize) ||
+			!readArray(joint->ScaleKeys.pointer(), scaleSize) ||
+			!readArray(joint->RotationKeys.pointer(), rotationSize))
+			return false;
+		if (Swap)
+		{
+			swapWords(joint->PositionKeys.pointer(), positionSize / 4);
+			swapWords(joint->ScaleKeys.pointer(), scaleSize / 4);
+			swapWords(joint->RotationKeys.pointer(), rotationSize / 4);
+		}
+
+		if (!fits(header.WeightCount, sizeof(SIrrBinaryMeshWeight)))
+			return false;
+		joint->Weights.reallocate(header.WeightCount);
+		for (u32 j=0; j<header.WeightCount; ++j)
+		{
+			SIrrBinaryMeshWeight weight;
+			if (!readWords(&weight, sizeof(weight) / 4) || weight.BufferID >= buffers.size() ||
+				weight.VertexID >= buffers[weight.BufferID]->getVertexCount())
+				return false;
+
+			ISkinnedMesh::SWeight* w = mesh->addWeight(joint);
+			w->buffer_id = (u16)weight.BufferID;
+			w->vertex_id = weight.VertexID;
+			w->strength = weight.Strength;
+		}
+	}
+
+	// parents have to lead to a root joint
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		s32 parent = parents[i];
+		for (u32 depth=0; parent != -1; ++depth)
+		{
+			if (depth == jointCount)
+				return false;
+			parent = parents[parent];
+		}
+	}
+
+	return true;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readString(core::stringc& str)
+{
+	u32 length;
+	if (!readWords(&length, 1) || !fits(length, 1))
+		return false;
+
+	core::array<c8> chars;
+	chars.set_used(length + 1);
+	if (File->read(chars.pointer(), length) != length)
+		return false;
+	chars[length] = 0;
+	str = chars.const_pointer();
+
+	skipPadding(4);
+	return true;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readWords(void* data, u32 count)
+{
+	if (File->read(data, count * 4) != count * 4)
+		return false;
+	if (Swap)
+		swapWords(data, count);
+	return true;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readArray(void* data, u32 size)
+{
+	skipPadding(IRRBIN_ARRAY_ALIGNMENT);
+	return !size || File->read(data, size) == size;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readVertices(void* vertices, const SIrrBinaryMeshBufferHeader& header)
+{
+	const video::E_VERTEX_TYPE type = (video::E_VERTEX_TYPE)header.VertexType;
+	const u32 size = header.VertexCount * video::getVertexPitchFromType(type);
+	if (!readArray(vertices, size))
+		return false;
+
+	if (Swap)
+	{
+		if (type == video::EVT_COMPACT)
+		{
+			video::S3DVertexCompact* v = (video::S3DVertexCompact*)vertices;
+			for (u32 i=0; i<header.VertexCount; ++i)
+			{
+				v[i].Pos[0] = os::Byteswap::byteswap(v[i].Pos[0]);
+				v[i].Pos[1] = os::Byteswap::byteswap(v[i].Pos[1]);
+				v[i].Pos[2] = os::Byteswap::byteswap(v[i].Pos[2]);
+				v[i].Color.color = os::Byteswap::byteswap(v[i].Color.color);
+				v[i].TCoords[0] = os::Byteswap::byteswap(v[i].TCoords[0]);
+				v[i].TCoords[1] = os::Byteswap::byteswap(v[i].TCoords[1]);
+			}
+		}
+		else
+			swapWords(vertices, size / 4);
+	}
+	return true;
+}
+
+
+bool CIrrBinaryMeshFileLoader::readIndices(void* indices, const SIrrBinaryMeshBufferHeader& header)
+{
+	// drivers don't check the indices, so the file has to be correct
+	if (header.IndexType == video::EIT_32BIT)
+	{
+		u32* idx = (u32*)indices;
+		if (!readArray(idx, header.IndexCount * sizeof(u32)))
+			return false;
+		for (u32 i=0; i<header.IndexCount; ++i)
+		{
+			if (Swap)
+				idx[i] = os::Byteswap::byteswap(idx[i]);
+			if (idx[i] >= header.VertexCount)
+				return false;
+		}
+	}
+	else
+	{
+		u16* idx = (u16*)indices;
+		if (!readArray(idx, header.IndexCount * sizeof(u16)))
+			return false;
+		for (u32 i=0; i<header.IndexCount; ++i)
+		{
+			if (Swap)
+				idx[i] = os::Byteswap::byteswap(idx[i]);
+			if (idx[i] >= header.VertexCount)
+				return false;
+		}
+	}
+	return true;
+}
+
+
+void CIrrBinaryMeshFileLoader::skipPadding(u32 alignment)
+{
+	const u32 remainder = (u32)File->getPos() % alignment;
+	if (remainder)
+		File->seek(alignment - remainder, true);
+}
+
+
+bool CIrrBinaryMeshFileLoader::fits(u32 count, u32 size) const
+{
+	const long remaining = File->getSize() - File->getPos();
+	return remaining >= 0 && count <= (u32)remaining / size;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+
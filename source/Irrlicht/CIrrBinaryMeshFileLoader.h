@@ -0,0 +1,99 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IRR_BINARY_MESH_FILE_LOADER_H_INCLUDED__
+#define __C_IRR_BINARY_MESH_FILE_LOADER_H_INCLUDED__
+
+#include "IMeshLoader.h"
+#include "IFileSystem.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ISkinnedMesh.h"
+#include "SMaterial.h"
+
+namespace irr
+{
+namespace scene
+{
+
+struct SIrrBinaryMeshHeader;
+struct SIrrBinaryMeshBufferHeader;
+
+
+//! Meshloader capable of loading .irrbin meshes, the binary Irrlicht Engine mesh format
+/** The vertex, index and key arrays are read directly into the arrays of
+the mesh buffers and joints. Files written on a machine with the other
+byte order are swapped after reading. */
+class CIrrBinaryMeshFileLoader : public IMeshLoader
+{
+public:
+
+	//! Constructor
+	CIrrBinaryMeshFileLoader(scene::ISceneManager* smgr, io::IFileSystem* fs);
+
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".cob")
+	virtual bool isALoadableFileExtension(const io::path& filename) const _IRR_OVERRIDE_;
+
+	//! creates/loads an animated mesh from the file.
+	//! \return Pointer to the created mesh. Returns 0 if loading failed.
+	//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+	//! See IReferenceCounted::drop() for more information.
+	virtual IAnimatedMesh* createMesh(io::IReadFile* file) _IRR_OVERRIDE_;
+
+	//! uses no scene nodes, mesh cache or other files
+	virtual bool isThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
+private:
+
+	//! reads the buffers of a static mesh
+	IAnimatedMesh* readMesh(const SIrrBinaryMeshHeader& header);
+
+	//! sizes the vertex and index arrays of a new buffer and reads them, drops the buffer on failure
+	template <class T>
+	IMeshBuffer* readMeshBuffer(T* buffer, const SIrrBinaryMeshBufferHeader& header);
+
+	//! reads the buffers and joints of a skinned mesh
+	IAnimatedMesh* readSkinnedMesh(u32 bufferCount);
+
+	//! reads a buffer header and checks the vertex and index count fit into the file
+	bool readMeshBufferHeader(SIrrBinaryMeshBufferHeader& header);
+
+	bool readMaterial(video::SMaterial& material);
+
+	bool readJoints(ISkinnedMesh* mesh);
+
+	bool readString(core::stringc& str);
+
+	//! reads 4 byte values, swapped to the byte order of this machine
+	bool readWords(void* data, u32 count);
+
+	//! reads a raw array from the next aligned file offset
+	bool readArray(void* data, u32 size);
+
+	//! reads the vertices of a buffer and swaps them to the byte order of this machine
+	bool readVertices(void* vertices, const SIrrBinaryMeshBufferHeader& header);
+
+	//! reads the indices of a buffer, swaps them to the byte order of this machine and checks their range
+	bool readIndices(void* indices, const SIrrBinaryMeshBufferHeader& header);
+
+	//! skips the padding to a multiple of alignment
+	void skipPadding(u32 alignment);
+
+	//! true if count elements of size bytes can still be read from the file
+	bool fits(u32 count, u32 size) const;
+
+	// member variables
+
+	scene::ISceneManager* SceneManager;
+	io::IFileSystem* FileSystem;
+	io::IReadFile* File;
+	bool Swap;
+};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
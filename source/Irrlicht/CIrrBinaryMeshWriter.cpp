@@ -0,0 +1,240 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+
+#include "CIrrBinaryMeshWriter.h"
+#include "SIrrBinaryMeshStructs.h"
+#include "os.h"
+#include "IWriteFile.h"
+#include "IMesh.h"
+#include "IAttributes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+CIrrBinaryMeshWriter::CIrrBinaryMeshWriter(video::IVideoDriver* driver,
+				io::IFileSystem* fs)
+	: FileSystem(fs), VideoDriver(driver), File(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CIrrBinaryMeshWriter");
+	#endif
+
+	if (VideoDriver)
+		VideoDriver->grab();
+
+	if (FileSystem)
+		FileSystem->grab();
+}
+
+
+CIrrBinaryMeshWriter::~CIrrBinaryMeshWriter()
+{
+	if (VideoDriver)
+		VideoDriver->drop();
+
+	if (FileSystem)
+		FileSystem->drop();
+}
+
+
+//! Returns the type of the mesh writer
+EMESH_WRITER_TYPE CIrrBinaryMeshWriter::getType() const
+{
+	return EMWT_IRR_BINARY_MESH;
+}
+
+
+//! writes a mesh
+bool CIrrBinaryMeshWriter::writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 flags)
+{
+	if (!file || !mesh)
+		return false;
+
+	ISkinnedMesh* skinnedMesh = 0;
+	if (mesh->getMeshType() == EAMT_SKINNED)
+		skinnedMesh = static_cast<ISkinnedMesh*>(mesh);
+
+	// the vertices are written as they are, so the loader has to know their type
+	const u32 bufferCount = mesh->getMeshBufferCount();
+	for (u32 i=0; i<bufferCount; ++i)
+	{
+		if (mesh->getMeshBuffer(i)->getVertexType() > video::EVT_COMPACT)
+		{
+			os::Printer::log("Could not write mesh, unknown vertex type", file->getFileName(), ELL_ERROR);
+			return false;
+		}
+	}
+
+	os::Printer::log("Writing mesh", file->getFileName());
+
+	File = file;
+
+	SIrrBinaryMeshHeader header;
+	header.Magic[0] = 'I';
+	header.Magic[1] = 'R';
+	header.Magic[2] = 'R';
+	header.Magic[3] = 'B';
+	header.ByteOrder = IRRBIN_BYTE_ORDER;
+	header.Version = IRRBIN_VERSION;
+	header.Flags = skinnedMesh ? IRRBIN_FLAG_SKINNED : 0;
+	header.BufferCount = bufferCount;
+	const core::aabbox3df& box = mesh->getBoundingBox();
+	header.BoundingBox[0] = box.MinEdge.X;
+	header.BoundingBox[1] = box.MinEdge.Y;
+	header.BoundingBox[2] = box.MinEdge.Z;
+	header.BoundingBox[3] = box.MaxEdge.X;
+	header.BoundingBox[4] = box.MaxEdge.Y;
+	header.BoundingBox[5] = box.MaxEdge.Z;
+	File->write(&header, sizeof(header));
+
+	for (u32 i=0; i<bufferCount; ++i)
+	{
+		if (skinnedMesh)
+			writeMeshBuffer(mesh->getMeshBuffer(i), &skinnedMesh->getMeshBuffers()[i]->Transformation);
+		else
+			writeMeshBuffer(mesh->getMeshBuffer(i), 0);
+	}
+
+	if (skinnedMesh)
+	{
+		const f32 fps = skinnedMesh->getAnimationSpeed();
+		File->write(&fps, sizeof(fps));
+		writeJoints(skinnedMesh);
+	}
+
+	File = 0;
+	return true;
+}
+
+
+void CIrrBinaryMeshWriter::writeMeshBuffer(const IMeshBuffer* buffer, const core::matrix4* transformation)
+{
+	SIrrBinaryMeshBufferHeader header;
+	header.VertexType = buffer->getVertexType();
+	header.IndexType = buffer->getIndexType();
+	header.PrimitiveType = buffer->getPrimitiveType();
+	header.VertexCount = buffer->getVertexCount();
+	header.IndexCount = buffer->getIndexCount();
+	const core::aabbox3df& box = buffer->getBoundingBox();
+	header.BoundingBox[0] = box.MinEdge.X;
+	header.BoundingBox[1] = box.MinEdge.Y;
+	header.BoundingBox[2] = box.MinEdge.Z;
+	header.BoundingBox[3] = box.MaxEdge.X;
+	header.BoundingBox[4] = box.MaxEdge.Y;
+	header.BoundingBox[5] = box.MaxEdge.Z;
+	File->write(&header, sizeof(header));
+
+	if (transformation)
+		File->write(transformation->pointer(), 16*sizeof(f32));
+
+	writeMaterial(buffer->getMaterial());
+
+	writeArray(buffer->getVertices(), header.VertexCount * video::getVertexPitchFromType(buffer->getVertexType()));
+
+	const u32 indexSize = buffer->getIndexType() == video::EIT_32BIT ? sizeof(u32) : sizeof(u16);
+	writeArray(buffer->getIndices(), header.IndexCount * indexSize);
+}
+
+
+void CIrrBinaryMeshWriter::writeMaterial(const video::SMaterial& material)
+{
+	io::IAttributes* attributes = VideoDriver ? VideoDriver->createAttributesFromMaterial(material) : 0;
+	const u32 count = attributes ? attributes->getAttributeCount() : 0;
+	File->write(&count, sizeof(count));
+
+	for (u32 i=0; i<count; ++i)
+	{
+		const u32 type = attributes->getAttributeType(i);
+		File->write(&type, sizeof(type));
+		writeString(attributes->getAttributeName(i));
+		writeString(attributes->getAttributeAsString(i));
+	}
+
+	if (attributes)
+		attributes->drop();
+}
+
+
+void CIrrBinaryMeshWriter::writeJoints(const ISkinnedMesh* mesh)
+{
+	const core::array<ISkinnedMesh::SJoint*>& joints = mesh->getAllJoints();
+	const u32 jointCount = joints.size();
+	File->write(&jointCount, sizeof(jointCount));
+
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		const ISkinnedMesh::SJoint* joint = joints[i];
+
+		SIrrBinaryMeshJointHeader header;
+		memcpy(header.LocalMatrix, joint->LocalMatrix.pointer(), sizeof(header.LocalMatrix));
+		memcpy(header.GlobalInversedMatrix, joint->GlobalInversedMatrix.pointer(), sizeof(header.GlobalInversedMatrix));
+		header.ChildCount = joint->Children.size();
+		header.AttachedMeshCount = joint->AttachedMeshes.size();
+		header.PositionKeyCount = joint->PositionKeys.size();
+		header.ScaleKeyCount = joint->ScaleKeys.size();
+		header.RotationKeyCount = joint->RotationKeys.size();
+		header.WeightCount = joint->Weights.size();
+		File->write(&header, sizeof(header));
+
+		writeString(joint->Name);
+
+		for (u32 j=0; j<joint->Children.size(); ++j)
+		{
+			const u32 child = (u32)joints.linear_search(joint->Children[j]);
+			File->write(&child, sizeof(child));
+		}
+		File->write(joint->AttachedMeshes.const_pointer(), joint->AttachedMeshes.size() * sizeof(u32));
+
+		writeArray(joint->PositionKeys.const_pointer(), joint->PositionKeys.size() * sizeof(ISkinnedMesh::SPositionKey));
+		writeArray(joint->ScaleKeys.const_pointer(), joint->ScaleKeys.size() * sizeof(ISkinnedMesh::SScaleKey));
+		writeArray(joint->RotationKeys.const_pointer(), joint->RotationKeys.size() * sizeof(ISkinnedMesh::SRotationKey));
+
+		for (u32 j=0; j<joint->Weights.size(); ++j)
+		{
+			SIrrBinaryMeshWeight weight;
+			weight.BufferID = joint->Weights[j].buffer_id;
+			weight.VertexID = joint->Weights[j].vertex_id;
+			weight.Strength = joint->Weights[j].strength;
+			File->write(&weight, sizeof(weight));
+		}
+	}
+}
+
+
+void CIrrBinaryMeshWriter::writeString(const core::stringc& str)
+{
+	const u32 length = str.size();
+	File->write(&length, sizeof(length));
+	File->write(str.c_str(), length);
+	pad(4);
+}
+
+
+void CIrrBinaryMeshWriter::writeArray(const void* data, u32 size)
+{
+	pad(IRRBIN_ARRAY_ALIGNMENT);
+	File->write(data, size);
+}
+
+
+void CIrrBinaryMeshWriter::pad(u32 alignment)
+{
+	static const c8 zeros[IRRBIN_ARRAY_ALIGNMENT] = { 0 };
+	const u32 remainder = (u32)File->getPos() % alignment;
+	if (remainder)
+		File->write(zeros, alignment - remainder);
+}
+
+
+} // end namespace
+} // end namespace
+
+#endif
+
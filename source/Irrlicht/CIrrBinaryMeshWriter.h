@@ -0,0 +1,66 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_IRR_BINARY_MESH_WRITER_H_INCLUDED__
+#define __IRR_IRR_BINARY_MESH_WRITER_H_INCLUDED__
+
+#include "IMeshWriter.h"
+#include "IVideoDriver.h"
+#include "IFileSystem.h"
+#include "ISkinnedMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMeshBuffer;
+
+
+	//! class to write meshes, implementing an Irrlicht binary mesh (.irrbin) writer
+	/** The binary format stores the vertices, indices and animation keys as
+	they are in memory, so loading them back needs no parsing. It is meant
+	as a cache of meshes converted from other formats, see
+	SIrrBinaryMeshStructs.h for the layout. Skinned meshes are written with
+	their joints, in the pose they currently have like with the B3D writer,
+	so write them before animating them. */
+	class CIrrBinaryMeshWriter : public IMeshWriter
+	{
+	public:
+
+		CIrrBinaryMeshWriter(video::IVideoDriver* driver, io::IFileSystem* fs);
+		virtual ~CIrrBinaryMeshWriter();
+
+		//! Returns the type of the mesh writer
+		virtual EMESH_WRITER_TYPE getType() const _IRR_OVERRIDE_;
+
+		//! writes a mesh
+		virtual bool writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 flags=EMWF_NONE) _IRR_OVERRIDE_;
+
+	protected:
+
+		void writeMeshBuffer(const IMeshBuffer* buffer, const core::matrix4* transformation);
+
+		void writeMaterial(const video::SMaterial& material);
+
+		void writeJoints(const ISkinnedMesh* mesh);
+
+		void writeString(const core::stringc& str);
+
+		//! writes a raw array, starting at an aligned file offset
+		void writeArray(const void* data, u32 size);
+
+		//! pads the file with zeros to a multiple of alignment
+		void pad(u32 alignment);
+
+		// member variables:
+
+		io::IFileSystem* FileSystem;
+		video::IVideoDriver* VideoDriver;
+		io::IWriteFile* File;
+	};
+
+} // end namespace
+} // end namespace
+
+#endif
+
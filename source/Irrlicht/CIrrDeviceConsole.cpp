@@ -203,6 +203,7 @@ bool CIrrDeviceConsole::run()
 {
 	// increment timer
 	os::Timer::tick();
+	runFrameUpdate();
 
 	// process Windows console input
 #ifdef _IRR_WINDOWS_NT_CONSOLE_
@@ -224,6 +224,7 @@ void CIrrDeviceFB::createDriver()
 bool CIrrDeviceFB::run()
 {
 	os::Timer::tick();
+	runFrameUpdate();
 
 	struct input_event ev;
 	if (EventDevice>=0)
@@ -762,6 +762,7 @@ EKEY_CODE CIrrDeviceLinux::getKeyCode(XEvent &event)
 bool CIrrDeviceLinux::run()
 {
 	os::Timer::tick();
+	runFrameUpdate();
 
 #ifdef _IRR_COMPILE_WITH_X11_
 
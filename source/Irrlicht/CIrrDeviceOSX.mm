@@ -906,6 +906,7 @@ bool CIrrDeviceMacOSX::run()
 	irr::SEvent	ievent;
 
 	os::Timer::tick();
+	runFrameUpdate();
 	storeMouseLocation();
 
 	event = [NSApp nextEventMatchingMask:NSAnyEventMask untilDate:[NSDate distantPast] inMode:NSDefaultRunLoopMode dequeue:YES];
@@ -284,6 +284,7 @@ void CIrrDeviceSDL::createDriver()
 bool CIrrDeviceSDL::run()
 {
 	os::Timer::tick();
+	runFrameUpdate();
 
 	SEvent irrevent;
 	SDL_Event SDL_event;
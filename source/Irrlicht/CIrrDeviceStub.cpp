@@ -13,15 +13,33 @@
 #include "CLogger.h"
 #include "irrString.h"
 #include "IRandomizer.h"
+#include "IFrameUpdater.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
+
+//! runs the update of the frame updater on the worker thread
+struct CIrrDeviceStub::SFrameUpdateJob : public IThreadPoolJob
+{
+	SFrameUpdateJob() : Updater(0), Time(0) {}
+
+	virtual void runJob(u32 index, u32 worker) _IRR_OVERRIDE_
+	{
+		Updater->update(Time);
+	}
+
+	IFrameUpdater* Updater;
+	u32 Time;
+};
+
 //! constructor
 CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 : IrrlichtDevice(), VideoDriver(0), GUIEnvironment(0), SceneManager(0),
 	Timer(0), CursorControl(0), UserReceiver(params.EventReceiver),
 	Logger(0), Operator(0), Randomizer(0), FileSystem(0),
 	InputReceivingSceneManager(0), VideoModeList(0), ContextManager(0),
+	FrameUpdater(0), FrameUpdatePool(0), FrameUpdateJob(0),
 	CreationParams(params), Close(false)
 {
 	Timer = new CTimer(params.UsePerformanceTimer);
@@ -54,6 +72,8 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 
 CIrrDeviceStub::~CIrrDeviceStub()
 {
+	setFrameUpdater(0);
+
 	VideoModeList->drop();
 
 	if (GUIEnvironment)
@@ -261,6 +281,67 @@ IEventReceiver* CIrrDeviceStub::getEventReceiver()
 }
 
 
+//! Sets application work which runs on a worker thread while a frame is drawn
+void CIrrDeviceStub::setFrameUpdater(IFrameUpdater* updater)
+{
+	if (updater == FrameUpdater)
+		return;
+
+	// the result of a running update is dropped
+	if (FrameUpdatePool)
+	{
+		FrameUpdatePool->wait();
+		FrameUpdateJob->Updater = 0;
+	}
+
+	if (updater)
+		updater->grab();
+	if (FrameUpdater)
+		FrameUpdater->drop();
+	FrameUpdater = updater;
+
+	if (FrameUpdater && !FrameUpdatePool)
+	{
+		// one worker next to the thread calling run()
+		FrameUpdatePool = new CThreadPool(2);
+		FrameUpdateJob = new SFrameUpdateJob();
+	}
+	else if (!FrameUpdater && FrameUpdatePool)
+	{
+		FrameUpdatePool->drop();
+		FrameUpdatePool = 0;
+		delete FrameUpdateJob;
+		FrameUpdateJob = 0;
+	}
+}
+
+
+//! Get the current frame updater.
+IFrameUpdater* CIrrDeviceStub::getFrameUpdater() const
+{
+	return FrameUpdater;
+}
+
+
+//! Waits for the update of the last frame, applies it and starts the next one
+void CIrrDeviceStub::runFrameUpdate()
+{
+	if (!FrameUpdater)
+		return;
+
+	// the first update has nothing to wait for
+	if (FrameUpdateJob->Updater)
+	{
+		FrameUpdatePool->wait();
+		FrameUpdater->apply();
+	}
+
+	FrameUpdateJob->Updater = FrameUpdater;
+	FrameUpdateJob->Time = Timer->getTime();
+	FrameUpdatePool->start(FrameUpdateJob, 1);
+}
+
+
 //! \return Returns a pointer to the logger.
 ILogger* CIrrDeviceStub::getLogger()
 {
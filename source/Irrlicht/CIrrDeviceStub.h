@@ -17,6 +17,7 @@ namespace irr
 	class ILogger;
 	class CLogger;
 	class IRandomizer;
+	class CThreadPool;
 
 	namespace gui
 	{
@@ -95,6 +96,12 @@ namespace irr
 		//! Returns pointer to the current event receiver. Returns 0 if there is none.
 		virtual IEventReceiver* getEventReceiver() _IRR_OVERRIDE_;
 
+		//! Sets application work which runs on a worker thread while a frame is drawn
+		virtual void setFrameUpdater(IFrameUpdater* updater) _IRR_OVERRIDE_;
+
+		//! Get the current frame updater.
+		virtual IFrameUpdater* getFrameUpdater() const _IRR_OVERRIDE_;
+
 		//! Sets the input receiving scene manager.
 		/** If set to null, the main scene manager (returned by GetSceneManager()) will receive the input */
 		virtual void setInputReceivingSceneManager(scene::ISceneManager* sceneManager) _IRR_OVERRIDE_;
@@ -158,6 +165,12 @@ namespace irr
 		void calculateGammaRamp ( u16 *ramp, f32 gamma, f32 relativebrightness, f32 relativecontrast );
 		void calculateGammaFromRamp ( f32 &gamma, const u16 *ramp );
 
+		//! Waits for the update of the last frame, applies it and starts the next one
+		/** Called by run() of the devices after the timer tick. */
+		void runFrameUpdate();
+
+		struct SFrameUpdateJob;
+
 		video::IVideoDriver* VideoDriver;
 		gui::IGUIEnvironment* GUIEnvironment;
 		scene::ISceneManager* SceneManager;
@@ -185,6 +198,9 @@ namespace irr
 		SMouseMultiClicks MouseMultiClicks;
 		video::CVideoModeList* VideoModeList;
 		video::IContextManager* ContextManager;
+		IFrameUpdater* FrameUpdater;
+		CThreadPool* FrameUpdatePool;
+		SFrameUpdateJob* FrameUpdateJob;
 		SIrrlichtCreationParameters CreationParams;
 		bool Close;
 	};
@@ -1213,6 +1213,7 @@ void CIrrDeviceWin32::createDriver()
 bool CIrrDeviceWin32::run()
 {
 	os::Timer::tick();
+	runFrameUpdate();
 
 	static_cast<CCursorControl*>(CursorControl)->update();
 
@@ -430,6 +430,10 @@ void CIrrMeshFileLoader::readMeshBuffer(io::IXMLReader* reader, int vertexCount,
 				Vertices.push_back(vtx);
 			}
 			break;
+
+			case video::EVT_COMPACT:
+				// not in .irrmesh files, the writer stores compact buffers as standard vertices
+			break;
 			};
 
 		}
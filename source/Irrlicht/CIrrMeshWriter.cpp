@@ -159,9 +159,11 @@ void CIrrMeshWriter::writeMeshBuffer(const scene::IMeshBuffer* buffer)
 
 	writeMaterial(buffer->getMaterial());
 
-	// write vertices
+	// write vertices, compact vertices are decoded into standard ones
 
-	const core::stringw vertexTypeStr = video::sBuiltInVertexTypeNames[buffer->getVertexType()];
+	const video::E_VERTEX_TYPE vertexType = buffer->getVertexType() == video::EVT_COMPACT ?
+		video::EVT_STANDARD : buffer->getVertexType();
+	const core::stringw vertexTypeStr = video::sBuiltInVertexTypeNames[vertexType];
 
 	Writer->writeElement(L"vertices", false,
 		L"type", vertexTypeStr.c_str(),
@@ -239,6 +241,27 @@ void CIrrMeshWriter::writeMeshBuffer(const scene::IMeshBuffer* buffer)
 			}
 		}
 		break;
+	case video::EVT_COMPACT:
+		{
+			const video::S3DVertexCompact* compact = (video::S3DVertexCompact*)buffer->getVertices();
+			for (u32 j=0; j<vertexCount; ++j)
+			{
+				const video::S3DVertex vtx = compact[j].getVertex(buffer->getBoundingBox());
+				core::stringw str = getVectorAsStringLine(vtx.Pos);
+				str += L" ";
+				str += getVectorAsStringLine(vtx.Normal);
+
+				char tmp[12];
+				sprintf(tmp, " %02x%02x%02x%02x ", vtx.Color.getAlpha(), vtx.Color.getRed(), vtx.Color.getGreen(), vtx.Color.getBlue());
+				str += tmp;
+
+				str += getVectorAsStringLine(vtx.TCoords);
+
+				Writer->writeText(str.c_str());
+				Writer->writeLineBreak();
+			}
+		}
+		break;
 	}
 
 	Writer->writeClosingTag(L"vertices");
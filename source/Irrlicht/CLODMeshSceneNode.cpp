@@ -0,0 +1,434 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+
+#include "CLODMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IMeshManipulator.h"
+#include "IAnimatedMesh.h"
+#include "IFileSystem.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CLODMeshSceneNode::CLODMeshSceneNode(IMesh* mesh, u32 levelCount, f32 reduction,
+			ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: ILODMeshSceneNode(parent, mgr, id, position, rotation, scale),
+	Box(core::vector3df(0.f, 0.f, 0.f)), LevelCount(0), Reduction(0.5f), ScreenSize(0.25f),
+	CurrentLevel(-1), CurrentScreenSize(0.f), PassCount(0), ReadOnlyMaterials(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CLODMeshSceneNode");
+	#endif
+
+	if (mesh)
+		setMesh(mesh, levelCount, reduction, ScreenSize);
+}
+
+
+//! destructor
+CLODMeshSceneNode::~CLODMeshSceneNode()
+{
+	clearLevels();
+}
+
+
+//! selects the level and registers the node
+void CLODMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && !Levels.empty())
+	{
+		selectLevel();
+		PassCount = 0;
+
+		if (CurrentLevel >= 0)
+		{
+			video::IVideoDriver* driver = SceneManager->getVideoDriver();
+			IMesh* mesh = Levels[CurrentLevel].Mesh;
+
+			int transparentCount = 0;
+			int solidCount = 0;
+
+			// count transparent and solid materials in this scene node
+			for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+			{
+				const video::SMaterial& material = getLevelMaterial(mesh->getMeshBuffer(i), i);
+
+				if (driver->needsTransparentRenderPass(material))
+					++transparentCount;
+				else
+					++solidCount;
+
+				if (solidCount && transparentCount)
+					break;
+			}
+
+			if (solidCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+			if (transparentCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+		}
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CLODMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (CurrentLevel < 0 || CurrentLevel >= (s32)Levels.size() || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	IMesh* mesh = Levels[CurrentLevel].Mesh;
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		scene::IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		if (!mb)
+			continue;
+
+		const video::SMaterial& material = getLevelMaterial(mb, i);
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		if (driver->needsTransparentRenderPass(material) == isTransparentPass)
+		{
+			driver->setMaterial(material);
+			driver->drawMeshBuffer(mb);
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 g=0; g<mesh->getMeshBufferCount(); ++g)
+			{
+				driver->draw3DBox(
+					mesh->getMeshBuffer(g)->getBoundingBox(),
+					video::SColor(255,190,128,128));
+			}
+		}
+
+		// show the mesh of the level
+		if (DebugDataVisible & scene::EDS_MESH_WIRE_OVERLAY)
+		{
+			m.Wireframe = true;
+			driver->setMaterial(m);
+
+			for (u32 g=0; g<mesh->getMeshBufferCount(); ++g)
+			{
+				driver->drawMeshBuffer(mesh->getMeshBuffer(g));
+			}
+		}
+	}
+}
+
+
+//! sets CurrentLevel for the active camera
+void CLODMeshSceneNode::selectLevel()
+{
+	ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+	{
+		CurrentLevel = 0;
+		CurrentScreenSize = FLT_MAX;
+		return;
+	}
+
+	// bounding sphere of the box in world space
+	core::vector3df center = Box.getCenter();
+	AbsoluteTransformation.transformVect(center);
+	const core::vector3df scale = AbsoluteTransformation.getScale();
+	const f32 radius = Box.getExtent().getLength() * 0.5f *
+		core::max_(core::abs_(scale.X), core::abs_(scale.Y), core::abs_(scale.Z));
+
+	// the projection scales the height of the view volume to 2
+	CurrentScreenSize = radius * camera->getProjectionMatrix()[5];
+	if (!camera->isOrthogonal())
+	{
+		const f32 distance = camera->getAbsolutePosition().getDistanceFrom(center);
+		CurrentScreenSize = distance > radius ? CurrentScreenSize / distance : FLT_MAX;
+	}
+
+	CurrentLevel = -1;
+	for (u32 i=0; i<Levels.size(); ++i)
+	{
+		if (CurrentScreenSize >= Levels[i].ScreenSize)
+		{
+			CurrentLevel = (s32)i;
+			break;
+		}
+	}
+}
+
+
+//! returns the axis aligned bounding box of all levels
+const core::aabbox3d<f32>& CLODMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! material of a mesh buffer of the current level
+const video::SMaterial& CLODMeshSceneNode::getLevelMaterial(IMeshBuffer* mb, u32 i) const
+{
+	if (ReadOnlyMaterials || i >= Materials.size())
+		return mb->getMaterial();
+
+	return Materials[i];
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CLODMeshSceneNode::getMaterial(u32 i)
+{
+	if (!Levels.empty() && ReadOnlyMaterials && i<Levels[0].Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Levels[0].Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CLODMeshSceneNode::getMaterialCount() const
+{
+	if (!Levels.empty() && ReadOnlyMaterials)
+		return Levels[0].Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets the most detailed mesh and creates simplified levels of it
+void CLODMeshSceneNode::setMesh(IMesh* mesh, u32 levelCount, f32 reduction, f32 screenSize)
+{
+	if (!mesh)
+		return;
+
+	mesh->grab();
+	clearLevels();
+
+	LevelCount = levelCount;
+	Reduction = reduction;
+	ScreenSize = screenSize;
+
+	core::array<IMesh*> meshes;
+	SceneManager->getMeshManipulator()->createMeshLODChain(mesh, meshes, levelCount, reduction);
+
+	// each level has about reduction times the triangles on reduction times the area
+	const f32 step = core::squareroot(core::clamp(reduction, 0.f, 1.f));
+	f32 size = screenSize;
+
+	addLevel(mesh, meshes.empty() ? 0.f : size);
+	mesh->drop();
+
+	for (u32 i=0; i<meshes.size(); ++i)
+	{
+		size *= step;
+		addLevel(meshes[i], i + 1 < meshes.size() ? size : 0.f);
+		meshes[i]->drop();
+	}
+}
+
+
+//! Adds a level
+u32 CLODMeshSceneNode::addLevel(IMesh* mesh, f32 minScreenSize)
+{
+	if (!mesh)
+		return Levels.size();
+
+	mesh->grab();
+
+	// sorted from the largest to the smallest screen size
+	u32 index = Levels.size();
+	while (index > 0 && Levels[index-1].ScreenSize < minScreenSize)
+		--index;
+
+	SLevel level;
+	level.Mesh = mesh;
+	level.ScreenSize = minScreenSize;
+	Levels.insert(level, index);
+
+	if (index == 0)
+		copyMaterials();
+
+	if (Levels.size() == 1)
+		Box = mesh->getBoundingBox();
+	else
+		Box.addInternalBox(mesh->getBoundingBox());
+
+	return index;
+}
+
+
+//! Removes all levels
+void CLODMeshSceneNode::clearLevels()
+{
+	for (u32 i=0; i<Levels.size(); ++i)
+		Levels[i].Mesh->drop();
+	Levels.clear();
+	Materials.clear();
+	Box.reset(0.f, 0.f, 0.f);
+	CurrentLevel = -1;
+}
+
+
+void CLODMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (!Levels.empty())
+	{
+		IMesh* mesh = Levels[0].Mesh;
+		video::SMaterial mat;
+
+		for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+/** Only the mesh and the parameters of setMesh() are written, levels added
+with addLevel() are not part of the scene file. */
+void CLODMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	ILODMeshSceneNode::serializeAttributes(out, options);
+
+	IMesh* mesh = Levels.empty() ? 0 : Levels[0].Mesh;
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+
+	out->addInt("LevelCount", LevelCount);
+	out->addFloat("Reduction", Reduction);
+	out->addFloat("ScreenSize", ScreenSize);
+}
+
+
+//! Reads attributes of the scene node.
+void CLODMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	IMesh* mesh = Levels.empty() ? 0 : Levels[0].Mesh;
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+
+	const u32 levelCount = in->existsAttribute("LevelCount") ? (u32)in->getAttributeAsInt("LevelCount") : LevelCount;
+	const f32 reduction = in->existsAttribute("Reduction") ? in->getAttributeAsFloat("Reduction") : Reduction;
+	const f32 screenSize = in->existsAttribute("ScreenSize") ? in->getAttributeAsFloat("ScreenSize") : ScreenSize;
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+		if (newAnimatedMesh && newAnimatedMesh->getMesh(0))
+			mesh = newAnimatedMesh->getMesh(0);
+	}
+
+	// the levels are only rebuilt when something changed
+	if (mesh && (!Levels.size() || mesh != Levels[0].Mesh || levelCount != LevelCount ||
+		reduction != Reduction || screenSize != ScreenSize))
+		setMesh(mesh, levelCount, reduction, screenSize);
+
+	ILODMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CLODMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CLODMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CLODMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CLODMeshSceneNode* nb = new CLODMeshSceneNode(0, LevelCount, Reduction, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->Levels = Levels;
+	for (u32 i=0; i<Levels.size(); ++i)
+		Levels[i].Mesh->grab();
+	nb->Materials = Materials;
+	nb->Box = Box;
+	nb->LevelCount = LevelCount;
+	nb->Reduction = Reduction;
+	nb->ScreenSize = ScreenSize;
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+
@@ -0,0 +1,123 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_LOD_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_LOD_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ILODMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! implementation of the ILODMeshSceneNode
+	class CLODMeshSceneNode : public ILODMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CLODMeshSceneNode(IMesh* mesh, u32 levelCount, f32 reduction,
+			ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CLODMeshSceneNode();
+
+		//! selects the level and registers the node
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of all levels
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0) _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_LOD_MESH; }
+
+		//! Sets the most detailed mesh and creates simplified levels of it
+		virtual void setMesh(IMesh* mesh, u32 levelCount, f32 reduction, f32 screenSize) _IRR_OVERRIDE_;
+
+		//! Adds a level
+		virtual u32 addLevel(IMesh* mesh, f32 minScreenSize) _IRR_OVERRIDE_;
+
+		//! Removes all levels
+		virtual void clearLevels() _IRR_OVERRIDE_;
+
+		//! Get the number of levels
+		virtual u32 getLevelCount() const _IRR_OVERRIDE_ { return Levels.size(); }
+
+		//! Get the mesh of a level
+		virtual IMesh* getLevelMesh(u32 level) const _IRR_OVERRIDE_ { return Levels[level].Mesh; }
+
+		//! Get the screen size down to which a level is drawn
+		virtual f32 getLevelScreenSize(u32 level) const _IRR_OVERRIDE_ { return Levels[level].ScreenSize; }
+
+		//! Get the level drawn in the last frame, -1 if none was drawn
+		virtual s32 getCurrentLevel() const _IRR_OVERRIDE_ { return CurrentLevel; }
+
+		//! Get the screen size of the node in the last frame
+		virtual f32 getCurrentScreenSize() const _IRR_OVERRIDE_ { return CurrentScreenSize; }
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+	protected:
+
+		struct SLevel
+		{
+			IMesh* Mesh;
+			f32 ScreenSize;
+		};
+
+		//! sets CurrentLevel for the active camera
+		void selectLevel();
+
+		void copyMaterials();
+
+		//! material of a mesh buffer of the current level
+		const video::SMaterial& getLevelMaterial(IMeshBuffer* mb, u32 i) const;
+
+		core::array<SLevel> Levels;
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+		core::aabbox3d<f32> Box;
+
+		//! parameters of setMesh, for serialization
+		u32 LevelCount;
+		f32 Reduction;
+		f32 ScreenSize;
+
+		s32 CurrentLevel;
+		f32 CurrentScreenSize;
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,338 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMeshLoadQueue.h"
+#include "CSceneManager.h"
+#include "IAnimatedMesh.h"
+#include "IMeshCache.h"
+#include "IVideoDriver.h"
+#include "os.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#define _IRR_MESHLOADQUEUE_WIN32_
+#elif defined(_IRR_POSIX_API_)
+	#include <pthread.h>
+	#define _IRR_MESHLOADQUEUE_PTHREAD_
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+//! mutex of the queue and the wake ups of the scene manager thread and the worker
+/** Without thread support the worker runs on the scene manager thread and
+nobody ever waits. */
+struct CMeshLoadQueue::SPrivate
+{
+#if defined(_IRR_MESHLOADQUEUE_PTHREAD_)
+	SPrivate()
+	{
+		pthread_mutex_init(&Mutex, 0);
+		pthread_cond_init(&MainCond, 0);
+		pthread_cond_init(&WorkerCond, 0);
+	}
+
+	~SPrivate()
+	{
+		pthread_cond_destroy(&WorkerCond);
+		pthread_cond_destroy(&MainCond);
+		pthread_mutex_destroy(&Mutex);
+	}
+
+	void lock() { pthread_mutex_lock(&Mutex); }
+	void unlock() { pthread_mutex_unlock(&Mutex); }
+	void waitMain() { pthread_cond_wait(&MainCond, &Mutex); }
+	void waitWorker() { pthread_cond_wait(&WorkerCond, &Mutex); }
+	void wakeMain() { pthread_cond_signal(&MainCond); }
+	void wakeWorker() { pthread_cond_signal(&WorkerCond); }
+
+	pthread_mutex_t Mutex;
+	pthread_cond_t MainCond;
+	pthread_cond_t WorkerCond;
+#elif defined(_IRR_MESHLOADQUEUE_WIN32_)
+	// auto reset events, each has a single waiter which checks its condition again
+	SPrivate()
+	{
+		InitializeCriticalSection(&Mutex);
+		MainEvent = CreateEvent(0, FALSE, FALSE, 0);
+		WorkerEvent = CreateEvent(0, FALSE, FALSE, 0);
+	}
+
+	~SPrivate()
+	{
+		CloseHandle(WorkerEvent);
+		CloseHandle(MainEvent);
+		DeleteCriticalSection(&Mutex);
+	}
+
+	void lock() { EnterCriticalSection(&Mutex); }
+	void unlock() { LeaveCriticalSection(&Mutex); }
+	void waitMain() { wait(MainEvent); }
+	void waitWorker() { wait(WorkerEvent); }
+	void wakeMain() { SetEvent(MainEvent); }
+	void wakeWorker() { SetEvent(WorkerEvent); }
+
+	void wait(HANDLE event)
+	{
+		LeaveCriticalSection(&Mutex);
+		WaitForSingleObject(event, INFINITE);
+		EnterCriticalSection(&Mutex);
+	}
+
+	CRITICAL_SECTION Mutex;
+	HANDLE MainEvent;
+	HANDLE WorkerEvent;
+#else
+	void lock() {}
+	void unlock() {}
+	void waitMain() {}
+	void waitWorker() {}
+	void wakeMain() {}
+	void wakeWorker() {}
+#endif
+};
+
+
+CMeshLoadRequest::CMeshLoadRequest(const io::path& name, io::IReadFile* file)
+	: Name(name), File(file), LoadedMesh(0), Mesh(0), Done(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CMeshLoadRequest");
+	#endif
+}
+
+
+CMeshLoadRequest::~CMeshLoadRequest()
+{
+	if (File)
+		File->drop();
+
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+void CMeshLoadRequest::setDone(IAnimatedMesh* mesh)
+{
+	Mesh = mesh;
+	if (Mesh)
+		Mesh->grab();
+	Done = true;
+}
+
+
+CMeshLoadQueue::CMeshLoadQueue(CSceneManager* smgr, video::IVideoDriver* driver, IMeshCache* cache)
+	: P(new SPrivate()), SceneManager(smgr), Driver(driver), MeshCache(cache), Pool(0),
+	Forwarding(false), Loading(0), ForwardedCall(0), WorkerInLoaders(false), LoadersLocked(0), Running(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CMeshLoadQueue");
+	#endif
+
+	// textures can't be created on the worker, so without forwarding load on this thread
+	Forwarding = Driver && Driver->setTextureCallForwarder(this);
+	if (!Forwarding)
+		os::Printer::log("Another scene manager loads meshes in the background, meshes are loaded at once", ELL_WARNING);
+
+	Pool = new CThreadPool(Forwarding ? 2 : 1);
+}
+
+
+CMeshLoadQueue::~CMeshLoadQueue()
+{
+	commit(true);
+	Pool->wait();
+
+	if (Forwarding)
+		Driver->setTextureCallForwarder(0);
+
+	Pool->drop();
+	delete P;
+}
+
+
+IMeshLoadRequest* CMeshLoadQueue::getRequest(const io::path& name)
+{
+	for (u32 i=0; i<Requests.size(); ++i)
+	{
+		if (Requests[i]->Name == name)
+		{
+			Requests[i]->grab();
+			return Requests[i];
+		}
+	}
+	return 0;
+}
+
+
+IMeshLoadRequest* CMeshLoadQueue::add(const io::path& name, io::IReadFile* file)
+{
+	// one reference for the caller, one for the queue
+	CMeshLoadRequest* request = new CMeshLoadRequest(name, file);
+	request->grab();
+	Requests.push_back(request);
+
+	P->lock();
+	Queued.push_back(request);
+	++Loading;
+	const bool start = !Running;
+	Running = true;
+	P->unlock();
+
+	if (start)
+	{
+		// the job of the last start returns after it set Running to false
+		Pool->wait();
+		Pool->start(this, 1);
+	}
+
+	return request;
+}
+
+
+u32 CMeshLoadQueue::commit(bool waitForAll)
+{
+	core::array<CMeshLoadRequest*> loaded;
+
+	P->lock();
+	for (;;)
+	{
+		if (ForwardedCall)
+			runForwardedCall();
+		else if (Loaded.size())
+		{
+			loaded.swap(Loaded);
+			P->unlock();
+
+			for (u32 i=0; i<loaded.size(); ++i)
+			{
+				CMeshLoadRequest* request = loaded[i];
+				IAnimatedMesh* mesh = request->LoadedMesh;
+				request->LoadedMesh = 0;
+
+				// a mesh added by getMesh meanwhile keeps its place in the cache
+				if (mesh)
+				{
+					IAnimatedMesh* cached = MeshCache->getMeshByName(request->Name);
+					if (!cached)
+						MeshCache->addMesh(request->Name, mesh);
+					mesh->drop();
+					if (cached)
+						mesh = cached;
+				}
+
+				request->setDone(mesh);
+				Requests.erase(Requests.linear_search(request));
+				request->drop();
+			}
+			loaded.set_used(0);
+
+			P->lock();
+		}
+		else if (waitForAll && Loading)
+			P->waitMain();
+		else
+			break;
+	}
+	P->unlock();
+
+	return Requests.size();
+}
+
+
+void CMeshLoadQueue::lockLoaders()
+{
+	// loaders of the worker may load other meshes themselves
+	if (Pool->isWorkerThread())
+		return;
+
+	P->lock();
+	++LoadersLocked;
+	while (WorkerInLoaders)
+	{
+		if (ForwardedCall)
+			runForwardedCall();
+		else
+			P->waitMain();
+	}
+	P->unlock();
+}
+
+
+void CMeshLoadQueue::unlockLoaders()
+{
+	if (Pool->isWorkerThread())
+		return;
+
+	P->lock();
+	if (--LoadersLocked == 0)
+		P->wakeWorker();
+	P->unlock();
+}
+
+
+bool CMeshLoadQueue::isForwardingThread() const
+{
+	return Pool->isWorkerThread();
+}
+
+
+void CMeshLoadQueue::forward(video::ITextureCall* call)
+{
+	P->lock();
+	ForwardedCall = call;
+	P->wakeMain();
+	while (ForwardedCall)
+		P->waitWorker();
+	P->unlock();
+}
+
+
+void CMeshLoadQueue::runJob(u32 index, u32 worker)
+{
+	P->lock();
+	while (Queued.size())
+	{
+		CMeshLoadRequest* request = Queued[0];
+		Queued.erase(0);
+
+		// without worker thread the loaders are locked by this thread itself
+		while (LoadersLocked && Pool->isWorkerThread())
+			P->waitWorker();
+		WorkerInLoaders = true;
+		P->unlock();
+
+		request->LoadedMesh = SceneManager->loadMesh(request->File, request->File->getFileName());
+		request->File->drop();
+		request->File = 0;
+
+		P->lock();
+		WorkerInLoaders = false;
+		Loaded.push_back(request);
+		--Loading;
+		P->wakeMain();
+	}
+	Running = false;
+	P->unlock();
+}
+
+
+void CMeshLoadQueue::runForwardedCall()
+{
+	video::ITextureCall* call = ForwardedCall;
+	P->unlock();
+
+	call->run();
+
+	P->lock();
+	ForwardedCall = 0;
+	P->wakeWorker();
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,135 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MESH_LOAD_QUEUE_H_INCLUDED__
+#define __C_MESH_LOAD_QUEUE_H_INCLUDED__
+
+#include "IMeshLoadRequest.h"
+#include "ITextureCallForwarder.h"
+#include "IReadFile.h"
+#include "CThreadPool.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+}
+namespace scene
+{
+	class CSceneManager;
+	class IMeshCache;
+
+	//! Request of ISceneManager::getMeshAsync
+	class CMeshLoadRequest : public IMeshLoadRequest
+	{
+	public:
+
+		//! takes over the reference of the file, which only the worker may drop then
+		CMeshLoadRequest(const io::path& name, io::IReadFile* file);
+		virtual ~CMeshLoadRequest();
+
+		virtual bool isDone() const _IRR_OVERRIDE_ { return Done; }
+
+		virtual IAnimatedMesh* getMesh() const _IRR_OVERRIDE_ { return Done ? Mesh : 0; }
+
+		virtual const io::path& getName() const _IRR_OVERRIDE_ { return Name; }
+
+		//! marks the request as done, with a mesh which it grabs or 0
+		void setDone(IAnimatedMesh* mesh);
+
+		io::path Name;
+		//! the opened file, dropped by the worker once it is parsed, or 0
+		io::IReadFile* File;
+		//! mesh created by the loaders, not grabbed by the request before setDone
+		IAnimatedMesh* LoadedMesh;
+
+	private:
+
+		IAnimatedMesh* Mesh;
+		bool Done;
+	};
+
+
+	//! Loads the files of getMeshAsync one after the other on a worker thread
+	/** Keeps the mesh loaders of the scene manager busy with one file at a
+	time and forwards their texture calls to the thread of the scene
+	manager, which executes them in commit(). Requests are grabbed and
+	dropped only on the thread of the scene manager. */
+	class CMeshLoadQueue : public virtual IReferenceCounted,
+		public video::ITextureCallForwarder, public IThreadPoolJob
+	{
+	public:
+
+		CMeshLoadQueue(CSceneManager* smgr, video::IVideoDriver* driver, IMeshCache* cache);
+
+		//! waits for the loading files and commits them
+		virtual ~CMeshLoadQueue();
+
+		//! returns the grabbed request loading a mesh of that name or 0
+		IMeshLoadRequest* getRequest(const io::path& name);
+
+		//! starts loading the opened file, takes over its reference
+		/** The returned request has to be dropped. */
+		IMeshLoadRequest* add(const io::path& name, io::IReadFile* file);
+
+		//! executes forwarded texture calls and adds the loaded meshes to the cache
+		u32 commit(bool waitForAll);
+
+		//! waits until the worker is outside the mesh loaders and keeps it out
+		void lockLoaders();
+
+		//! lets the worker use the mesh loaders again
+		void unlockLoaders();
+
+		// ITextureCallForwarder
+
+		virtual bool isForwardingThread() const _IRR_OVERRIDE_;
+
+		virtual void forward(video::ITextureCall* call) _IRR_OVERRIDE_;
+
+		// IThreadPoolJob
+
+		//! loads the queued files until the queue is empty
+		virtual void runJob(u32 index, u32 worker) _IRR_OVERRIDE_;
+
+	private:
+
+		//! executes the forwarded call with the mutex locked, unlocking it meanwhile
+		void runForwardedCall();
+
+		struct SPrivate;
+		SPrivate* P;
+
+		CSceneManager* SceneManager;
+		video::IVideoDriver* Driver;
+		IMeshCache* MeshCache;
+		CThreadPool* Pool;
+		//! the texture calls of the worker are forwarded, else there is no worker
+		bool Forwarding;
+
+		// shared with the worker, guarded by the mutex
+
+		//! files not yet taken by the worker
+		core::array<CMeshLoadRequest*> Queued;
+		//! files parsed by the worker, not yet committed
+		core::array<CMeshLoadRequest*> Loaded;
+		//! number of queued requests and the one of the worker
+		u32 Loading;
+		video::ITextureCall* ForwardedCall;
+		bool WorkerInLoaders;
+		//! nesting depth of lockLoaders
+		u32 LoadersLocked;
+		//! the started job still takes queued files
+		bool Running;
+
+		//! all requests which are not committed yet, only used by the scene manager thread
+		core::array<CMeshLoadRequest*> Requests;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
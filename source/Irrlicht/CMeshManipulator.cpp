@@ -5,10 +5,15 @@
 #include "CMeshManipulator.h"
 #include "SMesh.h"
 #include "CMeshBuffer.h"
+#include "SCompactMeshBuffer.h"
+#include "SClusteredMesh.h"
+#include "CDynamicMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "os.h"
 #include "irrMap.h"
 #include "triangle3d.h"
+#include "CThreadPool.h"
+#include "CWeldGrid.h"
 
 namespace irr
 {
@@ -36,6 +41,24 @@ static inline core::vector3df getAngleWeight(const core::vector3df& v1,
 }
 
 
+//! constructor
+CMeshManipulator::CMeshManipulator()
+	: Pool(0), ThreadCount(1)
+{
+	#ifdef _DEBUG
+	setDebugName("CMeshManipulator");
+	#endif
+}
+
+
+//! destructor
+CMeshManipulator::~CMeshManipulator()
+{
+	if (Pool)
+		Pool->drop();
+}
+
+
 //! Flips the direction of surfaces. Changes backfacing triangles to frontfacing
 //! triangles and vice versa.
 //! \param mesh: Mesh on which the operation is performed.
@@ -75,8 +98,56 @@ void CMeshManipulator::flipSurfaces(scene::IMesh* mesh) const
 
 namespace
 {
-template <typename T>
-void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
+//! positions and normals through the vertex array, all vertex types start with them
+class CVertexArrayAccess
+{
+public:
+	CVertexArrayAccess(IMeshBuffer* buffer)
+		: Vertices(static_cast<u8*>(buffer->getVertices())),
+		Pitch(video::getVertexPitchFromType(buffer->getVertexType()))
+	{
+	}
+
+	const core::vector3df& getPosition(u32 i) const
+	{
+		return reinterpret_cast<video::S3DVertex*>(Vertices + i*Pitch)->Pos;
+	}
+
+	core::vector3df& getNormal(u32 i) const
+	{
+		return reinterpret_cast<video::S3DVertex*>(Vertices + i*Pitch)->Normal;
+	}
+
+private:
+	u8* Vertices;
+	u32 Pitch;
+};
+
+//! positions and normals through the mesh buffer, for buffers without vertex array
+class CMeshBufferAccess
+{
+public:
+	CMeshBufferAccess(IMeshBuffer* buffer)
+		: Buffer(buffer)
+	{
+	}
+
+	const core::vector3df& getPosition(u32 i) const
+	{
+		return Buffer->getPosition(i);
+	}
+
+	core::vector3df& getNormal(u32 i) const
+	{
+		return Buffer->getNormal(i);
+	}
+
+private:
+	IMeshBuffer* Buffer;
+};
+
+template <typename T, class V>
+void recalculateNormalsT(IMeshBuffer* buffer, const V& vertices, bool smooth, bool angleWeighted)
 {
 	const u32 vtxcnt = buffer->getVertexCount();
 	const u32 idxcnt = buffer->getIndexCount();
@@ -86,13 +157,13 @@ void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
 	{
 		for (u32 i=0; i<idxcnt; i+=3)
 		{
-			const core::vector3df& v1 = buffer->getPosition(idx[i+0]);
-			const core::vector3df& v2 = buffer->getPosition(idx[i+1]);
-			const core::vector3df& v3 = buffer->getPosition(idx[i+2]);
+			const core::vector3df& v1 = vertices.getPosition(idx[i+0]);
+			const core::vector3df& v2 = vertices.getPosition(idx[i+1]);
+			const core::vector3df& v3 = vertices.getPosition(idx[i+2]);
 			const core::vector3df normal = core::plane3d<f32>(v1, v2, v3).Normal;
-			buffer->getNormal(idx[i+0]) = normal;
-			buffer->getNormal(idx[i+1]) = normal;
-			buffer->getNormal(idx[i+2]) = normal;
+			vertices.getNormal(idx[i+0]) = normal;
+			vertices.getNormal(idx[i+1]) = normal;
+			vertices.getNormal(idx[i+2]) = normal;
 		}
 	}
 	else
@@ -100,26 +171,26 @@ void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
 		u32 i;
 
 		for ( i = 0; i!= vtxcnt; ++i )
-			buffer->getNormal(i).set(0.f, 0.f, 0.f);
+			vertices.getNormal(i).set(0.f, 0.f, 0.f);
 
 		for ( i=0; i<idxcnt; i+=3)
 		{
-			const core::vector3df& v1 = buffer->getPosition(idx[i+0]);
-			const core::vector3df& v2 = buffer->getPosition(idx[i+1]);
-			const core::vector3df& v3 = buffer->getPosition(idx[i+2]);
+			const core::vector3df& v1 = vertices.getPosition(idx[i+0]);
+			const core::vector3df& v2 = vertices.getPosition(idx[i+1]);
+			const core::vector3df& v3 = vertices.getPosition(idx[i+2]);
 			const core::vector3df normal = core::plane3d<f32>(v1, v2, v3).Normal;
 
 			core::vector3df weight(1.f,1.f,1.f);
 			if (angleWeighted)
 				weight = irr::scene::getAngleWeight(v1,v2,v3); // writing irr::scene:: necessary for borland
 
-			buffer->getNormal(idx[i+0]) += weight.X*normal;
-			buffer->getNormal(idx[i+1]) += weight.Y*normal;
-			buffer->getNormal(idx[i+2]) += weight.Z*normal;
+			vertices.getNormal(idx[i+0]) += weight.X*normal;
+			vertices.getNormal(idx[i+1]) += weight.Y*normal;
+			vertices.getNormal(idx[i+2]) += weight.Z*normal;
 		}
 
 		for ( i = 0; i!= vtxcnt; ++i )
-			buffer->getNormal(i).normalize();
+			vertices.getNormal(i).normalize();
 	}
 }
 }
@@ -132,10 +203,33 @@ void CMeshManipulator::recalculateNormals(IMeshBuffer* buffer, bool smooth, bool
 	if (!buffer)
 		return;
 
-	if (buffer->getIndexType()==video::EIT_16BIT)
-		recalculateNormalsT<u16>(buffer, smooth, angleWeighted);
+	if (buffer->getVertexType()==video::EVT_COMPACT)
+	{
+		// the accessors return decoded copies, setDirty encodes the new normals again
+		const CMeshBufferAccess vertices(buffer);
+		if (buffer->getIndexType()==video::EIT_16BIT)
+			recalculateNormalsT<u16>(buffer, vertices, smooth, angleWeighted);
+		else
+			recalculateNormalsT<u32>(buffer, vertices, smooth, angleWeighted);
+		buffer->setDirty(EBT_VERTEX);
+	}
+	// virtual calls for every corner are slow, so use the vertices directly
+	else if (buffer->getVertices())
+	{
+		const CVertexArrayAccess vertices(buffer);
+		if (buffer->getIndexType()==video::EIT_16BIT)
+			recalculateNormalsT<u16>(buffer, vertices, smooth, angleWeighted);
+		else
+			recalculateNormalsT<u32>(buffer, vertices, smooth, angleWeighted);
+	}
 	else
-		recalculateNormalsT<u32>(buffer, smooth, angleWeighted);
+	{
+		const CMeshBufferAccess vertices(buffer);
+		if (buffer->getIndexType()==video::EIT_16BIT)
+			recalculateNormalsT<u16>(buffer, vertices, smooth, angleWeighted);
+		else
+			recalculateNormalsT<u32>(buffer, vertices, smooth, angleWeighted);
+	}
 }
 
 
@@ -147,6 +241,12 @@ void CMeshManipulator::recalculateNormals(scene::IMesh* mesh, bool smooth, bool
 		return;
 
 	const u32 bcount = mesh->getMeshBufferCount();
+	if (Pool && bcount > 1 && Pool->isOwnerThread())
+	{
+		recalculateBuffers(mesh, false, false, smooth, angleWeighted);
+		return;
+	}
+
 	for ( u32 b=0; b<bcount; ++b)
 		recalculateNormals(mesh->getMeshBuffer(b), smooth, angleWeighted);
 }
@@ -293,7 +393,7 @@ void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smo
 			//Angle-weighted normals look better, but are slightly more CPU intensive to calculate
 			core::vector3df weight(1.f,1.f,1.f);
 			if (angleWeighted)
-				weight = irr::scene::getAngleWeight(v[i+0].Pos,v[i+1].Pos,v[i+2].Pos);	// writing irr::scene:: necessary for borland
+				weight = irr::scene::getAngleWeight(v[idx[i+0]].Pos,v[idx[i+1]].Pos,v[idx[i+2]].Pos);	// writing irr::scene:: necessary for borland
 			core::vector3df localNormal;
 			core::vector3df localTangent;
 			core::vector3df localBinormal;
@@ -428,6 +528,12 @@ void CMeshManipulator::recalculateTangents(IMesh* mesh, bool recalculateNormals,
 		return;
 
 	const u32 meshBufferCount = mesh->getMeshBufferCount();
+	if (Pool && meshBufferCount > 1 && Pool->isOwnerThread())
+	{
+		recalculateBuffers(mesh, true, recalculateNormals, smooth, angleWeighted);
+		return;
+	}
+
 	for (u32 b=0; b<meshBufferCount; ++b)
 	{
 		recalculateTangents(mesh->getMeshBuffer(b), recalculateNormals, smooth, angleWeighted);
@@ -435,6 +541,61 @@ void CMeshManipulator::recalculateTangents(IMesh* mesh, bool recalculateNormals,
 }
 
 
+namespace
+{
+//! recalculates the normals or tangents of one mesh buffer
+struct SRecalculateJob : public IThreadPoolJob
+{
+	virtual void runJob(u32 index, u32 worker) _IRR_OVERRIDE_
+	{
+		IMeshBuffer* buffer = Mesh->getMeshBuffer(index);
+		if (Tangents)
+			Manipulator->recalculateTangents(buffer, RecalculateNormals, Smooth, AngleWeighted);
+		else
+			Manipulator->recalculateNormals(buffer, Smooth, AngleWeighted);
+	}
+
+	const IMeshManipulator* Manipulator;
+	IMesh* Mesh;
+	bool Tangents;
+	bool RecalculateNormals;
+	bool Smooth;
+	bool AngleWeighted;
+};
+}
+
+
+//! recalculates normals or tangents of the buffers of a mesh on the pool
+void CMeshManipulator::recalculateBuffers(IMesh* mesh, bool tangents, bool recalculateNormals, bool smooth, bool angleWeighted) const
+{
+	SRecalculateJob job;
+	job.Manipulator = this;
+	job.Mesh = mesh;
+	job.Tangents = tangents;
+	job.RecalculateNormals = recalculateNormals;
+	job.Smooth = smooth;
+	job.AngleWeighted = angleWeighted;
+	Pool->parallelFor(&job, mesh->getMeshBufferCount());
+}
+
+
+//! Set the number of threads for recalculating normals and tangents of meshes
+void CMeshManipulator::setThreadCount(u32 count)
+{
+	if (count == ThreadCount)
+		return;
+
+	ThreadCount = count;
+	if (Pool)
+	{
+		Pool->drop();
+		Pool = 0;
+	}
+	if (count != 1)
+		Pool = new CThreadPool(count);
+}
+
+
 namespace
 {
 //! Creates a planar texture mapping on the meshbuffer
@@ -647,6 +808,17 @@ SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
 				buffer->drop();
 			}
 			break;
+		case video::EVT_COMPACT:
+			{
+				SCompactMeshBuffer* buffer = new SCompactMeshBuffer();
+				buffer->Material = mb->getMaterial();
+				buffer->BoundingBox = mb->getBoundingBox();
+				buffer->PrimitiveType = mb->getPrimitiveType();
+				buffer->append(mb->getVertices(), mb->getVertexCount(), mb->getIndices(), mb->getIndexCount());
+				clone->addMeshBuffer(buffer);
+				buffer->drop();
+			}
+			break;
 		}// end switch
 
 	}// end for all mesh buffers
@@ -752,6 +924,33 @@ IMesh* CMeshManipulator::createMeshUniquePrimitives(IMesh* mesh) const
 				buffer->drop();
 			}
 			break;
+		case video::EVT_COMPACT:
+			{
+				// the same box keeps the encoded positions valid
+				SCompactMeshBuffer* buffer = new SCompactMeshBuffer();
+				buffer->Material = mb->getMaterial();
+				buffer->BoundingBox = mb->getBoundingBox();
+
+				video::S3DVertexCompact* v =
+					(video::S3DVertexCompact*)mb->getVertices();
+
+				buffer->Vertices.reallocate(idxCnt);
+				buffer->Indices.reallocate(idxCnt);
+				for (s32 i=0; i<idxCnt; i += 3)
+				{
+					buffer->Vertices.push_back( v[idx[i + 0 ]] );
+					buffer->Vertices.push_back( v[idx[i + 1 ]] );
+					buffer->Vertices.push_back( v[idx[i + 2 ]] );
+
+					buffer->Indices.push_back( i + 0 );
+					buffer->Indices.push_back( i + 1 );
+					buffer->Indices.push_back( i + 2 );
+				}
+
+				clone->addMeshBuffer(buffer);
+				buffer->drop();
+			}
+			break;
 		}// end switch
 
 	}// end for all mesh buffers
@@ -761,6 +960,83 @@ IMesh* CMeshManipulator::createMeshUniquePrimitives(IMesh* mesh) const
 }
 
 
+namespace
+{
+	//! attributes besides the position which have to match for welding
+	inline bool equalsForWelding(const video::S3DVertex& a, const video::S3DVertex& b, f32 tolerance)
+	{
+		return a.Normal.equals(b.Normal, tolerance) &&
+			a.TCoords.equals(b.TCoords) &&
+			(a.Color == b.Color);
+	}
+
+	inline bool equalsForWelding(const video::S3DVertex2TCoords& a, const video::S3DVertex2TCoords& b, f32 tolerance)
+	{
+		return a.Normal.equals(b.Normal, tolerance) &&
+			a.TCoords.equals(b.TCoords) &&
+			a.TCoords2.equals(b.TCoords2) &&
+			(a.Color == b.Color);
+	}
+
+	inline bool equalsForWelding(const video::S3DVertexTangents& a, const video::S3DVertexTangents& b, f32 tolerance)
+	{
+		return a.Normal.equals(b.Normal, tolerance) &&
+			a.TCoords.equals(b.TCoords) &&
+			a.Tangent.equals(b.Tangent, tolerance) &&
+			a.Binormal.equals(b.Binormal, tolerance) &&
+			(a.Color == b.Color);
+	}
+
+	//! Redirects each vertex to the first earlier vertex it equals, or to a new copy
+	template <class T>
+	void weldVertices(const T* v, u32 vertexCount, f32 tolerance,
+		core::array<u16>& redirects, core::array<T>& welded)
+	{
+		if (!vertexCount)
+			return;
+
+		core::aabbox3df box(v[0].Pos);
+		for (u32 i=1; i<vertexCount; ++i)
+			box.addInternalPoint(v[i].Pos);
+
+		CWeldGrid grid(vertexCount, box, tolerance);
+
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			u32 cell[3];
+			u32 side[3];
+			grid.getCells(v[i].Pos, cell, side);
+
+			u32 found = i;
+			for (u32 n=0; n<8; ++n)
+			{
+				u32 j = grid.getFirst((n & 1) ? side[0] : cell[0],
+					(n & 2) ? side[1] : cell[1],
+					(n & 4) ? side[2] : cell[2]);
+				for (; j < found; j = grid.getNext(j))
+				{
+					if (v[i].Pos.equals(v[j].Pos, tolerance) && equalsForWelding(v[i], v[j], tolerance))
+					{
+						found = j;
+						break;
+					}
+				}
+			}
+
+			if (found < i)
+				redirects[i] = redirects[found];
+			else
+			{
+				redirects[i] = (u16)welded.size();
+				welded.push_back(v[i]);
+			}
+
+			grid.add(cell[0], cell[1], cell[2], i);
+		}
+	}
+}
+
+
 //! Creates a copy of a mesh, which will have identical vertices welded together
 // not yet 32bit
 IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
@@ -800,28 +1076,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			outIdx = &buffer->Indices;
 
 			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldVertices(v, vertexCount, tolerance, redirects, buffer->Vertices);
 
 			break;
 		}
@@ -843,29 +1098,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			outIdx = &buffer->Indices;
 
 			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].TCoords2.equals( v[j].TCoords2 ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldVertices(v, vertexCount, tolerance, redirects, buffer->Vertices);
 			break;
 		}
 		case video::EVT_TANGENTS:
@@ -886,35 +1119,12 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			outIdx = &buffer->Indices;
 
 			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].Tangent.equals( v[j].Tangent, tolerance ) &&
-						 v[i].Binormal.equals( v[j].Binormal, tolerance ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldVertices(v, vertexCount, tolerance, redirects, buffer->Vertices);
 			break;
 		}
 		default:
 			os::Printer::log("Cannot create welded mesh, vertex type unsupported", ELL_ERROR);
-			break;
+			continue;
 		}
 
 		// Clean up any degenerate tris
@@ -1008,6 +1218,19 @@ IMesh* CMeshManipulator::createMeshWithTangents(IMesh* mesh, bool recalculateNor
 					buffer->Vertices.push_back(v[i]);
 			}
 			break;
+		case video::EVT_COMPACT:
+			{
+				const S3DVertexCompact* v =(const S3DVertexCompact*)original->getVertices();
+				const core::aabbox3df& box = original->getBoundingBox();
+
+				for (u32 i=0; i < vtxCnt; ++i)
+				{
+					const S3DVertex vertex(v[i].getVertex(box));
+					buffer->Vertices.push_back( S3DVertexTangents(
+						vertex.Pos, vertex.Normal, vertex.Color, vertex.TCoords) );
+				}
+			}
+			break;
 		}
 		buffer->recalculateBoundingBox();
 
@@ -1396,6 +1619,19 @@ IMesh* CMeshManipulator::createMeshWith2TCoords(IMesh* mesh) const
 						v[i].Pos, v[i].Normal, v[i].Color, v[i].TCoords, v[i].TCoords) );
 			}
 			break;
+		case video::EVT_COMPACT:
+			{
+				const S3DVertexCompact* v =(const S3DVertexCompact*)original->getVertices();
+				const core::aabbox3df& box = original->getBoundingBox();
+
+				for (u32 i=0; i < vtxCnt; ++i)
+				{
+					const S3DVertex vertex(v[i].getVertex(box));
+					buffer->Vertices.push_back( S3DVertex2TCoords(
+						vertex.Pos, vertex.Normal, vertex.Color, vertex.TCoords, vertex.TCoords) );
+				}
+			}
+			break;
 		}
 		buffer->recalculateBoundingBox();
 
@@ -1470,6 +1706,15 @@ IMesh* CMeshManipulator::createMeshWith1TCoords(IMesh* mesh) const
 						v[i].Pos, v[i].Normal, v[i].Color, v[i].TCoords) );
 			}
 			break;
+		case video::EVT_COMPACT:
+			{
+				const S3DVertexCompact* v =(const S3DVertexCompact*)original->getVertices();
+				const core::aabbox3df& box = original->getBoundingBox();
+
+				for (u32 i=0; i < vtxCnt; ++i)
+					buffer->Vertices.push_back( v[i].getVertex(box) );
+			}
+			break;
 		}
 
 		buffer->recalculateBoundingBox();
@@ -1483,6 +1728,62 @@ IMesh* CMeshManipulator::createMeshWith1TCoords(IMesh* mesh) const
 }
 
 
+//! Creates a copy of the mesh with quantized S3DVertexCompact vertices.
+IMesh* CMeshManipulator::createMeshCompact(IMesh* mesh) const
+{
+	if (!mesh)
+		return 0;
+
+	SMesh* clone = new SMesh();
+	const u32 meshBufferCount = mesh->getMeshBufferCount();
+
+	for (u32 b=0; b<meshBufferCount; ++b)
+	{
+		IMeshBuffer* original = mesh->getMeshBuffer(b);
+		const video::E_VERTEX_TYPE vType = original->getVertexType();
+		if (original->getIndexType() != video::EIT_16BIT ||
+			(vType != video::EVT_STANDARD && vType != video::EVT_2TCOORDS && vType != video::EVT_TANGENTS))
+		{
+			clone->addMeshBuffer(original);
+			continue;
+		}
+
+		SCompactMeshBuffer* buffer = new SCompactMeshBuffer();
+		buffer->Material = original->getMaterial();
+		buffer->PrimitiveType = original->getPrimitiveType();
+
+		// copy indices
+		const u32 idxCnt = original->getIndexCount();
+		const u16* indices = original->getIndices();
+		buffer->Indices.reallocate(idxCnt);
+		for (u32 i=0; i < idxCnt; ++i)
+			buffer->Indices.push_back(indices[i]);
+
+		// all float vertex types start with the members of S3DVertex
+		const u32 vtxCnt = original->getVertexCount();
+		const u32 pitch = video::getVertexPitchFromType(vType);
+		const u8* v = (const u8*)original->getVertices();
+
+		// the box of the positions gives the finest steps
+		if (vtxCnt)
+			buffer->BoundingBox.reset(reinterpret_cast<const video::S3DVertex*>(v)->Pos);
+		for (u32 i=1; i < vtxCnt; ++i)
+			buffer->BoundingBox.addInternalPoint(reinterpret_cast<const video::S3DVertex*>(v + i*pitch)->Pos);
+
+		buffer->Vertices.reallocate(vtxCnt);
+		for (u32 i=0; i < vtxCnt; ++i)
+			buffer->Vertices.push_back(video::S3DVertexCompact(
+				*reinterpret_cast<const video::S3DVertex*>(v + i*pitch), buffer->BoundingBox));
+
+		clone->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	clone->recalculateBoundingBox();
+	return clone;
+}
+
+
 //! Returns amount of polygons in mesh.
 s32 CMeshManipulator::getPolyCount(scene::IMesh* mesh) const
 {
@@ -2103,15 +2404,1568 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 				buf->drop();
 			}
 			break;
-		}
+			case video::EVT_COMPACT:
+			{
+				video::S3DVertexCompact *v = (video::S3DVertexCompact *) mb->getVertices();
 
-		delete [] vc;
-		delete [] tc;
+				SCompactMeshBuffer *buf = new SCompactMeshBuffer();
+				buf->Material = mb->getMaterial();
+				// the same box keeps the encoded positions valid
+				buf->setBoundingBox(mb->getBoundingBox());
 
-	} // for each meshbuffer
+				buf->Vertices.reallocate(vcount);
+				buf->Indices.reallocate(icount);
+
+				core::map<const video::S3DVertexCompact, const u16> sind; // search index for fast operation
+				typedef core::map<const video::S3DVertexCompact, const u16>::Node snode;
+
+				// Main algorithm
+				u32 highest = 0;
+				u32 drawcalls = 0;
+				for (;;)
+				{
+					if (tc[highest].drawn)
+					{
+						bool found = false;
+						float hiscore = 0;
+						for (u32 t = 0; t < tcount; t++)
+						{
+							if (!tc[t].drawn)
+							{
+								if (tc[t].score > hiscore)
+								{
+									highest = t;
+									hiscore = tc[t].score;
+									found = true;
+								}
+							}
+						}
+						if (!found)
+							break;
+					}
+
+					// Output the best triangle
+					u16 newind = buf->Vertices.size();
+
+					snode *s = sind.find(v[tc[highest].ind[0]]);
+
+					if (!s)
+					{
+						buf->Vertices.push_back(v[tc[highest].ind[0]]);
+						buf->Indices.push_back(newind);
+						sind.insert(v[tc[highest].ind[0]], newind);
+						newind++;
+					}
+					else
+					{
+						buf->Indices.push_back(s->getValue());
+					}
+
+					s = sind.find(v[tc[highest].ind[1]]);
+
+					if (!s)
+					{
+						buf->Vertices.push_back(v[tc[highest].ind[1]]);
+						buf->Indices.push_back(newind);
+						sind.insert(v[tc[highest].ind[1]], newind);
+						newind++;
+					}
+					else
+					{
+						buf->Indices.push_back(s->getValue());
+					}
+
+					s = sind.find(v[tc[highest].ind[2]]);
+
+					if (!s)
+					{
+						buf->Vertices.push_back(v[tc[highest].ind[2]]);
+						buf->Indices.push_back(newind);
+						sind.insert(v[tc[highest].ind[2]], newind);
+					}
+					else
+					{
+						buf->Indices.push_back(s->getValue());
+					}
+
+					vc[tc[highest].ind[0]].NumActiveTris--;
+					vc[tc[highest].ind[1]].NumActiveTris--;
+					vc[tc[highest].ind[2]].NumActiveTris--;
+
+					tc[highest].drawn = true;
+
+					for (u16 j = 0; j < 3; j++)
+					{
+						vcache *vert = &vc[tc[highest].ind[j]];
+						for (u16 t = 0; t < vert->tris.size(); t++)
+						{
+							if (highest == vert->tris[t])
+							{
+								vert->tris.erase(t);
+								break;
+							}
+						}
+					}
+
+					lru.add(tc[highest].ind[0]);
+					lru.add(tc[highest].ind[1]);
+					highest = lru.add(tc[highest].ind[2]);
+					drawcalls++;
+				}
+
+				newmesh->addMeshBuffer(buf);
+				buf->drop();
+			}
+			break;
+		}
+
+		delete [] vc;
+		delete [] tc;
+
+	} // for each meshbuffer
+
+	return newmesh;
+}
+
+namespace
+{
+
+//! symmetric 4x4 matrix of the quadric error metric, upper triangle
+struct SQuadric
+{
+	f64 A[10];
+
+	void clear()
+	{
+		for (u32 i=0; i<10; ++i)
+			A[i] = 0.0;
+	}
+
+	//! adds the squared distance to the plane ax+by+cz+d=0
+	void addPlane(f64 a, f64 b, f64 c, f64 d, f64 weight)
+	{
+		A[0] += weight*a*a; A[1] += weight*a*b; A[2] += weight*a*c; A[3] += weight*a*d;
+		A[4] += weight*b*b; A[5] += weight*b*c; A[6] += weight*b*d;
+		A[7] += weight*c*c; A[8] += weight*c*d;
+		A[9] += weight*d*d;
+	}
+
+	void add(const SQuadric& other)
+	{
+		for (u32 i=0; i<10; ++i)
+			A[i] += other.A[i];
+	}
+
+	//! error of the point, which is the weighted sum of squared plane distances
+	f64 evaluate(const SQuadric& other, const core::vector3df& p) const
+	{
+		const f64 x = p.X;
+		const f64 y = p.Y;
+		const f64 z = p.Z;
+		const f64 e = (A[0]+other.A[0])*x*x + 2.0*(A[1]+other.A[1])*x*y + 2.0*(A[2]+other.A[2])*x*z + 2.0*(A[3]+other.A[3])*x +
+			(A[4]+other.A[4])*y*y + 2.0*(A[5]+other.A[5])*y*z + 2.0*(A[6]+other.A[6])*y +
+			(A[7]+other.A[7])*z*z + 2.0*(A[8]+other.A[8])*z +
+			(A[9]+other.A[9]);
+		return e > 0.0 ? e : 0.0;
+	}
+};
+
+struct SPositionKey
+{
+	core::vector3df Pos;
+	u32 Vertex;
+
+	bool operator<(const SPositionKey& other) const
+	{
+		if (Pos.X != other.Pos.X)
+			return Pos.X < other.Pos.X;
+		if (Pos.Y != other.Pos.Y)
+			return Pos.Y < other.Pos.Y;
+		if (Pos.Z != other.Pos.Z)
+			return Pos.Z < other.Pos.Z;
+		return Vertex < other.Vertex;
+	}
+};
+
+struct SSimplifyEdge
+{
+	//! groups of the end points, lower one in the upper bits
+	u64 Key;
+	u32 Triangle;
+	//! vertex of the lower group
+	u32 Vertex;
+
+	bool operator<(const SSimplifyEdge& other) const
+	{
+		return Key < other.Key || (Key == other.Key && Triangle < other.Triangle);
+	}
+};
+
+//! Edge collapse simplification after Garland and Heckbert.
+/** Vertices with the same position form a group. A group is moved onto a
+neighbouring vertex, so the remaining vertices keep their attributes.
+Groups on an open border only move along the border, groups on a seam of
+the vertex attributes only along the seam with all their vertices, other
+groups are locked. Border and seam edges add planes perpendicular to the
+surface to the quadrics, which keeps the lines in shape. */
+class CQuadricSimplifier
+{
+public:
+
+	CQuadricSimplifier(const IMeshBuffer* mb)
+		: Live(0), Stamp(0)
+	{
+		const u32 vertexCount = mb->getVertexCount();
+		const u32 pitch = video::getVertexPitchFromType(mb->getVertexType());
+		const u8* vertices = (const u8*)mb->getVertices();
+
+		Positions.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+			Positions[i] = mb->getPosition(i);
+
+		// group the vertices by position, equal vertices of a group are merged
+		core::array<SPositionKey> keys(vertexCount);
+		keys.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			keys[i].Pos = Positions[i];
+			keys[i].Vertex = i;
+		}
+		// set_used keeps the sorted flag of the empty array
+		keys.set_sorted(false);
+		keys.sort();
+
+		core::array<u32> canonical(vertexCount);
+		canonical.set_used(vertexCount);
+		VertexGroup.set_used(vertexCount);
+		core::array<u32> wedgeCount;
+		for (u32 start=0; start<vertexCount; )
+		{
+			u32 end = start + 1;
+			while (end < vertexCount && keys[end].Pos == keys[start].Pos)
+				++end;
+
+			const u32 group = wedgeCount.size();
+			u32 wedges = 0;
+			for (u32 i=start; i<end; ++i)
+			{
+				const u32 v = keys[i].Vertex;
+				VertexGroup[v] = group;
+				canonical[v] = v;
+
+				// few distinct vertices share a position, so only a few are compared
+				for (u32 j=start; j<i && j<start+8; ++j)
+				{
+					const u32 other = keys[j].Vertex;
+					if (canonical[other] == other && !memcmp(vertices + v*pitch, vertices + other*pitch, pitch))
+					{
+						canonical[v] = other;
+						break;
+					}
+				}
+				if (canonical[v] == v)
+					++wedges;
+			}
+
+			wedgeCount.push_back(wedges);
+			start = end;
+		}
+
+		const u32 groupCount = wedgeCount.size();
+		Kinds.set_used(groupCount);
+		Quadrics.set_used(groupCount);
+		for (u32 g=0; g<groupCount; ++g)
+			Quadrics[g].clear();
+		Versions.set_used(groupCount);
+		memset(Versions.pointer(), 0, groupCount * sizeof(u32));
+		Marks.set_used(groupCount);
+		memset(Marks.pointer(), 0, groupCount * sizeof(u32));
+		Marks2.set_used(groupCount);
+		memset(Marks2.pointer(), 0, groupCount * sizeof(u32));
+		GroupTriangles.set_used(0);
+		GroupTriangles.reallocate(groupCount);
+		for (u32 g=0; g<groupCount; ++g)
+			GroupTriangles.push_back(core::array<u32>());
+
+		// triangles on merged vertices, those collapsed to a line or point are dropped
+		const u16* indices = mb->getIndices();
+		const u32 triangleCount = mb->getIndexCount() / 3;
+		Indices.set_used(triangleCount * 3);
+		Alive.set_used(triangleCount);
+		core::array<SSimplifyEdge> edges(triangleCount * 3);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			u32 g[3];
+			for (u32 c=0; c<3; ++c)
+			{
+				Indices[t*3+c] = canonical[indices[t*3+c]];
+				g[c] = VertexGroup[Indices[t*3+c]];
+			}
+
+			Alive[t] = g[0] != g[1] && g[1] != g[2] && g[0] != g[2];
+			if (!Alive[t])
+				continue;
+			++Live;
+
+			core::vector3d<f64> normal;
+			const f64 length = getPlane(t, normal);
+			for (u32 c=0; c<3; ++c)
+			{
+				// weighted by area, so small triangles don't dominate
+				if (length > 0.0)
+					addPlane(g[c], normal, Positions[Indices[t*3]], length*0.5);
+				GroupTriangles[g[c]].push_back(t);
+
+				SSimplifyEdge edge;
+				const u32 next = (c+1)%3;
+				const bool lower = g[c] < g[next];
+				edge.Key = lower ? ((u64)g[c] << 32) | g[next] : ((u64)g[next] << 32) | g[c];
+				edge.Triangle = t;
+				edge.Vertex = Indices[t*3 + (lower ? c : next)];
+				edges.push_back(edge);
+			}
+		}
+
+		// sort the edges of the triangles by their end points
+		edges.sort();
+		core::array<u32> borderEdges(groupCount);
+		borderEdges.set_used(groupCount);
+		memset(borderEdges.pointer(), 0, groupCount * sizeof(u32));
+		core::array<u32> seamEdges(borderEdges);
+		core::array<bool> locked(groupCount);
+		locked.set_used(groupCount);
+		memset(locked.pointer(), 0, groupCount * sizeof(bool));
+
+		for (u32 start=0; start<edges.size(); )
+		{
+			u32 end = start + 1;
+			while (end < edges.size() && edges[end].Key == edges[start].Key)
+				++end;
+
+			const u32 a = (u32)(edges[start].Key >> 32);
+			const u32 b = (u32)(edges[start].Key & 0xFFFFFFFF);
+			bool constrain = false;
+
+			if (end - start == 1)
+			{
+				++borderEdges[a];
+				++borderEdges[b];
+				constrain = true;
+			}
+			else if (end - start == 2)
+			{
+				if (edges[start].Vertex != edges[start+1].Vertex)
+				{
+					++seamEdges[a];
+					++seamEdges[b];
+					constrain = true;
+				}
+			}
+			else
+			{
+				locked[a] = true;
+				locked[b] = true;
+			}
+
+			// planes through the edge, perpendicular to the triangles
+			for (u32 i=start; constrain && i<end; ++i)
+			{
+				core::vector3d<f64> normal;
+				if (getPlane(edges[i].Triangle, normal) <= 0.0)
+					continue;
+
+				const core::vector3df& p0 = Positions[getGroupVertex(edges[i].Triangle, a)];
+				const core::vector3df& p1 = Positions[getGroupVertex(edges[i].Triangle, b)];
+				core::vector3d<f64> side = core::vector3d<f64>(p1.X - p0.X, p1.Y - p0.Y, p1.Z - p0.Z).crossProduct(normal);
+				const f64 length = side.getLength();
+				if (length <= 0.0)
+					continue;
+				side /= length;
+
+				addPlane(a, side, p0, length*length*BORDER_WEIGHT);
+				addPlane(b, side, p0, length*length*BORDER_WEIGHT);
+			}
+
+			start = end;
+		}
+
+		for (u32 g=0; g<groupCount; ++g)
+		{
+			if (locked[g])
+				Kinds[g] = EVK_LOCKED;
+			else if (wedgeCount[g] == 1 && borderEdges[g] == 0)
+				Kinds[g] = EVK_MANIFOLD;
+			else if (wedgeCount[g] == 1 && borderEdges[g] == 2)
+				Kinds[g] = EVK_BORDER;
+			else if (wedgeCount[g] == 2 && borderEdges[g] == 0 && seamEdges[g] == 2)
+				Kinds[g] = EVK_SEAM;
+			else
+				Kinds[g] = EVK_LOCKED;
+		}
+	}
+
+	//! collapses edges until at most targetCount triangles are left
+	void simplify(u32 targetCount)
+	{
+		if (Live <= targetCount)
+			return;
+
+		for (u32 g=0; g<Kinds.size(); ++g)
+			pushCollapse(g);
+
+		while (Live > targetCount && !Heap.empty())
+		{
+			const SCollapse top = Heap[0];
+			popHeap();
+
+			if (Kinds[top.Group] == EVK_COLLAPSED || top.Version != Versions[top.Group])
+				continue;
+
+			// the neighbourhood may have changed since the cost was computed
+			SCollapse current;
+			if (!findCollapse(top.Group, current))
+				continue;
+			if (current.Cost > top.Cost * 1.000001 + 1e-12)
+			{
+				pushCollapse(top.Group);
+				continue;
+			}
+
+			// open meshes could lose their last triangles
+			if (current.Shared >= Live)
+				continue;
+
+			collapse(current);
+		}
+	}
+
+	//! indices of the remaining triangles, in the original order
+	void getIndices(core::array<u32>& out) const
+	{
+		out.set_used(0);
+		out.reallocate(Live * 3);
+		for (u32 t=0; t<Alive.size(); ++t)
+		{
+			if (Alive[t])
+			{
+				out.push_back(Indices[t*3]);
+				out.push_back(Indices[t*3+1]);
+				out.push_back(Indices[t*3+2]);
+			}
+		}
+	}
+
+private:
+
+	enum E_VERTEX_KIND
+	{
+		EVK_MANIFOLD = 0,
+		EVK_BORDER,
+		EVK_SEAM,
+		EVK_LOCKED,
+		EVK_COLLAPSED
+	};
+
+	//! constraint planes of border and seam edges count this much more than the surface
+	static const f64 BORDER_WEIGHT;
+
+	//! collapse of a group onto a neighbour, with the new vertex of each vertex of the group
+	struct SCollapse
+	{
+		f64 Cost;
+		u32 Group;
+		u32 Version;
+		u32 Target;
+		//! number of vertices of the group and of triangles removed
+		u32 Shared;
+		u32 From[2];
+		u32 To[2];
+	};
+
+	//! unit normal of the triangle, returns the length of the cross product
+	f64 getPlane(u32 t, core::vector3d<f64>& normal) const
+	{
+		const core::vector3df& p0 = Positions[Indices[t*3]];
+		const core::vector3df e1 = Positions[Indices[t*3+1]] - p0;
+		const core::vector3df e2 = Positions[Indices[t*3+2]] - p0;
+		normal.set((f64)e1.Y*e2.Z - (f64)e1.Z*e2.Y, (f64)e1.Z*e2.X - (f64)e1.X*e2.Z, (f64)e1.X*e2.Y - (f64)e1.Y*e2.X);
+		const f64 length = normal.getLength();
+		if (length > 0.0)
+			normal /= length;
+		return length;
+	}
+
+	void addPlane(u32 group, const core::vector3d<f64>& normal, const core::vector3df& point, f64 weight)
+	{
+		Quadrics[group].addPlane(normal.X, normal.Y, normal.Z,
+			-(normal.X*point.X + normal.Y*point.Y + normal.Z*point.Z), weight);
+	}
+
+	//! vertex of the triangle in the group, the group has to be part of it
+	u32 getGroupVertex(u32 t, u32 group) const
+	{
+		if (VertexGroup[Indices[t*3]] == group)
+			return Indices[t*3];
+		if (VertexGroup[Indices[t*3+1]] == group)
+			return Indices[t*3+1];
+		return Indices[t*3+2];
+	}
+
+	bool hasGroup(u32 t, u32 group) const
+	{
+		return VertexGroup[Indices[t*3]] == group || VertexGroup[Indices[t*3+1]] == group ||
+			VertexGroup[Indices[t*3+2]] == group;
+	}
+
+	//! cheapest valid collapse of the group onto a neighbour
+	bool findCollapse(u32 group, SCollapse& best)
+	{
+		const E_VERTEX_KIND kind = (E_VERTEX_KIND)Kinds[group];
+		if (kind == EVK_LOCKED || kind == EVK_COLLAPSED)
+			return false;
+
+		const core::array<u32>& triangles = GroupTriangles[group];
+		const u32 stamp = ++Stamp;
+		bool found = false;
+
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const u32 t = triangles[i];
+			if (!Alive[t])
+				continue;
+
+			for (u32 c=0; c<3; ++c)
+			{
+				const u32 other = VertexGroup[Indices[t*3+c]];
+				if (other == group || Marks2[other] == stamp)
+					continue;
+				Marks2[other] = stamp;
+
+				SCollapse candidate;
+				if (!getTargets(group, other, kind, candidate))
+					continue;
+
+				candidate.Cost = Quadrics[group].evaluate(Quadrics[other], Positions[candidate.To[0]]);
+				if (found && candidate.Cost >= best.Cost)
+					continue;
+				if (!isLinkValid(group, other) || isFlipping(group, other, Positions[candidate.To[0]]))
+					continue;
+
+				best = candidate;
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	//! new vertices for the vertices of the group, false if the edge to the other group can't be collapsed
+	bool getTargets(u32 group, u32 other, E_VERTEX_KIND kind, SCollapse& collapse) const
+	{
+		collapse.Group = group;
+		collapse.Target = other;
+
+		u32 shared = 0;
+		const core::array<u32>& triangles = GroupTriangles[group];
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const u32 t = triangles[i];
+			if (!Alive[t] || !hasGroup(t, other))
+				continue;
+
+			if (shared == 2)
+				return false;
+			collapse.From[shared] = getGroupVertex(t, group);
+			collapse.To[shared] = getGroupVertex(t, other);
+			++shared;
+		}
+		collapse.Shared = shared;
+
+		switch (kind)
+		{
+		case EVK_MANIFOLD:
+			// both triangles of the edge use the single vertex of the group
+			return shared > 0;
+		case EVK_BORDER:
+			// only along the border
+			return shared == 1;
+		default:
+			// only along the seam, both sides move onto their own vertex
+			return shared == 2 && collapse.From[0] != collapse.From[1];
+		}
+	}
+
+	//! the groups may only share the neighbours opposite to their common edge
+	bool isLinkValid(u32 group, u32 other)
+	{
+		const u32 stamp = ++Stamp;
+		u32 shared = 0;
+
+		const core::array<u32>& triangles = GroupTriangles[group];
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const u32 t = triangles[i];
+			if (!Alive[t])
+				continue;
+			if (hasGroup(t, other))
+				++shared;
+			for (u32 c=0; c<3; ++c)
+				Marks[VertexGroup[Indices[t*3+c]]] = stamp;
+		}
+
+		u32 common = 0;
+		const u32 counted = ++Stamp;
+		const core::array<u32>& otherTriangles = GroupTriangles[other];
+		for (u32 i=0; i<otherTriangles.size(); ++i)
+		{
+			const u32 t = otherTriangles[i];
+			if (!Alive[t])
+				continue;
+			for (u32 c=0; c<3; ++c)
+			{
+				const u32 g = VertexGroup[Indices[t*3+c]];
+				if (g != group && g != other && Marks[g] == stamp)
+				{
+					Marks[g] = counted;
+					++common;
+				}
+			}
+		}
+		return common == shared;
+	}
+
+	//! true if a remaining triangle of the group would turn over
+	bool isFlipping(u32 group, u32 other, const core::vector3df& target) const
+	{
+		const core::array<u32>& triangles = GroupTriangles[group];
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const u32 t = triangles[i];
+			if (!Alive[t] || hasGroup(t, other))
+				continue;
+
+			core::vector3df p[3];
+			core::vector3df q[3];
+			for (u32 c=0; c<3; ++c)
+			{
+				p[c] = Positions[Indices[t*3+c]];
+				q[c] = VertexGroup[Indices[t*3+c]] == group ? target : p[c];
+			}
+
+			// more than about 75 degrees counts as turned over, too
+			const core::vector3df before = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+			const core::vector3df after = (q[1] - q[0]).crossProduct(q[2] - q[0]);
+			const f32 dot = before.dotProduct(after);
+			if (dot <= 0.f || dot * dot < 0.0625f * before.getLengthSQ() * after.getLengthSQ())
+				return true;
+		}
+		return false;
+	}
+
+	//! moves the vertices of the group onto the target group
+	void collapse(const SCollapse& c)
+	{
+		core::array<u32>& triangles = GroupTriangles[c.Group];
+		core::array<u32>& otherTriangles = GroupTriangles[c.Target];
+
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const u32 t = triangles[i];
+			if (!Alive[t])
+				continue;
+
+			if (hasGroup(t, c.Target))
+			{
+				Alive[t] = false;
+				--Live;
+				continue;
+			}
+
+			for (u32 n=0; n<3; ++n)
+			{
+				const u32 v = Indices[t*3+n];
+				if (VertexGroup[v] == c.Group)
+					Indices[t*3+n] = (v == c.From[0]) ? c.To[0] : c.To[1];
+			}
+			otherTriangles.push_back(t);
+		}
+
+		Quadrics[c.Target].add(Quadrics[c.Group]);
+		Kinds[c.Group] = EVK_COLLAPSED;
+		triangles.clear();
+
+		u32 used = 0;
+		for (u32 i=0; i<otherTriangles.size(); ++i)
+		{
+			if (Alive[otherTriangles[i]])
+				otherTriangles[used++] = otherTriangles[i];
+		}
+		otherTriangles.set_used(used);
+
+		// the costs of the target and its neighbours have changed
+		Neighbours.set_used(0);
+		const u32 stamp = ++Stamp;
+		for (u32 i=0; i<otherTriangles.size(); ++i)
+		{
+			for (u32 n=0; n<3; ++n)
+			{
+				const u32 g = VertexGroup[Indices[otherTriangles[i]*3+n]];
+				if (Marks[g] != stamp)
+				{
+					Marks[g] = stamp;
+					Neighbours.push_back(g);
+				}
+			}
+		}
+		for (u32 i=0; i<Neighbours.size(); ++i)
+			pushCollapse(Neighbours[i]);
+	}
+
+	void pushCollapse(u32 group)
+	{
+		++Versions[group];
+
+		SCollapse entry;
+		if (!findCollapse(group, entry))
+			return;
+		entry.Version = Versions[group];
+
+		// binary min heap on the cost
+		u32 i = Heap.size();
+		Heap.push_back(entry);
+		while (i > 0)
+		{
+			const u32 parent = (i - 1) / 2;
+			if (Heap[parent].Cost <= entry.Cost)
+				break;
+			Heap[i] = Heap[parent];
+			i = parent;
+		}
+		Heap[i] = entry;
+	}
+
+	void popHeap()
+	{
+		const SCollapse last = Heap.getLast();
+		Heap.set_used(Heap.size() - 1);
+		const u32 size = Heap.size();
+		if (!size)
+			return;
+
+		u32 i = 0;
+		for (;;)
+		{
+			u32 child = i * 2 + 1;
+			if (child >= size)
+				break;
+			if (child + 1 < size && Heap[child + 1].Cost < Heap[child].Cost)
+				++child;
+			if (last.Cost <= Heap[child].Cost)
+				break;
+			Heap[i] = Heap[child];
+			i = child;
+		}
+		Heap[i] = last;
+	}
+
+	core::array<core::vector3df> Positions;
+	core::array<u32> Indices;
+	core::array<bool> Alive;
+	u32 Live;
+
+	core::array<u32> VertexGroup;
+	//! per group
+	core::array<u8> Kinds;
+	core::array<SQuadric> Quadrics;
+	core::array<core::array<u32> > GroupTriangles;
+	core::array<u32> Versions;
+	core::array<u32> Marks;
+	core::array<u32> Marks2;
+	u32 Stamp;
+	core::array<u32> Neighbours;
+
+	core::array<SCollapse> Heap;
+};
+
+const f64 CQuadricSimplifier::BORDER_WEIGHT = 10.0;
+
+bool isSimplifiable(const IMeshBuffer* mb)
+{
+	if (mb->getIndexType() != video::EIT_16BIT || mb->getPrimitiveType() != EPT_TRIANGLES ||
+		mb->getIndexCount() < 3)
+		return false;
+
+	switch (mb->getVertexType())
+	{
+	case video::EVT_STANDARD:
+	case video::EVT_2TCOORDS:
+	case video::EVT_TANGENTS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//! copies the vertices used by the indices, in the order of first use
+template <class T>
+IMeshBuffer* createCompactedBuffer(const IMeshBuffer* mb, const core::array<u32>& indices)
+{
+	CMeshBuffer<T>* buffer = new CMeshBuffer<T>();
+	buffer->Material = mb->getMaterial();
+
+	const T* vertices = (const T*)mb->getVertices();
+	core::array<s32> remap(mb->getVertexCount());
+	remap.set_used(mb->getVertexCount());
+	for (u32 i=0; i<remap.size(); ++i)
+		remap[i] = -1;
+
+	buffer->Indices.reallocate(indices.size());
+	for (u32 i=0; i<indices.size(); ++i)
+	{
+		const u32 v = indices[i];
+		if (remap[v] < 0)
+		{
+			remap[v] = (s32)buffer->Vertices.size();
+			buffer->Vertices.push_back(vertices[v]);
+		}
+		buffer->Indices.push_back((u16)remap[v]);
+	}
+
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! copies the vertices used by the indices into a buffer of the same vertex type
+IMeshBuffer* createCompactedBuffer(const IMeshBuffer* mb, const core::array<u32>& indices)
+{
+	switch (mb->getVertexType())
+	{
+	case video::EVT_2TCOORDS:
+		return createCompactedBuffer<video::S3DVertex2TCoords>(mb, indices);
+	case video::EVT_TANGENTS:
+		return createCompactedBuffer<video::S3DVertexTangents>(mb, indices);
+	default:
+		return createCompactedBuffer<video::S3DVertex>(mb, indices);
+	}
+}
+
+} // end anonymous namespace
+
+
+//! Creates a copy of the mesh with fewer triangles
+IMesh* CMeshManipulator::createMeshSimplified(IMesh* mesh, f32 ratio) const
+{
+	if (!mesh)
+		return 0;
+
+	SMesh* clone = new SMesh();
+	core::array<u32> indices;
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		if (!isSimplifiable(mb))
+		{
+			clone->addMeshBuffer(mb);
+			continue;
+		}
+
+		CQuadricSimplifier simplifier(mb);
+		simplifier.simplify((u32)(core::clamp(ratio, 0.f, 1.f) * (mb->getIndexCount() / 3)));
+		simplifier.getIndices(indices);
+
+		IMeshBuffer* buffer = createCompactedBuffer(mb, indices);
+		clone->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	clone->recalculateBoundingBox();
+	return clone;
+}
+
+
+//! Creates successively simplified copies of the mesh
+u32 CMeshManipulator::createMeshLODChain(IMesh* mesh, core::array<IMesh*>& outLevels, u32 maxLevels, f32 reduction) const
+{
+	if (!mesh || reduction <= 0.f || reduction >= 1.f)
+		return 0;
+
+	IMesh* previous = mesh;
+	s32 previousCount = getPolyCount(mesh);
+	u32 count = 0;
+
+	for (; count<maxLevels; ++count)
+	{
+		IMesh* level = createMeshSimplified(previous, reduction);
+
+		// stop when the locked borders and seams are most of what is left
+		const s32 levelCount = getPolyCount(level);
+		if (levelCount == 0 || levelCount > previousCount * 0.9f)
+		{
+			level->drop();
+			break;
+		}
+
+		outLevels.push_back(level);
+		previous = level;
+		previousCount = levelCount;
+	}
+
+	return count;
+}
+
+
+namespace
+{
+
+//! FIFO vertex cache with time stamps, returns the misses of the triangle
+inline u32 updateVertexCache(const u32* triangle, core::array<u32>& timeStamps, u32& time, u32 cacheSize)
+{
+	u32 misses = 0;
+	for (u32 k=0; k<3; ++k)
+	{
+		if (time - timeStamps[triangle[k]] > cacheSize)
+		{
+			timeStamps[triangle[k]] = time++;
+			++misses;
+		}
+	}
+	return misses;
+}
+
+//! Tipsify triangle order after Sander, Nehab and Barczak
+/** Emits all triangles around a fanning vertex, then continues with the
+vertex of the last triangles which stays longest in the cache while its
+remaining triangles are emitted. Dead ends continue with the most recent
+vertex which has triangles left. Runs in linear time. */
+void orderForVertexCache(const core::array<u32>& indices, u32 vertexCount, u32 cacheSize, core::array<u32>& outIndices)
+{
+	const u32 triangleCount = indices.size() / 3;
+
+	// triangles around each vertex
+	core::array<u32> live(vertexCount);
+	live.set_used(vertexCount);
+	for (u32 v=0; v<vertexCount; ++v)
+		live[v] = 0;
+	for (u32 i=0; i<indices.size(); ++i)
+		++live[indices[i]];
+
+	core::array<u32> offsets(vertexCount + 1);
+	offsets.set_used(vertexCount + 1);
+	offsets[0] = 0;
+	for (u32 v=0; v<vertexCount; ++v)
+		offsets[v+1] = offsets[v] + live[v];
+
+	core::array<u32> fill(offsets);
+	core::array<u32> adjacency(indices.size());
+	adjacency.set_used(indices.size());
+	for (u32 i=0; i<indices.size(); ++i)
+		adjacency[fill[indices[i]]++] = i / 3;
+
+	core::array<u32> timeStamps(vertexCount);
+	timeStamps.set_used(vertexCount);
+	for (u32 v=0; v<vertexCount; ++v)
+		timeStamps[v] = 0;
+
+	core::array<bool> emitted(triangleCount);
+	emitted.set_used(triangleCount);
+	for (u32 t=0; t<triangleCount; ++t)
+		emitted[t] = false;
+
+	core::array<u32> deadEnds;
+	core::array<u32> candidates;
+	outIndices.set_used(0);
+	outIndices.reallocate(indices.size());
+
+	u32 time = cacheSize + 1;
+	u32 scan = 0;
+	s32 fan = 0;
+	while (fan >= 0)
+	{
+		candidates.set_used(0);
+		for (u32 a=offsets[fan]; a<offsets[fan+1]; ++a)
+		{
+			const u32 t = adjacency[a];
+			if (emitted[t])
+				continue;
+
+			for (u32 k=0; k<3; ++k)
+			{
+				const u32 v = indices[t*3+k];
+				outIndices.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+				if (time - timeStamps[v] > cacheSize)
+					timeStamps[v] = time++;
+			}
+			emitted[t] = true;
+		}
+
+		// prefer the vertex which stays longest in the cache while its triangles are emitted
+		fan = -1;
+		s32 best = -1;
+		for (u32 c=0; c<candidates.size(); ++c)
+		{
+			const u32 v = candidates[c];
+			if (!live[v])
+				continue;
+
+			s32 priority = 0;
+			if (time - timeStamps[v] + 2 * live[v] <= cacheSize)
+				priority = (s32)(time - timeStamps[v]);
+			if (priority > best)
+			{
+				best = priority;
+				fan = (s32)v;
+			}
+		}
+
+		// dead end, go back to a recent vertex or the next one with triangles left
+		while (fan < 0 && !deadEnds.empty())
+		{
+			const u32 v = deadEnds.getLast();
+			deadEnds.erase(deadEnds.size() - 1);
+			if (live[v])
+				fan = (s32)v;
+		}
+		while (fan < 0 && scan < vertexCount)
+		{
+			if (live[scan])
+				fan = (s32)scan;
+			++scan;
+		}
+	}
+}
+
+//! sort key of a cluster, clusters facing away from the center come first
+struct SOverdrawCluster
+{
+	f32 Key;
+	u32 Start;
+	u32 End;
+
+	bool operator<(const SOverdrawCluster& other) const
+	{
+		return Key > other.Key || (Key == other.Key && Start < other.Start);
+	}
+};
+
+//! Splits the cache order into clusters and draws them from outside to inside
+/** Clusters start where the cache order jumps to a part of the mesh which
+shares no vertices with the cache, and inside those where the cache misses
+per triangle are down to threshold times those of the part, so the
+clusters keep most of the cache efficiency. */
+void orderForOverdraw(const IMeshBuffer* mb, core::array<u32>& indices, u32 cacheSize, f32 threshold)
+{
+	const u32 triangleCount = indices.size() / 3;
+	const u32 vertexCount = mb->getVertexCount();
+
+	core::array<u32> timeStamps(vertexCount);
+	timeStamps.set_used(vertexCount);
+	for (u32 v=0; v<vertexCount; ++v)
+		timeStamps[v] = 0;
+	u32 time = cacheSize + 1;
+
+	core::array<u32> parts;
+	for (u32 t=0; t<triangleCount; ++t)
+	{
+		if (updateVertexCache(&indices[t*3], timeStamps, time, cacheSize) == 3 || t == 0)
+			parts.push_back(t);
+	}
+
+	core::array<u32> starts;
+	for (u32 p=0; p<parts.size(); ++p)
+	{
+		const u32 start = parts[p];
+		const u32 end = (p + 1 < parts.size()) ? parts[p+1] : triangleCount;
+
+		time += cacheSize + 1;
+		u32 misses = 0;
+		for (u32 t=start; t<end; ++t)
+			misses += updateVertexCache(&indices[t*3], timeStamps, time, cacheSize);
+		const f32 limit = threshold * misses / (end - start);
+
+		starts.push_back(start);
+		time += cacheSize + 1;
+		u32 runMisses = 0;
+		u32 runTriangles = 0;
+		for (u32 t=start; t<end; ++t)
+		{
+			runMisses += updateVertexCache(&indices[t*3], timeStamps, time, cacheSize);
+			++runTriangles;
+			if (runMisses <= limit * runTriangles)
+			{
+				if (t + 1 < end)
+					starts.push_back(t + 1);
+				time += cacheSize + 1;
+				runMisses = 0;
+				runTriangles = 0;
+			}
+		}
+
+		// the rest did not get down to the limit, it joins the cluster before
+		if (runTriangles && starts.getLast() != start)
+			starts.erase(starts.size() - 1);
+	}
+
+	// area weighted center and normal of the clusters
+	core::vector3df meshCenter;
+	for (u32 v=0; v<vertexCount; ++v)
+		meshCenter += mb->getPosition(v);
+	meshCenter /= (f32)vertexCount;
+
+	core::array<SOverdrawCluster> clusters(starts.size());
+	for (u32 c=0; c<starts.size(); ++c)
+	{
+		SOverdrawCluster cluster;
+		cluster.Start = starts[c];
+		cluster.End = (c + 1 < starts.size()) ? starts[c+1] : triangleCount;
+
+		core::vector3df center;
+		core::vector3df normal;
+		f32 area = 0.f;
+		for (u32 t=cluster.Start; t<cluster.End; ++t)
+		{
+			const core::vector3df& p0 = mb->getPosition(indices[t*3]);
+			const core::vector3df& p1 = mb->getPosition(indices[t*3+1]);
+			const core::vector3df& p2 = mb->getPosition(indices[t*3+2]);
+			const core::vector3df n = (p1 - p0).crossProduct(p2 - p0);
+			const f32 a = n.getLength();
+			center += (p0 + p1 + p2) * (a / 3.f);
+			normal += n;
+			area += a;
+		}
+		if (area > 0.f)
+			center /= area;
+		normal.normalize();
+		cluster.Key = (center - meshCenter).dotProduct(normal);
+		clusters.push_back(cluster);
+	}
+	clusters.sort();
+
+	core::array<u32> sorted(indices.size());
+	for (u32 c=0; c<clusters.size(); ++c)
+	{
+		for (u32 i=clusters[c].Start*3; i<clusters[c].End*3; ++i)
+			sorted.push_back(indices[i]);
+	}
+	indices.swap(sorted);
+}
+
+} // end anonymous namespace
+
+
+//! Reorders triangles and vertices for the vertex cache and less overdraw
+IMesh* CMeshManipulator::createMeshOptimized(IMesh* mesh, u32 cacheSize, f32 overdrawThreshold) const
+{
+	if (!mesh)
+		return 0;
+
+	cacheSize = core::max_(cacheSize, 3u);
+	SMesh* clone = new SMesh();
+	core::array<u32> indices;
+	core::array<u32> ordered;
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		if (!isSimplifiable(mb))
+		{
+			clone->addMeshBuffer(mb);
+			continue;
+		}
+
+		const u16* source = mb->getIndices();
+		indices.set_used(mb->getIndexCount() / 3 * 3);
+		for (u32 i=0; i<indices.size(); ++i)
+			indices[i] = source[i];
+
+		orderForVertexCache(indices, mb->getVertexCount(), cacheSize, ordered);
+		if (overdrawThreshold > 0.f)
+			orderForOverdraw(mb, ordered, cacheSize, overdrawThreshold);
+
+		IMeshBuffer* buffer = createCompactedBuffer(mb, ordered);
+		clone->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	clone->recalculateBoundingBox();
+	return clone;
+}
+
+
+namespace
+{
+
+bool isClusterable(const IMeshBuffer* mb, u32 maxTriangles)
+{
+	if (mb->getPrimitiveType() != EPT_TRIANGLES || mb->getIndexCount() / 3 <= maxTriangles)
+		return false;
+
+	switch (mb->getVertexType())
+	{
+	case video::EVT_STANDARD:
+	case video::EVT_2TCOORDS:
+	case video::EVT_TANGENTS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//! spreads the lower 10 bits of the value to every third bit
+inline u32 spreadBits(u32 v)
+{
+	v &= 0x3ff;
+	v = (v | (v << 16)) & 0x030000ff;
+	v = (v | (v << 8)) & 0x0300f00f;
+	v = (v | (v << 4)) & 0x030c30c3;
+	v = (v | (v << 2)) & 0x09249249;
+	return v;
+}
+
+//! triangle with the Morton code of its center
+struct SCurveTriangle
+{
+	u32 Code;
+	u32 Triangle;
+
+	bool operator<(const SCurveTriangle& other) const
+	{
+		return Code < other.Code || (Code == other.Code && Triangle < other.Triangle);
+	}
+};
+
+//! Groups the triangles of a mesh buffer into clusters
+/** Triangles are neighbours when they share a vertex position, so seams
+and unconnected triangle soups grow clusters as well. */
+class CClusterBuilder
+{
+public:
+
+	CClusterBuilder(const IMeshBuffer* mb)
+	{
+		const u32 vertexCount = mb->getVertexCount();
+		Positions.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+			Positions[i] = mb->getPosition(i);
+
+		Indices.set_used(mb->getIndexCount() / 3 * 3);
+		if (mb->getIndexType() == video::EIT_32BIT)
+		{
+			const u32* source = (const u32*)mb->getIndices();
+			for (u32 i=0; i<Indices.size(); ++i)
+				Indices[i] = source[i];
+		}
+		else
+		{
+			const u16* source = mb->getIndices();
+			for (u32 i=0; i<Indices.size(); ++i)
+				Indices[i] = source[i];
+		}
+
+		const u32 triangleCount = Indices.size() / 3;
+		Centers.set_used(triangleCount);
+		Normals.set_used(triangleCount);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			const core::vector3df& p0 = Positions[Indices[t*3]];
+			const core::vector3df& p1 = Positions[Indices[t*3+1]];
+			const core::vector3df& p2 = Positions[Indices[t*3+2]];
+			Centers[t] = (p0 + p1 + p2) / 3.f;
+			Normals[t] = (p1 - p0).crossProduct(p2 - p0).normalize();
+		}
+
+		// vertices at the same position share their triangles
+		core::array<SPositionKey> keys(vertexCount);
+		keys.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			keys[i].Pos = Positions[i];
+			keys[i].Vertex = i;
+		}
+		keys.set_sorted(false);
+		keys.sort();
+
+		Groups.set_used(vertexCount);
+		u32 groupCount = 0;
+		for (u32 start=0; start<vertexCount; ++groupCount)
+		{
+			u32 end = start + 1;
+			while (end < vertexCount && keys[end].Pos == keys[start].Pos)
+				++end;
+			for (; start<end; ++start)
+				Groups[keys[start].Vertex] = groupCount;
+		}
+
+		GroupStart.set_used(groupCount + 1);
+		for (u32 g=0; g<=groupCount; ++g)
+			GroupStart[g] = 0;
+		for (u32 i=0; i<Indices.size(); ++i)
+			++GroupStart[Groups[Indices[i]] + 1];
+		for (u32 g=0; g<groupCount; ++g)
+			GroupStart[g+1] += GroupStart[g];
+
+		core::array<u32> fill(groupCount);
+		fill.set_used(groupCount);
+		for (u32 g=0; g<groupCount; ++g)
+			fill[g] = GroupStart[g];
+		GroupTriangles.set_used(Indices.size());
+		for (u32 i=0; i<Indices.size(); ++i)
+			GroupTriangles[fill[Groups[Indices[i]]]++] = i / 3;
+	}
+
+	//! appends the indices of the triangles cluster by cluster and the clusters
+	void build(u32 maxTriangles, f32 coneWeight, core::array<u32>& outIndices, core::array<SMeshCluster>& outClusters)
+	{
+		const u32 triangleCount = Centers.size();
+
+		// seeds follow a Morton curve through the triangle centers
+		core::aabbox3df box(Centers[0]);
+		for (u32 t=1; t<triangleCount; ++t)
+			box.addInternalPoint(Centers[t]);
+		const core::vector3df extent = box.getExtent();
+		const core::vector3df scale(
+			extent.X > 0.f ? 1023.f / extent.X : 0.f,
+			extent.Y > 0.f ? 1023.f / extent.Y : 0.f,
+			extent.Z > 0.f ? 1023.f / extent.Z : 0.f);
+
+		core::array<SCurveTriangle> curve(triangleCount);
+		curve.set_used(triangleCount);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			const core::vector3df cell = (Centers[t] - box.MinEdge) * scale;
+			curve[t].Code = spreadBits((u32)cell.X) | (spreadBits((u32)cell.Y) << 1) | (spreadBits((u32)cell.Z) << 2);
+			curve[t].Triangle = t;
+		}
+		curve.set_sorted(false);
+		curve.sort();
+
+		core::array<u8> used(triangleCount);
+		used.set_used(triangleCount);
+		memset(used.pointer(), 0, triangleCount);
+		core::array<u32> marks(triangleCount);
+		marks.set_used(triangleCount);
+		memset(marks.pointer(), 0, triangleCount * sizeof(u32));
+		u32 stamp = 0;
+
+		core::array<u32> cluster(maxTriangles);
+		core::array<u32> candidates;
+		u32 next = 0;
+		for (;;)
+		{
+			while (next < triangleCount && used[curve[next].Triangle])
+				++next;
+			if (next == triangleCount)
+				break;
+
+			++stamp;
+			cluster.set_used(0);
+			candidates.set_used(0);
+			core::vector3df center;
+			core::vector3df normalSum;
+			u32 t = curve[next].Triangle;
+
+			for (;;)
+			{
+				used[t] = 1;
+				cluster.push_back(t);
+				center += (Centers[t] - center) / (f32)cluster.size();
+				normalSum += Normals[t];
+				if (cluster.size() == maxTriangles)
+					break;
+
+				for (u32 k=0; k<3; ++k)
+				{
+					const u32 g = Groups[Indices[t*3+k]];
+					for (u32 i=GroupStart[g]; i<GroupStart[g+1]; ++i)
+					{
+						const u32 n = GroupTriangles[i];
+						if (!used[n] && marks[n] != stamp)
+						{
+							marks[n] = stamp;
+							candidates.push_back(n);
+						}
+					}
+				}
+
+				// squared distance, scaled by the squared deviation of the normal
+				const core::vector3df axis = core::vector3df(normalSum).normalize();
+				s32 best = -1;
+				f32 bestScore = FLT_MAX;
+				for (u32 i=0; i<candidates.size(); )
+				{
+					const u32 n = candidates[i];
+					if (used[n])
+					{
+						candidates[i] = candidates.getLast();
+						candidates.set_used(candidates.size() - 1);
+						continue;
+					}
+
+					const f32 factor = 1.f + coneWeight * (1.f - Normals[n].dotProduct(axis));
+					const f32 score = Centers[n].getDistanceFromSQ(center) * factor * factor;
+					if (score < bestScore)
+					{
+						bestScore = score;
+						best = (s32)n;
+					}
+					++i;
+				}
+
+				// small clusters without connected candidates continue at the next seed
+				if (best < 0)
+				{
+					if (cluster.size() * 2 >= maxTriangles)
+						break;
+					while (next < triangleCount && used[curve[next].Triangle])
+						++next;
+					if (next == triangleCount)
+						break;
+					best = (s32)curve[next].Triangle;
+				}
+				t = (u32)best;
+			}
+
+			outClusters.push_back(createCluster(cluster, outIndices));
+		}
+	}
+
+private:
+
+	//! appends the indices of the triangles and returns their cluster
+	SMeshCluster createCluster(const core::array<u32>& triangles, core::array<u32>& outIndices) const
+	{
+		SMeshCluster cluster;
+		cluster.IndexStart = outIndices.size();
+		cluster.IndexCount = triangles.size() * 3;
+
+		cluster.BoundingBox.reset(Positions[Indices[triangles[0]*3]]);
+		core::vector3df axis;
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			for (u32 k=0; k<3; ++k)
+			{
+				const u32 v = Indices[triangles[i]*3+k];
+				outIndices.push_back(v);
+				cluster.BoundingBox.addInternalPoint(Positions[v]);
+			}
+			axis += Normals[triangles[i]];
+		}
+
+		// degenerate triangles have no normal and are never drawn
+		axis.normalize();
+		f32 minDot = 1.f;
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const core::vector3df& normal = Normals[triangles[i]];
+			if (!normal.equals(core::vector3df()))
+				minDot = core::min_(minDot, normal.dotProduct(axis));
+		}
+		cluster.ConeAxis = axis;
+
+		// normals spread over more than about 84 degrees leave too small a cone
+		if (minDot <= 0.1f)
+			return cluster;
+
+		// apex on the back side of all triangle planes, as far out as needed
+		const core::vector3df center = cluster.BoundingBox.getCenter();
+		f32 maxT = 0.f;
+		for (u32 i=0; i<triangles.size(); ++i)
+		{
+			const core::vector3df& normal = Normals[triangles[i]];
+			const f32 d = normal.dotProduct(axis);
+			if (d > 0.f)
+				maxT = core::max_(maxT, (center - Positions[Indices[triangles[i]*3]]).dotProduct(normal) / d);
+		}
+		cluster.ConeApex = center - axis * maxT;
+		cluster.ConeCutoff = sqrtf(1.f - minDot * minDot);
+		return cluster;
+	}
+
+	core::array<core::vector3df> Positions;
+	core::array<u32> Indices;
+	core::array<core::vector3df> Centers;
+	core::array<core::vector3df> Normals;
+	//! position group of each vertex
+	core::array<u32> Groups;
+	//! triangles of each group, starting at GroupStart
+	core::array<u32> GroupStart;
+	core::array<u32> GroupTriangles;
+};
+
+//! copies the vertices used by the indices, in the order of first use, into a buffer with 32 bit indices
+IMeshBuffer* createCompactedBuffer32(const IMeshBuffer* mb, const core::array<u32>& indices)
+{
+	CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(mb->getVertexType(), video::EIT_32BIT);
+	buffer->Material = mb->getMaterial();
+
+	const u8* vertices = (const u8*)mb->getVertices();
+	const u32 stride = video::getVertexPitchFromType(mb->getVertexType());
+	core::array<s32> remap(mb->getVertexCount());
+	remap.set_used(mb->getVertexCount());
+	for (u32 i=0; i<remap.size(); ++i)
+		remap[i] = -1;
+
+	IVertexBuffer& vertexBuffer = buffer->getVertexBuffer();
+	IIndexBuffer& indexBuffer = buffer->getIndexBuffer();
+	indexBuffer.reallocate(indices.size());
+	for (u32 i=0; i<indices.size(); ++i)
+	{
+		const u32 v = indices[i];
+		if (remap[v] < 0)
+		{
+			remap[v] = (s32)vertexBuffer.size();
+			// the vertex list copies the whole vertex of its type
+			vertexBuffer.push_back(*(const video::S3DVertex*)(vertices + v * stride));
+		}
+		indexBuffer.push_back((u32)remap[v]);
+	}
+
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+} // end anonymous namespace
+
+
+//! Creates a copy of the mesh with its triangles grouped into clusters
+SClusteredMesh* CMeshManipulator::createMeshClustered(IMesh* mesh, u32 maxTriangles, f32 coneWeight) const
+{
+	if (!mesh)
+		return 0;
+
+	maxTriangles = core::max_(maxTriangles, 1u);
+	coneWeight = core::max_(coneWeight, 0.f);
+	SClusteredMesh* clone = new SClusteredMesh();
+	core::array<u32> indices;
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		// set_used would not construct the arrays
+		clone->Clusters.push_back(core::array<SMeshCluster>());
+
+		IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		if (!isClusterable(mb, maxTriangles))
+		{
+			clone->addMeshBuffer(mb);
+			continue;
+		}
+
+		CClusterBuilder builder(mb);
+		indices.set_used(0);
+		builder.build(maxTriangles, coneWeight, indices, clone->Clusters[b]);
+
+		IMeshBuffer* buffer = (mb->getIndexType() == video::EIT_32BIT) ?
+			createCompactedBuffer32(mb, indices) : createCompactedBuffer(mb, indices);
+		clone->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	clone->recalculateBoundingBox();
+	return clone;
+}
 
-	return newmesh;
-}
 
 } // end namespace scene
 } // end namespace irr
@@ -9,6 +9,8 @@
 
 namespace irr
 {
+class CThreadPool;
+
 namespace scene
 {
 
@@ -20,6 +22,12 @@ not intended for doing mesh modifications and/or animations during runtime.
 class CMeshManipulator : public IMeshManipulator
 {
 public:
+	//! constructor
+	CMeshManipulator();
+
+	//! destructor
+	virtual ~CMeshManipulator();
+
 	//! Flips the direction of surfaces.
 	/** Changes backfacing triangles to frontfacing triangles and vice versa.
 	\param mesh: Mesh on which the operation is performed. */
@@ -60,6 +68,12 @@ public:
 	//! Recalculates tangents, requires a tangent mesh
 	virtual void recalculateTangents(IMesh* mesh, bool recalculateNormals=false, bool smooth=false, bool angleWeighted=false) const _IRR_OVERRIDE_;
 
+	//! Set the number of threads for recalculating normals and tangents of meshes
+	virtual void setThreadCount(u32 count) _IRR_OVERRIDE_;
+
+	//! Get the number of threads for recalculating normals and tangents of meshes
+	virtual u32 getThreadCount() const _IRR_OVERRIDE_ { return ThreadCount; }
+
 	//! Creates a copy of the mesh, which will only consist of S3DVertexTangents vertices.
 	virtual IMesh* createMeshWithTangents(IMesh* mesh, bool recalculateNormals=false, bool smooth=false, bool angleWeighted=false, bool recalculateTangents=true) const _IRR_OVERRIDE_;
 
@@ -69,6 +83,9 @@ public:
 	//! Creates a copy of the mesh, which will only consist of S3DVertex vertices.
 	virtual IMesh* createMeshWith1TCoords(IMesh* mesh) const _IRR_OVERRIDE_;
 
+	//! Creates a copy of the mesh with quantized S3DVertexCompact vertices.
+	virtual IMesh* createMeshCompact(IMesh* mesh) const _IRR_OVERRIDE_;
+
 	//! Creates a copy of the mesh, which will only consist of unique triangles, i.e. no vertices are shared.
 	virtual IMesh* createMeshUniquePrimitives(IMesh* mesh) const _IRR_OVERRIDE_;
 
@@ -87,11 +104,32 @@ public:
 	//! create a mesh optimized for the vertex cache
 	virtual IMesh* createForsythOptimizedMesh(const scene::IMesh *mesh) const _IRR_OVERRIDE_;
 
+	//! Reorders triangles and vertices for the vertex cache and less overdraw
+	virtual IMesh* createMeshOptimized(IMesh* mesh, u32 cacheSize=16, f32 overdrawThreshold=1.05f) const _IRR_OVERRIDE_;
+
+	//! Creates a copy of the mesh with fewer triangles
+	virtual IMesh* createMeshSimplified(IMesh* mesh, f32 ratio) const _IRR_OVERRIDE_;
+
+	//! Creates successively simplified copies of the mesh
+	virtual u32 createMeshLODChain(IMesh* mesh, core::array<IMesh*>& outLevels,
+		u32 maxLevels=4, f32 reduction=0.5f) const _IRR_OVERRIDE_;
+
+	//! Creates a copy of the mesh with its triangles grouped into clusters
+	virtual SClusteredMesh* createMeshClustered(IMesh* mesh, u32 maxTriangles=128, f32 coneWeight=1.f) const _IRR_OVERRIDE_;
+
 	//! Optimizes the mesh using an algorithm tuned for heightmaps
 	virtual void heightmapOptimizeMesh(IMesh * const m, const f32 tolerance = core::ROUNDING_ERROR_f32) const _IRR_OVERRIDE_;
 
 	//! Optimizes the mesh using an algorithm tuned for heightmaps
 	virtual void heightmapOptimizeMesh(IMeshBuffer * const m, const f32 tolerance = core::ROUNDING_ERROR_f32) const _IRR_OVERRIDE_;
+
+private:
+
+	//! recalculates normals or tangents of the buffers of a mesh on the pool
+	void recalculateBuffers(IMesh* mesh, bool tangents, bool recalculateNormals, bool smooth, bool angleWeighted) const;
+
+	CThreadPool* Pool;
+	u32 ThreadCount;
 };
 
 } // end namespace scene
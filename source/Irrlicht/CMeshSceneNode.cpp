@@ -29,7 +29,7 @@ CMeshSceneNode::CMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* m
 			const core::vector3df& position, const core::vector3df& rotation,
 			const core::vector3df& scale)
 : IMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0), Shadow(0),
-	PassCount(0), ReadOnlyMaterials(false)
+	PassCount(0), ReadOnlyMaterials(false), ClusterOrthogonal(false), ClusterConesValid(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CMeshSceneNode");
@@ -135,6 +135,8 @@ void CMeshSceneNode::render()
 	// render original meshes
 	if (renderMeshes)
 	{
+		const bool clustered = Mesh->getMeshType() == EAMT_CLUSTERED && prepareClusterCulling();
+
 		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
 		{
 			scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
@@ -148,8 +150,16 @@ void CMeshSceneNode::render()
 				// and solid only in solid pass
 				if (transparent == isTransparentPass)
 				{
-					driver->setMaterial(material);
-					driver->drawMeshBuffer(mb);
+					const void* indices = 0;
+					u32 primitiveCount = 0;
+					if (!clustered || cullClusters(i, material, indices, primitiveCount))
+					{
+						driver->setMaterial(material);
+						if (indices)
+							driver->drawMeshBufferIndices(mb, indices, primitiveCount);
+						else
+							driver->drawMeshBuffer(mb);
+					}
 				}
 			}
 		}
@@ -268,6 +278,7 @@ void CMeshSceneNode::setMesh(IMesh* mesh)
 
 		Mesh = mesh;
 		copyMaterials();
+		ClusterIndices.clear();
 	}
 }
 
@@ -315,6 +326,139 @@ void CMeshSceneNode::copyMaterials()
 }
 
 
+bool CMeshSceneNode::prepareClusterCulling()
+{
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return false;
+
+	const core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+	ClusterFrustum = *camera->getViewFrustum();
+	ClusterFrustum.transform(invTrans);
+
+	ClusterOrthogonal = camera->isOrthogonal();
+	if (ClusterOrthogonal)
+	{
+		ClusterViewDirection = ClusterFrustum.planes[SViewFrustum::VF_FAR_PLANE].Normal;
+		ClusterViewDirection.normalize();
+	}
+
+	// cones only keep their angles with uniform scale, mirroring turns them around
+	const f32* m = AbsoluteTransformation.pointer();
+	const core::vector3df x(m[0], m[1], m[2]);
+	const core::vector3df y(m[4], m[5], m[6]);
+	const core::vector3df z(m[8], m[9], m[10]);
+	const f32 scale = x.getLength();
+	ClusterConesValid = x.crossProduct(y).dotProduct(z) > 0.f &&
+		core::equals(y.getLength(), scale, scale * 0.001f) &&
+		core::equals(z.getLength(), scale, scale * 0.001f);
+
+	return true;
+}
+
+
+bool CMeshSceneNode::cullClusters(u32 i, const video::SMaterial& material, const void*& indices, u32& primitiveCount)
+{
+	const IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+	const SClusteredMesh* mesh = static_cast<const SClusteredMesh*>(Mesh);
+	if (i >= mesh->Clusters.size() || mesh->Clusters[i].empty())
+		return true;
+	const core::array<SMeshCluster>& clusters = mesh->Clusters[i];
+
+	// planes the whole buffer is behind need no tests for its clusters
+	u32 planeMask = 0;
+	for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+	{
+		const core::EIntersectionRelation3D rel = mb->getBoundingBox().classifyPlaneRelation(ClusterFrustum.planes[p]);
+		if (rel == core::ISREL3D_FRONT)
+			return false;
+		if (rel != core::ISREL3D_BACK)
+			planeMask |= 1 << p;
+	}
+
+	const bool cones = ClusterConesValid && material.BackfaceCulling && !material.FrontfaceCulling;
+	if (!planeMask && !cones)
+		return true;
+
+	VisibleClusters.set_used(0);
+	for (u32 c=0; c<clusters.size(); ++c)
+	{
+		const SMeshCluster& cluster = clusters[c];
+
+		bool culled = false;
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT && !culled; ++p)
+		{
+			culled = (planeMask & (1 << p)) &&
+				cluster.BoundingBox.classifyPlaneRelation(ClusterFrustum.planes[p]) == core::ISREL3D_FRONT;
+		}
+
+		if (!culled && cones)
+		{
+			culled = ClusterOrthogonal ? cluster.isBackFacingAlong(ClusterViewDirection) :
+				cluster.isBackFacingFrom(ClusterFrustum.cameraPosition);
+		}
+
+		if (!culled)
+			VisibleClusters.push_back(c);
+	}
+
+	// all visible keeps the indices of the source in its hardware buffer
+	if (VisibleClusters.size() == clusters.size())
+		return true;
+	if (VisibleClusters.empty())
+		return false;
+
+	while (ClusterIndices.size() <= i)
+		ClusterIndices.push_back(SVisibleClusters());
+
+	// the vertices are drawn from the mesh buffer itself, only the indices are copied
+	SVisibleClusters& visible = ClusterIndices[i];
+	const bool large = mb->getIndexType() == video::EIT_32BIT;
+	if (visible.Source != mb || visible.ChangedID != mb->getChangedID_Index() || visible.Clusters != VisibleClusters)
+	{
+		visible.Source = mb;
+		visible.ChangedID = mb->getChangedID_Index();
+		visible.Clusters = VisibleClusters;
+
+		if (large)
+			copyClusterIndices((const u32*)mb->getIndices(), clusters, VisibleClusters, visible.Indices32);
+		else
+			copyClusterIndices(mb->getIndices(), clusters, VisibleClusters, visible.Indices16);
+	}
+
+	if (large)
+	{
+		indices = visible.Indices32.const_pointer();
+		primitiveCount = visible.Indices32.size() / 3;
+	}
+	else
+	{
+		indices = visible.Indices16.const_pointer();
+		primitiveCount = visible.Indices16.size() / 3;
+	}
+	return true;
+}
+
+
+template <class T>
+void CMeshSceneNode::copyClusterIndices(const T* source, const core::array<SMeshCluster>& clusters,
+	const core::array<u32>& visible, core::array<T>& indices)
+{
+	u32 count = 0;
+	for (u32 i=0; i<visible.size(); ++i)
+		count += clusters[visible[i]].IndexCount;
+	indices.set_used(count);
+
+	T* out = indices.pointer();
+	for (u32 i=0; i<visible.size(); ++i)
+	{
+		const SMeshCluster& cluster = clusters[visible[i]];
+		memcpy(out, source + cluster.IndexStart, cluster.IndexCount * sizeof(T));
+		out += cluster.IndexCount;
+	}
+}
+
+
 //! Writes attributes of the scene node.
 void CMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
 {
@@ -7,12 +7,15 @@
 
 #include "IMeshSceneNode.h"
 #include "IMesh.h"
+#include "SClusteredMesh.h"
+#include "SViewFrustum.h"
 
 namespace irr
 {
 namespace scene
 {
 
+
 	class CMeshSceneNode : public IMeshSceneNode
 	{
 	public:
@@ -85,6 +88,35 @@ namespace scene
 
 		void copyMaterials();
 
+		//! moves the view into object space for culling the clusters of an SClusteredMesh
+		/** \return False if there is no camera to cull against. */
+		bool prepareClusterCulling();
+
+		//! culls the clusters of mesh buffer i
+		/** \param indices Set to the indices of the visible clusters, or
+		to 0 when the whole mesh buffer is drawn.
+		\return False if no cluster is visible. */
+		bool cullClusters(u32 i, const video::SMaterial& material, const void*& indices, u32& primitiveCount);
+
+		//! indices of the visible clusters of a mesh buffer
+		struct SVisibleClusters
+		{
+			SVisibleClusters() : Source(0), ChangedID(0) {}
+
+			//! mesh buffer the indices were copied from, kept by the mesh
+			const IMeshBuffer* Source;
+			//! index ChangedID of the source when they were copied
+			u32 ChangedID;
+			//! numbers of the visible clusters
+			core::array<u32> Clusters;
+			core::array<u16> Indices16;
+			core::array<u32> Indices32;
+		};
+
+		template <class T>
+		static void copyClusterIndices(const T* source, const core::array<SMeshCluster>& clusters,
+			const core::array<u32>& visible, core::array<T>& indices);
+
 		core::array<video::SMaterial> Materials;
 		core::aabbox3d<f32> Box;
 		video::SMaterial ReadOnlyMaterial;
@@ -94,6 +126,17 @@ namespace scene
 
 		s32 PassCount;
 		bool ReadOnlyMaterials;
+
+		// culling of the clusters of an SClusteredMesh, in object space
+		SViewFrustum ClusterFrustum;
+		//! normalized view direction for orthogonal cameras
+		core::vector3df ClusterViewDirection;
+		bool ClusterOrthogonal;
+		//! the transformation keeps the cones, without mirroring or non uniform scale
+		bool ClusterConesValid;
+		core::array<u32> VisibleClusters;
+		//! one per mesh buffer, the indices are copied again when the visible clusters change
+		core::array<SVisibleClusters> ClusterIndices;
 	};
 
 } // end namespace scene
@@ -88,7 +88,8 @@ IImageWriter* createImageWriterPPM();
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 	: SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
 	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500),
-	TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+	TextureCreationFlags(0), TextureCallForwarder(0), ForwardedTextureCreationFlags(0),
+	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CNullDriver");
@@ -432,6 +433,15 @@ void CNullDriver::renameTexture(ITexture* texture, const io::path& newName)
 
 ITexture* CNullDriver::addTexture(const core::dimension2d<u32>& size, const io::path& name, ECOLOR_FORMAT format)
 {
+	if (isForwardingTextureCalls())
+	{
+		SForwardedTextureCall call(this, SForwardedTextureCall::ETC_ADD_TEXTURE);
+		call.Size = size;
+		call.Name = name;
+		call.Format = format;
+		return forwardTextureCall(call);
+	}
+
 	if (0 == name.size())
 	{
 		os::Printer::log("Could not create ITexture, texture needs to have a non-empty name.", ELL_WARNING);
@@ -462,6 +472,14 @@ ITexture* CNullDriver::addTexture(const core::dimension2d<u32>& size, const io::
 
 ITexture* CNullDriver::addTexture(const io::path& name, IImage* image)
 {
+	if (isForwardingTextureCalls())
+	{
+		SForwardedTextureCall call(this, SForwardedTextureCall::ETC_ADD_TEXTURE_FROM_IMAGE);
+		call.Name = name;
+		call.Image = image;
+		return forwardTextureCall(call);
+	}
+
 	if (0 == name.size())
 	{
 		os::Printer::log("Could not create ITexture, texture needs to have a non-empty name.", ELL_WARNING);
@@ -556,6 +574,13 @@ ITexture* CNullDriver::addTextureCubemap(const irr::u32 sideLen, const io::path&
 //! loads a Texture
 ITexture* CNullDriver::getTexture(const io::path& filename)
 {
+	if (isForwardingTextureCalls())
+	{
+		SForwardedTextureCall call(this, SForwardedTextureCall::ETC_GET_TEXTURE);
+		call.Name = filename;
+		return forwardTextureCall(call);
+	}
+
 	// Identify textures by their absolute filenames if possible.
 	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
 
@@ -618,6 +643,13 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 //! loads a Texture
 ITexture* CNullDriver::getTexture(io::IReadFile* file)
 {
+	if (isForwardingTextureCalls())
+	{
+		SForwardedTextureCall call(this, SForwardedTextureCall::ETC_GET_TEXTURE_FROM_FILE);
+		call.File = file;
+		return forwardTextureCall(call);
+	}
+
 	ITexture* texture = 0;
 
 	if (file)
@@ -712,6 +744,13 @@ void CNullDriver::addTexture(video::ITexture* texture)
 //! looks if the image is already loaded
 video::ITexture* CNullDriver::findTexture(const io::path& filename)
 {
+	if (isForwardingTextureCalls())
+	{
+		SForwardedTextureCall call(this, SForwardedTextureCall::ETC_FIND_TEXTURE);
+		call.Name = filename;
+		return forwardTextureCall(call);
+	}
+
 	SSurface s;
 	SDummyTexture dummy(filename, ETT_2D);
 	s.Surface = &dummy;
@@ -1293,6 +1332,15 @@ void CNullDriver::makeNormalMapTexture(video::ITexture* texture, f32 amplitude)
 	if (!texture)
 		return;
 
+	if (isForwardingTextureCalls())
+	{
+		SForwardedTextureCall call(const_cast<CNullDriver*>(this), SForwardedTextureCall::ETC_MAKE_NORMAL_MAP);
+		call.Texture = texture;
+		call.Amplitude = amplitude;
+		forwardTextureCall(call);
+		return;
+	}
+
 	if (texture->getColorFormat() != ECF_A1R5G5B5 &&
 		texture->getColorFormat() != ECF_A8R8G8B8 )
 	{
@@ -1527,16 +1575,73 @@ void CNullDriver::setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag, bool enab
 		setTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED, false);
 	}
 
-	// set flag
-	TextureCreationFlags = (TextureCreationFlags & (~flag)) |
-		((((u32)!enabled)-1) & flag);
+	// set flag, forwarding threads have their own flags
+	u32& flags = isForwardingTextureCalls() ? ForwardedTextureCreationFlags : TextureCreationFlags;
+	flags = (flags & (~flag)) | ((((u32)!enabled)-1) & flag);
 }
 
 
 //! Returns if a texture creation flag is enabled or disabled.
 bool CNullDriver::getTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag) const
 {
-	return (TextureCreationFlags & flag)!=0;
+	const u32 flags = isForwardingTextureCalls() ? ForwardedTextureCreationFlags : TextureCreationFlags;
+	return (flags & flag)!=0;
+}
+
+
+//! Sets the forwarder for texture calls made on other threads.
+bool CNullDriver::setTextureCallForwarder(ITextureCallForwarder* forwarder)
+{
+	if (forwarder && TextureCallForwarder && forwarder != TextureCallForwarder)
+		return false;
+
+	TextureCallForwarder = forwarder;
+	ForwardedTextureCreationFlags = TextureCreationFlags;
+	return true;
+}
+
+
+bool CNullDriver::isForwardingTextureCalls() const
+{
+	return TextureCallForwarder && TextureCallForwarder->isForwardingThread();
+}
+
+
+ITexture* CNullDriver::forwardTextureCall(SForwardedTextureCall& call) const
+{
+	TextureCallForwarder->forward(&call);
+	return call.Texture;
+}
+
+
+void CNullDriver::SForwardedTextureCall::run()
+{
+	const u32 flags = Driver->TextureCreationFlags;
+	Driver->TextureCreationFlags = Driver->ForwardedTextureCreationFlags;
+
+	switch (Function)
+	{
+	case ETC_GET_TEXTURE:
+		Texture = Driver->getTexture(Name);
+		break;
+	case ETC_GET_TEXTURE_FROM_FILE:
+		Texture = Driver->getTexture(File);
+		break;
+	case ETC_FIND_TEXTURE:
+		Texture = Driver->findTexture(Name);
+		break;
+	case ETC_ADD_TEXTURE:
+		Texture = Driver->addTexture(Size, Name, Format);
+		break;
+	case ETC_ADD_TEXTURE_FROM_IMAGE:
+		Texture = Driver->addTexture(Name, Image);
+		break;
+	case ETC_MAKE_NORMAL_MAP:
+		Driver->makeNormalMapTexture(Texture, Amplitude);
+		break;
+	}
+
+	Driver->TextureCreationFlags = flags;
 }
 
 core::array<IImage*> CNullDriver::createImagesFromFile(const io::path& filename, E_TEXTURE_TYPE* type)
@@ -1765,6 +1870,13 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	if (!mb)
 		return;
 
+	// compact vertices need the bounding box of the buffer for decoding
+	if (mb->getVertexType() == EVT_COMPACT)
+	{
+		drawCompactMeshBuffer(mb, mb->getIndices(), mb->getPrimitiveCount());
+		return;
+	}
+
 	//IVertexBuffer and IIndexBuffer later
 	SHWBufferLink *HWBuffer=getBufferLink(mb);
 
@@ -1775,6 +1887,53 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws the vertices of a mesh buffer with other indices
+void CNullDriver::drawMeshBufferIndices(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount)
+{
+	if (!mb || !indices)
+		return;
+
+	if (mb->getVertexType() == EVT_COMPACT)
+	{
+		drawCompactMeshBuffer(mb, indices, primitiveCount);
+		return;
+	}
+
+	// the link of the mesh buffer itself, so its vertices are uploaded once
+	SHWBufferLink *HWBuffer=getBufferLink(mb);
+
+	if (HWBuffer)
+		drawHardwareBufferIndices(HWBuffer, indices, primitiveCount);
+	else
+		drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), indices, primitiveCount, mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+}
+
+
+//! Draw the vertices of a hardware buffer with other indices, from client memory by default
+void CNullDriver::drawHardwareBufferIndices(SHWBufferLink *HWBuffer, const void* indices, u32 primitiveCount)
+{
+	HWBuffer->LastUsed=0;
+
+	const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+	drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), indices, primitiveCount, mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+}
+
+
+//! Draws a mesh buffer with EVT_COMPACT vertices
+void CNullDriver::drawCompactMeshBuffer(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount)
+{
+	const u32 count = mb->getVertexCount();
+	const S3DVertexCompact* vertices = (const S3DVertexCompact*)mb->getVertices();
+	const core::aabbox3df& box = mb->getBoundingBox();
+
+	CompactVertices.set_used(count);
+	for (u32 i=0; i < count; ++i)
+		CompactVertices[i] = vertices[i].getVertex(box);
+
+	drawVertexPrimitiveList(CompactVertices.const_pointer(), count, indices, primitiveCount, EVT_STANDARD, mb->getPrimitiveType(), mb->getIndexType());
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
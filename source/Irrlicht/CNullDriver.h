@@ -21,6 +21,7 @@
 #include "SVertexIndex.h"
 #include "SLight.h"
 #include "SExposedVideoData.h"
+#include "ITextureCallForwarder.h"
 
 #ifdef _MSC_VER
 #pragma warning( disable: 4996)
@@ -347,6 +348,9 @@ namespace video
 		//! Returns if a texture creation flag is enabled or disabled.
 		virtual bool getTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag) const _IRR_OVERRIDE_;
 
+		//! Sets the forwarder for texture calls made on other threads.
+		virtual bool setTextureCallForwarder(ITextureCallForwarder* forwarder) _IRR_OVERRIDE_;
+
 		virtual core::array<IImage*> createImagesFromFile(const io::path& filename, E_TEXTURE_TYPE* type = 0) _IRR_OVERRIDE_;
 
 		virtual core::array<IImage*> createImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type = 0) _IRR_OVERRIDE_;
@@ -378,6 +382,9 @@ namespace video
 		//! Draws a mesh buffer
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws the vertices of a mesh buffer with other indices
+		virtual void drawMeshBufferIndices(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount) _IRR_OVERRIDE_;
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f,
 			SColor color=0xffffffff) _IRR_OVERRIDE_;
@@ -423,12 +430,18 @@ namespace video
 		//! Draw hardware buffer (only some drivers can)
 		virtual void drawHardwareBuffer(SHWBufferLink *HWBuffer) {}
 
+		//! Draw the vertices of a hardware buffer with other indices, from client memory by default
+		virtual void drawHardwareBufferIndices(SHWBufferLink *HWBuffer, const void* indices, u32 primitiveCount);
+
 		//! Delete hardware buffer
 		virtual void deleteHardwareBuffer(SHWBufferLink *HWBuffer);
 
 		//! Create hardware buffer from mesh (only some drivers can)
 		virtual SHWBufferLink *createHardwareBuffer(const scene::IMeshBuffer* mb) {return 0;}
 
+		//! Draws a mesh buffer with EVT_COMPACT vertices, decoded into S3DVertex by default
+		virtual void drawCompactMeshBuffer(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount);
+
 	public:
 		//! Remove hardware buffer
 		virtual void removeHardwareBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
@@ -699,6 +712,43 @@ namespace video
 		//! adds a surface, not loaded or created by the Irrlicht Engine
 		void addTexture(video::ITexture* surface);
 
+		//! a texture function called on a forwarding thread, executed on the driver thread
+		struct SForwardedTextureCall : public ITextureCall
+		{
+			enum E_TEXTURE_CALL
+			{
+				ETC_GET_TEXTURE,
+				ETC_GET_TEXTURE_FROM_FILE,
+				ETC_FIND_TEXTURE,
+				ETC_ADD_TEXTURE,
+				ETC_ADD_TEXTURE_FROM_IMAGE,
+				ETC_MAKE_NORMAL_MAP
+			};
+
+			SForwardedTextureCall(CNullDriver* driver, E_TEXTURE_CALL function)
+				: Driver(driver), Function(function), File(0), Image(0),
+				Format(ECF_A8R8G8B8), Amplitude(1.f), Texture(0) {}
+
+			//! executes the function with the texture creation flags of the forwarding thread
+			virtual void run() _IRR_OVERRIDE_;
+
+			CNullDriver* Driver;
+			E_TEXTURE_CALL Function;
+			io::path Name;
+			io::IReadFile* File;
+			IImage* Image;
+			core::dimension2du Size;
+			ECOLOR_FORMAT Format;
+			f32 Amplitude;
+			ITexture* Texture;
+		};
+
+		//! true if the texture calls of the calling thread are forwarded
+		bool isForwardingTextureCalls() const;
+
+		//! passes the call to the forwarder and returns its texture once it is executed
+		ITexture* forwardTextureCall(SForwardedTextureCall& call) const;
+
 		virtual ITexture* createDeviceDependentTexture(const io::path& name, IImage* image);
 
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image);
@@ -860,6 +910,9 @@ namespace video
 		//core::array<SHWBufferLink*> HWBufferLinks;
 		core::map< const scene::IMeshBuffer* , SHWBufferLink* > HWBufferMap;
 
+		//! decoded vertices of the last drawn compact mesh buffer
+		core::array<S3DVertex> CompactVertices;
+
 		io::IFileSystem* FileSystem;
 
 		//! mesh manipulator
@@ -876,6 +929,10 @@ namespace video
 
 		u32 TextureCreationFlags;
 
+		//! see setTextureCallForwarder
+		ITextureCallForwarder* TextureCallForwarder;
+		u32 ForwardedTextureCreationFlags;
+
 		f32 FogStart;
 		f32 FogEnd;
 		f32 FogDensity;
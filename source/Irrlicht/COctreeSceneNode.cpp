@@ -266,6 +266,9 @@ void COctreeSceneNode::render()
 			}
 		}
 		break;
+	case video::EVT_COMPACT:
+		// not used, compact vertices are decoded into one of the others
+		break;
 	}
 
 	// for debug purposes only
@@ -288,6 +291,8 @@ void COctreeSceneNode::render()
 				case video::EVT_TANGENTS:
 					TangentsOctree->getBoundingBoxes(box, boxes);
 					break;
+				case video::EVT_COMPACT:
+					break;
 			}
 
 			for (u32 b=0; b!=boxes.size(); ++b)
@@ -446,6 +451,10 @@ bool COctreeSceneNode::createTree(IMesh* mesh)
 							for (v=0; v<b->getVertexCount(); ++v)
 								nchunk.Vertices.push_back(((video::S3DVertexTangents*)b->getVertices())[v]);
 							break;
+						case video::EVT_COMPACT:
+							for (v=0; v<b->getVertexCount(); ++v)
+								nchunk.Vertices.push_back(((video::S3DVertexCompact*)b->getVertices())[v].getVertex(b->getBoundingBox()));
+							break;
 						}
 
 						polyCount += b->getIndexCount();
@@ -499,6 +508,13 @@ bool COctreeSceneNode::createTree(IMesh* mesh)
 							for (v=0; v<b->getVertexCount(); ++v)
 								nchunk.Vertices.push_back(((video::S3DVertexTangents*)b->getVertices())[v]);
 							break;
+						case video::EVT_COMPACT:
+							for (v=0; v<b->getVertexCount(); ++v)
+							{
+								video::S3DVertex tmpV = ((video::S3DVertexCompact*)b->getVertices())[v].getVertex(b->getBoundingBox());
+								nchunk.Vertices.push_back(tmpV);
+							}
+							break;
 						}
 
 						polyCount += b->getIndexCount();
@@ -549,6 +565,13 @@ bool COctreeSceneNode::createTree(IMesh* mesh)
 							for (v=0; v<b->getVertexCount(); ++v)
 								nchunk.Vertices.push_back(((video::S3DVertexTangents*)b->getVertices())[v]);
 							break;
+						case video::EVT_COMPACT:
+							for (v=0; v<b->getVertexCount(); ++v)
+							{
+								const video::S3DVertex tmpV = ((video::S3DVertexCompact*)b->getVertices())[v].getVertex(b->getBoundingBox());
+								nchunk.Vertices.push_back(video::S3DVertexTangents(tmpV.Pos, tmpV.Color, tmpV.TCoords));
+							}
+							break;
 						}
 
 						polyCount += b->getIndexCount();
@@ -562,6 +585,8 @@ bool COctreeSceneNode::createTree(IMesh* mesh)
 				nodeCount = TangentsOctree->getNodeCount();
 			}
 			break;
+		case video::EVT_COMPACT:
+			break;
 		}
 	}
 
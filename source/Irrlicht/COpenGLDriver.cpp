@@ -680,6 +680,36 @@ void COpenGLDriver::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
 }
 
 
+//! Draw the vertices of a hardware buffer with indices from client memory
+void COpenGLDriver::drawHardwareBufferIndices(SHWBufferLink *_HWBuffer, const void* indices, u32 primitiveCount)
+{
+	if (!_HWBuffer)
+		return;
+
+	updateHardwareBuffer(_HWBuffer); //check if update is needed
+	_HWBuffer->LastUsed=0; //reset count
+
+#if defined(GL_ARB_vertex_buffer_object)
+	SHWBufferLink_opengl *HWBuffer=(SHWBufferLink_opengl*)_HWBuffer;
+
+	const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+	const void *vertices=mb->getVertices();
+
+	if (HWBuffer->Mapped_Vertex!=scene::EHM_NEVER)
+	{
+		extGlBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
+		vertices=0;
+	}
+
+	// the index buffer of the mesh buffer stays unbound
+	drawVertexPrimitiveList(vertices, mb->getVertexCount(), indices, primitiveCount, mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+
+	if (HWBuffer->Mapped_Vertex!=scene::EHM_NEVER)
+		extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+
 //! Create occlusion query.
 /** Use node for identification and mesh for occlusion test. */
 void COpenGLDriver::addOcclusionQuery(scene::ISceneNode* node,
@@ -824,6 +854,14 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 	if (!checkPrimitiveCount(primitiveCount))
 		return;
 
+	// compact positions are only valid in the box of their mesh buffer,
+	// drawMeshBuffer() decodes them
+	if (vType == EVT_COMPACT)
+	{
+		os::Printer::log("Compact vertices can only be drawn with drawMeshBuffer.", ELL_WARNING);
+		return;
+	}
+
 	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
 	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
@@ -859,6 +897,8 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 				case EVT_TANGENTS:
 					glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Color);
 					break;
+				case EVT_COMPACT:
+					break;
 			}
 		}
 		else
@@ -954,6 +994,8 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(48));
 			}
 			break;
+		case EVT_COMPACT:
+			break;
 	}
 
 	renderArray(indexList, primitiveCount, pType, iType);
@@ -1014,6 +1056,8 @@ void COpenGLDriver::getColorBuffer(const void* vertices, u32 vertexCount, E_VERT
 			}
 		}
 		break;
+		case EVT_COMPACT:
+		break;
 	}
 }
 
@@ -1140,6 +1184,14 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 	if (!checkPrimitiveCount(primitiveCount))
 		return;
 
+	// compact positions are only valid in the box of their mesh buffer,
+	// drawMeshBuffer() decodes them
+	if (vType == EVT_COMPACT)
+	{
+		os::Printer::log("Compact vertices can only be drawn with drawMeshBuffer.", ELL_WARNING);
+		return;
+	}
+
 	CNullDriver::draw2DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
 	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
@@ -1186,6 +1238,8 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 				case EVT_TANGENTS:
 					glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Color);
 					break;
+				case EVT_COMPACT:
+					break;
 			}
 		}
 		else
@@ -1257,6 +1311,8 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(0));
 			}
 
+			break;
+		case EVT_COMPACT:
 			break;
 	}
 
@@ -88,6 +88,9 @@ namespace video
 		//! Draw hardware buffer
 		virtual void drawHardwareBuffer(SHWBufferLink *HWBuffer) _IRR_OVERRIDE_;
 
+		//! Draw the vertices of a hardware buffer with indices from client memory
+		virtual void drawHardwareBufferIndices(SHWBufferLink *HWBuffer, const void* indices, u32 primitiveCount) _IRR_OVERRIDE_;
+
 		//! Create occlusion query.
 		/** Use node for identification and mesh for occlusion test. */
 		virtual void addOcclusionQuery(scene::ISceneNode* node,
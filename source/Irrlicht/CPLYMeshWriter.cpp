@@ -116,6 +116,9 @@ bool CPLYMeshWriter::writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 fla
 		case video::EVT_TANGENTS:
 			vertexSize = sizeof(video::S3DVertexTangents);
 			break;
+		case video::EVT_COMPACT:
+			vertexSize = sizeof(video::S3DVertexCompact);
+			break;
 		}
 		u8 *vertices  = (u8*)mb->getVertices() ;
 
@@ -123,6 +126,12 @@ bool CPLYMeshWriter::writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 fla
 		{
         	u8 *buf = vertices + j * vertexSize;
 			const video::S3DVertex* vertex = ( (video::S3DVertex*)buf );
+			video::S3DVertex decoded;
+			if (mb->getVertexType() == video::EVT_COMPACT)
+			{
+				decoded = ((video::S3DVertexCompact*)buf)->getVertex(mb->getBoundingBox());
+				vertex = &decoded;
+			}
 			const core::vector3df& pos    = vertex->Pos;
 			const core::vector3df& n      = vertex->Normal;
 			const core::vector2df& uv     = vertex->TCoords;
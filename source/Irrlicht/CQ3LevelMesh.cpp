@@ -13,6 +13,7 @@
 #include "ILightSceneNode.h"
 #include "IQ3Shader.h"
 #include "IFileList.h"
+#include "irrMap.h"
 
 //#define TJUNCTION_SOLVER_ROUND
 //#define TJUNCTION_SOLVER_0125
@@ -43,6 +44,10 @@ CQ3LevelMesh::CQ3LevelMesh(io::IFileSystem* fs, scene::ISceneManager* smgr,
 		Mesh[i] = 0;
 	}
 
+	VisData.numOfClusters = 0;
+	VisData.bytesPerCluster = 0;
+	VisData.pBitsets = 0;
+
 	Driver = smgr ? smgr->getVideoDriver() : 0;
 	if (Driver)
 		Driver->grab();
@@ -162,6 +167,7 @@ bool CQ3LevelMesh::loadFile(io::IReadFile* file)
 
 	cleanMeshes();
 	calcBoundingBoxes();
+	constructVisibility();
 	cleanLoader();
 
 	return true;
@@ -314,7 +320,24 @@ void CQ3LevelMesh::loadFaces(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadPlanes(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumPlanes = l->length / sizeof(tBSPPlane);
+	if (!NumPlanes)
+		return;
+	Planes = new tBSPPlane[NumPlanes];
+
+	file->seek(l->offset);
+	file->read(Planes, l->length);
+
+	if ( LoadParam.swapHeader )
+	{
+		for ( s32 i=0;i<NumPlanes;i++)
+		{
+			Planes[i].vNormal[0] = os::Byteswap::byteswap(Planes[i].vNormal[0]);
+			Planes[i].vNormal[1] = os::Byteswap::byteswap(Planes[i].vNormal[1]);
+			Planes[i].vNormal[2] = os::Byteswap::byteswap(Planes[i].vNormal[2]);
+			Planes[i].d = os::Byteswap::byteswap(Planes[i].d);
+		}
+	}
 }
 
 
@@ -322,7 +345,28 @@ void CQ3LevelMesh::loadPlanes(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadNodes(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumNodes = l->length / sizeof(tBSPNode);
+	if (!NumNodes)
+		return;
+	Nodes = new tBSPNode[NumNodes];
+
+	file->seek(l->offset);
+	file->read(Nodes, l->length);
+
+	if ( LoadParam.swapHeader )
+	{
+		for ( s32 i=0;i<NumNodes;i++)
+		{
+			Nodes[i].plane = os::Byteswap::byteswap(Nodes[i].plane);
+			Nodes[i].front = os::Byteswap::byteswap(Nodes[i].front);
+			Nodes[i].back = os::Byteswap::byteswap(Nodes[i].back);
+			for ( s32 k=0; k<3; ++k )
+			{
+				Nodes[i].mins[k] = os::Byteswap::byteswap(Nodes[i].mins[k]);
+				Nodes[i].maxs[k] = os::Byteswap::byteswap(Nodes[i].maxs[k]);
+			}
+		}
+	}
 }
 
 
@@ -330,7 +374,31 @@ void CQ3LevelMesh::loadNodes(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadLeafs(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumLeafs = l->length / sizeof(tBSPLeaf);
+	if (!NumLeafs)
+		return;
+	Leafs = new tBSPLeaf[NumLeafs];
+
+	file->seek(l->offset);
+	file->read(Leafs, l->length);
+
+	if ( LoadParam.swapHeader )
+	{
+		for ( s32 i=0;i<NumLeafs;i++)
+		{
+			Leafs[i].cluster = os::Byteswap::byteswap(Leafs[i].cluster);
+			Leafs[i].area = os::Byteswap::byteswap(Leafs[i].area);
+			for ( s32 k=0; k<3; ++k )
+			{
+				Leafs[i].mins[k] = os::Byteswap::byteswap(Leafs[i].mins[k]);
+				Leafs[i].maxs[k] = os::Byteswap::byteswap(Leafs[i].maxs[k]);
+			}
+			Leafs[i].leafface = os::Byteswap::byteswap(Leafs[i].leafface);
+			Leafs[i].numOfLeafFaces = os::Byteswap::byteswap(Leafs[i].numOfLeafFaces);
+			Leafs[i].leafBrush = os::Byteswap::byteswap(Leafs[i].leafBrush);
+			Leafs[i].numOfLeafBrushes = os::Byteswap::byteswap(Leafs[i].numOfLeafBrushes);
+		}
+	}
 }
 
 
@@ -338,7 +406,19 @@ void CQ3LevelMesh::loadLeafs(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadLeafFaces(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumLeafFaces = l->length / sizeof(s32);
+	if (!NumLeafFaces)
+		return;
+	LeafFaces = new s32[NumLeafFaces];
+
+	file->seek(l->offset);
+	file->read(LeafFaces, l->length);
+
+	if ( LoadParam.swapHeader )
+	{
+		for ( s32 i=0;i<NumLeafFaces;i++)
+			LeafFaces[i] = os::Byteswap::byteswap(LeafFaces[i]);
+	}
 }
 
 
@@ -346,7 +426,36 @@ void CQ3LevelMesh::loadLeafFaces(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadVisData(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	ClusterVisibility.clear();
+	VisData.numOfClusters = 0;
+	VisData.bytesPerCluster = 0;
+	VisData.pBitsets = 0;
+
+	if ( l->length < (s32) (2 * sizeof(s32)) )
+		return;
+
+	file->seek(l->offset);
+	file->read(&VisData.numOfClusters, sizeof(s32));
+	file->read(&VisData.bytesPerCluster, sizeof(s32));
+
+	if ( LoadParam.swapHeader )
+	{
+		VisData.numOfClusters = os::Byteswap::byteswap(VisData.numOfClusters);
+		VisData.bytesPerCluster = os::Byteswap::byteswap(VisData.bytesPerCluster);
+	}
+
+	const s32 size = VisData.numOfClusters * VisData.bytesPerCluster;
+	if ( VisData.numOfClusters <= 0 || VisData.bytesPerCluster <= 0 ||
+		size > l->length - (s32) (2 * sizeof(s32)) )
+	{
+		VisData.numOfClusters = 0;
+		VisData.bytesPerCluster = 0;
+		return;
+	}
+
+	ClusterVisibility.set_used(size);
+	file->read(ClusterVisibility.pointer(), size);
+	VisData.pBitsets = (c8*) ClusterVisibility.pointer();
 }
 
 
@@ -965,6 +1074,8 @@ scene::SMesh** CQ3LevelMesh::buildMesh(s32 num)
 			}
 
 
+			const u32 firstIndex = buffer->getIndexCount();
+
 			switch(Faces[i].type)
 			{
 				case 4: // billboards
@@ -1018,6 +1129,18 @@ scene::SMesh** CQ3LevelMesh::buildMesh(s32 num)
 					break;
 
 			} // end switch
+
+			// remember the indices of the world faces for the leaves of the bsp tree
+			if ( 0 == num && item[g].index == E_Q3_MESH_GEOMETRY &&
+				buffer->getIndexCount() > firstIndex )
+			{
+				SFaceBuffer f;
+				f.Face = i;
+				f.Buffer = buffer;
+				f.FirstIndex = firstIndex;
+				f.IndexCount = buffer->getIndexCount() - firstIndex;
+				GeometryFaces.push_back(f);
+			}
 		}
 	}
 
@@ -1030,6 +1153,139 @@ void CQ3LevelMesh::solveTJunction()
 {
 }
 
+/*!
+	keeps the bsp tree, the leaves and the cluster visibility of the main
+	level in mesh space. Must be called after the meshes were cleaned.
+*/
+void CQ3LevelMesh::constructVisibility()
+{
+	BSPPlanes.clear();
+	BSPNodes.clear();
+	BSPLeafs.clear();
+	BSPLeafFaces.clear();
+	FaceIndices.clear();
+
+	// buffers may have been removed while cleaning, only the pointers are compared
+	core::map<const IMeshBuffer*, u32> bufferIndex;
+	const SMesh* geometry = Mesh[E_Q3_MESH_GEOMETRY];
+	for ( u32 b = 0; b != geometry->MeshBuffers.size(); ++b )
+		bufferIndex.insert(geometry->MeshBuffers[b], b);
+
+	core::array<s32> faceMap;
+	faceMap.set_used(NumFaces);
+	for ( s32 f = 0; f < NumFaces; ++f )
+		faceMap[f] = -1;
+
+	FaceIndices.reallocate(GeometryFaces.size());
+	for ( u32 f = 0; f != GeometryFaces.size(); ++f )
+	{
+		const SFaceBuffer& face = GeometryFaces[f];
+		core::map<const IMeshBuffer*, u32>::Node* n = bufferIndex.find(face.Buffer);
+		if ( 0 == n )
+			continue;
+
+		quake3::SFaceIndices indices;
+		indices.MeshBuffer = n->getValue();
+		indices.FirstIndex = face.FirstIndex;
+		indices.IndexCount = face.IndexCount;
+		faceMap[face.Face] = FaceIndices.size();
+		FaceIndices.push_back(indices);
+	}
+	GeometryFaces.clear();
+
+	// quake uses z up, swap y and z like the vertices
+	s32 i;
+	BSPPlanes.reallocate(NumPlanes);
+	for ( i = 0; i < NumPlanes; ++i )
+	{
+		BSPPlanes.push_back(core::plane3df(core::vector3df(Planes[i].vNormal[0],
+			Planes[i].vNormal[2], Planes[i].vNormal[1]), -Planes[i].d));
+	}
+
+	BSPNodes.reallocate(NumNodes);
+	for ( i = 0; i < NumNodes; ++i )
+	{
+		SNode node;
+		node.Plane = Nodes[i].plane;
+		node.Front = Nodes[i].front;
+		node.Back = Nodes[i].back;
+		if ( node.Plane < 0 || node.Plane >= NumPlanes )
+		{
+			// broken tree, don't answer queries with it
+			BSPNodes.clear();
+			break;
+		}
+		BSPNodes.push_back(node);
+	}
+
+	BSPLeafs.reallocate(NumLeafs);
+	for ( i = 0; i < NumLeafs; ++i )
+	{
+		const tBSPLeaf& l = Leafs[i];
+
+		quake3::SLeaf leaf;
+		leaf.Cluster = l.cluster < VisData.numOfClusters || 0 == VisData.numOfClusters ? l.cluster : -1;
+		leaf.Box.reset(core::vector3df((f32) l.mins[0], (f32) l.mins[2], (f32) l.mins[1]));
+		leaf.Box.addInternalPoint(core::vector3df((f32) l.maxs[0], (f32) l.maxs[2], (f32) l.maxs[1]));
+		leaf.FirstFace = BSPLeafFaces.size();
+
+		for ( s32 f = 0; f < l.numOfLeafFaces; ++f )
+		{
+			const s32 leafFace = l.leafface + f;
+			if ( leafFace < 0 || leafFace >= NumLeafFaces )
+				break;
+			const s32 face = LeafFaces[leafFace];
+			if ( face >= 0 && face < NumFaces && faceMap[face] >= 0 )
+				BSPLeafFaces.push_back(faceMap[face]);
+		}
+
+		leaf.FaceCount = BSPLeafFaces.size() - leaf.FirstFace;
+		BSPLeafs.push_back(leaf);
+	}
+}
+
+/*!
+*/
+s32 CQ3LevelMesh::getClusterAt(const core::vector3df& pos) const
+{
+	if ( BSPNodes.empty() )
+		return -1;
+
+	s32 index = 0;
+	u32 steps = 0;
+	while ( index >= 0 )
+	{
+		// a valid tree is never deeper than it has nodes
+		if ( index >= (s32) BSPNodes.size() || ++steps > BSPNodes.size() )
+			return -1;
+
+		const SNode& node = BSPNodes[index];
+		index = BSPPlanes[node.Plane].getDistanceTo(pos) >= 0.f ? node.Front : node.Back;
+	}
+
+	const s32 leaf = -(index + 1);
+	if ( leaf >= (s32) BSPLeafs.size() )
+		return -1;
+
+	return BSPLeafs[leaf].Cluster;
+}
+
+/*!
+*/
+bool CQ3LevelMesh::isClusterVisible(s32 from, s32 target) const
+{
+	if ( target < 0 )
+		return false;
+
+	// outside of the level or no visibility data, everything may be seen
+	if ( from < 0 || 0 == VisData.pBitsets || from >= VisData.numOfClusters ||
+		target >= VisData.numOfClusters )
+		return true;
+
+	const u8 bits = ClusterVisibility[from * VisData.bytesPerCluster + (target >> 3)];
+	return ( bits & (1 << (target & 7)) ) != 0;
+}
+
 /*!
 	constructs a mesh from the quake 3 level file.
 */
@@ -89,6 +89,30 @@ namespace scene
 		//! returns the requested brush entity
 		virtual IMesh* getBrushEntityMesh(quake3::IEntity &ent) const _IRR_OVERRIDE_;
 
+		//! Returns the visibility cluster at a position.
+		virtual s32 getClusterAt(const core::vector3df& pos) const _IRR_OVERRIDE_;
+
+		//! Checks if a cluster is potentially visible from another one.
+		virtual bool isClusterVisible(s32 from, s32 target) const _IRR_OVERRIDE_;
+
+		//! Get the leaves of the bsp tree of the main level geometry
+		virtual const core::array<quake3::SLeaf>& getLeafs() const _IRR_OVERRIDE_
+		{
+			return BSPLeafs;
+		}
+
+		//! Get the faces of the leaves, as indices into getFaceIndices().
+		virtual const core::array<u32>& getLeafFaces() const _IRR_OVERRIDE_
+		{
+			return BSPLeafFaces;
+		}
+
+		//! Get where the faces of the E_Q3_MESH_GEOMETRY mesh are stored in its mesh buffers
+		virtual const core::array<quake3::SFaceIndices>& getFaceIndices() const _IRR_OVERRIDE_
+		{
+			return FaceIndices;
+		}
+
 		//Link to held meshes? ...
 
 
@@ -134,6 +158,7 @@ namespace scene
 
 		void constructMesh();
 		void solveTJunction();
+		void constructVisibility();
 		void loadTextures();
 		scene::SMesh** buildMesh(s32 num);
 
@@ -412,6 +437,32 @@ namespace scene
 
 		scene::SMesh** BrushEntities;
 
+		tBSPVisData VisData;
+
+		//! indices of a face in the main geometry while the mesh is built
+		struct SFaceBuffer
+		{
+			s32 Face;
+			IMeshBuffer* Buffer;
+			u32 FirstIndex;
+			u32 IndexCount;
+		};
+		core::array<SFaceBuffer> GeometryFaces;
+
+		//! bsp tree in mesh space, kept for the visibility queries
+		struct SNode
+		{
+			s32 Plane;
+			s32 Front;
+			s32 Back;
+		};
+		core::array<core::plane3df> BSPPlanes;
+		core::array<SNode> BSPNodes;
+		core::array<quake3::SLeaf> BSPLeafs;
+		core::array<u32> BSPLeafFaces;
+		core::array<quake3::SFaceIndices> FaceIndices;
+		core::array<u8> ClusterVisibility;
+
 		scene::SMesh* Mesh[quake3::E_Q3_MESH_SIZE];
 		video::IVideoDriver* Driver;
 		core::stringc LevelName;
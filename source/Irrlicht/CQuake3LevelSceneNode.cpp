@@ -0,0 +1,217 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_BSP_LOADER_
+
+#include "CQuake3LevelSceneNode.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "SViewFrustum.h"
+#include "SMesh.h"
+#include "IShadowVolumeSceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CQuake3LevelSceneNode::CQuake3LevelSceneNode(IQ3LevelMesh* level, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: CMeshSceneNode(0, parent, mgr, id, position, rotation, scale),
+	Level(level), VisibleMesh(new SMesh()), Stamp(0), LastCluster(-1),
+	LastFrustumCulling(false), Valid(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CQuake3LevelSceneNode");
+	#endif
+
+	Level->grab();
+
+	// the index lists are rebuilt, so the buffers can't be shared with the level
+	const IMesh* geometry = Level->getMesh(quake3::E_Q3_MESH_GEOMETRY);
+	const u32 count = geometry ? geometry->getMeshBufferCount() : 0;
+	Targets.set_used(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		IMeshBuffer* mb = geometry->getMeshBuffer(i);
+		Targets[i] = 0;
+
+		if (mb->getVertexType() != video::EVT_2TCOORDS || mb->getIndexType() != video::EIT_16BIT ||
+			mb->getPrimitiveType() != EPT_TRIANGLES || Level->getLeafs().empty())
+		{
+			VisibleMesh->addMeshBuffer(mb);
+			continue;
+		}
+
+		SMeshBufferLightMap* target = new SMeshBufferLightMap();
+		target->Material = mb->getMaterial();
+		const video::S3DVertex2TCoords* vertices = (const video::S3DVertex2TCoords*)mb->getVertices();
+		target->Vertices.reallocate(mb->getVertexCount());
+		for (u32 v=0; v<mb->getVertexCount(); ++v)
+			target->Vertices.push_back(vertices[v]);
+		target->Indices.set_used(mb->getIndexCount());
+		memcpy(target->Indices.pointer(), mb->getIndices(), mb->getIndexCount() * sizeof(u16));
+		target->BoundingBox = mb->getBoundingBox();
+		target->setHardwareMappingHint(EHM_STATIC, EBT_VERTEX);
+		target->setHardwareMappingHint(EHM_DYNAMIC, EBT_INDEX);
+
+		VisibleMesh->addMeshBuffer(target);
+		target->drop();
+		Targets[i] = target;
+	}
+	VisibleMesh->recalculateBoundingBox();
+
+	FaceStamps.set_used(Level->getFaceIndices().size());
+	for (u32 i=0; i<FaceStamps.size(); ++i)
+		FaceStamps[i] = 0;
+
+	setMesh(VisibleMesh);
+}
+
+
+//! destructor
+CQuake3LevelSceneNode::~CQuake3LevelSceneNode()
+{
+	VisibleMesh->drop();
+	Level->drop();
+}
+
+
+//! renders the node.
+void CQuake3LevelSceneNode::render()
+{
+	// PassCount is incremented by CMeshSceneNode::render
+	if (PassCount == 0 && Mesh == VisibleMesh)
+		updateVisibleFaces();
+
+	CMeshSceneNode::render();
+}
+
+
+//! collects the indices of the visible faces
+void CQuake3LevelSceneNode::updateVisibleFaces()
+{
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera || Level->getLeafs().empty())
+		return;
+
+	core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+	core::vector3df cameraPos = camera->getAbsolutePosition();
+	invTrans.transformVect(cameraPos);
+	const s32 cluster = Level->getClusterAt(cameraPos);
+
+	const bool frustumCulling = AutomaticCullingState != EAC_OFF;
+
+	// the set of faces only changes with the cluster, or with the frustum when it is used
+	if (Valid && cluster == LastCluster && frustumCulling == LastFrustumCulling &&
+		(!frustumCulling || (camera->getViewMatrix() == LastView &&
+		camera->getProjectionMatrix() == LastProjection &&
+		AbsoluteTransformation == LastTransformation)))
+		return;
+
+	Valid = true;
+	LastCluster = cluster;
+	LastFrustumCulling = frustumCulling;
+	LastView = camera->getViewMatrix();
+	LastProjection = camera->getProjectionMatrix();
+	LastTransformation = AbsoluteTransformation;
+
+	// cull in node space
+	SViewFrustum frust = *camera->getViewFrustum();
+	frust.transform(invTrans);
+
+	const IMesh* geometry = Level->getMesh(quake3::E_Q3_MESH_GEOMETRY);
+	const core::array<quake3::SLeaf>& leafs = Level->getLeafs();
+	const core::array<u32>& leafFaces = Level->getLeafFaces();
+	const core::array<quake3::SFaceIndices>& faces = Level->getFaceIndices();
+
+	u32 i;
+	for (i=0; i<Targets.size(); ++i)
+	{
+		if (Targets[i])
+			Targets[i]->Indices.set_used(0);
+	}
+
+	// a face can be in several leaves
+	if (++Stamp == 0)
+	{
+		for (i=0; i<FaceStamps.size(); ++i)
+			FaceStamps[i] = 0;
+		Stamp = 1;
+	}
+
+	for (i=0; i<leafs.size(); ++i)
+	{
+		const quake3::SLeaf& leaf = leafs[i];
+		if (0 == leaf.FaceCount || !Level->isClusterVisible(cluster, leaf.Cluster))
+			continue;
+
+		if (frustumCulling)
+		{
+			bool outside = false;
+			for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT && !outside; ++p)
+				outside = leaf.Box.classifyPlaneRelation(frust.planes[p]) == core::ISREL3D_FRONT;
+			if (outside)
+				continue;
+		}
+
+		for (u32 f=leaf.FirstFace; f<leaf.FirstFace+leaf.FaceCount; ++f)
+		{
+			const u32 face = leafFaces[f];
+			if (FaceStamps[face] == Stamp)
+				continue;
+			FaceStamps[face] = Stamp;
+
+			const quake3::SFaceIndices& indices = faces[face];
+			SMeshBufferLightMap* target = indices.MeshBuffer < Targets.size() ? Targets[indices.MeshBuffer] : 0;
+			if (!target)
+				continue;
+
+			const u16* src = geometry->getMeshBuffer(indices.MeshBuffer)->getIndices() + indices.FirstIndex;
+			for (u32 n=0; n<indices.IndexCount; ++n)
+				target->Indices.push_back(src[n]);
+		}
+	}
+
+	for (i=0; i<Targets.size(); ++i)
+	{
+		if (Targets[i])
+			Targets[i]->setDirty(EBT_INDEX);
+	}
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CQuake3LevelSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CQuake3LevelSceneNode* nb = new CQuake3LevelSceneNode(Level, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->Shadow = Shadow;
+	if ( nb->Shadow )
+		nb->Shadow->grab();
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BSP_LOADER_
+
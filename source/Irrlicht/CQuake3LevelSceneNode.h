@@ -0,0 +1,68 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_QUAKE3_LEVEL_SCENE_NODE_H_INCLUDED__
+#define __C_QUAKE3_LEVEL_SCENE_NODE_H_INCLUDED__
+
+#include "CMeshSceneNode.h"
+#include "IQ3LevelMesh.h"
+#include "SMeshBufferLightMap.h"
+
+namespace irr
+{
+namespace scene
+{
+	struct SMesh;
+
+	//! Draws the main geometry of a quake3 level, culled with the bsp tree.
+	/** Only the faces of the leaves whose cluster is potentially visible from
+	the cluster of the camera, and whose box is inside the view frustum, are
+	drawn. The vertices are static, the index lists are rebuilt when the
+	camera moves to another cluster or changes its view. */
+	class CQuake3LevelSceneNode : public CMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CQuake3LevelSceneNode(IQ3LevelMesh* level, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CQuake3LevelSceneNode();
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+	private:
+
+		//! collects the indices of the visible faces
+		void updateVisibleFaces();
+
+		IQ3LevelMesh* Level;
+		SMesh* VisibleMesh;
+
+		//! buffer of VisibleMesh for each buffer of the level, 0 if it is always drawn completely
+		core::array<SMeshBufferLightMap*> Targets;
+
+		//! last update in which a face was added
+		core::array<u32> FaceStamps;
+		u32 Stamp;
+
+		s32 LastCluster;
+		core::matrix4 LastView;
+		core::matrix4 LastProjection;
+		core::matrix4 LastTransformation;
+		bool LastFrustumCulling;
+		bool Valid;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
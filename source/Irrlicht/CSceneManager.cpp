@@ -19,6 +19,7 @@
 #include "IProfiler.h"
 
 #include "os.h"
+#include "radixsort.h"
 
 // We need this include for the case of skinned mesh support without
 // any such loader
@@ -30,6 +31,10 @@
 #include "CIrrMeshFileLoader.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+#include "CIrrBinaryMeshFileLoader.h"
+#endif
+
 #ifdef _IRR_COMPILE_WITH_BSP_LOADER_
 #include "CBSPMeshFileLoader.h"
 #endif
@@ -138,6 +143,10 @@
 #include "CB3DMeshWriter.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+#include "CIrrBinaryMeshWriter.h"
+#endif
+
 #ifdef _IRR_COMPILE_WITH_CUBE_SCENENODE_
 #include "CCubeSceneNode.h"
 #endif // _IRR_COMPILE_WITH_CUBE_SCENENODE_
@@ -154,6 +163,13 @@
 #include "CBillboardSceneNode.h"
 #endif // _IRR_COMPILE_WITH_BILLBOARD_SCENENODE_
 #include "CMeshSceneNode.h"
+#ifdef _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+#include "CInstancedMeshSceneNode.h"
+#endif // _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+
+#ifdef _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+#include "CLODMeshSceneNode.h"
+#endif // _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
 #include "CSkyBoxSceneNode.h"
 #ifdef _IRR_COMPILE_WITH_SKYDOME_SCENENODE_
 #include "CSkyDomeSceneNode.h"
@@ -179,6 +195,7 @@
 #include "CEmptySceneNode.h"
 #include "CTextSceneNode.h"
 #include "CQuake3ShaderSceneNode.h"
+#include "CQuake3LevelSceneNode.h"
 #include "CVolumeLightSceneNode.h"
 
 #include "CDefaultSceneNodeFactory.h"
@@ -204,6 +221,12 @@
 #include "CDefaultSceneNodeAnimatorFactory.h"
 
 #include "CGeometryCreator.h"
+#include "CThreadPool.h"
+#include "CSceneNodeBVH.h"
+#include "CSceneNodeLookupIndex.h"
+#include "CStaticBatchBuilder.h"
+#include "CClusteredLightManager.h"
+#include "CMeshLoadQueue.h"
 
 #include <locale.h>
 
@@ -212,13 +235,57 @@ namespace irr
 namespace scene
 {
 
+//! nodes per chunk of the deferred culling
+const u32 RENDER_LIST_CHUNK_SIZE = 64;
+
+//! culls chunks of the pending nodes
+struct CSceneManager::SRenderListJob : public IThreadPoolJob
+{
+	SRenderListJob(CSceneManager* manager) : Manager(manager) {}
+
+	virtual void runJob(u32 index, u32 worker) _IRR_OVERRIDE_
+	{
+		Manager->cullRenderListChunk(index);
+	}
+
+	CSceneManager* Manager;
+};
+
+#ifdef _IRR_COMPILE_WITH_SHADOW_VOLUME_SCENENODE_
+//! builds one volume of ShadowVolumeBuilds
+struct CSceneManager::SShadowVolumeJob : public IThreadPoolJob
+{
+	SShadowVolumeJob(CSceneManager* manager) : Manager(manager) {}
+
+	virtual void runJob(u32 index, u32 worker) _IRR_OVERRIDE_
+	{
+		const SShadowVolumeBuild& build = Manager->ShadowVolumeBuilds[index];
+		build.Node->buildShadowVolume(build.Volume);
+	}
+
+	CSceneManager* Manager;
+};
+#endif
+
+//! clears the pre culling of a node and its children, see SCENE_NODE_BVH_CULLING
+static void resetPreCulling(ISceneNode* node)
+{
+	node->setPreCulling(ESNPC_NONE);
+
+	const ISceneNodeList& children = node->getChildren();
+	for (ISceneNodeList::ConstIterator it = children.begin(); it != children.end(); ++it)
+		resetPreCulling(*it);
+}
+
 //! constructor
 CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl, IMeshCache* cache,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
-	CursorControl(cursorControl), CollisionManager(0),
-	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
+	CursorControl(cursorControl), CollisionManager(0), SortTextureCount(0),
+	RenderListPool(0), RenderListThreads(0), DeferCulling(false), NodeBVH(0),
+	ShadowVolumePool(0), ShadowVolumeThreads(0),
+	LookupIndex(0), MeshLoadQueue(0), ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
 	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), LightManager(0),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
 {
@@ -253,6 +320,12 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	Parameters->setAttribute(DEBUG_NORMAL_LENGTH, 1.f);
 	Parameters->setAttribute(DEBUG_NORMAL_COLOR, video::SColor(255, 34, 221, 221));
 
+	// group solid nodes by state, draw transparent ones back to front
+	SolidSortKeyLayout.addField(ERSKF_MATERIAL_TYPE, 8);
+	SolidSortKeyLayout.addField(ERSKF_TEXTURE, 16);
+	TransparentSortKeyLayout.addField(ERSKF_DEPTH_INVERSE, 32);
+	TransparentEffectSortKeyLayout = TransparentSortKeyLayout;
+
 	// create collision manager
 	CollisionManager = new CSceneCollisionManager(this, Driver);
 
@@ -307,6 +380,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	#ifdef _IRR_COMPILE_WITH_IRR_MESH_LOADER_
 	MeshLoaderList.push_back(new CIrrMeshFileLoader(this, FileSystem));
 	#endif
+	#ifdef _IRR_COMPILE_WITH_IRR_BINARY_MESH_LOADER_
+	MeshLoaderList.push_back(new CIrrBinaryMeshFileLoader(this, FileSystem));
+	#endif
 	#ifdef _IRR_COMPILE_WITH_BSP_LOADER_
 	MeshLoaderList.push_back(new CBSPMeshFileLoader(this, FileSystem));
 	#endif
@@ -367,6 +443,10 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 //! destructor
 CSceneManager::~CSceneManager()
 {
+	// finishes the loading meshes while the loaders and the cache are still there
+	if (MeshLoadQueue)
+		MeshLoadQueue->drop();
+
 	clearDeletionList();
 
 	//! force to remove hardwareTextures from the driver
@@ -416,12 +496,24 @@ CSceneManager::~CSceneManager()
 	if (LightManager)
 		LightManager->drop();
 
+	if (RenderListPool)
+		RenderListPool->drop();
+
+	if (ShadowVolumePool)
+		ShadowVolumePool->drop();
+
+	if (NodeBVH)
+		NodeBVH->drop();
+
 	// remove all nodes and animators before dropping the driver
 	// as render targets may be destroyed twice
 
 	removeAll();
 	removeAnimators();
 
+	if (LookupIndex)
+		LookupIndex->drop();
+
 	if (Driver)
 		Driver->drop();
 }
@@ -466,8 +558,108 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 	return msh;
 }
 
+//! loads a mesh in the background
+IMeshLoadRequest* CSceneManager::getMeshAsync(const io::path& filename, const io::path& alternativeCacheName)
+{
+	io::path cacheName = alternativeCacheName.empty() ? filename : alternativeCacheName;
+	IAnimatedMesh* msh = MeshCache->getMeshByName(cacheName);
+	if (msh)
+	{
+		CMeshLoadRequest* request = new CMeshLoadRequest(cacheName, 0);
+		request->setDone(msh);
+		return request;
+	}
+
+	if (MeshLoadQueue)
+	{
+		IMeshLoadRequest* request = MeshLoadQueue->getRequest(cacheName);
+		if (request)
+			return request;
+	}
+
+	// loaders which create scene nodes, use the mesh cache or open more files load at once
+	if (!isLoadableInBackground(filename))
+	{
+		CMeshLoadRequest* request = new CMeshLoadRequest(cacheName, 0);
+		request->setDone(getMesh(filename, alternativeCacheName));
+		return request;
+	}
+
+	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+	if (!file)
+	{
+		os::Printer::log("Could not load mesh, because file could not be opened: ", filename, ELL_ERROR);
+		CMeshLoadRequest* request = new CMeshLoadRequest(cacheName, 0);
+		request->setDone(0);
+		return request;
+	}
+
+	// files of uncompressed archives read from the archive file, which this thread uses as well
+	if (file->getType() == io::ERFT_LIMIT_READ_FILE)
+	{
+		const long size = file->getSize();
+		c8* data = new c8[size];
+		const size_t read = file->read(data, size);
+		io::IReadFile* memoryFile = FileSystem->createMemoryReadFile(data, (s32)read, file->getFileName(), true);
+		file->drop();
+		file = memoryFile;
+	}
+
+	if (!MeshLoadQueue)
+		MeshLoadQueue = new CMeshLoadQueue(this, Driver, MeshCache);
+
+	// the file is dropped by the worker
+	return MeshLoadQueue->add(cacheName, file);
+}
+
+
+bool CSceneManager::isLoadableInBackground(const io::path& filename) const
+{
+	bool loadable = false;
+	for (u32 i=0; i<MeshLoaderList.size(); ++i)
+	{
+		if (MeshLoaderList[i]->isALoadableFileExtension(filename))
+		{
+			if (!MeshLoaderList[i]->isThreadSafe())
+				return false;
+			loadable = true;
+		}
+	}
+	return loadable;
+}
+
+
+//! adds the meshes loaded in the background to the mesh cache
+u32 CSceneManager::commitLoadedMeshes(bool waitForAll)
+{
+	return MeshLoadQueue ? MeshLoadQueue->commit(waitForAll) : 0;
+}
+
+
 // load and create a mesh which we know already isn't in the cache and put it in there
 IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename)
+{
+	// the loaders are not thread safe, so wait until the background loading is out of them
+	if (MeshLoadQueue)
+		MeshLoadQueue->lockLoaders();
+
+	IAnimatedMesh* msh = loadMesh(file, filename);
+
+	if (MeshLoadQueue)
+		MeshLoadQueue->unlockLoaders();
+
+	if (msh)
+	{
+		MeshCache->addMesh(cachename, msh);
+		msh->drop();
+	}
+
+	return msh;
+}
+
+
+//! creates a mesh with the loaders, without adding it to the mesh cache
+IAnimatedMesh* CSceneManager::loadMesh(io::IReadFile* file, const io::path& filename)
 {
 	IAnimatedMesh* msh = 0;
 
@@ -481,11 +673,7 @@ IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::pat
 			file->seek(0);
 			msh = MeshLoaderList[i]->createMesh(file);
 			if (msh)
-			{
-				MeshCache->addMesh(cachename, msh);
-				msh->drop();
 				break;
-			}
 		}
 	}
 
@@ -587,6 +775,29 @@ IMeshSceneNode* CSceneManager::addQuake3SceneNode(const IMeshBuffer* meshBuffer,
 }
 
 
+//! Adds a scene node which draws the main geometry of a quake3 level with the visibility data of the level.
+IMeshSceneNode* CSceneManager::addQuake3LevelSceneNode(IQ3LevelMesh* mesh,
+	ISceneNode* parent, s32 id, const core::vector3df& position,
+	const core::vector3df& rotation, const core::vector3df& scale)
+{
+#ifdef _IRR_COMPILE_WITH_BSP_LOADER_
+	if (!mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	CQuake3LevelSceneNode* node = new CQuake3LevelSceneNode(mesh, parent,
+		this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+#else
+	return 0;
+#endif
+}
+
+
 //! adds Volume Lighting Scene Node.
 //! the returned pointer must not be dropped.
 IVolumeLightSceneNode* CSceneManager::addVolumeLightSceneNode(
@@ -663,6 +874,74 @@ IMeshSceneNode* CSceneManager::addMeshSceneNode(IMesh* mesh, ISceneNode* parent,
 }
 
 
+//! adds a scene node for rendering many copies of a static mesh
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale)
+{
+#ifdef _IRR_COMPILE_WITH_INSTANCED_MESH_SCENENODE_
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+#else
+	return 0;
+#endif
+}
+
+
+//! adds a scene node drawing simplified versions of a static mesh by screen size
+ILODMeshSceneNode* CSceneManager::addLODMeshSceneNode(IMesh* mesh, u32 levelCount, f32 reduction,
+	ISceneNode* parent, s32 id, const core::vector3df& position,
+	const core::vector3df& rotation, const core::vector3df& scale)
+{
+#ifdef _IRR_COMPILE_WITH_LOD_MESH_SCENENODE_
+	if (!parent)
+		parent = this;
+
+	ILODMeshSceneNode* node = new CLODMeshSceneNode(mesh, levelCount, reduction, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+#else
+	return 0;
+#endif
+}
+
+
+//! Merges static mesh scene nodes into a few large mesh buffers.
+ISceneNode* CSceneManager::addStaticBatchSceneNode(const core::array<IMeshSceneNode*>& nodes,
+	f32 chunkSize, ISceneNode* parent, s32 id)
+{
+	if (!parent)
+		parent = this;
+
+	CStaticBatchBuilder builder(chunkSize, parent);
+
+	core::array<IMeshSceneNode*> merged;
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		if (builder.addNode(nodes[i]))
+			merged.push_back(nodes[i]);
+	}
+
+	if (merged.empty())
+		return 0;
+
+	ISceneNode* batch = addEmptySceneNode(parent, id);
+	for (u32 i=0; i<builder.getChunkCount(); ++i)
+		addMeshSceneNode(builder.getChunkMesh(i), batch);
+
+	for (u32 i=0; i<merged.size(); ++i)
+		merged[i]->setVisible(false);
+
+	return batch;
+}
+
+
 //! Adds a scene node for rendering a animated water surface mesh.
 ISceneNode* CSceneManager::addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 waveLength,
 	ISceneNode* parent, s32 id, const core::vector3df& position,
@@ -1308,12 +1587,84 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 }
 
 
+//! isCulled for a registered node, without the tests the pre culling already did
+bool CSceneManager::isRegisteredNodeCulled(const ISceneNode* node) const
+{
+	switch (node->getPreCulling())
+	{
+	case ESNPC_CULLED:
+	case ESNPC_SUBTREE_CULLED:
+		return true;
+	case ESNPC_VISIBLE:
+		// the same box test as in isCulled
+		if (node->getAutomaticCulling() == EAC_BOX)
+			return false;
+		break;
+	default:
+		break;
+	}
+
+	return isCulled(node);
+}
+
+
+//! sets the pre culling of the nodes before they register, see SCENE_NODE_BVH_CULLING
+void CSceneManager::preCullSceneNodes(bool enabled)
+{
+	const ICameraSceneNode* cam = getActiveCamera();
+	if (enabled && cam)
+	{
+		if (!NodeBVH)
+			NodeBVH = new CSceneNodeBVH();
+
+		NodeBVH->update(this);
+		NodeBVH->cull(*cam->getViewFrustum());
+	}
+	else if (NodeBVH)
+	{
+		NodeBVH->drop();
+		NodeBVH = 0;
+		resetPreCulling(this);
+	}
+}
+
+
+//! pass of a node registered for ESNRP_AUTOMATIC, transparent if any of its materials is
+E_SCENE_NODE_RENDER_PASS CSceneManager::getAutomaticRenderPass(ISceneNode* node) const
+{
+	const u32 count = node->getMaterialCount();
+	for (u32 i=0; i<count; ++i)
+	{
+		if (Driver->needsTransparentRenderPass(node->getMaterial(i)))
+			return ESNRP_TRANSPARENT;
+	}
+
+	return ESNRP_SOLID;
+}
+
+
 //! registers a node for rendering it at a specific time.
 u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
 	IRR_PROFILE(CProfileScope p1(EPID_SM_REGISTER);)
 	u32 taken = 0;
 
+#ifdef _IRR_SCENEMANAGER_DEBUG
+	s32 index = Parameters->findAttribute("calls");
+	Parameters->setAttribute(index, Parameters->getAttributeAsInt(index)+1);
+#endif
+
+	// passes which are culled are collected and sorted in by buildRenderLists
+	if (DeferCulling && pass != ESNRP_CAMERA && pass != ESNRP_LIGHT &&
+		pass != ESNRP_SKY_BOX && pass != ESNRP_NONE)
+	{
+		SPendingNode pending;
+		pending.Node = node;
+		pending.Pass = pass;
+		PendingNodeList.push_back(pending);
+		return 1;
+	}
+
 	switch(pass)
 	{
 		// take camera if it is not already registered
@@ -1338,7 +1689,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	case ESNRP_LIGHT:
 		// TODO: Point Light culling..
 		// Lighting model in irrlicht has to be redone..
-		//if (!isCulled(node))
+		//if (!isRegisteredNodeCulled(node))
 		{
 			LightList.push_back(node);
 			taken = 1;
@@ -1350,54 +1701,38 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		taken = 1;
 		break;
 	case ESNRP_SOLID:
-		if (!isCulled(node))
+		if (!isRegisteredNodeCulled(node))
 		{
 			SolidNodeList.push_back(node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT:
-		if (!isCulled(node))
+		if (!isRegisteredNodeCulled(node))
 		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			TransparentNodeList.push_back(node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT_EFFECT:
-		if (!isCulled(node))
+		if (!isRegisteredNodeCulled(node))
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			TransparentEffectNodeList.push_back(node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_AUTOMATIC:
-		if (!isCulled(node))
+		if (!isRegisteredNodeCulled(node))
 		{
-			const u32 count = node->getMaterialCount();
-
-			taken = 0;
-			for (u32 i=0; i<count; ++i)
-			{
-				if (Driver->needsTransparentRenderPass(node->getMaterial(i)))
-				{
-					// register as transparent node
-					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
-					taken = 1;
-					break;
-				}
-			}
-
-			// not transparent, register as solid
-			if (!taken)
-			{
+			if (getAutomaticRenderPass(node) == ESNRP_TRANSPARENT)
+				TransparentNodeList.push_back(node);
+			else
 				SolidNodeList.push_back(node);
-				taken = 1;
-			}
+			taken = 1;
 		}
 		break;
 	case ESNRP_SHADOW:
-		if (!isCulled(node))
+		if (!isRegisteredNodeCulled(node))
 		{
 			ShadowNodeList.push_back(node);
 			taken = 1;
@@ -1405,7 +1740,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		break;
 
 	case ESNRP_GUI:
-		if (!isCulled(node))
+		if (!isRegisteredNodeCulled(node))
 		{
 			GuiNodeList.push_back(node);
 			taken = 1;
@@ -1416,9 +1751,6 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	}
 
 #ifdef _IRR_SCENEMANAGER_DEBUG
-	s32 index = Parameters->findAttribute("calls");
-	Parameters->setAttribute(index, Parameters->getAttributeAsInt(index)+1);
-
 	if (!taken)
 	{
 		index = Parameters->findAttribute("culled");
@@ -1429,6 +1761,238 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	return taken;
 }
 
+
+//! culls the nodes registered during OnRegisterSceneNode with several threads
+void CSceneManager::buildRenderLists(u32 threadCount)
+{
+	const u32 chunkCount = (PendingNodeList.size() + RENDER_LIST_CHUNK_SIZE - 1) / RENDER_LIST_CHUNK_SIZE;
+	if (!chunkCount)
+		return;
+
+	while (RenderListChunks.size() < chunkCount)
+		RenderListChunks.push_back(SRenderListChunk());
+
+	if (!RenderListPool || RenderListThreads != threadCount)
+	{
+		if (RenderListPool)
+			RenderListPool->drop();
+		RenderListPool = new CThreadPool(threadCount);
+		RenderListThreads = threadCount;
+	}
+
+	SRenderListJob job(this);
+	RenderListPool->parallelFor(&job, chunkCount);
+
+	// append in chunk order. gives the same lists as culling during registration
+	u32 culled = 0;
+	for (u32 c = 0; c < chunkCount; ++c)
+	{
+		const SRenderListChunk& chunk = RenderListChunks[c];
+		u32 i;
+		for (i = 0; i < chunk.SolidNodeList.size(); ++i)
+			SolidNodeList.push_back(chunk.SolidNodeList[i]);
+		for (i = 0; i < chunk.TransparentNodeList.size(); ++i)
+			TransparentNodeList.push_back(chunk.TransparentNodeList[i]);
+		for (i = 0; i < chunk.TransparentEffectNodeList.size(); ++i)
+			TransparentEffectNodeList.push_back(chunk.TransparentEffectNodeList[i]);
+		for (i = 0; i < chunk.ShadowNodeList.size(); ++i)
+			ShadowNodeList.push_back(chunk.ShadowNodeList[i]);
+		for (i = 0; i < chunk.GuiNodeList.size(); ++i)
+			GuiNodeList.push_back(chunk.GuiNodeList[i]);
+		culled += chunk.Culled;
+	}
+
+#ifdef _IRR_SCENEMANAGER_DEBUG
+	s32 index = Parameters->findAttribute("culled");
+	Parameters->setAttribute(index, Parameters->getAttributeAsInt(index)+(s32)culled);
+#else
+	(void)culled;
+#endif
+
+	PendingNodeList.set_used(0);
+}
+
+
+//! builds the changed volumes of the shadow nodes on threadCount threads
+void CSceneManager::buildShadowVolumes(u32 threadCount)
+{
+#ifdef _IRR_COMPILE_WITH_SHADOW_VOLUME_SCENENODE_
+	ShadowVolumeBuilds.set_used(0);
+	for (u32 i = 0; i < ShadowNodeList.size(); ++i)
+	{
+		// nodes of this type are only created by the engine
+		if (ShadowNodeList[i]->getType() != ESNT_SHADOW_VOLUME)
+			continue;
+
+		CShadowVolumeSceneNode* node = static_cast<CShadowVolumeSceneNode*>(ShadowNodeList[i]);
+		for (u32 v = 0; v < node->getShadowVolumeCount(); ++v)
+		{
+			if (node->isShadowVolumeDirty(v))
+			{
+				SShadowVolumeBuild build;
+				build.Node = node;
+				build.Volume = v;
+				ShadowVolumeBuilds.push_back(build);
+			}
+		}
+	}
+
+	// a single volume is built while drawing
+	if (ShadowVolumeBuilds.size() < 2)
+		return;
+
+	if (!ShadowVolumePool || ShadowVolumeThreads != threadCount)
+	{
+		if (ShadowVolumePool)
+			ShadowVolumePool->drop();
+		ShadowVolumePool = new CThreadPool(threadCount);
+		ShadowVolumeThreads = threadCount;
+	}
+
+	SShadowVolumeJob job(this);
+	ShadowVolumePool->parallelFor(&job, ShadowVolumeBuilds.size());
+#endif
+}
+
+
+//! culls one chunk of PendingNodeList into RenderListChunks[chunk]
+void CSceneManager::cullRenderListChunk(u32 chunk)
+{
+	SRenderListChunk& list = RenderListChunks[chunk];
+	list.ShadowNodeList.set_used(0);
+	list.SolidNodeList.set_used(0);
+	list.TransparentNodeList.set_used(0);
+	list.TransparentEffectNodeList.set_used(0);
+	list.GuiNodeList.set_used(0);
+	list.Culled = 0;
+
+	const u32 end = core::min_(PendingNodeList.size(), (chunk + 1) * RENDER_LIST_CHUNK_SIZE);
+	for (u32 i = chunk * RENDER_LIST_CHUNK_SIZE; i < end; ++i)
+	{
+		ISceneNode* node = PendingNodeList[i].Node;
+		if (isRegisteredNodeCulled(node))
+		{
+			list.Culled += 1;
+			continue;
+		}
+
+		switch (PendingNodeList[i].Pass)
+		{
+		case ESNRP_SOLID:
+			list.SolidNodeList.push_back(node);
+			break;
+		case ESNRP_TRANSPARENT:
+			list.TransparentNodeList.push_back(node);
+			break;
+		case ESNRP_TRANSPARENT_EFFECT:
+			list.TransparentEffectNodeList.push_back(node);
+			break;
+		case ESNRP_AUTOMATIC:
+			if (getAutomaticRenderPass(node) == ESNRP_TRANSPARENT)
+				list.TransparentNodeList.push_back(node);
+			else
+				list.SolidNodeList.push_back(node);
+			break;
+		case ESNRP_SHADOW:
+			list.ShadowNodeList.push_back(node);
+			break;
+		case ESNRP_GUI:
+			list.GuiNodeList.push_back(node);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+
+//! builds the keys of the render list and sorts it
+void CSceneManager::sortRenderList(core::array<RenderNodeEntry>& list, const SRenderSortKeyLayout& layout)
+{
+	if (list.size() < 2 || !layout.FieldCount)
+		return;
+
+	if (layout.hasField(ERSKF_TEXTURE))
+	{
+		// keep the table at most half full
+		u32 size = 64;
+		while (size < list.size() * 2)
+			size <<= 1;
+		SortTextures.set_used(size);
+		SortTextureIds.set_used(size);
+		for (u32 i=0; i<size; ++i)
+			SortTextures[i] = 0;
+		SortTextureCount = 0;
+	}
+
+	for (u32 i=0; i<list.size(); ++i)
+	{
+		ISceneNode* node = list[i].Node;
+		const video::SMaterial* material = node->getMaterialCount() ? &node->getMaterial(0) : 0;
+
+		u64 key = 0;
+		for (u32 f=0; f<layout.FieldCount; ++f)
+		{
+			const u32 bits = layout.Bits[f];
+			const u64 mask = bits < 64 ? ((u64)1 << bits) - 1 : ~(u64)0;
+
+			u64 value = 0;
+			switch (layout.Field[f])
+			{
+			case ERSKF_MATERIAL_TYPE:
+				if (material)
+					value = core::min_((u64)(u32)material->MaterialType, mask);
+				break;
+			case ERSKF_TEXTURE:
+				if (material)
+					value = getSortTextureId(material->getTexture(0)) & mask;
+				break;
+			case ERSKF_DEPTH:
+			case ERSKF_DEPTH_INVERSE:
+				{
+					// the bits of a positive float sort like the float, keep the highest ones
+					const f32 distance = (f32)node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camWorldPos);
+					value = core::min_((u64)(IR(distance) >> (bits < 31 ? 31 - bits : 0)), mask);
+					if (layout.Field[f] == ERSKF_DEPTH_INVERSE)
+						value = mask - value;
+				}
+				break;
+			default:
+				break;
+			}
+
+			key = bits < 64 ? (key << bits) | value : value;
+		}
+		list[i].SortKey = key;
+	}
+
+	SortBuffer.set_used(list.size());
+	core::radixsort(list.pointer(), SortBuffer.pointer(), list.size(), &RenderNodeEntry::SortKey);
+}
+
+
+//! number of a texture in the render list which is sorted, 0 for no texture
+u32 CSceneManager::getSortTextureId(const void* texture)
+{
+	if (!texture)
+		return 0;
+
+	const u32 mask = SortTextures.size() - 1;
+	u32 slot = ((u32)((size_t)texture >> 4) * 2654435761u) & mask;
+	while (SortTextures[slot])
+	{
+		if (SortTextures[slot] == texture)
+			return SortTextureIds[slot];
+		slot = (slot + 1) & mask;
+	}
+
+	SortTextureCount += 1;
+	SortTextures[slot] = texture;
+	SortTextureIds[slot] = SortTextureCount;
+	return SortTextureCount;
+}
+
+
 void CSceneManager::clearAllRegisteredNodesForRendering()
 {
 	CameraList.clear();
@@ -1439,6 +2003,7 @@ void CSceneManager::clearAllRegisteredNodesForRendering()
 	TransparentEffectNodeList.clear();
 	ShadowNodeList.clear();
 	GuiNodeList.clear();
+	PendingNodeList.clear();
 }
 
 //! This method is called just before the rendering process of the whole scene.
@@ -1450,6 +2015,8 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
+	commitLoadedMeshes();
+
 #ifdef _IRR_SCENEMANAGER_DEBUG
 	// reset attributes
 	Parameters->setAttribute("culled", 0);
@@ -1489,8 +2056,18 @@ void CSceneManager::drawAll()
 	}
 	IRR_PROFILE(getProfiler().stop(EPID_SM_RENDER_CAMERAS));
 
+	// skip the subtrees outside of the frustum in the registration
+	preCullSceneNodes(Parameters->getAttributeAsBool(SCENE_NODE_BVH_CULLING));
+
 	// let all nodes register themselves
+	const s32 renderListThreads = Parameters->getAttributeAsInt(RENDER_LIST_THREADS);
+	DeferCulling = renderListThreads > 1;
 	OnRegisterSceneNode();
+	if (DeferCulling)
+	{
+		DeferCulling = false;
+		buildRenderLists((u32)renderListThreads);
+	}
 
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
@@ -1594,7 +2171,7 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		SolidNodeList.sort(); // sort by textures
+		sortRenderList(SolidNodeList, SolidSortKeyLayout);
 
 		if (LightManager)
 		{
@@ -1628,6 +2205,10 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SHADOW;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
+		const s32 shadowVolumeThreads = Parameters->getAttributeAsInt(SHADOW_VOLUME_THREADS);
+		if (shadowVolumeThreads > 1)
+			buildShadowVolumes((u32)shadowVolumeThreads);
+
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
@@ -1661,7 +2242,7 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_TRANSPARENT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		TransparentNodeList.sort(); // sort by distance from camera
+		sortRenderList(TransparentNodeList, TransparentSortKeyLayout);
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
@@ -1695,7 +2276,7 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_TRANSPARENT_EFFECT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		TransparentEffectNodeList.sort(); // sort by distance from camera
+		sortRenderList(TransparentEffectNodeList, TransparentEffectSortKeyLayout);
 
 		if (LightManager)
 		{
@@ -1770,6 +2351,13 @@ void CSceneManager::setLightManager(ILightManager* lightManager)
 }
 
 
+//! Creates a light manager which switches on the most relevant lights for each scene node.
+IClusteredLightManager* CSceneManager::createClusteredLightManager(u32 maxLightsPerNode)
+{
+	return new CClusteredLightManager(this, maxLightsPerNode);
+}
+
+
 //! Sets the color of stencil buffers shadows drawn by the scene manager.
 void CSceneManager::setShadowColor(video::SColor color)
 {
@@ -1887,7 +2475,14 @@ void CSceneManager::addExternalMeshLoader(IMeshLoader* externalLoader)
 		return;
 
 	externalLoader->grab();
+
+	if (MeshLoadQueue)
+		MeshLoadQueue->lockLoaders();
+
 	MeshLoaderList.push_back(externalLoader);
+
+	if (MeshLoadQueue)
+		MeshLoadQueue->unlockLoaders();
 }
 
 
@@ -2064,6 +2659,9 @@ ISceneNode* CSceneManager::getSceneNodeFromName(const char* name, ISceneNode* st
 
 	ISceneNode* node = 0;
 
+	if (LookupIndex && LookupIndex->getSceneNodeFromName(name, start, node))
+		return node;
+
 	const ISceneNodeList& list = start->getChildren();
 	ISceneNodeList::ConstIterator it = list.begin();
 	for (; it!=list.end(); ++it)
@@ -2088,6 +2686,9 @@ ISceneNode* CSceneManager::getSceneNodeFromId(s32 id, ISceneNode* start)
 
 	ISceneNode* node = 0;
 
+	if (LookupIndex && LookupIndex->getSceneNodeFromId(id, start, node))
+		return node;
+
 	const ISceneNodeList& list = start->getChildren();
 	ISceneNodeList::ConstIterator it = list.begin();
 	for (; it!=list.end(); ++it)
@@ -2112,6 +2713,9 @@ ISceneNode* CSceneManager::getSceneNodeFromType(scene::ESCENE_NODE_TYPE type, IS
 
 	ISceneNode* node = 0;
 
+	if (LookupIndex && LookupIndex->getSceneNodeFromType(type, start, node))
+		return node;
+
 	const ISceneNodeList& list = start->getChildren();
 	ISceneNodeList::ConstIterator it = list.begin();
 	for (; it!=list.end(); ++it)
@@ -2131,6 +2735,10 @@ void CSceneManager::getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<sce
 	if (start == 0)
 		start = getRootSceneNode();
 
+	// the index has no bucket for all nodes
+	if (LookupIndex && ESNT_ANY != type && LookupIndex->getSceneNodesFromType(type, start, outNodes))
+		return;
+
 	if (start->getType() == type || ESNT_ANY == type)
 		outNodes.push_back(start);
 
@@ -2144,6 +2752,58 @@ void CSceneManager::getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<sce
 }
 
 
+//! Enables an index for the lookups of scene nodes by id, name and type.
+void CSceneManager::setSceneNodeLookupIndexEnabled(bool enabled)
+{
+	if (enabled && !LookupIndex)
+	{
+		LookupIndex = new CSceneNodeLookupIndex(this);
+	}
+	else if (!enabled && LookupIndex)
+	{
+		LookupIndex->drop();
+		LookupIndex = 0;
+	}
+}
+
+
+//! Check if the lookups of scene nodes use an index.
+bool CSceneManager::isSceneNodeLookupIndexEnabled() const
+{
+	return LookupIndex != 0;
+}
+
+
+//! keeps the lookup index up to date
+void CSceneManager::onLookupChange(ISceneNode* node, E_SCENE_NODE_LOOKUP_CHANGE change)
+{
+	if (NodeBVH && change != ESNLC_CHANGED)
+	{
+		NodeBVH->invalidate();
+
+		// a detached node must not keep the result of this scene
+		if (change == ESNLC_REMOVED)
+			resetPreCulling(node);
+	}
+
+	if (!LookupIndex)
+		return;
+
+	switch (change)
+	{
+	case ESNLC_ADDED:
+		LookupIndex->addSubtree(node);
+		break;
+	case ESNLC_REMOVED:
+		LookupIndex->removeSubtree(node);
+		break;
+	case ESNLC_CHANGED:
+		LookupIndex->updateNode(node);
+		break;
+	}
+}
+
+
 //! Posts an input event to the environment. Usually you do not have to
 //! use this method, it is used by the internal engine.
 bool CSceneManager::postEventFromUser(const SEvent& event)
@@ -2160,6 +2820,10 @@ bool CSceneManager::postEventFromUser(const SEvent& event)
 //! Removes all children of this scene node
 void CSceneManager::removeAll()
 {
+	// cheaper than removing each subtree
+	if (LookupIndex)
+		LookupIndex->invalidate();
+
 	ISceneNode::removeAll();
 	setActiveCamera(0);
 	// Make sure the driver is reset, might need a more complex method at some point
@@ -2189,6 +2853,44 @@ E_SCENE_NODE_RENDER_PASS CSceneManager::getSceneNodeRenderPass() const
 }
 
 
+//! Set how the nodes of a render pass are sorted before drawing.
+void CSceneManager::setRenderSortKeyLayout(E_SCENE_NODE_RENDER_PASS pass, const SRenderSortKeyLayout& layout)
+{
+	switch (pass)
+	{
+	case ESNRP_SOLID:
+		SolidSortKeyLayout = layout;
+		break;
+	case ESNRP_TRANSPARENT:
+		TransparentSortKeyLayout = layout;
+		break;
+	case ESNRP_TRANSPARENT_EFFECT:
+		TransparentEffectSortKeyLayout = layout;
+		break;
+	default:
+		os::Printer::log("Render pass has no sort key", ELL_WARNING);
+		break;
+	}
+}
+
+
+//! Get the layout of the sort key of a render pass.
+const SRenderSortKeyLayout& CSceneManager::getRenderSortKeyLayout(E_SCENE_NODE_RENDER_PASS pass) const
+{
+	switch (pass)
+	{
+	case ESNRP_SOLID:
+		return SolidSortKeyLayout;
+	case ESNRP_TRANSPARENT:
+		return TransparentSortKeyLayout;
+	case ESNRP_TRANSPARENT_EFFECT:
+		return TransparentEffectSortKeyLayout;
+	default:
+		return UnsortedKeyLayout;
+	}
+}
+
+
 //! Returns an interface to the mesh cache which is shared between all existing scene managers.
 IMeshCache* CSceneManager::getMeshCache()
 {
@@ -2200,6 +2902,9 @@ IMeshCache* CSceneManager::getMeshCache()
 ISceneManager* CSceneManager::createNewSceneManager(bool cloneContent)
 {
 	CSceneManager* manager = new CSceneManager(Driver, FileSystem, CursorControl, MeshCache, GUIEnvironment);
+	manager->SolidSortKeyLayout = SolidSortKeyLayout;
+	manager->TransparentSortKeyLayout = TransparentSortKeyLayout;
+	manager->TransparentEffectSortKeyLayout = TransparentEffectSortKeyLayout;
 
 	if (cloneContent)
 		manager->cloneMembers(this, manager);
@@ -2685,6 +3390,13 @@ IMeshWriter* CSceneManager::createMeshWriter(EMESH_WRITER_TYPE type)
 #else
 		return 0;
 #endif
+
+	case EMWT_IRR_BINARY_MESH:
+#ifdef _IRR_COMPILE_WITH_IRR_BINARY_WRITER_
+		return new CIrrBinaryMeshWriter(Driver, FileSystem);
+#else
+		return 0;
+#endif
 	}
 
 	return 0;
@@ -16,6 +16,8 @@
 
 namespace irr
 {
+	class CThreadPool;
+
 namespace io
 {
 	class IFileSystem;
@@ -24,6 +26,10 @@ namespace scene
 {
 	class IMeshCache;
 	class IGeometryCreator;
+	class CSceneNodeBVH;
+	class CSceneNodeLookupIndex;
+	class CShadowVolumeSceneNode;
+	class CMeshLoadQueue;
 
 	/*!
 		The Scene Manager manages scene nodes, mesh resources, cameras and all the other stuff.
@@ -46,6 +52,16 @@ namespace scene
 		//! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! loads a mesh in the background
+		virtual IMeshLoadRequest* getMeshAsync(const io::path& filename, const io::path& alternativeCacheName) _IRR_OVERRIDE_;
+
+		//! adds the meshes loaded in the background to the mesh cache
+		virtual u32 commitLoadedMeshes(bool waitForAll=false) _IRR_OVERRIDE_;
+
+		//! creates a mesh with the loaders, without adding it to the mesh cache
+		/** Used by the background loading, on the worker thread. */
+		IAnimatedMesh* loadMesh(io::IReadFile* file, const io::path& filename);
+
 		//! Returns an interface to the mesh cache which is shared between all existing scene managers.
 		virtual IMeshCache* getMeshCache() _IRR_OVERRIDE_;
 
@@ -96,6 +112,25 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
 
+		//! adds a scene node for rendering many copies of a static mesh
+		//! the returned pointer must not be dropped.
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) _IRR_OVERRIDE_;
+
+		//! adds a scene node drawing simplified versions of a static mesh by screen size
+		//! the returned pointer must not be dropped.
+		virtual ILODMeshSceneNode* addLODMeshSceneNode(IMesh* mesh, u32 levelCount=4, f32 reduction=0.5f,
+			ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) _IRR_OVERRIDE_;
+
+		//! Merges static mesh scene nodes into a few large mesh buffers.
+		virtual ISceneNode* addStaticBatchSceneNode(const core::array<IMeshSceneNode*>& nodes,
+			f32 chunkSize=256.f, ISceneNode* parent=0, s32 id=-1) _IRR_OVERRIDE_;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		virtual ISceneNode* addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 wlength, ISceneNode* parent=0, s32 id=-1,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -203,6 +238,13 @@ namespace scene
 		virtual IMeshSceneNode* addQuake3SceneNode(const IMeshBuffer* meshBuffer, const quake3::IShader * shader,
 			ISceneNode* parent=0, s32 id=-1) _IRR_OVERRIDE_;
 
+		//! Adds a scene node which draws the main geometry of a quake3 level with the visibility data of the level.
+		virtual IMeshSceneNode* addQuake3LevelSceneNode(IQ3LevelMesh* mesh,
+			ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) _IRR_OVERRIDE_;
+
 
 		//! Adds a Hill Plane mesh to the mesh pool. The mesh is
 		//! generated on the fly and looks like a plane with some hills
@@ -426,6 +468,12 @@ namespace scene
 		//! returns scene nodes by type.
 		virtual void getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<scene::ISceneNode*>& outNodes, ISceneNode* start=0) _IRR_OVERRIDE_;
 
+		//! Enables an index for the lookups of scene nodes by id, name and type.
+		virtual void setSceneNodeLookupIndexEnabled(bool enabled) _IRR_OVERRIDE_;
+
+		//! Check if the lookups of scene nodes use an index.
+		virtual bool isSceneNodeLookupIndexEnabled() const _IRR_OVERRIDE_;
+
 		//! Posts an input event to the environment. Usually you do not have to
 		//! use this method, it is used by the internal engine.
 		virtual bool postEventFromUser(const SEvent& event) _IRR_OVERRIDE_;
@@ -442,6 +490,12 @@ namespace scene
 		//! Returns current render pass.
 		virtual E_SCENE_NODE_RENDER_PASS getSceneNodeRenderPass() const _IRR_OVERRIDE_;
 
+		//! Set how the nodes of a render pass are sorted before drawing.
+		virtual void setRenderSortKeyLayout(E_SCENE_NODE_RENDER_PASS pass, const SRenderSortKeyLayout& layout) _IRR_OVERRIDE_;
+
+		//! Get the layout of the sort key of a render pass.
+		virtual const SRenderSortKeyLayout& getRenderSortKeyLayout(E_SCENE_NODE_RENDER_PASS pass) const _IRR_OVERRIDE_;
+
 		//! Creates a new scene manager.
 		virtual ISceneManager* createNewSceneManager(bool cloneContent) _IRR_OVERRIDE_;
 
@@ -522,6 +576,9 @@ namespace scene
 		//! Register a custom callbacks manager which gets callbacks during scene rendering.
 		virtual void setLightManager(ILightManager* lightManager) _IRR_OVERRIDE_;
 
+		//! Creates a light manager which switches on the most relevant lights for each scene node.
+		virtual IClusteredLightManager* createClusteredLightManager(u32 maxLightsPerNode=0) _IRR_OVERRIDE_;
+
 		//! Get current render time.
 		virtual E_SCENE_NODE_RENDER_PASS getCurrentRenderPass() const _IRR_OVERRIDE_ { return CurrentRenderPass; }
 
@@ -534,55 +591,79 @@ namespace scene
 		//! returns if node is culled
 		virtual bool isCulled(const ISceneNode* node) const _IRR_OVERRIDE_;
 
+	protected:
+
+		//! keeps the lookup index up to date
+		virtual void onLookupChange(ISceneNode* node, E_SCENE_NODE_LOOKUP_CHANGE change) _IRR_OVERRIDE_;
+
 	private:
 
 		// load and create a mesh which we know already isn't in the cache and put it in there
 		IAnimatedMesh* getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename);
 
+		//! returns true if all loaders for the file may run on the worker of getMeshAsync
+		bool isLoadableInBackground(const io::path& filename) const;
+
 		//! clears the deletion list
 		void clearDeletionList();
 
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
-		struct DefaultNodeEntry
-		{
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
+		//! culls the nodes registered during OnRegisterSceneNode with several threads
+		void buildRenderLists(u32 threadCount);
 
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
+		//! sets the pre culling of the nodes before they register, see SCENE_NODE_BVH_CULLING
+		void preCullSceneNodes(bool enabled);
 
-			ISceneNode* Node;
-			private:
-			void* TextureValue;
+		//! isCulled for a registered node, without the tests the pre culling already did
+		bool isRegisteredNodeCulled(const ISceneNode* node) const;
+
+		//! pass of a node registered for ESNRP_AUTOMATIC, transparent if any of its materials is
+		E_SCENE_NODE_RENDER_PASS getAutomaticRenderPass(ISceneNode* node) const;
+
+		//! culls one chunk of PendingNodeList into RenderListChunks[chunk]
+		void cullRenderListChunk(u32 chunk);
+
+		struct SRenderListJob;
+		friend struct SRenderListJob;
+
+		//! builds the changed volumes of the shadow pass with several threads
+		void buildShadowVolumes(u32 threadCount);
+
+		struct SShadowVolumeJob;
+		friend struct SShadowVolumeJob;
+
+		//! volume of a shadow node to build in parallel
+		struct SShadowVolumeBuild
+		{
+			CShadowVolumeSceneNode* Node;
+			u32 Volume;
 		};
 
-		//! sort on distance (center) to camera
-		struct TransparentNodeEntry
+		//! sort on the key built by sortRenderList
+		struct RenderNodeEntry
 		{
-			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
-				: Node(n)
+			RenderNodeEntry(ISceneNode* n) :
+				Node(n), SortKey(0)
 			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
 			}
 
-			bool operator < (const TransparentNodeEntry& other) const
+			bool operator < (const RenderNodeEntry& other) const
 			{
-				return Distance > other.Distance;
+				return SortKey < other.SortKey;
 			}
 
 			ISceneNode* Node;
-			private:
-				f64 Distance;
+			u64 SortKey;
 		};
 
+		//! builds the keys of the render list and sorts it
+		void sortRenderList(core::array<RenderNodeEntry>& list, const SRenderSortKeyLayout& layout);
+
+		//! number of a texture in the render list which is sorted, 0 for no texture
+		u32 getSortTextureId(const void* texture);
+
 		//! sort on distance (sphere) to camera
 		struct DistanceNodeEntry
 		{
@@ -609,6 +690,26 @@ namespace scene
 			f64 Distance;
 		};
 
+		//! registration of a culled render pass, waiting for buildRenderLists
+		struct SPendingNode
+		{
+			ISceneNode* Node;
+			E_SCENE_NODE_RENDER_PASS Pass;
+		};
+
+		//! render lists of a consecutive range of PendingNodeList
+		struct SRenderListChunk
+		{
+			SRenderListChunk() : Culled(0) {}
+
+			core::array<ISceneNode*> ShadowNodeList;
+			core::array<RenderNodeEntry> SolidNodeList;
+			core::array<RenderNodeEntry> TransparentNodeList;
+			core::array<RenderNodeEntry> TransparentEffectNodeList;
+			core::array<ISceneNode*> GuiNodeList;
+			u32 Culled;
+		};
+
 		//! video driver
 		video::IVideoDriver* Driver;
 
@@ -629,11 +730,43 @@ namespace scene
 		core::array<ISceneNode*> LightList;
 		core::array<ISceneNode*> ShadowNodeList;
 		core::array<ISceneNode*> SkyBoxList;
-		core::array<DefaultNodeEntry> SolidNodeList;
-		core::array<TransparentNodeEntry> TransparentNodeList;
-		core::array<TransparentNodeEntry> TransparentEffectNodeList;
+		core::array<RenderNodeEntry> SolidNodeList;
+		core::array<RenderNodeEntry> TransparentNodeList;
+		core::array<RenderNodeEntry> TransparentEffectNodeList;
 		core::array<ISceneNode*> GuiNodeList;
 
+		//! sort keys of the render passes, see setRenderSortKeyLayout
+		SRenderSortKeyLayout SolidSortKeyLayout;
+		SRenderSortKeyLayout TransparentSortKeyLayout;
+		SRenderSortKeyLayout TransparentEffectSortKeyLayout;
+		SRenderSortKeyLayout UnsortedKeyLayout;
+		core::array<RenderNodeEntry> SortBuffer;
+		//! open addressing table of getSortTextureId
+		core::array<const void*> SortTextures;
+		core::array<u32> SortTextureIds;
+		u32 SortTextureCount;
+
+		//! deferred culling, see RENDER_LIST_THREADS
+		core::array<SPendingNode> PendingNodeList;
+		core::array<SRenderListChunk> RenderListChunks;
+		CThreadPool* RenderListPool;
+		u32 RenderListThreads;
+		bool DeferCulling;
+
+		//! see SCENE_NODE_BVH_CULLING
+		CSceneNodeBVH* NodeBVH;
+
+		//! see SHADOW_VOLUME_THREADS
+		core::array<SShadowVolumeBuild> ShadowVolumeBuilds;
+		CThreadPool* ShadowVolumePool;
+		u32 ShadowVolumeThreads;
+
+		//! see setSceneNodeLookupIndexEnabled
+		CSceneNodeLookupIndex* LookupIndex;
+
+		//! see getMeshAsync
+		CMeshLoadQueue* MeshLoadQueue;
+
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
 		core::array<ISceneNode*> DeletionList;
@@ -0,0 +1,357 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeBVH.h"
+#include "SViewFrustum.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! items per leaf
+	const u32 BVH_LEAF_SIZE = 4;
+
+	//! deeper nodes split in the middle of their range instead of spatially
+	const u32 BVH_MAX_SPATIAL_DEPTH = 32;
+
+	//! a refit which makes the tree this much larger than after the build rebuilds it
+	const f32 BVH_REBUILD_GROWTH = 2.f;
+
+	//! no parent item or tree node
+	const u32 BVH_NONE = 0xffffffff;
+
+	inline f32 surfaceArea(const core::aabbox3df& box)
+	{
+		const core::vector3df e = box.getExtent();
+		return 2.f * (e.X * e.Y + e.Y * e.Z + e.Z * e.X);
+	}
+
+	inline f32 component(const core::vector3df& v, u32 axis)
+	{
+		return axis == 0 ? v.X : axis == 1 ? v.Y : v.Z;
+	}
+
+	//! exact compare, aabbox3d::operator== has a tolerance
+	inline bool equalsExact(const core::aabbox3df& a, const core::aabbox3df& b)
+	{
+		return a.MinEdge.X == b.MinEdge.X && a.MinEdge.Y == b.MinEdge.Y && a.MinEdge.Z == b.MinEdge.Z &&
+			a.MaxEdge.X == b.MaxEdge.X && a.MaxEdge.Y == b.MaxEdge.Y && a.MaxEdge.Z == b.MaxEdge.Z;
+	}
+
+	inline core::aabbox3df transformedBox(const ISceneNode* node, const core::aabbox3df& localBox)
+	{
+		core::aabbox3df box(localBox);
+		node->getAbsoluteTransformation().transformBoxEx(box);
+		return box;
+	}
+}
+
+
+//! constructor
+CSceneNodeBVH::CSceneNodeBVH()
+	: BuildArea(0.f), Area(0.f), BuildCount(0), Dirty(true)
+{
+	#ifdef _DEBUG
+	setDebugName("CSceneNodeBVH");
+	#endif
+}
+
+
+//! Refit or rebuild the tree for the current bounds of the children of root.
+void CSceneNodeBVH::update(ISceneNode* root)
+{
+	if (Dirty)
+	{
+		Items.set_used(0);
+		collect(root, BVH_NONE);
+		build();
+		Dirty = false;
+		return;
+	}
+
+	// static nodes cost a compare of their version and box
+	for (u32 i = 0; i < Items.size(); ++i)
+	{
+		SItem& item = Items[i];
+		const ISceneNode* node = item.Node;
+		const core::aabbox3df& localBox = node->getBoundingBox();
+		if (node->getAbsoluteTransformationVersion() != item.Version || !equalsExact(localBox, item.LocalBox))
+		{
+			item.Version = node->getAbsoluteTransformationVersion();
+			item.LocalBox = localBox;
+			item.Box = transformedBox(node, localBox);
+			markRefit(item.Leaf);
+		}
+	}
+
+	if (!Refit.empty())
+	{
+		refit();
+		if (Area > BuildArea * BVH_REBUILD_GROWTH)
+			build();
+	}
+}
+
+
+//! Sets the pre culling of all nodes in the tree, see ISceneNode::getPreCulling.
+void CSceneNodeBVH::cull(const SViewFrustum& frustum)
+{
+	Result.set_used(Items.size());
+	if (!Nodes.empty())
+		cullNode(0, frustum, (1 << SViewFrustum::VF_PLANE_COUNT) - 1);
+
+	KeepSubtree.set_used(Items.size());
+	u32 i;
+	for (i = 0; i < KeepSubtree.size(); ++i)
+		KeepSubtree[i] = 0;
+
+	// children are stored behind their parent, so all children are done before it
+	for (i = Items.size(); i > 0; --i)
+	{
+		SItem& item = Items[i - 1];
+		E_SCENE_NODE_PRE_CULLING state = (E_SCENE_NODE_PRE_CULLING)Result[i - 1];
+		if (item.Node->getAutomaticCulling() == EAC_OFF || item.UpdatesInRegistration)
+			state = ESNPC_NONE;
+		else if (state == ESNPC_CULLED && !KeepSubtree[i - 1])
+			state = ESNPC_SUBTREE_CULLED;
+
+		if (state != ESNPC_SUBTREE_CULLED && item.Parent != BVH_NONE)
+			KeepSubtree[item.Parent] = 1;
+
+		// most nodes keep their state from frame to frame
+		if (state != item.State)
+		{
+			item.State = state;
+			item.Node->setPreCulling(state);
+		}
+	}
+}
+
+
+//! adds the children of node and their subtrees in depth first order
+void CSceneNodeBVH::collect(ISceneNode* node, u32 parent)
+{
+	const ISceneNodeList& children = node->getChildren();
+	for (ISceneNodeList::ConstIterator it = children.begin(); it != children.end(); ++it)
+	{
+		ISceneNode* child = *it;
+
+		SItem item;
+		item.Node = child;
+		item.LocalBox = child->getBoundingBox();
+		item.Version = child->getAbsoluteTransformationVersion();
+		item.Box = transformedBox(child, item.LocalBox);
+		item.Parent = parent;
+		item.Leaf = BVH_NONE;
+		item.State = child->getPreCulling();
+		// particles are emitted and moved during the registration
+		item.UpdatesInRegistration = child->getType() == ESNT_PARTICLE_SYSTEM;
+		Items.push_back(item);
+
+		collect(child, Items.size() - 1);
+	}
+}
+
+
+void CSceneNodeBVH::build()
+{
+	Order.set_used(Items.size());
+	for (u32 i = 0; i < Order.size(); ++i)
+		Order[i] = i;
+
+	Nodes.set_used(0);
+	BuildArea = 0.f;
+	BuildCount += 1;
+
+	if (!Items.empty())
+	{
+		SNode root;
+		root.Child = 0;
+		root.Parent = BVH_NONE;
+		Nodes.push_back(root);
+		buildNode(0, 0, Items.size(), 0);
+	}
+
+	Area = BuildArea;
+	Refit.set_used(0);
+	RefitMark.set_used(Nodes.size());
+	for (u32 n = 0; n < RefitMark.size(); ++n)
+		RefitMark[n] = 0;
+}
+
+
+void CSceneNodeBVH::buildNode(u32 node, u32 start, u32 count, u32 depth)
+{
+	core::aabbox3df box(Items[Order[start]].Box);
+	core::aabbox3df centers(Items[Order[start]].Box.getCenter());
+	for (u32 i = start + 1; i < start + count; ++i)
+	{
+		box.addInternalBox(Items[Order[i]].Box);
+		centers.addInternalPoint(Items[Order[i]].Box.getCenter());
+	}
+
+	Nodes[node].Box = box;
+	Nodes[node].Start = start;
+	Nodes[node].Count = count;
+	Nodes[node].Child = 0;
+	BuildArea += surfaceArea(box);
+
+	if (count <= BVH_LEAF_SIZE)
+	{
+		for (u32 i = start; i < start + count; ++i)
+			Items[Order[i]].Leaf = node;
+		return;
+	}
+
+	// split at the middle of the longest axis of the centers
+	u32 split = 0;
+	if (depth < BVH_MAX_SPATIAL_DEPTH)
+	{
+		const core::vector3df extent = centers.getExtent();
+		const u32 axis = extent.X >= extent.Y && extent.X >= extent.Z ? 0 : extent.Y >= extent.Z ? 1 : 2;
+		const f32 mid = component(centers.getCenter(), axis);
+
+		split = start;
+		for (u32 i = start; i < start + count; ++i)
+		{
+			if (component(Items[Order[i]].Box.getCenter(), axis) < mid)
+			{
+				core::swap(Order[i], Order[split]);
+				split += 1;
+			}
+		}
+		split -= start;
+	}
+
+	// all centers on one side
+	if (split == 0 || split == count)
+		split = count / 2;
+
+	const u32 child = Nodes.size();
+	Nodes[node].Child = child;
+
+	SNode empty;
+	empty.Child = 0;
+	empty.Parent = node;
+	Nodes.push_back(empty);
+	Nodes.push_back(empty);
+
+	buildNode(child, start, split, depth + 1);
+	buildNode(child + 1, start + split, count - split, depth + 1);
+}
+
+
+//! queues the node and its parents for the next refit
+void CSceneNodeBVH::markRefit(u32 node)
+{
+	while (node != BVH_NONE && !RefitMark[node])
+	{
+		RefitMark[node] = 1;
+		Refit.push_back(node);
+		node = Nodes[node].Parent;
+	}
+}
+
+
+//! updates the boxes of the queued nodes bottom up
+void CSceneNodeBVH::refit()
+{
+	// children are always stored behind their parent
+	Refit.set_sorted(false);
+	Refit.sort();
+	for (u32 i = Refit.size(); i > 0; --i)
+	{
+		const u32 n = Refit[i - 1];
+		Area -= surfaceArea(Nodes[n].Box);
+		updateBox(n);
+		Area += surfaceArea(Nodes[n].Box);
+		RefitMark[n] = 0;
+	}
+	Refit.set_used(0);
+}
+
+
+void CSceneNodeBVH::updateBox(u32 n)
+{
+	SNode& node = Nodes[n];
+	if (node.Child)
+	{
+		node.Box = Nodes[node.Child].Box;
+		node.Box.addInternalBox(Nodes[node.Child + 1].Box);
+	}
+	else
+	{
+		node.Box = Items[Order[node.Start]].Box;
+		for (u32 i = node.Start + 1; i < node.Start + node.Count; ++i)
+			node.Box.addInternalBox(Items[Order[i]].Box);
+	}
+}
+
+
+void CSceneNodeBVH::cullNode(u32 n, const SViewFrustum& frustum, u32 planeMask)
+{
+	const SNode& node = Nodes[n];
+
+	for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+	{
+		if (!(planeMask & (1 << p)))
+			continue;
+
+		const core::EIntersectionRelation3D rel = node.Box.classifyPlaneRelation(frustum.planes[p]);
+		if (rel == core::ISREL3D_FRONT)
+		{
+			markNode(node, ESNPC_CULLED);
+			return;
+		}
+
+		// completely inside of this plane, the children are as well
+		if (rel == core::ISREL3D_BACK)
+			planeMask &= ~(1 << p);
+	}
+
+	// completely inside of the frustum
+	if (!planeMask)
+	{
+		markNode(node, ESNPC_VISIBLE);
+		return;
+	}
+
+	if (node.Child)
+	{
+		cullNode(node.Child, frustum, planeMask);
+		cullNode(node.Child + 1, frustum, planeMask);
+		return;
+	}
+
+	// a leaf box is the union of its items, test them one by one
+	for (u32 i = node.Start; i < node.Start + node.Count; ++i)
+	{
+		const u32 item = Order[i];
+		const core::aabbox3df& box = Items[item].Box;
+
+		Result[item] = box.intersectsWithBox(frustum.getBoundingBox()) ? ESNPC_VISIBLE : ESNPC_NONE;
+		for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			if ((planeMask & (1 << p)) &&
+				box.classifyPlaneRelation(frustum.planes[p]) == core::ISREL3D_FRONT)
+			{
+				Result[item] = ESNPC_CULLED;
+				break;
+			}
+		}
+	}
+}
+
+
+void CSceneNodeBVH::markNode(const SNode& node, E_SCENE_NODE_PRE_CULLING result)
+{
+	for (u32 i = node.Start; i < node.Start + node.Count; ++i)
+		Result[Order[i]] = (u8)result;
+}
+
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,112 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_BVH_H_INCLUDED__
+#define __C_SCENE_NODE_BVH_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+	struct SViewFrustum;
+
+	//! Bounding volume hierarchy over the world space boxes of the nodes of a scene graph.
+	/** Used by the scene manager to find the nodes which are completely
+	outside of the view frustum before they register. The tree is kept
+	across frames. Only the leaves of nodes which moved or changed their
+	bounding box are refitted. It is rebuilt when nodes were added or
+	removed or when the refitted boxes became too loose. */
+	class CSceneNodeBVH : public virtual IReferenceCounted
+	{
+	public:
+
+		//! constructor
+		CSceneNodeBVH();
+
+		//! Collect the nodes again on the next update.
+		/** Has to be called when nodes are added to or removed from the
+		graph. The nodes are not accessed until then. */
+		void invalidate()
+		{
+			Dirty = true;
+		}
+
+		//! Refit or rebuild the tree for the current bounds of the children of root.
+		void update(ISceneNode* root);
+
+		//! Sets the pre culling of all nodes in the tree, see ISceneNode::getPreCulling.
+		void cull(const SViewFrustum& frustum);
+
+		//! Number of rebuilds since creation, refits are not counted.
+		u32 getBuildCount() const
+		{
+			return BuildCount;
+		}
+
+	private:
+
+		struct SItem
+		{
+			ISceneNode* Node;
+			//! bounding box and transformation version of the last refit
+			core::aabbox3df LocalBox;
+			u32 Version;
+			//! world space bounding box
+			core::aabbox3df Box;
+			//! item of the parent node, NONE for children of the root
+			u32 Parent;
+			//! tree node which contains the item
+			u32 Leaf;
+			//! pre culling last set on the node
+			E_SCENE_NODE_PRE_CULLING State;
+			//! the node updates its box during the registration, it is never culled before
+			bool UpdatesInRegistration;
+		};
+
+		struct SNode
+		{
+			core::aabbox3df Box;
+			//! range in Order
+			u32 Start;
+			u32 Count;
+			//! first of two children, 0 for leaves
+			u32 Child;
+			u32 Parent;
+		};
+
+		void collect(ISceneNode* node, u32 parent);
+		void build();
+		void buildNode(u32 node, u32 start, u32 count, u32 depth);
+		void markRefit(u32 node);
+		void refit();
+		void updateBox(u32 node);
+		void cullNode(u32 node, const SViewFrustum& frustum, u32 planeMask);
+		void markNode(const SNode& node, E_SCENE_NODE_PRE_CULLING result);
+
+		core::array<SItem> Items;
+		core::array<u32> Order;
+		core::array<SNode> Nodes;
+
+		//! frustum test of each item by the last cull
+		core::array<u8> Result;
+		//! items which have a child that is not completely culled
+		core::array<u8> KeepSubtree;
+
+		//! tree nodes to refit, and a mark for each node if it is in there
+		core::array<u32> Refit;
+		core::array<u8> RefitMark;
+
+		//! summed surface area of the nodes after the last build and now
+		f32 BuildArea;
+		f32 Area;
+		u32 BuildCount;
+		bool Dirty;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // __C_SCENE_NODE_BVH_H_INCLUDED__
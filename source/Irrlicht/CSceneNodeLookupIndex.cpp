@@ -0,0 +1,503 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeLookupIndex.h"
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	inline u32 hashKey(u32 kind, u32 key)
+	{
+		return (key * 2654435761u) ^ (kind * 0x9E3779B9u);
+	}
+
+	inline u32 hashPointer(const void* p)
+	{
+		return (u32)((size_t)p >> 4) * 2654435761u;
+	}
+}
+
+
+//! constructor
+CSceneNodeLookupIndex::CSceneNodeLookupIndex(ISceneNode* root)
+	: Root(root), RemovedCount(0), BuildCount(0), Dirty(true)
+{
+}
+
+
+//! Queues a node and its children which were attached to the graph.
+void CSceneNodeLookupIndex::addSubtree(ISceneNode* node)
+{
+	// the rebuild numbers all nodes
+	if (Dirty)
+		return;
+
+	Added.push_back(node);
+}
+
+
+//! Removes a node and its children, called before it is detached from the graph.
+void CSceneNodeLookupIndex::removeSubtree(ISceneNode* node)
+{
+	if (Dirty)
+		return;
+
+	// queued nodes may be deleted with the subtree
+	for (u32 a=Added.size(); a>0; --a)
+	{
+		if (isInSubtree(Added[a-1], node))
+			Added.erase(a-1);
+	}
+
+	const s32 n = findEntry(node);
+	if (n < 0)
+		return;
+
+	// the subtree is numbered consecutively
+	for (u32 i=(u32)n; i<=Entries[n].End; ++i)
+	{
+		SEntry& e = Entries[i];
+		if (e.Removed)
+			continue;
+
+		removeItem(EKK_ID, (u32)e.ID, i);
+		removeItem(EKK_NAME, e.NameHash, i);
+		removeItem(EKK_TYPE, e.Type, i);
+		e.Removed = true;
+		++RemovedCount;
+	}
+}
+
+
+//! Updates the name and id of a node.
+void CSceneNodeLookupIndex::updateNode(ISceneNode* node)
+{
+	if (Dirty)
+		return;
+
+	const s32 n = findEntry(node);
+	if (n < 0)
+		return;
+
+	SEntry& e = Entries[n];
+
+	const s32 id = node->getID();
+	if (id != e.ID)
+	{
+		removeItem(EKK_ID, (u32)e.ID, n);
+		insertItem(EKK_ID, (u32)id, n);
+		e.ID = id;
+	}
+
+	const u32 nameHash = hashName(node->getName());
+	if (nameHash != e.NameHash)
+	{
+		removeItem(EKK_NAME, e.NameHash, n);
+		insertItem(EKK_NAME, nameHash, n);
+		e.NameHash = nameHash;
+	}
+}
+
+
+//! First node below start with the id.
+bool CSceneNodeLookupIndex::getSceneNodeFromId(s32 id, ISceneNode* start, ISceneNode*& result)
+{
+	u32 first, last;
+	if (!getRange(start, first, last))
+		return false;
+
+	result = 0;
+	const SBucket* bucket = findBucket(EKK_ID, (u32)id);
+	if (bucket)
+	{
+		const u32 i = lowerBound(bucket->Items, first + 1);
+		if (i < bucket->Items.size() && bucket->Items[i] <= last)
+			result = Entries[bucket->Items[i]].Node;
+	}
+	return true;
+}
+
+
+//! First node below start with the name, see getSceneNodeFromId.
+bool CSceneNodeLookupIndex::getSceneNodeFromName(const c8* name, ISceneNode* start, ISceneNode*& result)
+{
+	u32 first, last;
+	if (!getRange(start, first, last))
+		return false;
+
+	result = 0;
+	const SBucket* bucket = findBucket(EKK_NAME, hashName(name));
+	if (bucket)
+	{
+		// different names may share the hash
+		for (u32 i = lowerBound(bucket->Items, first + 1); i < bucket->Items.size() && bucket->Items[i] <= last; ++i)
+		{
+			ISceneNode* node = Entries[bucket->Items[i]].Node;
+			if (!strcmp(node->getName(), name))
+			{
+				result = node;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+
+//! First node below start with the type, see getSceneNodeFromId.
+bool CSceneNodeLookupIndex::getSceneNodeFromType(ESCENE_NODE_TYPE type, ISceneNode* start, ISceneNode*& result)
+{
+	u32 first, last;
+	if (!getRange(start, first, last))
+		return false;
+
+	result = 0;
+	const SBucket* bucket = findBucket(EKK_TYPE, (u32)type);
+	if (bucket)
+	{
+		const u32 i = lowerBound(bucket->Items, first + 1);
+		if (i < bucket->Items.size() && bucket->Items[i] <= last)
+			result = Entries[bucket->Items[i]].Node;
+	}
+	return true;
+}
+
+
+//! Appends start and all nodes below with the type in search order.
+bool CSceneNodeLookupIndex::getSceneNodesFromType(ESCENE_NODE_TYPE type, ISceneNode* start, core::array<ISceneNode*>& outNodes)
+{
+	u32 first, last;
+	if (!getRange(start, first, last))
+		return false;
+
+	const SBucket* bucket = findBucket(EKK_TYPE, (u32)type);
+	if (bucket)
+	{
+		for (u32 i = lowerBound(bucket->Items, first); i < bucket->Items.size() && bucket->Items[i] <= last; ++i)
+			outNodes.push_back(Entries[bucket->Items[i]].Node);
+	}
+	return true;
+}
+
+
+void CSceneNodeLookupIndex::rebuild()
+{
+	Buckets.clear();
+	BucketTable.set_used(0);
+
+	Entries.set_used(countNodes(Root));
+	u32 n = 0;
+	addNode(Root, n);
+	resizeNodeTable();
+
+	Added.set_used(0);
+	RemovedCount = 0;
+	++BuildCount;
+	Dirty = false;
+}
+
+
+//! numbers the queued nodes, their constructors are done by now
+void CSceneNodeLookupIndex::insertAdded()
+{
+	// many entries of removed nodes are cheaper to drop with a rebuild
+	if (RemovedCount > Entries.size() / 2)
+	{
+		invalidate();
+		return;
+	}
+
+	for (u32 a=0; a<Added.size() && !Dirty; ++a)
+		insertSubtree(Added[a]);
+	Added.set_used(0);
+}
+
+
+//! numbers a subtree behind the last child of its parent, later nodes move up
+void CSceneNodeLookupIndex::insertSubtree(ISceneNode* node)
+{
+	// numbered with a subtree queued before
+	if (findEntry(node) >= 0)
+		return;
+
+	const s32 parent = findEntry(node->getParent());
+	if (parent < 0)
+	{
+		invalidate();
+		return;
+	}
+
+	// addChild appends, so the subtree follows the one of the parent
+	const u32 first = Entries[parent].End + 1;
+	const u32 count = countNodes(node);
+	const u32 oldSize = Entries.size();
+	u32 i;
+
+	// the parent and its ancestors grow, the nodes behind move
+	for (i=0; i<oldSize; ++i)
+	{
+		if (i >= first || (i <= (u32)parent && Entries[i].End + 1 >= first))
+			Entries[i].End += count;
+	}
+
+	Entries.set_used(oldSize + count);
+	for (i=oldSize; i>first; --i)
+		Entries[i - 1 + count] = Entries[i - 1];
+
+	for (i=0; i<Buckets.size(); ++i)
+	{
+		core::array<u32>& items = Buckets[i].Items;
+		for (u32 j=lowerBound(items, first); j<items.size(); ++j)
+			items[j] += count;
+	}
+
+	u32 n = first;
+	addNode(node, n);
+
+	if (Entries.size() * 2 > NodeTable.size())
+	{
+		resizeNodeTable();
+		return;
+	}
+
+	for (i=0; i<NodeTable.size(); ++i)
+	{
+		if (NodeTable[i] > first)
+			NodeTable[i] += count;
+	}
+	for (i=first; i<first+count; ++i)
+		insertSlot(i);
+}
+
+
+//! numbers the node and its children depth first, starting with n
+/** The entries have to exist already. */
+void CSceneNodeLookupIndex::addNode(ISceneNode* node, u32& n)
+{
+	const u32 number = n++;
+
+	SEntry e;
+	e.Node = node;
+	e.End = number;
+	e.ID = node->getID();
+	e.NameHash = hashName(node->getName());
+	e.Type = (u32)node->getType();
+	e.Removed = false;
+	Entries[number] = e;
+
+	insertItem(EKK_ID, (u32)e.ID, number);
+	insertItem(EKK_NAME, e.NameHash, number);
+	insertItem(EKK_TYPE, e.Type, number);
+
+	const ISceneNodeList& children = node->getChildren();
+	for (ISceneNodeList::ConstIterator it = children.begin(); it != children.end(); ++it)
+		addNode(*it, n);
+
+	Entries[number].End = n - 1;
+}
+
+
+//! sizes the node table for the entries and fills it, removed nodes are left out
+void CSceneNodeLookupIndex::resizeNodeTable()
+{
+	u32 size = 16;
+	while (size < Entries.size() * 2)
+		size <<= 1;
+	NodeTable.set_used(size);
+	memset(NodeTable.pointer(), 0, size * sizeof(u32));
+
+	for (u32 i=0; i<Entries.size(); ++i)
+	{
+		if (!Entries[i].Removed)
+			insertSlot(i);
+	}
+}
+
+
+void CSceneNodeLookupIndex::insertSlot(u32 n)
+{
+	const u32 mask = NodeTable.size() - 1;
+	u32 slot = hashPointer(Entries[n].Node) & mask;
+	while (NodeTable[slot])
+		slot = (slot + 1) & mask;
+	NodeTable[slot] = n + 1;
+}
+
+
+//! number of the node, -1 if not indexed
+s32 CSceneNodeLookupIndex::findEntry(const ISceneNode* node) const
+{
+	if (NodeTable.empty())
+		return -1;
+
+	const u32 mask = NodeTable.size() - 1;
+	u32 slot = hashPointer(node) & mask;
+	while (NodeTable[slot])
+	{
+		// a moved node has a removed entry as well
+		const SEntry& e = Entries[NodeTable[slot] - 1];
+		if (e.Node == node && !e.Removed)
+			return (s32)NodeTable[slot] - 1;
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+
+//! bucket of the key, 0 if there is none
+CSceneNodeLookupIndex::SBucket* CSceneNodeLookupIndex::findBucket(u32 kind, u32 key)
+{
+	if (BucketTable.empty())
+		return 0;
+
+	const u32 mask = BucketTable.size() - 1;
+	u32 slot = hashKey(kind, key) & mask;
+	while (BucketTable[slot])
+	{
+		SBucket& b = Buckets[BucketTable[slot] - 1];
+		if (b.Key == key && b.Kind == kind)
+			return &b;
+		slot = (slot + 1) & mask;
+	}
+	return 0;
+}
+
+
+//! bucket of the key, created if needed
+CSceneNodeLookupIndex::SBucket* CSceneNodeLookupIndex::getBucket(u32 kind, u32 key)
+{
+	SBucket* b = findBucket(kind, key);
+	if (b)
+		return b;
+
+	// keep the table at most half full
+	if ((Buckets.size() + 1) * 2 > BucketTable.size())
+	{
+		const u32 size = core::max_(BucketTable.size() * 2, 64u);
+		BucketTable.set_used(size);
+		memset(BucketTable.pointer(), 0, size * sizeof(u32));
+
+		const u32 mask = size - 1;
+		for (u32 i=0; i<Buckets.size(); ++i)
+		{
+			u32 slot = hashKey(Buckets[i].Kind, Buckets[i].Key) & mask;
+			while (BucketTable[slot])
+				slot = (slot + 1) & mask;
+			BucketTable[slot] = i + 1;
+		}
+	}
+
+	const u32 mask = BucketTable.size() - 1;
+	u32 slot = hashKey(kind, key) & mask;
+	while (BucketTable[slot])
+		slot = (slot + 1) & mask;
+
+	SBucket bucket;
+	bucket.Kind = kind;
+	bucket.Key = key;
+	Buckets.push_back(bucket);
+	BucketTable[slot] = Buckets.size();
+	return &Buckets.getLast();
+}
+
+
+void CSceneNodeLookupIndex::insertItem(u32 kind, u32 key, u32 item)
+{
+	core::array<u32>& items = getBucket(kind, key)->Items;
+	items.insert(item, lowerBound(items, item));
+}
+
+
+void CSceneNodeLookupIndex::removeItem(u32 kind, u32 key, u32 item)
+{
+	SBucket* b = findBucket(kind, key);
+	if (!b)
+		return;
+
+	const u32 i = lowerBound(b->Items, item);
+	if (i < b->Items.size() && b->Items[i] == item)
+		b->Items.erase(i);
+}
+
+
+//! range of the subtree below start
+bool CSceneNodeLookupIndex::getRange(const ISceneNode* start, u32& first, u32& last)
+{
+	if (!Dirty && !Added.empty())
+		insertAdded();
+	if (Dirty)
+		rebuild();
+
+	if (start == Root)
+	{
+		first = 0;
+		last = Entries.size() - 1;
+		return true;
+	}
+
+	const s32 n = findEntry(start);
+	if (n < 0)
+		return false;
+
+	first = (u32)n;
+	last = Entries[n].End;
+	return true;
+}
+
+
+//! index of the first item not below first
+u32 CSceneNodeLookupIndex::lowerBound(const core::array<u32>& items, u32 first)
+{
+	u32 lo = 0;
+	u32 hi = items.size();
+	while (lo < hi)
+	{
+		const u32 mid = (lo + hi) / 2;
+		if (items[mid] < first)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+
+u32 CSceneNodeLookupIndex::countNodes(const ISceneNode* node)
+{
+	u32 count = 1;
+	const ISceneNodeList& children = node->getChildren();
+	for (ISceneNodeList::ConstIterator it = children.begin(); it != children.end(); ++it)
+		count += countNodes(*it);
+	return count;
+}
+
+
+bool CSceneNodeLookupIndex::isInSubtree(const ISceneNode* node, const ISceneNode* root)
+{
+	for (; node; node = node->getParent())
+	{
+		if (node == root)
+			return true;
+	}
+	return false;
+}
+
+
+//! FNV-1a
+u32 CSceneNodeLookupIndex::hashName(const c8* name)
+{
+	u32 h = 2166136261u;
+	for (; *name; ++name)
+		h = (h ^ (u8)*name) * 16777619u;
+	return h;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
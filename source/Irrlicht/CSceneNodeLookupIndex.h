@@ -0,0 +1,148 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_LOOKUP_INDEX_H_INCLUDED__
+#define __C_SCENE_NODE_LOOKUP_INDEX_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+#include "ESceneNodeTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneNode;
+
+	//! Hash index over the ids, names and types of the nodes of a scene graph.
+	/** The nodes are numbered in the depth first order of the recursive
+	searches of the scene manager, so the first match of a search below any
+	start node is the match with the lowest number in the range of the
+	subtree of the start node. Added nodes are queued, because they are
+	announced by the constructor of ISceneNode before their type is known,
+	and numbered in place on the next query. Removed nodes and changed names
+	or ids are updated in place. */
+	class CSceneNodeLookupIndex : public virtual IReferenceCounted
+	{
+	public:
+
+		//! constructor
+		/** \param root Root of the indexed graph, not grabbed. */
+		CSceneNodeLookupIndex(ISceneNode* root);
+
+		//! Rebuild on the next query.
+		void invalidate()
+		{
+			Dirty = true;
+			Added.set_used(0);
+		}
+
+		//! Queues a node and its children which were attached to the graph.
+		void addSubtree(ISceneNode* node);
+
+		//! Removes a node and its children, called before it is detached from the graph.
+		void removeSubtree(ISceneNode* node);
+
+		//! Updates the name and id of a node.
+		void updateNode(ISceneNode* node);
+
+		//! First node below start with the id.
+		/** Start itself is not tested.
+		\return False if start is not part of the graph, the caller has
+		to search without the index then. */
+		bool getSceneNodeFromId(s32 id, ISceneNode* start, ISceneNode*& result);
+
+		//! First node below start with the name, see getSceneNodeFromId.
+		bool getSceneNodeFromName(const c8* name, ISceneNode* start, ISceneNode*& result);
+
+		//! First node below start with the type, see getSceneNodeFromId.
+		bool getSceneNodeFromType(ESCENE_NODE_TYPE type, ISceneNode* start, ISceneNode*& result);
+
+		//! Appends start and all nodes below with the type in search order.
+		/** \return False if start is not part of the graph. */
+		bool getSceneNodesFromType(ESCENE_NODE_TYPE type, ISceneNode* start, core::array<ISceneNode*>& outNodes);
+
+		//! Number of rebuilds since creation.
+		u32 getBuildCount() const
+		{
+			return BuildCount;
+		}
+
+	private:
+
+		enum E_KEY_KIND
+		{
+			EKK_ID = 0,
+			EKK_NAME,
+			EKK_TYPE
+		};
+
+		struct SEntry
+		{
+			ISceneNode* Node;
+			//! last number of the subtree
+			u32 End;
+			//! keys the node is stored with
+			s32 ID;
+			u32 NameHash;
+			u32 Type;
+			bool Removed;
+		};
+
+		struct SBucket
+		{
+			u32 Kind;
+			u32 Key;
+			//! numbers of the nodes, ascending
+			core::array<u32> Items;
+		};
+
+		void rebuild();
+		void insertAdded();
+		void insertSubtree(ISceneNode* node);
+		void addNode(ISceneNode* node, u32& n);
+		void resizeNodeTable();
+		void insertSlot(u32 n);
+
+		//! number of the node, -1 if not indexed
+		s32 findEntry(const ISceneNode* node) const;
+
+		//! bucket of the key, 0 if there is none
+		SBucket* findBucket(u32 kind, u32 key);
+		SBucket* getBucket(u32 kind, u32 key);
+
+		void insertItem(u32 kind, u32 key, u32 item);
+		void removeItem(u32 kind, u32 key, u32 item);
+
+		//! range of the subtree below start
+		bool getRange(const ISceneNode* start, u32& first, u32& last);
+
+		//! index of the first item not below first
+		static u32 lowerBound(const core::array<u32>& items, u32 first);
+
+		static u32 countNodes(const ISceneNode* node);
+		static bool isInSubtree(const ISceneNode* node, const ISceneNode* root);
+		static u32 hashName(const c8* name);
+
+		ISceneNode* Root;
+
+		core::array<SEntry> Entries;
+		//! open addressing tables of the node pointers and the bucket keys, slot value is index + 1
+		core::array<u32> NodeTable;
+		core::array<SBucket> Buckets;
+		core::array<u32> BucketTable;
+
+		//! attached nodes which are not numbered yet
+		core::array<ISceneNode*> Added;
+		//! entries of removed nodes, kept until the next rebuild
+		u32 RemovedCount;
+
+		u32 BuildCount;
+		bool Dirty;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -13,6 +13,7 @@
 #include "ICameraSceneNode.h"
 #include "SViewFrustum.h"
 #include "SLight.h"
+#include "CWeldGrid.h"
 #include "os.h"
 
 namespace irr
@@ -45,67 +46,70 @@ CShadowVolumeSceneNode::~CShadowVolumeSceneNode()
 }
 
 
-void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bool isDirectional)
+//! Swaps the contents of two volumes without copying the triangles.
+void CShadowVolumeSceneNode::swapVolumes(SShadowVolume& a, SShadowVolume& b)
 {
-	SShadowVolume* svp = 0;
-	core::aabbox3d<f32>* bb = 0;
-
-	// builds the shadow volume and adds it to the shadow volume list.
-
-	if (ShadowVolumes.size() > ShadowVolumesUsed)
-	{
-		// get the next unused buffer
+	a.Triangles.swap(b.Triangles);
+	a.FaceData.swap(b.FaceData);
+	core::swap(a.BBox, b.BBox);
+	core::swap(a.Light, b.Light);
+	core::swap(a.Directional, b.Directional);
+	core::swap(a.Dirty, b.Dirty);
+}
 
-		svp = &ShadowVolumes[ShadowVolumesUsed];
-		svp->set_used(0);
 
-		bb = &ShadowBBox[ShadowVolumesUsed];
-	}
-	else
-	{
-		ShadowVolumes.push_back(SShadowVolume());
-		svp = &ShadowVolumes.getLast();
+//! Builds a shadow volume of the last update
+void CShadowVolumeSceneNode::buildShadowVolume(u32 i)
+{
+	SShadowVolume& volume = ShadowVolumes[i];
 
-		ShadowBBox.push_back(core::aabbox3d<f32>());
-		bb = &ShadowBBox.getLast();
-	}
-	svp->reallocate(IndexCount*5);
-	++ShadowVolumesUsed;
+	// builds the shadow volume for the light of the slot
+	volume.Triangles.set_used(0);
+	if (volume.Triangles.allocated_size() < IndexCount*5)
+		volume.Triangles.reallocate(IndexCount*5);
 
-	// We use triangle lists
-	Edges.set_used(IndexCount*2);
-	u32 numEdges = 0;
+	createEdgesAndCaps(volume);
+	volume.Dirty = false;
+}
 
-	numEdges=createEdgesAndCaps(light, isDirectional, svp, bb);
 
-	// for all edges add the near->far quads
-	core::vector3df lightDir1(light*Infinity);
-	core::vector3df lightDir2(light*Infinity);
-	for (u32 i=0; i<numEdges; ++i)
+namespace
+{
+	//! adds the near->far quad of an edge
+	inline void addSide(core::array<core::vector3df>& svp, const core::vector3df& v1, const core::vector3df& v2,
+		const core::vector3df& light, bool isDirectional, f32 infinity)
 	{
-		const core::vector3df &v1 = Vertices[Edges[2*i+0]];
-		const core::vector3df &v2 = Vertices[Edges[2*i+1]];
+		core::vector3df lightDir1(light*infinity);
+		core::vector3df lightDir2(light*infinity);
 		if ( !isDirectional )
 		{
-			lightDir1 = (v1 - light).normalize()*Infinity;
-			lightDir2 = (v2 - light).normalize()*Infinity;
+			lightDir1 = (v1 - light).normalize()*infinity;
+			lightDir2 = (v2 - light).normalize()*infinity;
 		}
 		const core::vector3df v3(v1+lightDir1);
 		const core::vector3df v4(v2+lightDir2);
 
 		// Add a quad (two triangles) to the vertex list
-#ifdef _DEBUG
-		if (svp->size() >= svp->allocated_size()-5)
-			os::Printer::log("Allocation too small.", ELL_DEBUG);
-#endif
-		svp->push_back(v1);
-		svp->push_back(v2);
-		svp->push_back(v3);
+		svp.push_back(v1);
+		svp.push_back(v2);
+		svp.push_back(v3);
 
-		svp->push_back(v2);
-		svp->push_back(v4);
-		svp->push_back(v3);
+		svp.push_back(v2);
+		svp.push_back(v4);
+		svp.push_back(v3);
 	}
+
+	//! edge of a face by the positions of its vertices
+	struct SEdgeRef
+	{
+		u64 Key;
+		u32 Corner;
+
+		bool operator<(const SEdgeRef& other) const
+		{
+			return Key < other.Key || (Key == other.Key && Corner < other.Corner);
+		}
+	};
 }
 
 // TODO.
@@ -116,11 +120,17 @@ void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bo
 // is probably ending up with same value anyway 
 #define IRR_USE_REVERSE_EXTRUDED
 
-u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light, bool isDirectional,
-					SShadowVolume* svp, core::aabbox3d<f32>* bb)
+void CShadowVolumeSceneNode::createEdgesAndCaps(SShadowVolume& volume)
 {
-	u32 numEdges=0;
+	const core::vector3df& light = volume.Light;
+	const bool isDirectional = volume.Directional;
+	core::array<core::vector3df>* svp = &volume.Triangles;
+	core::aabbox3d<f32>* bb = &volume.BBox;
+	core::array<bool>& faceData = volume.FaceData;
+
 	const u32 faceCount = IndexCount / 3;
+	faceData.set_used(faceCount);
+	u32 frontFaces = 0;
 
 	if(faceCount >= 1)
 		bb->reset(Vertices[Indices[0]]);
@@ -142,13 +152,15 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light, boo
 			lightDir0 = (v0-light).normalize();
 		}
 #ifdef IRR_USE_REVERSE_EXTRUDED
-		FaceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(lightDir0);	// actually the back-facing polygons
+		faceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(lightDir0);	// actually the back-facing polygons
 #else
-		FaceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(lightDir0);
+		faceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(lightDir0);
 #endif
+		if (faceData[i])
+			++frontFaces;
 
 #if 0	// Useful for internal debugging & testing. Show all the faces in the light.
-		if ( FaceData[i] )
+		if ( faceData[i] )
 		{
 			video::SMaterial m;
 			m.Lighting = false;
@@ -161,12 +173,8 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light, boo
 		}
 #endif
 
-		if (UseZFailMethod && FaceData[i])
+		if (UseZFailMethod && faceData[i])
 		{
-#ifdef _DEBUG
-			if (svp->size() >= svp->allocated_size()-5)
-				os::Printer::log("Allocation too small.", ELL_DEBUG);
-#endif
 			// add front cap from light-facing faces
 			svp->push_back(v2);
 			svp->push_back(v1);
@@ -192,32 +200,25 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light, boo
 		}
 	}
 
+	// every front face adds at most three quads, so pushing never reallocates
+	if (svp->allocated_size() < svp->size() + frontFaces*18)
+		svp->reallocate(svp->size() + frontFaces*18);
+
 	// Create edges
 	for (u32 i=0; i<faceCount; ++i)
 	{
 		// check all front facing faces
-		if (FaceData[i] == true)
+		if (faceData[i] == true)
 		{
-			const u16 wFace0 = Indices[3*i+0];
-			const u16 wFace1 = Indices[3*i+1];
-			const u16 wFace2 = Indices[3*i+2];
+			const core::vector3df& v0 = Vertices[Indices[3*i+0]];
+			const core::vector3df& v1 = Vertices[Indices[3*i+1]];
+			const core::vector3df& v2 = Vertices[Indices[3*i+2]];
 
 			if ( Optimization == ESV_NONE )
 			{
-				// add edge v0-v1
-				Edges[2*numEdges+0] = wFace0;
-				Edges[2*numEdges+1] = wFace1;
-				++numEdges;
-
-				// add edge v1-v2
-				Edges[2*numEdges+0] = wFace1;
-				Edges[2*numEdges+1] = wFace2;
-				++numEdges;
-
-				// add edge v2-v0
-				Edges[2*numEdges+0] = wFace2;
-				Edges[2*numEdges+1] = wFace0;
-				++numEdges;
+				addSide(*svp, v0, v1, light, isDirectional, Infinity);
+				addSide(*svp, v1, v2, light, isDirectional, Infinity);
+				addSide(*svp, v2, v0, light, isDirectional, Infinity);
 			}
 			else
 			{
@@ -227,33 +228,17 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light, boo
 
 				// add edges if face is adjacent to back-facing face
 				// or if no adjacent face was found
-				if (adj0 == i || FaceData[adj0] == false)
-				{
-					// add edge v0-v1
-					Edges[2*numEdges+0] = wFace0;
-					Edges[2*numEdges+1] = wFace1;
-					++numEdges;
-				}
+				if (adj0 == i || faceData[adj0] == false)
+					addSide(*svp, v0, v1, light, isDirectional, Infinity);
 
-				if (adj1 == i || FaceData[adj1] == false)
-				{
-					// add edge v1-v2
-					Edges[2*numEdges+0] = wFace1;
-					Edges[2*numEdges+1] = wFace2;
-					++numEdges;
-				}
+				if (adj1 == i || faceData[adj1] == false)
+					addSide(*svp, v1, v2, light, isDirectional, Infinity);
 
-				if (adj2 == i || FaceData[adj2] == false)
-				{
-					// add edge v2-v0
-					Edges[2*numEdges+0] = wFace2;
-					Edges[2*numEdges+1] = wFace0;
-					++numEdges;
-				}
+				if (adj2 == i || faceData[adj2] == false)
+					addSide(*svp, v2, v0, light, isDirectional, Infinity);
 			}
 		}
 	}
-	return numEdges;
 }
 
 
@@ -272,10 +257,81 @@ void CShadowVolumeSceneNode::setShadowMesh(const IMesh* mesh)
 }
 
 
+//! Copies the positions and indices of the mesh, returns true if anything changed.
+bool CShadowVolumeSceneNode::copyMesh(const IMesh* mesh, u32 totalVertices, u32 totalIndices, bool& indicesChanged)
+{
+	bool changed = Vertices.size() != totalVertices || Indices.size() != totalIndices;
+	indicesChanged = Indices.size() != totalIndices;
+
+	// allocate memory if necessary
+	Vertices.set_used(totalVertices);
+	Indices.set_used(totalIndices);
+
+	const u32 bufcnt = mesh->getMeshBufferCount();
+	for (u32 i=0; i<bufcnt; ++i)
+	{
+		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
+
+		const u16* idxp = buf->getIndices();
+		const u16* idxpend = idxp + buf->getIndexCount();
+		for (; idxp!=idxpend; ++idxp)
+		{
+			const u16 index = (u16)(*idxp + VertexCount);
+			if (Indices[IndexCount] != index)
+			{
+				Indices[IndexCount] = index;
+				indicesChanged = true;
+			}
+			++IndexCount;
+		}
+
+		const u32 vtxcnt = buf->getVertexCount();
+		for (u32 j=0; j<vtxcnt; ++j)
+		{
+			const core::vector3df& pos = buf->getPosition(j);
+			core::vector3df& copy = Vertices[VertexCount++];
+			if (copy.X != pos.X || copy.Y != pos.Y || copy.Z != pos.Z)
+			{
+				copy = pos;
+				changed = true;
+			}
+		}
+	}
+
+	return changed || indicesChanged;
+}
+
+
+//! Appends a volume for the light, reusing a matching volume of the last update
+void CShadowVolumeSceneNode::addShadowVolume(const core::vector3df& light, bool isDirectional, u32 oldCount)
+{
+	if (ShadowVolumes.size() <= ShadowVolumesUsed)
+		ShadowVolumes.push_back(SShadowVolume());
+
+	SShadowVolume& volume = ShadowVolumes[ShadowVolumesUsed++];
+	volume.Dirty = true;
+
+	for (u32 i=0; i<oldCount; ++i)
+	{
+		SShadowVolume& old = OldVolumes[i];
+		if (!old.Dirty && old.Directional == isDirectional && old.Light == light)
+		{
+			// the old slot gets the unused triangles and is dirty afterwards
+			swapVolumes(volume, old);
+			return;
+		}
+	}
+
+	volume.Light = light;
+	volume.Directional = isDirectional;
+}
+
+
 void CShadowVolumeSceneNode::updateShadowVolumes()
 {
 	const u32 oldIndexCount = IndexCount;
 	const u32 oldVertexCount = VertexCount;
+	const u32 oldVolumesUsed = ShadowVolumesUsed;
 
 	VertexCount = 0;
 	IndexCount = 0;
@@ -321,31 +377,21 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 		return;
 	}
 
-	// allocate memory if necessary
-
-	Vertices.set_used(totalVertices);
-	Indices.set_used(totalIndices);
-	FaceData.set_used(totalIndices / 3);
+	// copy mesh, volumes of lights which did not move relative to the
+	// node are reused as long as it does not change
+	bool indicesChanged = false;
+	bool meshChanged = copyMesh(mesh, totalVertices, totalIndices, indicesChanged);
 
-	// copy mesh 
-	// (could speed this up for static meshes by adding some user flag to prevents copying)
-	for (i=0; i<bufcnt; ++i)
+	// recalculate adjacency if necessary
+	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount || AdjacencyDirtyFlag || indicesChanged)
 	{
-		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
-
-		const u16* idxp = buf->getIndices();
-		const u16* idxpend = idxp + buf->getIndexCount();
-		for (; idxp!=idxpend; ++idxp)
-			Indices[IndexCount++] = *idxp + VertexCount;
-
-		const u32 vtxcnt = buf->getVertexCount();
-		for (u32 j=0; j<vtxcnt; ++j)
-			Vertices[VertexCount++] = buf->getPosition(j);
+		calculateAdjacency();
+		meshChanged = true;
 	}
 
-	// recalculate adjacency if necessary
-	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount || AdjacencyDirtyFlag)
-		calculateAdjacency();
+	// the volumes of the last update are searched for the current lights
+	ShadowVolumes.swap(OldVolumes);
+	const u32 oldCount = meshChanged ? 0 : oldVolumesUsed;
 
 	core::matrix4 matInv(Parent->getAbsoluteTransformation());
 	matInv.makeInverse();
@@ -360,7 +406,7 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 		{
 			core::vector3df ldir(dl.Direction);
 			matTransp.transformVect(ldir);
-			createShadowVolume(ldir, true);
+			addShadowVolume(ldir, true, oldCount);
 		}
 		else
 		{
@@ -369,7 +415,7 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 				fabs((lpos - parentpos).getLengthSQ()) <= (dl.Radius*dl.Radius*4.0f))
 			{
 				matInv.transformVect(lpos);
-				createShadowVolume(lpos, false);
+				addShadowVolume(lpos, false, oldCount);
 			}
 		}
 	}
@@ -402,6 +448,13 @@ void CShadowVolumeSceneNode::render()
 	if (!ShadowVolumesUsed || !driver)
 		return;
 
+	// volumes which were not built by the scene manager in parallel
+	for (u32 i=0; i<ShadowVolumesUsed; ++i)
+	{
+		if (ShadowVolumes[i].Dirty)
+			buildShadowVolume(i);
+	}
+
 	driver->setTransform(video::ETS_WORLD, Parent->getAbsoluteTransformation());
 
 	bool checkFarPlaneClipping = UseZFailMethod && !driver->queryFeature(video::EVDF_DEPTH_CLAMP);
@@ -434,7 +487,7 @@ void CShadowVolumeSceneNode::render()
 			//       Anyone who can figure it out is welcome to provide a patch.
 
 			core::vector3df edges[8];
-			ShadowBBox[i].getEdges(edges);
+			ShadowVolumes[i].BBox.getEdges(edges);
 
 			for(int j = 0; j < 8; ++j)
 			{
@@ -447,7 +500,7 @@ void CShadowVolumeSceneNode::render()
 		}
 
 		if(drawShadow)
-			driver->drawStencilShadowVolume(ShadowVolumes[i], UseZFailMethod, DebugDataVisible);
+			driver->drawStencilShadowVolume(ShadowVolumes[i].Triangles, UseZFailMethod, DebugDataVisible);
 		else
 		{
 			// TODO: For some reason (not yet further investigated), Direct3D needs a call to drawStencilShadowVolume
@@ -480,47 +533,87 @@ void CShadowVolumeSceneNode::calculateAdjacency()
 	{
 		Adjacency.set_used(IndexCount);
 
-		// go through all faces and fetch their three neighbours
-		for (u32 f=0; f<IndexCount; f+=3)
+		// vertices at the same position, within ROUNDING_ERROR_f32 like
+		// vector3df::equals, get the id of the first of them
+		core::array<u32> ids;
+		ids.set_used(VertexCount);
+		u32 id = 0;
+		if (VertexCount)
 		{
-			for (u32 edge = 0; edge<3; ++edge)
-			{
-				const core::vector3df& v1 = Vertices[Indices[f+edge]];
-				const core::vector3df& v2 = Vertices[Indices[f+((edge+1)%3)]];
+			core::aabbox3df box(Vertices[0]);
+			u32 i;
+			for (i=1; i<VertexCount; ++i)
+				box.addInternalPoint(Vertices[i]);
 
-				// now we search an_O_ther _F_ace with these two
-				// vertices, which is not the current face.
-				u32 of;
+			CWeldGrid grid(VertexCount, box, core::ROUNDING_ERROR_f32);
+			for (i=0; i<VertexCount; ++i)
+			{
+				u32 cell[3];
+				u32 side[3];
+				grid.getCells(Vertices[i], cell, side);
 
-				for (of=0; of<IndexCount; of+=3)
+				u32 found = i;
+				for (u32 n=0; n<8; ++n)
 				{
-					// only other faces
-					if (of != f)
+					u32 j = grid.getFirst((n & 1) ? side[0] : cell[0],
+						(n & 2) ? side[1] : cell[1],
+						(n & 4) ? side[2] : cell[2]);
+					for (; j < found; j = grid.getNext(j))
 					{
-						bool cnt1 = false;
-						bool cnt2 = false;
-
-						for (s32 e=0; e<3; ++e)
+						if (Vertices[i].equals(Vertices[j]))
 						{
-							if (v1.equals(Vertices[Indices[of+e]]))
-								cnt1=true;
-
-							if (v2.equals(Vertices[Indices[of+e]]))
-								cnt2=true;
-						}
-						// one match for each vertex, i.e. edge is the same
-						if (cnt1 && cnt2)
+							found = j;
 							break;
+						}
 					}
 				}
 
-				// no adjacent edges -> store face number, else store adjacent face
-				if (of >= IndexCount)
-					Adjacency[f + edge] = f/3;
-				else
-					Adjacency[f + edge] = of/3;
+				ids[i] = (found < i) ? ids[found] : id++;
+				grid.add(cell[0], cell[1], cell[2], i);
 			}
 		}
+
+		// sorting the edges by their positions puts the faces sharing an edge next to each other
+		core::array<SEdgeRef> edges;
+		edges.set_used(IndexCount);
+		for (u32 f=0; f<IndexCount; f+=3)
+		{
+			for (u32 edge = 0; edge<3; ++edge)
+			{
+				const u32 id1 = ids[Indices[f+edge]];
+				const u32 id2 = ids[Indices[f+((edge+1)%3)]];
+				edges[f+edge].Key = ((u64)core::min_(id1, id2) << 32) | core::max_(id1, id2);
+				edges[f+edge].Corner = f+edge;
+			}
+		}
+		edges.set_sorted(false);
+		edges.sort();
+
+		for (u32 first=0; first<IndexCount; )
+		{
+			u32 last = first + 1;
+			while (last<IndexCount && edges[last].Key == edges[first].Key)
+				++last;
+
+			// the first other face with the edge in index order, as the
+			// faces of a group are sorted. no adjacent edges -> store face number
+			for (u32 e=first; e<last; ++e)
+			{
+				const u32 face = edges[e].Corner/3;
+				u32 other = face;
+				for (u32 o=first; o<last; ++o)
+				{
+					if (edges[o].Corner/3 != face)
+					{
+						other = edges[o].Corner/3;
+						break;
+					}
+				}
+				Adjacency[edges[e].Corner] = (u16)other;
+			}
+
+			first = last;
+		}
 	}
 }
 
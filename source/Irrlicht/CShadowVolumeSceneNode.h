@@ -56,12 +56,49 @@ namespace scene
 		//! Returns type of the scene node
 		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_SHADOW_VOLUME; }
 
+		//! Number of shadow volumes of the last update
+		u32 getShadowVolumeCount() const { return ShadowVolumesUsed; }
+
+		//! Check if a shadow volume has to be built before it is drawn
+		bool isShadowVolumeDirty(u32 i) const { return ShadowVolumes[i].Dirty; }
+
+		//! Builds a shadow volume of the last update
+		/** Only reads the shared mesh data, so different volumes can
+		be built by different threads at the same time. */
+		void buildShadowVolume(u32 i);
+
 	private:
 
-		typedef core::array<core::vector3df> SShadowVolume;
+		struct SShadowVolume
+		{
+			SShadowVolume() : Directional(false), Dirty(true) {}
+
+			//! triangle list of caps and sides
+			core::array<core::vector3df> Triangles;
+
+			//! bounding box of the back cap
+			core::aabbox3d<f32> BBox;
+
+			//! tells if face is front facing
+			core::array<bool> FaceData;
+
+			//! light position or direction in the space of the parent
+			core::vector3df Light;
+			bool Directional;
+
+			//! the triangles do not match the light or the mesh
+			bool Dirty;
+		};
+
+		//! Appends a volume for the light, reusing a matching volume of the last update
+		void addShadowVolume(const core::vector3df& light, bool isDirectional, u32 oldCount);
+
+		void createEdgesAndCaps(SShadowVolume& volume);
+
+		static void swapVolumes(SShadowVolume& a, SShadowVolume& b);
 
-		void createShadowVolume(const core::vector3df& pos, bool isDirectional);
-		u32 createEdgesAndCaps(const core::vector3df& light, bool isDirectional, SShadowVolume* svp, core::aabbox3d<f32>* bb);
+		//! Copies the positions and indices of the mesh, returns true if anything changed.
+		bool copyMesh(const IMesh* mesh, u32 totalVertices, u32 totalIndices, bool& indicesChanged);
 
 		//! Generates adjacency information based on mesh indices.
 		void calculateAdjacency();
@@ -71,15 +108,12 @@ namespace scene
 		// a shadow volume for every light
 		core::array<SShadowVolume> ShadowVolumes;
 
-		// a back cap bounding box for every light
-		core::array<core::aabbox3d<f32> > ShadowBBox;
+		// volumes of the last update, reused for lights which did not move
+		core::array<SShadowVolume> OldVolumes;
 
 		core::array<core::vector3df> Vertices;
 		core::array<u16> Indices;
 		core::array<u16> Adjacency;
-		core::array<u16> Edges;
-		// tells if face is front facing
-		core::array<bool> FaceData;
 		bool AdjacencyDirtyFlag;
 
 		const scene::IMesh* ShadowMesh;
@@ -336,6 +336,14 @@ void CSoftwareDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCo
 				E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
 
 {
+	// compact positions are only valid in the box of their mesh buffer,
+	// drawMeshBuffer() decodes them
+	if (vType == EVT_COMPACT)
+	{
+		os::Printer::log("Compact vertices can only be drawn with drawMeshBuffer.", ELL_WARNING);
+		return;
+	}
+
 	switch (iType)
 	{
 		case (EIT_16BIT):
@@ -387,6 +395,8 @@ void CSoftwareDriver::drawVertexPrimitiveList16(const void* vertices, u32 vertex
 									((S3DVertexTangents*)vertices)[indexList[i]].Color);
 						}
 						break;
+					case EVT_COMPACT:
+						break;
 				}
 			}
 			return;
@@ -409,6 +419,8 @@ void CSoftwareDriver::drawVertexPrimitiveList16(const void* vertices, u32 vertex
 						((S3DVertexTangents*)vertices)[indexList[0]].Pos,
 						((S3DVertexTangents*)vertices)[indexList[primitiveCount-1]].Color);
 					break;
+				case EVT_COMPACT:
+					break;
 			}
 			return;
 		case scene::EPT_LINES:
@@ -439,6 +451,8 @@ void CSoftwareDriver::drawVertexPrimitiveList16(const void* vertices, u32 vertex
 									((S3DVertexTangents*)vertices)[indexList[i]].Color);
 						}
 						break;
+					case EVT_COMPACT:
+						break;
 				}
 			}
 			return;
@@ -473,6 +487,8 @@ void CSoftwareDriver::drawVertexPrimitiveList16(const void* vertices, u32 vertex
 		case EVT_TANGENTS:
 			drawClippedIndexedTriangleListT((S3DVertexTangents*)vertices, vertexCount, indexPointer, primitiveCount);
 			break;
+		case EVT_COMPACT:
+			break;
 	}
 }
 
@@ -14,6 +14,11 @@
 #include "S3DVertex.h"
 #include "S4DVertex.h"
 #include "CBlit.h"
+#include "CDepthBuffer.h"
+
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
 
 
 // Matrix now here
@@ -253,7 +258,7 @@ namespace video
 CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, video::IImagePresenter* presenter)
 	: CNullDriver(io, params.WindowSize), BackBuffer(0), Presenter(presenter),
 	WindowId(0), SceneSourceRect(0),
-	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
+	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0), CurrentShaderIndex(ETR_INVALID),
 	DepthBuffer(0), StencilBuffer(0)
 {
 	//enable fpu exception
@@ -264,6 +269,7 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 #endif
 
 	VertexCache_map_source_format();
+	CpuFeature = params.BurningVideoSimd ? burning_cpu_features() : 0;
 
 	//Use AntiAlias(hack) to shrink BackBuffer Size and keep ScreenSize the same as Input
 	scale_setup scale;
@@ -273,6 +279,9 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	Interlaced.enable = scale.i;
 	Interlaced.bypass = !Interlaced.enable;
 	Interlaced.nr = 0;
+	Interlaced.tile_bypass = 1;
+	Interlaced.tile_nr = 0;
+	Interlaced.tile_count = 1;
 
 	// create backbuffer.
 	core::dimension2du use(params.WindowSize.Width / scale.x, params.WindowSize.Height / scale.y);
@@ -300,41 +309,75 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 
 	// create triangle renderers
 
-	memset(BurningShader, 0, sizeof(BurningShader));
-	//BurningShader[ETR_FLAT] = createTRFlat2(DepthBuffer);
-	//BurningShader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
-	BurningShader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
-	BurningShader[ETR_GOURAUD_NOZ] = createTriangleRendererGouraudNoZ2(this);
-	//BurningShader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
-	BurningShader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this); // 2D
-	//BurningShader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
-	BurningShader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ(this);
-
-	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap(this);
-	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow(this);
-	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend(this);
-
-	BurningShader[ETR_TRANSPARENT_REFLECTION_2_LAYER] = createTriangleRendererTexture_transparent_reflection_2_layer(this);
-	//BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
-
-	BurningShader[ETR_COLOR] = create_burning_shader_color(this);
+	for (size_t i = 0; i < ETR2_COUNT; ++i)
+	{
+		BurningShader[i] = createBurningShader(i);
+	}
+
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+	// tile binned rasterizer
+	TilePool = 0;
+	TileJob.Driver = this;
+	TileGroupCount = 1;
+	TileActive = false;
+	TileTriangleCount = 0;
+	TileTexSize = 0;
+	if (params.BurningVideoThreads > 1)
+	{
+		TilePool = new CThreadPool(core::min_(params.BurningVideoThreads, (u32)SOFTWARE_DRIVER_2_TILE_GROUP_MAX));
+		TileGroupCount = TilePool->getWorkerCount();
+		if (TileGroupCount < 2)
+		{
+			TilePool->drop();
+			TilePool = 0;
+			TileGroupCount = 1;
+		}
+		else
+		{
+			TileShader.set_used(TileGroupCount * ETR2_COUNT);
+			for (u32 i = 0; i < TileShader.size(); ++i)
+				TileShader[i] = 0;
+			TileBin.reallocate(TileGroupCount);
+			for (u32 i = 0; i < TileGroupCount; ++i)
+				TileBin.push_back(core::array<u32>());
+			TileVertex.resize(SOFTWARE_DRIVER_2_TILE_TRIANGLE_MAX * 3);
+			TileTriangleTexture.reallocate(SOFTWARE_DRIVER_2_TILE_TRIANGLE_MAX);
+
+			char buf[64];
+			snprintf_irr(buf, sizeof(buf), "Burning's Video rasterizer threads: %u", TileGroupCount);
+			os::Printer::log(buf, ELL_INFORMATION);
+		}
+	}
+	DriverAttributes->setAttribute("RasterizerThreads", (s32)TileGroupCount);
+#else
+	if (params.BurningVideoThreads > 1)
+		os::Printer::log("Burning's Video multithreaded rasterizer not compiled in", ELL_WARNING);
+	DriverAttributes->setAttribute("RasterizerThreads", 1);
+#endif
+
+	// texel layout of image textures
+	TextureLayoutFlags = 0;
+	if (params.BurningVideoTiledTextures)
+	{
+#if defined(SOFTWARE_DRIVER_2_TEXTURE_TILED)
+		TextureLayoutFlags = CSoftwareTexture2::TILED_LAYOUT;
+#else
+		os::Printer::log("Burning's Video tiled textures not compiled in", ELL_WARNING);
+#endif
+	}
+
+	// clipping of triangles crossing the x,y planes
+	GuardBand = false;
+	if (params.BurningVideoGuardBand)
+	{
+#if defined(SOFTWARE_DRIVER_2_GUARD_BAND)
+		GuardBand = true;
+#else
+		os::Printer::log("Burning's Video guard band not compiled in", ELL_WARNING);
+#endif
+	}
+	for (u32 i = 0; i < ECP_COUNT; ++i)
+		ClipPathCount[i] = 0;
 
 	// add the same renderer for all solid types
 	CSoftware2MaterialRenderer_SOLID* smr = new CSoftware2MaterialRenderer_SOLID(this);
@@ -403,6 +446,21 @@ CBurningVideoDriver::~CBurningVideoDriver()
 		}
 	}
 
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+	for (u32 i = 0; i < TileShader.size(); ++i)
+	{
+		if (TileShader[i])
+			TileShader[i]->drop();
+	}
+	TileShader.clear();
+
+	if (TilePool)
+	{
+		TilePool->drop();
+		TilePool = 0;
+	}
+#endif
+
 	// delete Additional buffer
 	if (StencilBuffer)
 	{
@@ -433,6 +491,51 @@ CBurningVideoDriver::~CBurningVideoDriver()
 }
 
 
+//! creates the triangle renderer for EBurningFFShader
+IBurningShader* CBurningVideoDriver::createBurningShader(size_t shader)
+{
+	switch (shader)
+	{
+	//case ETR_FLAT: return createTRFlat2(DepthBuffer);
+	//case ETR_FLAT_WIRE: return createTRFlatWire2(DepthBuffer);
+	case ETR_GOURAUD: return createTriangleRendererGouraud2(this);
+	case ETR_GOURAUD_NOZ: return createTriangleRendererGouraudNoZ2(this);
+	//case ETR_GOURAUD_ALPHA: return createTriangleRendererGouraudAlpha2(this );
+	case ETR_GOURAUD_ALPHA_NOZ: return createTRGouraudAlphaNoZ2(this); // 2D
+	//case ETR_GOURAUD_WIRE: return createTriangleRendererGouraudWire2(DepthBuffer);
+	//case ETR_TEXTURE_FLAT: return createTriangleRendererTextureFlat2(DepthBuffer);
+	//case ETR_TEXTURE_FLAT_WIRE: return createTriangleRendererTextureFlatWire2(DepthBuffer);
+	case ETR_TEXTURE_GOURAUD: return createTriangleRendererTextureGouraud2(this);
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_M1: return createTriangleRendererTextureLightMap2_M1(this);
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_M2: return createTriangleRendererTextureLightMap2_M2(this);
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_M4: return createTriangleRendererGTextureLightMap2_M4(this);
+	case ETR_TEXTURE_LIGHTMAP_M4: return createTriangleRendererTextureLightMap2_M4(this);
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD: return createTriangleRendererTextureLightMap2_Add(this);
+	case ETR_TEXTURE_GOURAUD_DETAIL_MAP: return createTriangleRendererTextureDetailMap2(this);
+
+	case ETR_TEXTURE_GOURAUD_WIRE: return createTriangleRendererTextureGouraudWire2(this);
+	case ETR_TEXTURE_GOURAUD_NOZ: return createTRTextureGouraudNoZ2(this);
+	case ETR_TEXTURE_GOURAUD_ADD: return createTRTextureGouraudAdd2(this);
+	case ETR_TEXTURE_GOURAUD_ADD_NO_Z: return createTRTextureGouraudAddNoZ2(this);
+	case ETR_TEXTURE_GOURAUD_VERTEX_ALPHA: return createTriangleRendererTextureVertexAlpha2(this);
+
+	case ETR_TEXTURE_GOURAUD_ALPHA: return createTRTextureGouraudAlpha(this);
+	case ETR_TEXTURE_GOURAUD_ALPHA_NOZ: return createTRTextureGouraudAlphaNoZ(this);
+
+	case ETR_NORMAL_MAP_SOLID: return createTRNormalMap(this);
+	case ETR_STENCIL_SHADOW: return createTRStencilShadow(this);
+	case ETR_TEXTURE_BLEND: return createTRTextureBlend(this);
+
+	case ETR_TRANSPARENT_REFLECTION_2_LAYER: return createTriangleRendererTexture_transparent_reflection_2_layer(this);
+	//case ETR_REFERENCE: return createTriangleRendererReference ( this );
+
+	case ETR_COLOR: return create_burning_shader_color(this);
+	default: break;
+	}
+	return 0;
+}
+
+
 
 //! queries the features of the driver, returns true if feature is available
 bool CBurningVideoDriver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
@@ -666,6 +769,9 @@ bool CBurningVideoDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clear
 
 	clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
+	for (u32 i = 0; i < ECP_COUNT; ++i)
+		ClipPathCount[i] = 0;
+
 	//memset ( TransformationFlag, 0, sizeof ( TransformationFlag ) );
 	return true;
 }
@@ -674,6 +780,11 @@ bool CBurningVideoDriver::endScene()
 {
 	CNullDriver::endScene();
 
+	DriverAttributes->setAttribute("ClipTrianglesInside", (s32)ClipPathCount[ECP_INSIDE]);
+	DriverAttributes->setAttribute("ClipTrianglesOutside", (s32)ClipPathCount[ECP_OUTSIDE]);
+	DriverAttributes->setAttribute("ClipTrianglesGuardBand", (s32)ClipPathCount[ECP_GUARD_BAND]);
+	DriverAttributes->setAttribute("ClipTrianglesClipped", (s32)ClipPathCount[ECP_CLIPPED]);
+
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
 }
 
@@ -967,6 +1078,27 @@ REALINLINE size_t clipToFrustumTest(const s4DVertex* v)
 #endif // _MSC_VER
 
 
+//! adds VERTEX4D_GUARDBAND to the clip flags of a vertex inside near, far and the guard band
+REALINLINE u32 CBurningVideoDriver::guard_band_test(const s4DVertex* v, u32 flag) const
+{
+#if defined(SOFTWARE_DRIVER_2_GUARD_BAND)
+	if (!GuardBand)
+		return flag;
+
+	if ((flag & VERTEX4D_CLIPMASK) == VERTEX4D_INSIDE)
+		return flag | VERTEX4D_GUARDBAND;
+
+	if ((flag & (VERTEX4D_CLIP_NEAR | VERTEX4D_CLIP_FAR)) != (VERTEX4D_CLIP_NEAR | VERTEX4D_CLIP_FAR))
+		return flag;
+
+	const f32 g = v->Pos.w * SOFTWARE_DRIVER_2_GUARD_BAND_SIZE;
+	if (fabsf(v->Pos.x) <= g && fabsf(v->Pos.y) <= g)
+		flag |= VERTEX4D_GUARDBAND;
+#endif
+	return flag;
+}
+
+
 size_t clipToHyperPlane(
 	s4DVertexPair* burning_restrict dest,
 	const s4DVertexPair* burning_restrict source,
@@ -1452,6 +1584,9 @@ void CBurningVideoDriver::VertexCache_map_source_format()
 
 	VertexCache.mem.resize(VERTEXCACHE_ELEMENT * 2);
 	VertexCache.vType = E4VT_STANDARD;
+	VertexCache.compact = false;
+	VertexCache.compactBox = core::aabbox3df(0.f, 0.f, 0.f, 1.f, 1.f, 1.f);
+	VertexCache.vertexPitch = sizeof(S3DVertex);
 
 	Clipper.resize(VERTEXCACHE_ELEMENT * 2);
 	Clipper_temp.resize(VERTEXCACHE_ELEMENT * 2);
@@ -1475,7 +1610,7 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 	u8* burning_restrict source;
 	s4DVertex* burning_restrict dest;
 
-	source = (u8*)VertexCache.vertices + (sourceIndex * VertexCache.vSize[VertexCache.vType].Pitch);
+	source = (u8*)VertexCache.vertices + (sourceIndex * VertexCache.vertexPitch);
 
 	// it's a look ahead so we never hit it..
 	// but give priority...
@@ -1490,6 +1625,12 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 
 	//Irrlicht S3DVertex,S3DVertex2TCoords,S3DVertexTangents
 	const S3DVertex* base = ((S3DVertex*)source);
+	S3DVertex decoded;
+	if (VertexCache.compact)
+	{
+		decoded = ((const S3DVertexCompact*)source)->getVertex(VertexCache.compactBox);
+		base = &decoded;
+	}
 
 	// transform Model * World * Camera * Projection * NDCSpace matrix
 	const core::matrix4* matrix = Transformation[TransformationStack];
@@ -1542,6 +1683,29 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 
 #endif
 
+	VertexCache_fill_attributes(base, dest, 0);
+
+clipandproject:
+
+	// test vertex visible
+	dest[0].flag = guard_band_test(dest, (u32)(clipToFrustumTest(dest) | VertexCache.vSize[VertexCache.vType].Format));
+	dest[1].flag = dest[0].flag;
+
+	// to DC Space, project homogenous vertex
+	if ((dest[0].flag & VERTEX4D_CLIPMASK) == VERTEX4D_INSIDE || (dest[0].flag & VERTEX4D_GUARDBAND))
+	{
+		ndc_2_dc_and_project(dest + s4DVertex_proj(0), dest + s4DVertex_ofs(0), s4DVertex_ofs(1));
+	}
+
+}
+
+
+//! vertex color, lighting, fog and texture coordinates. needs transformed EyeSpace if lit, fogged or texture transformed.
+//! lightAccu: ambient, diffuse and specular sum of all lights or 0 to do the lighting here
+void CBurningVideoDriver::VertexCache_fill_attributes(const S3DVertex* burning_restrict base, s4DVertex* burning_restrict dest, const sVec3Color* lightAccu)
+{
+	const core::matrix4* matrix = Transformation[TransformationStack];
+
 #if BURNING_MATERIAL_MAX_COLORS > 1
 	dest->Color[1].a = 1.f;
 	dest->Color[1].r = 0.f;
@@ -1575,7 +1739,10 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 #if defined (SOFTWARE_DRIVER_2_LIGHTING)
 	if (Material.org.Lighting)
 	{
-		lightVertex_eye(dest, base->Color.color);
+		if (lightAccu)
+			lightVertex_sum(dest, base->Color.color, lightAccu);
+		else
+			lightVertex_eye(dest, base->Color.color);
 	}
 	else
 	{
@@ -1763,7 +1930,7 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 		((VertexCache.vSize[VertexCache.vType].Format & VERTEX4D_FORMAT_MASK_TANGENT) == VERTEX4D_FORMAT_BUMP_DOT3)
 		)
 	{
-		const S3DVertexTangents* tangent = ((S3DVertexTangents*)source);
+		const S3DVertexTangents* tangent = ((const S3DVertexTangents*)base);
 
 		sVec4 vp;
 		sVec4 light_accu;
@@ -1809,21 +1976,416 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 #endif //if BURNING_MATERIAL_MAX_LIGHT_TANGENT > 0
 
 //#endif // SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM
+}
 
-clipandproject:
 
-	// test vertex visible
-	dest[0].flag = (u32)(clipToFrustumTest(dest) | VertexCache.vSize[VertexCache.vType].Format);
-	dest[1].flag = dest[0].flag;
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2)
 
-	// to DC Space, project homogenous vertex
-	if ((dest[0].flag & VERTEX4D_CLIPMASK) == VERTEX4D_INSIDE)
+/*
+	Batched vertex processing, 4 vertices per step in SoA layout.
+	Every lane does the same float operations in the same order as the scalar path,
+	so the result is identical to VertexCache_fill.
+*/
+
+//! x,y,z of 4 vertices
+struct sVec3SoA4
+{
+	__m128 x, y, z;
+};
+
+//! mask ? a : 0
+static REALINLINE __m128 and4(const __m128 mask, const __m128 a)
+{
+	return _mm_and_ps(mask, a);
+}
+
+//! core::matrix4::transformVect(T* out, in)
+static REALINLINE void transformVect4(__m128 out[4], const f32* burning_restrict M, const sVec3SoA4& v)
+{
+	for (size_t i = 0; i < 4; ++i)
 	{
-		ndc_2_dc_and_project(dest + s4DVertex_proj(0), dest + s4DVertex_ofs(0), s4DVertex_ofs(1));
+		out[i] = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(v.x, _mm_set1_ps(M[i])),
+			_mm_mul_ps(v.y, _mm_set1_ps(M[i + 4]))),
+			_mm_mul_ps(v.z, _mm_set1_ps(M[i + 8]))),
+			_mm_set1_ps(M[i + 12]));
+	}
+}
+
+//! core::matrix4::rotateVect(T* out, in)
+static REALINLINE void rotateVect4(sVec3SoA4& out, const f32* burning_restrict M, const sVec3SoA4& v)
+{
+	out.x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v.x, _mm_set1_ps(M[0])), _mm_mul_ps(v.y, _mm_set1_ps(M[4]))), _mm_mul_ps(v.z, _mm_set1_ps(M[8])));
+	out.y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v.x, _mm_set1_ps(M[1])), _mm_mul_ps(v.y, _mm_set1_ps(M[5]))), _mm_mul_ps(v.z, _mm_set1_ps(M[9])));
+	out.z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v.x, _mm_set1_ps(M[2])), _mm_mul_ps(v.y, _mm_set1_ps(M[6]))), _mm_mul_ps(v.z, _mm_set1_ps(M[10])));
+}
+
+//! sVec4::dot_xyz
+static REALINLINE __m128 dot_xyz4(const sVec3SoA4& a, const __m128 x, const __m128 y, const __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, x), _mm_mul_ps(a.y, y)), _mm_mul_ps(a.z, z));
+}
+
+//! reciprocal_zero
+static REALINLINE __m128 reciprocal_zero4(const __m128 x)
+{
+	return and4(_mm_cmpneq_ps(x, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(1.f), x));
+}
+
+//! reciprocal_one
+static REALINLINE __m128 reciprocal_one4(const __m128 x)
+{
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 mask = _mm_cmpneq_ps(x, _mm_setzero_ps());
+	return _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(one, x)), _mm_andnot_ps(mask, one));
+}
+
+//! sVec4::normalize_dir_xyz
+static REALINLINE void normalize_dir_xyz4(__m128& x, __m128& y, __m128& z)
+{
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 l = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+	const __m128 mask = _mm_cmpgt_ps(l, _mm_set1_ps(0.0000001f));
+	const __m128 r = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(one, _mm_sqrt_ps(l))), _mm_andnot_ps(mask, one));
+	x = _mm_mul_ps(x, r);
+	y = _mm_mul_ps(y, r);
+	z = _mm_mul_ps(z, r);
+}
+
+#if defined(SOFTWARE_DRIVER_2_LIGHTING) && BURNING_MATERIAL_MAX_COLORS > 0
+
+//! powf_limit per lane
+static REALINLINE __m128 powf_limit4(const __m128 a, const f32 b)
+{
+	ALIGN(16) f32 v[4];
+	_mm_store_ps(v, a);
+	for (size_t i = 0; i < 4; ++i)
+		v[i] = powf_limit(v[i], b);
+	return _mm_load_ps(v);
+}
+
+//! sVec3Color::mad_rgb on lanes in mask. acc is r,g,b
+static REALINLINE void mad_rgb4(__m128 acc[3], const sVec3Color& c, const __m128 v, const __m128 mask)
+{
+	acc[0] = _mm_add_ps(acc[0], and4(mask, _mm_mul_ps(_mm_set1_ps(c.r), v)));
+	acc[1] = _mm_add_ps(acc[1], and4(mask, _mm_mul_ps(_mm_set1_ps(c.g), v)));
+	acc[2] = _mm_add_ps(acc[2], and4(mask, _mm_mul_ps(_mm_set1_ps(c.b), v)));
+}
+
+//! specular term of point and spot light
+static REALINLINE __m128 light_specular4(const sVec3SoA4& normal, const sVec3SoA4& vp, const f32 shininess)
+{
+	__m128 x = vp.x;
+	__m128 y = vp.y;
+	__m128 z = _mm_sub_ps(vp.z, _mm_set1_ps(1.f));
+	normalize_dir_xyz4(x, y, z);
+	return powf_limit4(dot_xyz4(normal, x, y, z), shininess);
+}
+
+//! lightVertex_eye for 4 vertices. returns ambient, diffuse and specular sum per vertex
+static void lightVertex_eye4(sVec3Color accu[4][3], const SBurningShaderEyeSpace& EyeSpace, const f32 shininess,
+	const sVec3SoA4& vertex, const sVec3SoA4& normal)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 all = _mm_cmpeq_ps(zero, zero);
+	const __m128 sign = _mm_set1_ps(-0.f);
+	const bool specular = (EyeSpace.TL_Flag & TL_SPECULAR) != 0;
+
+	__m128 ambient[3];
+	__m128 diffuse[3];
+	__m128 spec[3];
+	ambient[0] = _mm_set1_ps(EyeSpace.Global_AmbientLight.r);
+	ambient[1] = _mm_set1_ps(EyeSpace.Global_AmbientLight.g);
+	ambient[2] = _mm_set1_ps(EyeSpace.Global_AmbientLight.b);
+	diffuse[0] = diffuse[1] = diffuse[2] = zero;
+	spec[0] = spec[1] = spec[2] = zero;
+
+	for (u32 i = 0; i < EyeSpace.Light.size(); ++i)
+	{
+		const SBurningShaderLight& light = EyeSpace.Light[i];
+		if (!light.LightIsOn)
+			continue;
+
+		switch (light.Type)
+		{
+		case ELT_DIRECTIONAL:
+		{
+			const __m128 dot = dot_xyz4(normal, _mm_set1_ps(light.spotDirection4.x), _mm_set1_ps(light.spotDirection4.y), _mm_set1_ps(light.spotDirection4.z));
+
+			ambient[0] = _mm_add_ps(ambient[0], _mm_set1_ps(light.AmbientColor.r));
+			ambient[1] = _mm_add_ps(ambient[1], _mm_set1_ps(light.AmbientColor.g));
+			ambient[2] = _mm_add_ps(ambient[2], _mm_set1_ps(light.AmbientColor.b));
+
+			mad_rgb4(diffuse, light.DiffuseColor, dot, _mm_cmpgt_ps(dot, zero));
+		}
+		break;
+
+		case ELT_POINT:
+		{
+			sVec3SoA4 vp;
+			vp.x = _mm_sub_ps(_mm_set1_ps(light.pos4.x), vertex.x);
+			vp.y = _mm_sub_ps(_mm_set1_ps(light.pos4.y), vertex.y);
+			vp.z = _mm_sub_ps(_mm_set1_ps(light.pos4.z), vertex.z);
+
+			const __m128 distance = _mm_sqrt_ps(dot_xyz4(vp, vp.x, vp.y, vp.z));
+
+			__m128 attenuation = _mm_add_ps(_mm_add_ps(_mm_set1_ps(light.constantAttenuation),
+				_mm_mul_ps(_mm_set1_ps(light.linearAttenuation), distance)),
+				_mm_mul_ps(_mm_set1_ps(light.quadraticAttenuation), _mm_mul_ps(distance, distance)));
+			attenuation = reciprocal_one4(attenuation);
+
+			mad_rgb4(ambient, light.AmbientColor, attenuation, all);
+
+			const __m128 rd = reciprocal_zero4(distance);
+			vp.x = _mm_mul_ps(vp.x, rd);
+			vp.y = _mm_mul_ps(vp.y, rd);
+			vp.z = _mm_mul_ps(vp.z, rd);
+
+			const __m128 dot = dot_xyz4(normal, vp.x, vp.y, vp.z);
+			const __m128 lit = _mm_cmpnle_ps(dot, zero);
+			if (!_mm_movemask_ps(lit))
+				break;
+
+			mad_rgb4(diffuse, light.DiffuseColor, _mm_mul_ps(dot, attenuation), lit);
+
+			if (specular)
+				mad_rgb4(spec, light.SpecularColor, _mm_mul_ps(light_specular4(normal, vp, shininess), attenuation), lit);
+		}
+		break;
+
+		case ELT_SPOT:
+		{
+			sVec3SoA4 vp;
+			vp.x = _mm_sub_ps(_mm_set1_ps(light.pos4.x), vertex.x);
+			vp.y = _mm_sub_ps(_mm_set1_ps(light.pos4.y), vertex.y);
+			vp.z = _mm_sub_ps(_mm_set1_ps(light.pos4.z), vertex.z);
+
+			const __m128 distance = _mm_sqrt_ps(dot_xyz4(vp, vp.x, vp.y, vp.z));
+
+			const __m128 rd = reciprocal_zero4(distance);
+			vp.x = _mm_mul_ps(vp.x, rd);
+			vp.y = _mm_mul_ps(vp.y, rd);
+			vp.z = _mm_mul_ps(vp.z, rd);
+
+			// sVec4::dot_minus_xyz
+			const __m128 spotDot = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_xor_ps(vp.x, sign), _mm_set1_ps(light.spotDirection4.x)),
+				_mm_mul_ps(_mm_xor_ps(vp.y, sign), _mm_set1_ps(light.spotDirection4.y))),
+				_mm_mul_ps(_mm_xor_ps(vp.z, sign), _mm_set1_ps(light.spotDirection4.z)));
+			const __m128 cone = _mm_cmpnlt_ps(spotDot, _mm_set1_ps(light.spotCosCutoff));
+			if (!_mm_movemask_ps(cone))
+				break;
+
+			__m128 attenuation = _mm_add_ps(_mm_add_ps(_mm_set1_ps(light.constantAttenuation),
+				_mm_mul_ps(_mm_set1_ps(light.linearAttenuation), distance)),
+				_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(light.quadraticAttenuation), distance), distance));
+			attenuation = reciprocal_one4(attenuation);
+			attenuation = _mm_mul_ps(attenuation, powf_limit4(spotDot, light.spotExponent));
+
+			mad_rgb4(ambient, light.AmbientColor, attenuation, cone);
+
+			const __m128 dot = dot_xyz4(normal, vp.x, vp.y, vp.z);
+			const __m128 lit = _mm_and_ps(cone, _mm_cmpnlt_ps(dot, zero));
+			if (!_mm_movemask_ps(lit))
+				break;
+
+			mad_rgb4(diffuse, light.DiffuseColor, _mm_mul_ps(dot, attenuation), lit);
+
+			if (specular)
+				mad_rgb4(spec, light.SpecularColor, _mm_mul_ps(light_specular4(normal, vp, shininess), attenuation), lit);
+		}
+		break;
+
+		default:
+			break;
+		}
 	}
 
+	// transpose to sVec3Color per vertex
+	ALIGN(16) f32 v[9][4];
+	for (size_t c = 0; c < 3; ++c)
+	{
+		_mm_store_ps(v[c], ambient[c]);
+		_mm_store_ps(v[c + 3], diffuse[c]);
+		_mm_store_ps(v[c + 6], spec[c]);
+	}
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (size_t k = 0; k < 3; ++k)
+		{
+			accu[i][k].r = v[k * 3 + 0][i];
+			accu[i][k].g = v[k * 3 + 1][i];
+			accu[i][k].b = v[k * 3 + 2][i];
+			accu[i][k].a = 0.f;
+		}
+	}
+}
+
+#endif // SOFTWARE_DRIVER_2_LIGHTING
+
+/*!
+	VertexCache_fill for a run of cache misses.
+	position, frustum clip codes, eye space and lighting are done for 4 vertices at once,
+	the remaining attributes per vertex.
+*/
+void CBurningVideoDriver::VertexCache_fill_batch(const u32* sourceIndex, const u32* destIndex, const u32 count)
+{
+	const size_t pitch = VertexCache.vertexPitch;
+	const size_t format = VertexCache.vSize[VertexCache.vType].Format;
+	const core::matrix4* matrix = Transformation[TransformationStack];
+
+#if defined (SOFTWARE_DRIVER_2_LIGHTING) || defined ( SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM )
+	const bool eye = Material.org.Lighting || (EyeSpace.TL_Flag & (TL_TEXTURE_TRANSFORM | TL_FOG));
+#else
+	const bool eye = false;
+#endif
+#if defined(SOFTWARE_DRIVER_2_LIGHTING) && BURNING_MATERIAL_MAX_COLORS > 0
+	const bool lit = Material.org.Lighting;
+	sVec3Color accu[4][3];
+#endif
+
+	const __m128 sign = _mm_set1_ps(-0.f);
+
+	for (u32 run = 0; run < count; run += 4)
+	{
+		// repeat the last vertex in unused lanes
+		const S3DVertex* base[4];
+		S3DVertex decoded[4];
+		for (u32 i = 0; i < 4; ++i)
+		{
+			const u8* source = (const u8*)VertexCache.vertices + sourceIndex[core::min_(run + i, count - 1)] * pitch;
+			if (VertexCache.compact)
+			{
+				decoded[i] = ((const S3DVertexCompact*)source)->getVertex(VertexCache.compactBox);
+				base[i] = decoded + i;
+			}
+			else
+				base[i] = (const S3DVertex*)source;
+		}
+
+		sVec3SoA4 p;
+		p.x = _mm_set_ps(base[3]->Pos.X, base[2]->Pos.X, base[1]->Pos.X, base[0]->Pos.X);
+		p.y = _mm_set_ps(base[3]->Pos.Y, base[2]->Pos.Y, base[1]->Pos.Y, base[0]->Pos.Y);
+		p.z = _mm_set_ps(base[3]->Pos.Z, base[2]->Pos.Z, base[1]->Pos.Z, base[0]->Pos.Z);
+
+		// transform Model * World * Camera * Projection * NDCSpace matrix
+		ALIGN(16) f32 pos[4][4];
+		ALIGN(16) u32 flag[4];
+		{
+			__m128 v[4];
+			transformVect4(v, matrix[ETS_PROJ_MODEL_VIEW].pointer(), p);
+			for (size_t i = 0; i < 4; ++i)
+				_mm_store_ps(pos[i], v[i]);
+
+			// clipToFrustumTest
+			const __m128 w = v[3];
+			__m128i f;
+			f = _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(v[2], w)), _mm_set1_epi32(VERTEX4D_CLIP_NEAR));
+			f = _mm_or_si128(f, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(_mm_xor_ps(v[2], sign), w)), _mm_set1_epi32(VERTEX4D_CLIP_FAR)));
+			f = _mm_or_si128(f, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(v[0], w)), _mm_set1_epi32(VERTEX4D_CLIP_LEFT)));
+			f = _mm_or_si128(f, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(_mm_xor_ps(v[0], sign), w)), _mm_set1_epi32(VERTEX4D_CLIP_RIGHT)));
+			f = _mm_or_si128(f, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(v[1], w)), _mm_set1_epi32(VERTEX4D_CLIP_BOTTOM)));
+			f = _mm_or_si128(f, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(_mm_xor_ps(v[1], sign), w)), _mm_set1_epi32(VERTEX4D_CLIP_TOP)));
+			_mm_store_si128((__m128i*)flag, f);
+		}
+
+		// vertex, normal in light(eye) space
+		ALIGN(16) f32 es[10][4];
+		if (eye)
+		{
+			__m128 v[4];
+			transformVect4(v, matrix[ETS_MODEL_VIEW].pointer(), p);
+
+			const __m128 iw = reciprocal_zero4(v[3]);
+			sVec3SoA4 vertex;
+			vertex.x = _mm_mul_ps(v[0], iw);
+			vertex.y = _mm_mul_ps(v[1], iw);
+			vertex.z = _mm_mul_ps(v[2], iw);
+
+			__m128 cx = vertex.x;
+			__m128 cy = vertex.y;
+			__m128 cz = vertex.z;
+			normalize_dir_xyz4(cx, cy, cz);
+
+			sVec3SoA4 n;
+			n.x = _mm_set_ps(base[3]->Normal.X, base[2]->Normal.X, base[1]->Normal.X, base[0]->Normal.X);
+			n.y = _mm_set_ps(base[3]->Normal.Y, base[2]->Normal.Y, base[1]->Normal.Y, base[0]->Normal.Y);
+			n.z = _mm_set_ps(base[3]->Normal.Z, base[2]->Normal.Z, base[1]->Normal.Z, base[0]->Normal.Z);
+
+			sVec3SoA4 normal;
+			rotateVect4(normal, matrix[ETS_NORMAL].pointer(), n);
+			if (EyeSpace.TL_Flag & TL_NORMALIZE_NORMALS)
+				normalize_dir_xyz4(normal.x, normal.y, normal.z);
+
+			_mm_store_ps(es[0], vertex.x);
+			_mm_store_ps(es[1], vertex.y);
+			_mm_store_ps(es[2], vertex.z);
+			_mm_store_ps(es[3], iw);
+			_mm_store_ps(es[4], cx);
+			_mm_store_ps(es[5], cy);
+			_mm_store_ps(es[6], cz);
+			_mm_store_ps(es[7], normal.x);
+			_mm_store_ps(es[8], normal.y);
+			_mm_store_ps(es[9], normal.z);
+
+#if defined(SOFTWARE_DRIVER_2_LIGHTING) && BURNING_MATERIAL_MAX_COLORS > 0
+			if (lit)
+				lightVertex_eye4(accu, EyeSpace, Material.org.Shininess, vertex, normal);
+#endif
+		}
+
+		const u32 lanes = core::min_(count - run, (u32)4);
+		for (u32 i = 0; i < lanes; ++i)
+		{
+			const u32 destIndexI = destIndex[run + i];
+
+			// store info
+			VertexCache.info[destIndexI].index = sourceIndex[run + i];
+			VertexCache.info[destIndexI].hit = 0;
+
+			s4DVertex* burning_restrict dest = VertexCache.mem.data + s4DVertex_ofs(destIndexI);
+			dest->Pos.x = pos[0][i];
+			dest->Pos.y = pos[1][i];
+			dest->Pos.z = pos[2][i];
+			dest->Pos.w = pos[3][i];
+
+			const sVec3Color* lightAccu = 0;
+			if (eye)
+			{
+				EyeSpace.vertex.x = es[0][i];
+				EyeSpace.vertex.y = es[1][i];
+				EyeSpace.vertex.z = es[2][i];
+				EyeSpace.vertex.w = es[3][i];
+				EyeSpace.cam_dir.x = es[4][i];
+				EyeSpace.cam_dir.y = es[5][i];
+				EyeSpace.cam_dir.z = es[6][i];
+				EyeSpace.cam_dir.w = es[3][i];
+				EyeSpace.normal.x = es[7][i];
+				EyeSpace.normal.y = es[8][i];
+				EyeSpace.normal.z = es[9][i];
+#if defined(SOFTWARE_DRIVER_2_LIGHTING) && BURNING_MATERIAL_MAX_COLORS > 0
+				if (lit)
+					lightAccu = accu[i];
+#endif
+			}
+
+			VertexCache_fill_attributes(base[i], dest, lightAccu);
+
+			// test vertex visible
+			dest[0].flag = guard_band_test(dest, (u32)(flag[i] | format));
+			dest[1].flag = dest[0].flag;
+
+			// to DC Space, project homogenous vertex
+			if ((dest[0].flag & VERTEX4D_CLIPMASK) == VERTEX4D_INSIDE || (dest[0].flag & VERTEX4D_GUARDBAND))
+			{
+				ndc_2_dc_and_project(dest + s4DVertex_proj(0), dest + s4DVertex_ofs(0), s4DVertex_ofs(1));
+			}
+		}
+	}
 }
 
+#endif // SOFTWARE_DRIVER_2_SIMD_SSE2
+
 
 //todo: this should return only index
 s4DVertexPair* CBurningVideoDriver::VertexCache_getVertex(const u32 sourceIndex) const
@@ -1927,6 +2489,9 @@ void CBurningVideoDriver::VertexCache_get(s4DVertexPair* face[4])
 		}
 
 		// fill new
+		u32 missSource[VERTEXCACHE_ELEMENT];
+		u32 missDest[VERTEXCACHE_ELEMENT];
+		u32 missCount = 0;
 		for (i = 0; i != fillIndex; ++i)
 		{
 			if (VertexCache.info_temp[i].hit != VERTEXCACHE_MISS)
@@ -1936,13 +2501,25 @@ void CBurningVideoDriver::VertexCache_get(s4DVertexPair* face[4])
 			{
 				if (0 == VertexCache.info[dIndex].hit)
 				{
-					VertexCache_fill(VertexCache.info_temp[i].index, dIndex);
+					missSource[missCount] = VertexCache.info_temp[i].index;
+					missDest[missCount] = dIndex;
+					missCount += 1;
 					VertexCache.info[dIndex].hit += 1;
 					VertexCache.info_temp[i].hit = dIndex;
 					break;
 				}
 			}
 		}
+
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2)
+		if ((CpuFeature & CPU_FEATURE_SSE2) && VertexCache.vType != E4VT_SHADOW)
+			VertexCache_fill_batch(missSource, missDest, missCount);
+		else
+#endif
+		for (i = 0; i != missCount; ++i)
+		{
+			VertexCache_fill(missSource[i], missDest[i]);
+		}
 	}
 
 	//const u32 i0 = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
@@ -2005,6 +2582,11 @@ int CBurningVideoDriver::VertexCache_reset(const void* vertices, u32 vertexCount
 	VertexCache.vertices = vertices;
 	VertexCache.vertexCount = vertexCount;
 
+	// compact vertices are decoded to S3DVertex, EVT_COMPACT is no e4DVertexType
+	VertexCache.compact = vType == EVT_COMPACT;
+	if (VertexCache.compact)
+		vType = EVT_STANDARD;
+
 	switch (Material.org.MaterialType) // (Material.Fallback_MaterialType)
 	{
 	case EMT_REFLECTION_2_LAYER:
@@ -2015,6 +2597,7 @@ int CBurningVideoDriver::VertexCache_reset(const void* vertices, u32 vertexCount
 		VertexCache.vType = (e4DVertexType)vType;
 		break;
 	}
+	VertexCache.vertexPitch = VertexCache.compact ? sizeof(S3DVertexCompact) : VertexCache.vSize[VertexCache.vType].Pitch;
 
 	//check material
 	SVSize* vSize = VertexCache.vSize;
@@ -2153,6 +2736,14 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 	size_t vertex_from_clipper; // from VertexCache or CurrentOut
 	size_t has_vertex_run;
 
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+	tile_begin(primitiveCount);
+#endif
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+	const bool hiz = hiz_begin();
+#endif
+	const bool guard_band = guard_band_begin();
+
 	for (size_t primitive_run = 0; primitive_run < primitiveCount; ++primitive_run)
 	{
 		//collect pointer to face vertices
@@ -2170,12 +2761,14 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			clipMask_o &= face[has_vertex_run]->flag; // if fully inside
 		}
 
+		const size_t guard_o = clipMask_o & VERTEX4D_GUARDBAND;
 		clipMask_i &= VERTEX4D_CLIPMASK;
 		clipMask_o &= VERTEX4D_CLIPMASK;
 
 		if (clipMask_i != VERTEX4D_INSIDE)
 		{
 			// if primitive fully outside or outside on same side
+			ClipPathCount[ECP_OUTSIDE] += 1;
 			continue;
 			vOut = 0;
 			vertex_from_clipper = 0;
@@ -2183,6 +2776,14 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		else if (clipMask_o == VERTEX4D_INSIDE)
 		{
 			// if primitive fully inside
+			ClipPathCount[ECP_INSIDE] += 1;
+			vOut = VertexCache.primitiveHasVertex;
+			vertex_from_clipper = 0;
+		}
+		else if (guard_band && guard_o)
+		{
+			// inside the guard band. vertices are projected, the shader cuts the scanlines to the viewport
+			ClipPathCount[ECP_GUARD_BAND] += 1;
 			vOut = VertexCache.primitiveHasVertex;
 			vertex_from_clipper = 0;
 		}
@@ -2190,6 +2791,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 #if defined(SOFTWARE_DRIVER_2_CLIPPING)
 		{
 			// else if not complete inside clipping necessary
+			ClipPathCount[ECP_CLIPPED] += 1;
 			// check: clipping should reuse vertexcache (try to minimize clipping)
 			for (has_vertex_run = 0; has_vertex_run < VertexCache.primitiveHasVertex; ++has_vertex_run)
 			{
@@ -2244,6 +2846,12 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			if (Material.CullFlag & sign)
 				break; //continue;
 
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+			// hidden behind already drawn geometry
+			if (hiz && hiz_reject(face[0] + s4DVertex_proj(0), face[1] + s4DVertex_proj(0), face[2] + s4DVertex_proj(0)))
+				continue;
+#endif
+
 			//select mipmap ratio between drawing space and texture space (for multiply divide here)
 			dc_area = reciprocal_zero(dc_area);
 
@@ -2275,12 +2883,30 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 				select_polygon_mipmap_inside(face, m, tex->getTexBound());
 			}
 			
-			CurrentShader->drawWireFrameTriangle(face[0] + s4DVertex_proj(0), face[1] + s4DVertex_proj(0), face[2] + s4DVertex_proj(0));
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+			if (TileActive)
+				tile_add(face, VertexCache.vSize[VertexCache.vType].TexSize);
+			else
+#endif
+			{
+				CurrentShader->drawWireFrameTriangle(face[0] + s4DVertex_proj(0), face[1] + s4DVertex_proj(0), face[2] + s4DVertex_proj(0));
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+				hiz_touch(face[0] + s4DVertex_proj(0), face[1] + s4DVertex_proj(0), face[2] + s4DVertex_proj(0), hiz);
+#endif
+			}
 			vertex_from_clipper = 1;
 		}
 
 	}
 
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+	if (TileActive)
+	{
+		tile_flush();
+		TileActive = false;
+	}
+#endif
+
 	//release texture
 	for (size_t m = 0; m < VertexCache.vSize[VertexCache.vType].TexSize; ++m)
 	{
@@ -2290,6 +2916,237 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 }
 
 
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+
+//! decide if the current draw call is rasterized by the tile binned rasterizer
+bool CBurningVideoDriver::tile_begin(u32 primitiveCount)
+{
+	TileActive = TilePool && CurrentShader &&
+		primitiveCount >= SOFTWARE_DRIVER_2_TILE_MIN_PRIMITIVES &&
+		CurrentShaderIndex < ETR2_COUNT && CurrentShaderIndex != ETR_TEXTURE_GOURAUD_WIRE &&
+		!Material.org.Wireframe && !Material.org.PointCloud;
+
+	TileTriangleCount = 0;
+	TileTexSize = 0;
+	return TileActive;
+}
+
+static inline bool tile_same_texture(const sInternalTexture& a, const sInternalTexture& b)
+{
+	return a.data == b.data && a.textureXMask == b.textureXMask && a.textureYMask == b.textureYMask &&
+		a.pitchlog2 == b.pitchlog2 && a.lodFactor == b.lodFactor && a.tiled == b.tiled;
+}
+
+//! record a projected triangle and the texture setup of CurrentShader. sort into the bands it covers
+void CBurningVideoDriver::tile_add(const s4DVertexPair* const face[], size_t texSize)
+{
+	if (TileTriangleCount >= SOFTWARE_DRIVER_2_TILE_TRIANGLE_MAX)
+		tile_flush();
+
+	const u32 tri = TileTriangleCount++;
+	TileTexSize = texSize;
+
+	// texture setup changes only on mipmap switch
+	u32 state = TileTexture.size();
+	if (texSize)
+	{
+		size_t m = 0;
+		if (state >= texSize)
+		{
+			state -= (u32)texSize;
+			for (m = 0; m < texSize; ++m)
+			{
+				if (!tile_same_texture(TileTexture[state + m], CurrentShader->getTextureParam(m)))
+					break;
+			}
+		}
+		if (m != texSize)
+		{
+			state = TileTexture.size();
+			for (m = 0; m < texSize; ++m)
+				TileTexture.push_back(CurrentShader->getTextureParam(m));
+		}
+	}
+	TileTriangleTexture.push_back(state);
+
+	s4DVertex* v = TileVertex.data + tri * 3;
+	for (size_t i = 0; i < 3; ++i)
+		memcpy((void*)(v + i), face[i] + s4DVertex_proj(0), sizeof(s4DVertex));
+
+	// covered bands
+	f32 y0 = v[0].Pos.y;
+	f32 y1 = v[0].Pos.y;
+	for (size_t i = 1; i < 3; ++i)
+	{
+		if (v[i].Pos.y < y0) y0 = v[i].Pos.y;
+		if (v[i].Pos.y > y1) y1 = v[i].Pos.y;
+	}
+	const s32 b0 = core::max_((s32)floorf(y0), 0) >> SOFTWARE_DRIVER_2_TILE_BAND_LOG2;
+	const s32 b1 = core::max_((s32)ceilf(y1), 0) >> SOFTWARE_DRIVER_2_TILE_BAND_LOG2;
+
+	if ((u32)(b1 - b0) + 1 >= TileGroupCount)
+	{
+		for (u32 g = 0; g < TileGroupCount; ++g)
+			TileBin[g].push_back(tri);
+	}
+	else
+	{
+		for (s32 b = b0; b <= b1; ++b)
+			TileBin[b % TileGroupCount].push_back(tri);
+	}
+}
+
+//! rasterize all recorded triangles. band groups run in parallel
+void CBurningVideoDriver::tile_flush()
+{
+	if (TileTriangleCount == 0)
+		return;
+
+	// shader instances per group get the state of CurrentShader. only their own scanlines pass
+	for (u32 g = 0; g < TileGroupCount; ++g)
+	{
+		IBurningShader*& shader = TileShader[g * ETR2_COUNT + CurrentShaderIndex];
+		if (!shader)
+			shader = createBurningShader(CurrentShaderIndex);
+
+		interlaced_control tile = Interlaced;
+		tile.tile_bypass = 0;
+		tile.tile_nr = g;
+		tile.tile_count = TileGroupCount;
+
+		shader->setRenderTarget(RenderTargetSurface, ViewPort, tile);
+		shader->OnSetMaterial(Material);
+		shader->copyRenderState(CurrentShader);
+	}
+
+	TilePool->parallelFor(&TileJob, TileGroupCount);
+
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+	const bool monotonic = hiz_enabled();
+	for (u32 tri = 0; tri < TileTriangleCount; ++tri)
+	{
+		const s4DVertex* v = TileVertex.data + tri * 3;
+		hiz_touch(v, v + 1, v + 2, monotonic);
+	}
+#endif
+
+	for (u32 g = 0; g < TileGroupCount; ++g)
+		TileBin[g].set_used(0);
+	TileTriangleTexture.set_used(0);
+	TileTexture.set_used(0);
+	TileTriangleCount = 0;
+}
+
+//! worker: rasterize the triangles of one band group in submission order
+void CBurningVideoDriver::tile_raster(u32 group)
+{
+	IBurningShader* shader = TileShader[group * ETR2_COUNT + CurrentShaderIndex];
+	const core::array<u32>& bin = TileBin[group];
+
+	u32 state = 0xFFFFFFFF;
+	for (u32 i = 0; i < bin.size(); ++i)
+	{
+		const u32 tri = bin[i];
+		if (TileTexSize && TileTriangleTexture[tri] != state)
+		{
+			state = TileTriangleTexture[tri];
+			for (size_t m = 0; m < TileTexSize; ++m)
+				shader->setTextureParamShared(m, TileTexture[state + m]);
+		}
+
+		const s4DVertex* v = TileVertex.data + tri * 3;
+		shader->drawWireFrameTriangle(v, v + 1, v + 2);
+	}
+}
+
+#endif // SOFTWARE_DRIVER_2_MULTITHREADED
+
+
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+
+//! true if the current shader passes only on w >= z and has no side effect on failed pixel
+bool CBurningVideoDriver::hiz_enabled() const
+{
+	if (!DepthBuffer || !CurrentShader || !Material.depth_test || Material.org.Wireframe || Material.org.PointCloud)
+		return false;
+
+	switch (CurrentShaderIndex)
+	{
+	case ETR_GOURAUD:
+	case ETR_TEXTURE_GOURAUD:
+	case ETR_TEXTURE_GOURAUD_ADD:
+	case ETR_TEXTURE_GOURAUD_VERTEX_ALPHA:
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_M1:
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_M2:
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_M4:
+	case ETR_TEXTURE_LIGHTMAP_M4:
+	case ETR_TEXTURE_GOURAUD_DETAIL_MAP:
+	case ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD:
+	case ETR_TEXTURE_GOURAUD_ALPHA:
+	case ETR_NORMAL_MAP_SOLID:
+	case ETR_TRANSPARENT_REFLECTION_2_LAYER:
+	case ETR_COLOR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//! tighten the tile bounds written by the previous draw calls. true if the current draw call is tested
+bool CBurningVideoDriver::hiz_begin()
+{
+	if (!hiz_enabled())
+		return false;
+
+	((CDepthBuffer*)DepthBuffer)->hiz_refresh();
+	return true;
+}
+
+//! conservative pixel bounds of a projected triangle
+static inline void hiz_bounds(s32 r[4], const s4DVertex* v0, const s4DVertex* v1, const s4DVertex* v2)
+{
+	r[0] = (s32)floorf(core::min_(v0->Pos.x, v1->Pos.x, v2->Pos.x));
+	r[1] = (s32)floorf(core::min_(v0->Pos.y, v1->Pos.y, v2->Pos.y));
+	r[2] = (s32)ceilf(core::max_(v0->Pos.x, v1->Pos.x, v2->Pos.x));
+	r[3] = (s32)ceilf(core::max_(v0->Pos.y, v1->Pos.y, v2->Pos.y));
+}
+
+//! true if the projected triangle is behind the depth bound of every tile it covers
+bool CBurningVideoDriver::hiz_reject(const s4DVertex* v0, const s4DVertex* v1, const s4DVertex* v2)
+{
+	s32 r[4];
+	hiz_bounds(r, v0, v1, v2);
+
+	// nearest w of the triangle, with some room for the interpolation error of the scanline
+	f32 w = core::max_(v0->Pos.w, v1->Pos.w, v2->Pos.w);
+	w += w * (1.f / 256.f);
+
+	return ((CDepthBuffer*)DepthBuffer)->hiz_reject(r[0], r[1], r[2], r[3], w);
+}
+
+//! mark the tile bounds below a drawn primitive. monotonic: primitive was drawn by a shader of hiz_enabled
+void CBurningVideoDriver::hiz_touch(const s4DVertex* v0, const s4DVertex* v1, const s4DVertex* v2, bool monotonic)
+{
+	if (!DepthBuffer)
+		return;
+
+	s32 r[4];
+	hiz_bounds(r, v0, v1, v2);
+	((CDepthBuffer*)DepthBuffer)->hiz_touch(r[0], r[1], r[2], r[3], monotonic);
+}
+
+#endif // SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+
+
+//! true if triangles of the current draw call may skip clipping against the x,y planes
+bool CBurningVideoDriver::guard_band_begin() const
+{
+	return GuardBand && CurrentShader && VertexCache.primitiveHasVertex == 3 &&
+		CurrentShaderIndex < ETR2_COUNT && CurrentShaderIndex != ETR_TEXTURE_GOURAUD_WIRE &&
+		!Material.org.Wireframe && !Material.org.PointCloud;
+}
+
+
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
 //! \param color: New color of the ambient light.
@@ -2631,6 +3488,7 @@ void CBurningVideoDriver::setMaterial(const SMaterial& material)
 	//shader = ETR_REFERENCE;
 
 	// switchToTriangleRenderer
+	CurrentShaderIndex = shader;
 	CurrentShader = BurningShader[shader];
 	if (CurrentShader)
 	{
@@ -2672,9 +3530,10 @@ void CBurningVideoDriver::lightVertex_eye(s4DVertex* dest, u32 vertexargb)
 {
 	//gl_FrontLightModelProduct.sceneColor = gl_FrontMaterial.emission + gl_FrontMaterial.ambient * gl_LightModel.ambient
 
-	sVec3Color ambient;
-	sVec3Color diffuse;
-	sVec3Color specular;
+	sVec3Color accu[3];
+	sVec3Color& ambient = accu[0];
+	sVec3Color& diffuse = accu[1];
+	sVec3Color& specular = accu[2];
 
 
 	// the universe started in darkness..
@@ -2809,6 +3668,16 @@ void CBurningVideoDriver::lightVertex_eye(s4DVertex* dest, u32 vertexargb)
 
 	}
 
+	lightVertex_sum(dest, vertexargb, accu);
+}
+
+//! material color from the ambient, diffuse and specular light sum
+void CBurningVideoDriver::lightVertex_sum(s4DVertex* dest, u32 vertexargb, const sVec3Color accu[3])
+{
+	const sVec3Color& ambient = accu[0];
+	const sVec3Color& diffuse = accu[1];
+	const sVec3Color& specular = accu[2];
+
 	// sum up lights
 	sVec3Color dColor;
 	dColor.set(0.f);
@@ -3060,6 +3929,15 @@ void CBurningVideoDriver::setRenderStates3DMode()
 	TransformationStack = 0;
 }
 
+//! Draws a mesh buffer with EVT_COMPACT vertices, which are decoded in the vertex cache
+void CBurningVideoDriver::drawCompactMeshBuffer(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount)
+{
+	VertexCache.compactBox = mb->getBoundingBox();
+	drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), indices, primitiveCount, EVT_COMPACT, mb->getPrimitiveType(), mb->getIndexType());
+	VertexCache.compactBox = core::aabbox3df(0.f, 0.f, 0.f, 1.f, 1.f, 1.f);
+}
+
+
 //! draws a vertex primitive list in 2d
 void CBurningVideoDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount,
 	const void* indexList, u32 primitiveCount,
@@ -3407,6 +4285,9 @@ void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	for (has_vertex_run = 0; (has_vertex_run + VertexCache.primitiveHasVertex) <= vOut; has_vertex_run += 1)
 	{
 		shader->drawLine(v + s4DVertex_proj(has_vertex_run), v + s4DVertex_proj(has_vertex_run+1));
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+		hiz_touch(v + s4DVertex_proj(has_vertex_run), v + s4DVertex_proj(has_vertex_run + 1), v + s4DVertex_proj(has_vertex_run + 1), false);
+#endif
 	}
 
 	shader->popEdgeTest();
@@ -3527,6 +4408,7 @@ ITexture* CBurningVideoDriver::createDeviceDependentTexture(const io::path& name
 		| ((TextureCreationFlags & ETCF_IMAGE_IS_LINEAR) ? CSoftwareTexture2::IMAGE_IS_LINEAR : 0)
 		| ((TextureCreationFlags & ETCF_TEXTURE_IS_LINEAR) ? CSoftwareTexture2::TEXTURE_IS_LINEAR : 0)
 #endif
+		| TextureLayoutFlags
 		;
 
 	CSoftwareTexture2* texture = new CSoftwareTexture2(image, name, flags, this);
@@ -3561,6 +4443,7 @@ void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector
 	Material.org.ZWriteEnable = video::EZW_OFF;
 	Material.org.ZBuffer = ECFN_LESS;
 
+	CurrentShaderIndex = ETR_STENCIL_SHADOW;
 	CurrentShader = BurningShader[ETR_STENCIL_SHADOW];
 
 	CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort, Interlaced);
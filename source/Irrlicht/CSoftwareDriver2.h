@@ -12,6 +12,7 @@
 #include "os.h"
 #include "irrString.h"
 #include "SIrrCreationParameters.h"
+#include "CThreadPool.h"
 
 
 namespace irr
@@ -256,6 +257,9 @@ namespace video
 		//pass BaseMaterialID
 		void setFallback_Material(E_MATERIAL_TYPE fallback_MaterialType);
 
+		//! eBurningCpuFeature usable by the shaders, none if SIrrlichtCreationParameters::BurningVideoSimd is false
+		size_t getCpuFeature() const { return CpuFeature; }
+
 		//! Return an index constant for the vertex shader based on a name.
 		virtual s32 getVertexShaderConstantID(const c8* name) _IRR_OVERRIDE_;
 		virtual bool setVertexShaderConstant(s32 index, const f32* floats, int count) _IRR_OVERRIDE_;
@@ -315,6 +319,9 @@ namespace video
 		virtual ITexture* createDeviceDependentTexture(const io::path& name, IImage* image) _IRR_OVERRIDE_;
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image) _IRR_OVERRIDE_;
 
+		//! decodes compact vertices while filling the vertex cache
+		virtual void drawCompactMeshBuffer(const scene::IMeshBuffer* mb, const void* indices, u32 primitiveCount) _IRR_OVERRIDE_;
+
 		video::CImage* BackBuffer;
 		video::IImagePresenter* Presenter;
 
@@ -328,10 +335,68 @@ namespace video
 
 		IBurningShader* CurrentShader;
 		IBurningShader* BurningShader[ETR2_COUNT];
+		size_t CurrentShaderIndex; //EBurningFFShader of CurrentShader
+		size_t CpuFeature; // eBurningCpuFeature, dispatch of batched vertex processing and span kernels
+		u32 TextureLayoutFlags; // CSoftwareTexture2::eTex2Flags added to all image textures
+
+		IBurningShader* createBurningShader(size_t shader);
+
+#if defined(SOFTWARE_DRIVER_2_MULTITHREADED)
+		// tile binned multithreaded rasterizer
+		// triangles are recorded in submission order and sorted into the horizontal bands they touch.
+		// every band group is rasterized by an own shader instance which only writes scanlines of its bands.
+		struct STileRasterJob : public IThreadPoolJob
+		{
+			CBurningVideoDriver* Driver;
+			virtual void runJob(u32 index, u32 worker) _IRR_OVERRIDE_ { Driver->tile_raster(index); }
+		};
+
+		bool tile_begin(u32 primitiveCount);
+		void tile_add(const s4DVertexPair* const face[], size_t texSize);
+		void tile_flush();
+		void tile_raster(u32 group);
+
+		CThreadPool* TilePool;
+		STileRasterJob TileJob;
+		u32 TileGroupCount;
+		bool TileActive;
+		core::array<IBurningShader*> TileShader; // [group][EBurningFFShader]
+		core::array< core::array<u32> > TileBin; // triangle index per group
+		SAligned4DVertex TileVertex; // 3 projected vertices per triangle
+		core::array<u32> TileTriangleTexture; // offset into TileTexture per triangle
+		core::array<sInternalTexture> TileTexture; // texture setup, texSize entries per used state
+		u32 TileTriangleCount;
+		size_t TileTexSize;
+#endif
 
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
 
+#if defined(SOFTWARE_DRIVER_2_HIERARCHICAL_Z)
+		// coarse depth test of whole triangles against the tile bounds of CDepthBuffer
+		bool hiz_enabled() const;
+		bool hiz_begin();
+		bool hiz_reject(const s4DVertex* v0, const s4DVertex* v1, const s4DVertex* v2);
+		void hiz_touch(const s4DVertex* v0, const s4DVertex* v1, const s4DVertex* v2, bool monotonic);
+#endif
+
+		// triangles inside the guard band are not clipped, the shaders cut their scanlines to the viewport
+		bool guard_band_begin() const;
+		u32 guard_band_test(const s4DVertex* v, u32 flag) const;
+		bool GuardBand; // SIrrlichtCreationParameters::BurningVideoGuardBand
+
+		// triangles per clip path since beginScene, published as driver attributes by endScene
+		enum E_CLIP_PATH
+		{
+			ECP_INSIDE = 0,
+			ECP_OUTSIDE,
+			ECP_GUARD_BAND,
+			ECP_CLIPPED,
+
+			ECP_COUNT
+		};
+		u32 ClipPathCount[ECP_COUNT];
+
 
 		/*
 			extend Matrix Stack
@@ -386,6 +451,10 @@ namespace video
 
 		void VertexCache_map_source_format();
 		void VertexCache_fill ( const u32 sourceIndex,const u32 destIndex );
+		void VertexCache_fill_attributes ( const S3DVertex* burning_restrict base, s4DVertex* burning_restrict dest, const sVec3Color* lightAccu );
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2)
+		void VertexCache_fill_batch ( const u32* sourceIndex, const u32* destIndex, const u32 count );
+#endif
 		s4DVertexPair* VertexCache_getVertex ( const u32 sourceIndex ) const;
 
 
@@ -404,6 +473,7 @@ namespace video
 
 #ifdef SOFTWARE_DRIVER_2_LIGHTING
 		void lightVertex_eye ( s4DVertex *dest, u32 vertexargb );
+		void lightVertex_sum ( s4DVertex *dest, u32 vertexargb, const sVec3Color accu[3] );
 #endif
 
 		//! Sets the fog mode.
@@ -51,7 +51,7 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 fl
 		, ETT_2D
 #endif
 	)
-	, MipMapLOD(0), Flags(flags), Driver(driver)
+	, MipMapLOD(0), Flags(flags), Driver(driver), TiledDirty(false)
 {
 #ifdef _DEBUG
 	setDebugName("CSoftwareTexture2");
@@ -69,6 +69,7 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 fl
 	MipMap0_Area[1] = 1;
 	LodBIAS = 1.f;
 	for (size_t i = 0; i < array_size(MipMap); ++i) MipMap[i] = 0;
+	for (size_t i = 0; i < array_size(Tiled); ++i) Tiled[i] = 0;
 	if (!image) return;
 
 	OriginalSize = image->getDimension();
@@ -170,6 +171,8 @@ CSoftwareTexture2::~CSoftwareTexture2()
 			MipMap[i]->drop();
 			MipMap[i] = 0;
 		}
+		delete[] Tiled[i];
+		Tiled[i] = 0;
 	}
 }
 
@@ -328,9 +331,52 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* data)
 		}
 	}
 
+	buildTiledLayout();
 	calcDerivative();
 }
 
+//! copy every mipmap level into 4x4 texel tiles, tile rows from top to bottom.
+//! matches the tiled addressing of the texel fetch helpers in SoftwareDriver2_helper.h
+void CSoftwareTexture2::buildTiledLayout()
+{
+	TiledDirty = false;
+	for (size_t i = 0; i < array_size(Tiled); ++i)
+	{
+		delete[] Tiled[i];
+		Tiled[i] = 0;
+
+		if (!(Flags & TILED_LAYOUT) || !MipMap[i])
+			continue;
+
+		//fetch wraps with power of two masks. levels smaller than a tile stay row major
+		const core::dimension2du& dim = MipMap[i]->getDimension();
+		if (dim.Width < 4 || dim.Height < 4 ||
+			(dim.Width & (dim.Width - 1)) || (dim.Height & (dim.Height - 1)) ||
+			MipMap[i]->getPitch() != dim.Width * sizeof(tVideoSample))
+			continue;
+
+		Tiled[i] = new u8[dim.Height * MipMap[i]->getPitch()];
+
+		const tVideoSample* src = (const tVideoSample*)MipMap[i]->getData();
+		tVideoSample* dst = (tVideoSample*)Tiled[i];
+		for (u32 y = 0; y < dim.Height; y += 4)
+		{
+			for (u32 x = 0; x < dim.Width; x += 4)
+			{
+				for (u32 row = 0; row < 4; ++row)
+				{
+					const tVideoSample* s = src + (y + row) * dim.Width + x;
+					dst[0] = s[0];
+					dst[1] = s[1];
+					dst[2] = s[2];
+					dst[3] = s[3];
+					dst += 4;
+				}
+			}
+		}
+	}
+}
+
 void CSoftwareTexture2::calcDerivative()
 {
 	//reset current MipMap
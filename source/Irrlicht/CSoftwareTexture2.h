@@ -46,6 +46,7 @@ public:
 		ALLOW_NPOT			= 8,		//allow non power of two
 		IMAGE_IS_LINEAR		= 16,
 		TEXTURE_IS_LINEAR	= 32,
+		TILED_LAYOUT		= 64,		// keep a 4x4 texel tiled copy of the mipmaps for sampling
 	};
 	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags /*eTex2Flags*/, CBurningVideoDriver* driver);
 
@@ -75,6 +76,8 @@ public:
 			Size = MipMap[MipMapLOD]->getDimension();
 			Pitch = MipMap[MipMapLOD]->getPitch();
 		}
+		if (mode != ETLM_READ_ONLY)
+			TiledDirty = true;
 
 		return MipMap[MipMapLOD]->getData();
 	}
@@ -82,6 +85,15 @@ public:
 	//! unlock function
 	virtual void unlock() _IRR_OVERRIDE_
 	{
+		//caller may have written to the row major level
+		if (TiledDirty)
+			buildTiledLayout();
+	}
+
+	//! mipmap level in 4x4 texel tiles. 0 if the level is sampled row major
+	const void* getTiledData(u32 level) const
+	{
+		return level < array_size(Tiled) ? Tiled[level] : 0;
 	}
 /*
 	//! compare the area drawn with the area of the texture
@@ -145,6 +157,7 @@ public:
 
 private:
 	void calcDerivative();
+	void buildTiledLayout();
 
 	//! controls MipmapSelection. relation between drawn area and image size
 	u32 MipMapLOD; // 0 .. original Texture pot -SOFTWARE_DRIVER_2_MIPMAPPING_MAX
@@ -152,6 +165,8 @@ private:
 	CBurningVideoDriver* Driver;
 
 	CImage* MipMap[SOFTWARE_DRIVER_2_MIPMAPPING_MAX];
+	u8* Tiled[SOFTWARE_DRIVER_2_MIPMAPPING_MAX]; // TILED_LAYOUT copy of MipMap
+	bool TiledDirty;
 	CSoftwareTexture2_Bound TexBound[SOFTWARE_DRIVER_2_MIPMAPPING_MAX];
 	u32 MipMap0_Area[2];
 	f32 LodBIAS;	// Tweak mipmap selection
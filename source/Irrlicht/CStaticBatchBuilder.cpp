@@ -0,0 +1,224 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CStaticBatchBuilder.h"
+#include "IMeshSceneNode.h"
+#include "CMeshBuffer.h"
+#include "SMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! the grid cell is packed into the key with 21 bits per axis
+	inline u64 getCellKey(s32 x, s32 y, s32 z)
+	{
+		const u64 mask = 0x1FFFFF;
+		const s32 offset = 1 << 20;
+		return (((u64)(x + offset) & mask) << 42) |
+			(((u64)(y + offset) & mask) << 21) |
+			((u64)(z + offset) & mask);
+	}
+
+	inline void transformVertex(video::S3DVertex& v, const core::matrix4& m, const core::matrix4& normalMatrix)
+	{
+		m.transformVect(v.Pos);
+		normalMatrix.rotateVect(v.Normal);
+		v.Normal.normalize();
+	}
+
+	inline void transformVertex(video::S3DVertexTangents& v, const core::matrix4& m, const core::matrix4& normalMatrix)
+	{
+		transformVertex((video::S3DVertex&)v, m, normalMatrix);
+		m.rotateVect(v.Tangent);
+		v.Tangent.normalize();
+		m.rotateVect(v.Binormal);
+		v.Binormal.normalize();
+	}
+
+	//! appends src transformed by m to dst
+	template <class T>
+	void appendTransformed(CMeshBuffer<T>* dst, const IMeshBuffer* src,
+		const core::matrix4& m, const core::matrix4& normalMatrix)
+	{
+		const T* vertices = (const T*)src->getVertices();
+		const u16* indices = src->getIndices();
+		const u32 vertexCount = src->getVertexCount();
+		const u32 indexCount = src->getIndexCount();
+		const u32 base = dst->Vertices.size();
+
+		dst->Vertices.reallocate(base + vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			T v = vertices[i];
+			transformVertex(v, m, normalMatrix);
+			if (dst->Vertices.empty())
+				dst->BoundingBox.reset(v.Pos);
+			else
+				dst->BoundingBox.addInternalPoint(v.Pos);
+			dst->Vertices.push_back(v);
+		}
+
+		dst->Indices.reallocate(dst->Indices.size() + indexCount);
+		for (u32 i=0; i<indexCount; ++i)
+			dst->Indices.push_back((u16)(indices[i] + base));
+	}
+}
+
+
+//! constructor
+CStaticBatchBuilder::CStaticBatchBuilder(f32 chunkSize, ISceneNode* target)
+	: TargetInverse(getAbsoluteTransformation(target), core::matrix4::EM4CONST_INVERSE),
+	ChunkSize(chunkSize > 0.f ? chunkSize : 1.f)
+{
+}
+
+
+//! destructor
+CStaticBatchBuilder::~CStaticBatchBuilder()
+{
+	for (u32 i=0; i<Chunks.size(); ++i)
+		Chunks[i]->drop();
+}
+
+
+//! Merges the buffers of the node.
+bool CStaticBatchBuilder::addNode(IMeshSceneNode* node)
+{
+	// the node is hidden afterwards, which would hide the children as well
+	if (!node || !node->isTrulyVisible() || !node->getChildren().empty() ||
+		!node->getAnimators().empty())
+		return false;
+
+	IMesh* mesh = node->getMesh();
+	if (!mesh || mesh->getMeshBufferCount() == 0)
+		return false;
+
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		if (!isMergeable(mesh->getMeshBuffer(i)))
+			return false;
+	}
+
+	const core::matrix4 absolute = getAbsoluteTransformation(node);
+	const core::matrix4 m = TargetInverse * absolute;
+	const core::matrix4 normalMatrix(m, core::matrix4::EM4CONST_INVERSE_TRANSPOSED);
+
+	// the whole node goes to one chunk, which keeps its buffers together
+	core::aabbox3df box = mesh->getBoundingBox();
+	absolute.transformBoxEx(box);
+	SMesh* chunk = getChunk(box.getCenter());
+
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		if (mb->getVertexCount() == 0)
+			continue;
+
+		const video::SMaterial& material = i < node->getMaterialCount() ? node->getMaterial(i) : mb->getMaterial();
+
+		// find a buffer of the chunk with the same material which can still be indexed with 16 bit
+		IMeshBuffer* dst = 0;
+		for (s32 b=(s32)chunk->getMeshBufferCount()-1; b>=0; --b)
+		{
+			IMeshBuffer* candidate = chunk->getMeshBuffer(b);
+			if (candidate->getVertexType() == mb->getVertexType() &&
+				candidate->getVertexCount() + mb->getVertexCount() <= 65536 &&
+				candidate->getMaterial() == material)
+			{
+				dst = candidate;
+				break;
+			}
+		}
+
+		if (!dst)
+		{
+			switch (mb->getVertexType())
+			{
+			case video::EVT_2TCOORDS:
+				dst = new SMeshBufferLightMap();
+				break;
+			case video::EVT_TANGENTS:
+				dst = new SMeshBufferTangents();
+				break;
+			default:
+				dst = new SMeshBuffer();
+				break;
+			}
+			dst->getMaterial() = material;
+			dst->setHardwareMappingHint(EHM_STATIC);
+			chunk->addMeshBuffer(dst);
+			dst->drop();
+		}
+
+		switch (mb->getVertexType())
+		{
+		case video::EVT_2TCOORDS:
+			appendTransformed((SMeshBufferLightMap*)dst, mb, m, normalMatrix);
+			break;
+		case video::EVT_TANGENTS:
+			appendTransformed((SMeshBufferTangents*)dst, mb, m, normalMatrix);
+			break;
+		default:
+			appendTransformed((SMeshBuffer*)dst, mb, m, normalMatrix);
+			break;
+		}
+		dst->setDirty();
+	}
+
+	chunk->recalculateBoundingBox();
+	return true;
+}
+
+
+//! true if the buffer can be appended to a merged buffer
+bool CStaticBatchBuilder::isMergeable(const IMeshBuffer* mb) const
+{
+	if (!mb || mb->getIndexType() != video::EIT_16BIT ||
+		mb->getPrimitiveType() != EPT_TRIANGLES || mb->getVertexCount() > 65536)
+		return false;
+
+	switch (mb->getVertexType())
+	{
+	case video::EVT_STANDARD:
+	case video::EVT_2TCOORDS:
+	case video::EVT_TANGENTS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+//! returns the chunk of the cell, creates it if needed
+SMesh* CStaticBatchBuilder::getChunk(const core::vector3df& worldPos)
+{
+	const u64 key = getCellKey(core::floor32(worldPos.X / ChunkSize),
+		core::floor32(worldPos.Y / ChunkSize), core::floor32(worldPos.Z / ChunkSize));
+
+	core::map<u64, u32>::Node* node = ChunkIndex.find(key);
+	if (node)
+		return Chunks[node->getValue()];
+
+	ChunkIndex.insert(key, Chunks.size());
+	Chunks.push_back(new SMesh());
+	return Chunks.getLast();
+}
+
+
+//! absolute transformation, also for nodes which were never rendered
+core::matrix4 CStaticBatchBuilder::getAbsoluteTransformation(const ISceneNode* node)
+{
+	core::matrix4 m;
+	for (; node; node = node->getParent())
+		m = node->getRelativeTransformation() * m;
+	return m;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,76 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_STATIC_BATCH_BUILDER_H_INCLUDED__
+#define __C_STATIC_BATCH_BUILDER_H_INCLUDED__
+
+#include "irrArray.h"
+#include "irrMap.h"
+#include "matrix4.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMeshBuffer;
+	class IMeshSceneNode;
+	class ISceneNode;
+	struct SMesh;
+
+	//! Merges the mesh buffers of static mesh scene nodes.
+	/** Buffers with equal material and vertex type whose nodes lie in the
+	same cube of the chunk grid are appended to one buffer, transformed into
+	the space of the node which will draw the chunks. Used by
+	CSceneManager::addStaticBatchSceneNode. */
+	class CStaticBatchBuilder
+	{
+	public:
+
+		//! constructor
+		/** \param chunkSize Edge length of the grid cubes in world space.
+		\param target Node the chunks will be attached to. */
+		CStaticBatchBuilder(f32 chunkSize, ISceneNode* target);
+
+		//! destructor
+		~CStaticBatchBuilder();
+
+		//! Merges the buffers of the node.
+		/** \return False if the node was skipped because it can't be
+		hidden without side effects or has a buffer which can't be merged. */
+		bool addNode(IMeshSceneNode* node);
+
+		//! Number of chunks which received buffers
+		u32 getChunkCount() const
+		{
+			return Chunks.size();
+		}
+
+		//! Mesh with the merged buffers of a chunk, valid until the builder is destroyed
+		SMesh* getChunkMesh(u32 chunk) const
+		{
+			return Chunks[chunk];
+		}
+
+	private:
+
+		//! true if the buffer can be appended to a merged buffer
+		bool isMergeable(const IMeshBuffer* mb) const;
+
+		//! returns the chunk of the cell, creates it if needed
+		SMesh* getChunk(const core::vector3df& worldPos);
+
+		//! absolute transformation, also for nodes which were never rendered
+		static core::matrix4 getAbsoluteTransformation(const ISceneNode* node);
+
+		core::matrix4 TargetInverse;
+		f32 ChunkSize;
+
+		core::array<SMesh*> Chunks;
+		core::map<u64, u32> ChunkIndex;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
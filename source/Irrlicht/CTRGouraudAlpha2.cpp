@@ -141,6 +141,7 @@ void CTRGouraudAlpha2::fragmentShader()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -361,6 +362,7 @@ void CTRGouraudAlpha2::drawTriangle(const s4DVertex* burning_restrict a, const s
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -520,6 +522,7 @@ void CTRGouraudAlpha2::drawTriangle(const s4DVertex* burning_restrict a, const s
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - b->Pos.y;
@@ -4,6 +4,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IBurningShader.h"
+#include "burning_shader_simd.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -23,6 +24,7 @@
 #undef IPOL_C0
 #undef IPOL_T0
 #undef IPOL_T1
+#undef SPAN_SSE2
 
 // define render case
 #define SUBTEXEL
@@ -68,6 +70,11 @@
 
 #endif
 
+// 4 pixel kernel for the default render case
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2) && defined(CMP_W) && defined(INVERSE_W) && \
+	defined(IPOL_C0) && defined(IPOL_T0)
+	#define SPAN_SSE2
+#endif
 
 
 namespace irr
@@ -101,6 +108,11 @@ private:
 	void fragment_src_alpha_one();
 	void fragment_src_alpha_one_minus_src_alpha();
 
+#ifdef SPAN_SSE2
+	s32 fragment_src_alpha_one_minus_src_alpha_sse2(tVideoSample* burning_restrict dst, const fp24* burning_restrict z, const s32 dx,
+		const fp24 slopeW, const sVec4& slopeC, const sVec2& slopeT);
+#endif
+
 	tFragmentShader fragmentShader;
 
 	E_COMPARISON_FUNC depth_func;
@@ -246,6 +258,7 @@ void CTRTextureBlend::fragment_dst_color_src_alpha ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -432,6 +445,7 @@ void CTRTextureBlend::fragment_src_color_src_alpha ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 	if ( dx < 0 )
@@ -626,6 +640,7 @@ void CTRTextureBlend::fragment_one_one_minus_src_alpha()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -827,6 +842,7 @@ void CTRTextureBlend::fragment_one_minus_dst_alpha_one ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -1027,6 +1043,7 @@ void CTRTextureBlend::fragment_src_alpha_one ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -1258,6 +1275,7 @@ void CTRTextureBlend::fragment_src_alpha_one_minus_src_alpha()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left(line.x[0]);
 	xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 	if (dx < 0)
@@ -1321,7 +1339,13 @@ void CTRTextureBlend::fragment_src_alpha_one_minus_src_alpha()
 	{
 	default:
 	case ECFN_LESSEQUAL:
-		for (i = 0; i <= dx; i += SOFTWARE_DRIVER_2_STEP_X)
+		i = 0;
+#ifdef SPAN_SSE2
+		// vector kernel blends multiple of 4 pixel, the remaining pixel are done below
+		if (CpuFeature & CPU_FEATURE_SSE2)
+			i = fragment_src_alpha_one_minus_src_alpha_sse2(dst, z, dx, slopeW, slopeC[0], slopeT[0]);
+#endif
+		for (; i <= dx; i += SOFTWARE_DRIVER_2_STEP_X)
 		{
 #ifdef CMP_W
 			if (line.w[0] >= z[i])
@@ -1376,6 +1400,82 @@ void CTRTextureBlend::fragment_src_alpha_one_minus_src_alpha()
 }
 
 
+#ifdef SPAN_SSE2
+/*!
+	same as the scalar loop of fragment_src_alpha_one_minus_src_alpha, 4 pixel per iteration
+	returns the first pixel not blended
+*/
+s32 CTRTextureBlend::fragment_src_alpha_one_minus_src_alpha_sse2(tVideoSample* burning_restrict dst, const fp24* burning_restrict z, const s32 dx,
+	const fp24 slopeW, const sVec4& slopeC, const sVec2& slopeT)
+{
+	sIpol4 ipolW;
+	sIpol4 ipolC[4];
+	sIpol4 ipolT[2];
+
+	ipol4_setup(ipolW, slopeW);
+	ipol4_setup(ipolC[0], slopeC.a);
+	ipol4_setup(ipolC[1], slopeC.r);
+	ipol4_setup(ipolC[2], slopeC.g);
+	ipol4_setup(ipolC[3], slopeC.b);
+	ipol4_setup(ipolT[0], slopeT.x);
+	ipol4_setup(ipolT[1], slopeT.y);
+
+	const __m128 fix_mul = _mm_set1_ps(FIX_POINT_F32_MUL);
+	const __m128i alpha_ref = _mm_set1_epi32(AlphaRef);
+	const __m128i one = _mm_set1_epi32(1);
+
+	sVec4& c0 = line.c[0][0];
+	sVec2& t0 = line.t[0][0];
+
+	s32 i;
+	for (i = 0; i + 3 <= dx; i += 4)
+	{
+		const __m128 w = ipol4_next(line.w[0], ipolW);
+		const __m128 tx = ipol4_next(t0.x, ipolT[0]);
+		const __m128 ty = ipol4_next(t0.y, ipolT[1]);
+		ipol4_skip(c0.a, ipolC[0]);
+		const __m128 c0r = ipol4_next(c0.r, ipolC[1]);
+		const __m128 c0g = ipol4_next(c0.g, ipolC[2]);
+		const __m128 c0b = ipol4_next(c0.b, ipolC[3]);
+
+		// w-buffer, not written by transparent pixel
+		__m128i pass = _mm_castps_si128(_mm_cmpge_ps(w, _mm_loadu_ps(z + i)));
+		if (0 == _mm_movemask_epi8(pass))
+			continue;
+
+		const __m128 iw = _mm_div_ps(fix_mul, w);
+
+		__m128i a0, r0, g0, b0;
+		getSample_texture4(a0, r0, g0, b0, &IT[0], tofix4(tx, iw), tofix4(ty, iw));
+
+		pass = _mm_and_si128(pass, _mm_cmpgt_epi32(a0, alpha_ref));
+		if (0 == _mm_movemask_epi8(pass))
+			continue;
+
+		r0 = imulFix4(r0, tofix4(c0r, iw));
+		g0 = imulFix4(g0, tofix4(c0g, iw));
+		b0 = imulFix4(b0, tofix4(c0b, iw));
+
+		__m128i* d = (__m128i*)(dst + i);
+		const __m128i dst4 = _mm_loadu_si128(d);
+		__m128i r1, g1, b1;
+		color_to_fix4(r1, g1, b1, dst4);
+
+		//fix_color_norm
+		a0 = _mm_srai_epi32(_mm_add_epi32(a0, one), COLOR_MAX_LOG2);
+
+		const __m128i r2 = _mm_add_epi32(r1, imulFix4(a0, _mm_sub_epi32(r0, r1)));
+		const __m128i g2 = _mm_add_epi32(g1, imulFix4(a0, _mm_sub_epi32(g0, g1)));
+		const __m128i b2 = _mm_add_epi32(b1, imulFix4(a0, _mm_sub_epi32(b0, b1)));
+
+		_mm_storeu_si128(d, select4(pass, fix4_to_sample4(a0, r2, g2, b2), dst4));
+	}
+
+	return i;
+}
+#endif
+
+
 /*!
 */
 void CTRTextureBlend::fragment_dst_color_one_minus_dst_alpha ()
@@ -1411,6 +1511,7 @@ void CTRTextureBlend::fragment_dst_color_one_minus_dst_alpha ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -1610,6 +1711,7 @@ void CTRTextureBlend::fragment_dst_color_zero ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -1807,6 +1909,7 @@ void CTRTextureBlend::fragment_dst_color_one ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -2007,6 +2110,7 @@ void CTRTextureBlend::fragment_zero_one_minus_scr_color ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -2276,6 +2380,7 @@ void CTRTextureBlend::drawTriangle(const s4DVertex* burning_restrict a, const s4
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -2435,6 +2540,7 @@ void CTRTextureBlend::drawTriangle(const s4DVertex* burning_restrict a, const s4
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - b->Pos.y;
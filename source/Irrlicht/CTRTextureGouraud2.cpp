@@ -4,6 +4,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IBurningShader.h"
+#include "burning_shader_simd.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -26,6 +27,7 @@
 #undef IPOL_T0
 #undef IPOL_T1
 #undef IPOL_L0
+#undef SPAN_SSE2
 
 // define render case
 #define SUBTEXEL
@@ -87,6 +89,12 @@
 
 #endif
 
+// 4 pixel kernel for the default render case
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2) && defined(CMP_W) && defined(WRITE_W) && defined(INVERSE_W) && \
+	defined(IPOL_C0) && defined(IPOL_C1) && defined(IPOL_T0)
+	#define SPAN_SSE2
+#endif
+
 
 namespace irr
 {
@@ -108,6 +116,11 @@ public:
 
 private:
 	void fragmentShader ();
+
+#ifdef SPAN_SSE2
+	s32 fragment_span_sse2(tVideoSample* burning_restrict dst, fp24* burning_restrict z, const s32 dx,
+		const fp24 slopeW, const sVec4* slopeC, const sVec2& slopeT);
+#endif
 };
 
 //! constructor
@@ -160,6 +173,7 @@ void CTRTextureGouraud2::fragmentShader ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -254,7 +268,15 @@ void CTRTextureGouraud2::fragmentShader ()
 	u32 dIndex = ( line.y & 3 ) << 2;
 #endif
 
-	for ( s32 i = 0; i <= dx; i += SOFTWARE_DRIVER_2_STEP_X)
+	s32 i = 0;
+
+#ifdef SPAN_SSE2
+	// vector kernel shades multiple of 4 pixel, the remaining pixel are done below
+	if ((CpuFeature & CPU_FEATURE_SSE2) && (EdgeTestPass & edge_test_pass))
+		i = fragment_span_sse2(dst, z, dx, slopeW, slopeC, slopeT[0]);
+#endif
+
+	for ( ; i <= dx; i += SOFTWARE_DRIVER_2_STEP_X)
 	{
 		//if test active only first pixel
 		if ((0 == EdgeTestPass) & (i > line.x_edgetest)) break;
@@ -278,68 +300,68 @@ void CTRTextureGouraud2::fragmentShader ()
 #endif
 
 #ifdef IPOL_C1
-			//complete inside fog
+			//complete inside fog, the interpolation still advances below
 			if (TL_Flag & TL_FOG)
-			{
 				aFog = tofix(line.c[1][0].a, inversew);
-				if (aFog <= 0)
-				{
-					dst[i] = fog_color_sample;
-					continue;
-				}
+			if ((TL_Flag & TL_FOG) && aFog <= 0)
+			{
+				dst[i] = fog_color_sample;
 			}
+			else
 #endif
-			tx0 = tofix ( line.t[0][0].x, inversew);
-			ty0 = tofix ( line.t[0][0].y, inversew);
+			{
+				tx0 = tofix ( line.t[0][0].x, inversew);
+				ty0 = tofix ( line.t[0][0].y, inversew);
 
 
 #ifdef IPOL_C0
 
-			getSample_texture(r0, g0, b0, &IT[0], tx0, ty0);
-			vec4_to_fix(r1, g1, b1, line.c[0][0], inversew);
+				getSample_texture(r0, g0, b0, &IT[0], tx0, ty0);
+				vec4_to_fix(r1, g1, b1, line.c[0][0], inversew);
 
-			r0 = imulFix_simple(r0, r1);
-			g0 = imulFix_simple(g0, g1);
-			b0 = imulFix_simple(b0, b1);
+				r0 = imulFix_simple(r0, r1);
+				g0 = imulFix_simple(g0, g1);
+				b0 = imulFix_simple(b0, b1);
 
 #ifdef IPOL_C1
 
-			//specular highlight
-			if (TL_Flag & TL_SPECULAR)
-			{
-				vec4_to_fix(r1, g1, b1, line.c[1][0], inversew*COLOR_MAX);
-				r0 = clampfix_maxcolor(r1 + r0);
-				g0 = clampfix_maxcolor(g1 + g0);
-				b0 = clampfix_maxcolor(b1 + b0);
-			}
-			//mix with distance
-			if (aFog < FIX_POINT_ONE)
-			{
-				r0 = fog_color[1] + imulFix(aFog, r0 - fog_color[1]);
-				g0 = fog_color[2] + imulFix(aFog, g0 - fog_color[2]);
-				b0 = fog_color[3] + imulFix(aFog, b0 - fog_color[3]);
-			}
-			dst[i] = fix_to_sample(r0, g0, b0);
+				//specular highlight
+				if (TL_Flag & TL_SPECULAR)
+				{
+					vec4_to_fix(r1, g1, b1, line.c[1][0], inversew*COLOR_MAX);
+					r0 = clampfix_maxcolor(r1 + r0);
+					g0 = clampfix_maxcolor(g1 + g0);
+					b0 = clampfix_maxcolor(b1 + b0);
+				}
+				//mix with distance
+				if (aFog < FIX_POINT_ONE)
+				{
+					r0 = fog_color[1] + imulFix(aFog, r0 - fog_color[1]);
+					g0 = fog_color[2] + imulFix(aFog, g0 - fog_color[2]);
+					b0 = fog_color[3] + imulFix(aFog, b0 - fog_color[3]);
+				}
+				dst[i] = fix_to_sample(r0, g0, b0);
 
 #else
-			dst[i] = fix_to_sample(
-				imulFix_simple(r0, r1),
-				imulFix_simple(g0, g1),
-				imulFix_simple(b0, b1)
-			);
+				dst[i] = fix_to_sample(
+					imulFix_simple(r0, r1),
+					imulFix_simple(g0, g1),
+					imulFix_simple(b0, b1)
+				);
 #endif
 
 #else
 
 #if defined(BURNINGVIDEO_RENDERER_FAST) && COLOR_MAX==0xff
-			const tFixPointu d = dithermask [ dIndex | ( i ) & 3 ];
-			dst[i] = getTexel_plain ( &IT[0], d + tx0, d + ty0 );
+				const tFixPointu d = dithermask [ dIndex | ( i ) & 3 ];
+				dst[i] = getTexel_plain ( &IT[0], d + tx0, d + ty0 );
 #else
-			getSample_texture ( r0, g0, b0, &IT[0], tx0,ty0 );
-			dst[i] = fix_to_sample( r0, g0, b0 );
+				getSample_texture ( r0, g0, b0, &IT[0], tx0,ty0 );
+				dst[i] = fix_to_sample( r0, g0, b0 );
 #endif
 
 #endif
+			}
 
 		}
 
@@ -371,6 +393,122 @@ void CTRTextureGouraud2::fragmentShader ()
 
 }
 
+#ifdef SPAN_SSE2
+/*!
+	same as the scalar loop of fragmentShader, 4 pixel per iteration
+	returns the first pixel not shaded
+*/
+s32 CTRTextureGouraud2::fragment_span_sse2(tVideoSample* burning_restrict dst, fp24* burning_restrict z, const s32 dx,
+	const fp24 slopeW, const sVec4* slopeC, const sVec2& slopeT)
+{
+	sIpol4 ipolW;
+	sIpol4 ipolC0[3];
+	sIpol4 ipolC1[4];
+	sIpol4 ipolT0[2];
+
+	ipol4_setup(ipolW, slopeW);
+	ipol4_setup(ipolC0[0], slopeC[0].r);
+	ipol4_setup(ipolC0[1], slopeC[0].g);
+	ipol4_setup(ipolC0[2], slopeC[0].b);
+	ipol4_setup(ipolC1[0], slopeC[1].a);
+	ipol4_setup(ipolC1[1], slopeC[1].r);
+	ipol4_setup(ipolC1[2], slopeC[1].g);
+	ipol4_setup(ipolC1[3], slopeC[1].b);
+	ipol4_setup(ipolT0[0], slopeT.x);
+	ipol4_setup(ipolT0[1], slopeT.y);
+
+	const size_t fog = TL_Flag & TL_FOG;
+	const size_t specular = TL_Flag & TL_SPECULAR;
+
+	const __m128 fix_mul = _mm_set1_ps(FIX_POINT_F32_MUL);
+	const __m128 color_max = _mm_set1_ps((f32)COLOR_MAX);
+	const __m128i fix_one = _mm_set1_epi32(FIX_POINT_ONE);
+	const __m128i fog_r = _mm_set1_epi32(fog_color[1]);
+	const __m128i fog_g = _mm_set1_epi32(fog_color[2]);
+	const __m128i fog_b = _mm_set1_epi32(fog_color[3]);
+	const __m128i fog_sample = _mm_set1_epi32((s32)fog_color_sample);
+
+	sVec4& c0 = line.c[0][0];
+	sVec4& c1 = line.c[1][0];
+	sVec2& t0 = line.t[0][0];
+
+	s32 i;
+	for (i = 0; i + 3 <= dx; i += 4)
+	{
+		const __m128 w = ipol4_next(line.w[0], ipolW);
+		const __m128 c0r = ipol4_next(c0.r, ipolC0[0]);
+		const __m128 c0g = ipol4_next(c0.g, ipolC0[1]);
+		const __m128 c0b = ipol4_next(c0.b, ipolC0[2]);
+		const __m128 tx = ipol4_next(t0.x, ipolT0[0]);
+		const __m128 ty = ipol4_next(t0.y, ipolT0[1]);
+
+		__m128 c1a = _mm_setzero_ps();
+		__m128 c1r = _mm_setzero_ps();
+		__m128 c1g = _mm_setzero_ps();
+		__m128 c1b = _mm_setzero_ps();
+		if (fog) c1a = ipol4_next(c1.a, ipolC1[0]); else ipol4_skip(c1.a, ipolC1[0]);
+		if (specular)
+		{
+			c1r = ipol4_next(c1.r, ipolC1[1]);
+			c1g = ipol4_next(c1.g, ipolC1[2]);
+			c1b = ipol4_next(c1.b, ipolC1[3]);
+		}
+		else
+		{
+			ipol4_skip(c1.r, ipolC1[1]);
+			ipol4_skip(c1.g, ipolC1[2]);
+			ipol4_skip(c1.b, ipolC1[3]);
+		}
+
+		// w-buffer
+		const __m128 zOld = _mm_loadu_ps(z + i);
+		const __m128 pass = _mm_cmpge_ps(w, zOld);
+		if (0 == _mm_movemask_ps(pass))
+			continue;
+		_mm_storeu_ps(z + i, _mm_or_ps(_mm_and_ps(pass, w), _mm_andnot_ps(pass, zOld)));
+
+		const __m128 inversew = _mm_div_ps(fix_mul, w);
+
+		__m128i r0, g0, b0;
+		getSample_texture4(r0, g0, b0, &IT[0], tofix4(tx, inversew), tofix4(ty, inversew));
+
+		r0 = imulFix4(r0, tofix4(c0r, inversew));
+		g0 = imulFix4(g0, tofix4(c0g, inversew));
+		b0 = imulFix4(b0, tofix4(c0b, inversew));
+
+		//specular highlight
+		if (specular)
+		{
+			const __m128 mulby = _mm_mul_ps(inversew, color_max);
+			r0 = clampfix_maxcolor4(_mm_add_epi32(tofix4(c1r, mulby), r0));
+			g0 = clampfix_maxcolor4(_mm_add_epi32(tofix4(c1g, mulby), g0));
+			b0 = clampfix_maxcolor4(_mm_add_epi32(tofix4(c1b, mulby), b0));
+		}
+
+		__m128i color;
+		if (fog)
+		{
+			//mix with distance, complete inside fog
+			const __m128i aFog = tofix4(c1a, inversew);
+			const __m128i mix = _mm_cmplt_epi32(aFog, fix_one);
+			r0 = select4(mix, _mm_add_epi32(fog_r, imulFix4(aFog, _mm_sub_epi32(r0, fog_r))), r0);
+			g0 = select4(mix, _mm_add_epi32(fog_g, imulFix4(aFog, _mm_sub_epi32(g0, fog_g))), g0);
+			b0 = select4(mix, _mm_add_epi32(fog_b, imulFix4(aFog, _mm_sub_epi32(b0, fog_b))), b0);
+			color = select4(_mm_cmplt_epi32(aFog, _mm_set1_epi32(1)), fog_sample, fix_to_sample4(r0, g0, b0));
+		}
+		else
+		{
+			color = fix_to_sample4(r0, g0, b0);
+		}
+
+		__m128i* d = (__m128i*)(dst + i);
+		_mm_storeu_si128(d, select4(_mm_castps_si128(pass), color, _mm_loadu_si128(d)));
+	}
+
+	return i;
+}
+#endif
+
 void CTRTextureGouraud2::drawTriangle(const s4DVertex* burning_restrict a, const s4DVertex* burning_restrict b, const s4DVertex* burning_restrict c)
 {
 	// sort on height, y
@@ -502,6 +640,7 @@ void CTRTextureGouraud2::drawTriangle(const s4DVertex* burning_restrict a, const
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -733,6 +872,7 @@ void CTRTextureGouraud2::drawTriangle(const s4DVertex* burning_restrict a, const
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - b->Pos.y;
@@ -177,6 +177,7 @@ void CTRTextureGouraudAlphaNoZ::fragment_linear()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -397,6 +398,7 @@ void CTRTextureGouraudAlphaNoZ::fragment_linear_test()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left(line.x[0]);
 	xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -618,6 +620,7 @@ void CTRTextureGouraudAlphaNoZ::fragment_point_noz()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left(line.x[0]);
 	xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -913,6 +916,7 @@ void CTRTextureGouraudAlphaNoZ::drawTriangle(const s4DVertex* burning_restrict a
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -1098,6 +1102,7 @@ void CTRTextureGouraudAlphaNoZ::drawTriangle(const s4DVertex* burning_restrict a
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - b->Pos.y;
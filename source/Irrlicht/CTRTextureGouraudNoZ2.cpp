@@ -166,6 +166,7 @@ void CTRTextureGouraudNoZ2::fragment_bilinear()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left( line.x[0] );
 	xEnd = fill_convention_right( line.x[1] );
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 
@@ -307,6 +308,7 @@ void CTRTextureGouraudNoZ2::fragment_no_filter()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left(line.x[0]);
 	xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 	if (dx < 0)
@@ -514,6 +516,7 @@ void CTRTextureGouraudNoZ2::drawTriangle(const s4DVertex* burning_restrict a, co
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -676,6 +679,7 @@ void CTRTextureGouraudNoZ2::drawTriangle(const s4DVertex* burning_restrict a, co
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 
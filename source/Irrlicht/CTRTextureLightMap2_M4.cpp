@@ -4,6 +4,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IBurningShader.h"
+#include "burning_shader_simd.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -23,6 +24,7 @@
 #undef IPOL_C0
 #undef IPOL_T0
 #undef IPOL_T1
+#undef SPAN_SSE2
 
 // define render case
 #define SUBTEXEL
@@ -68,6 +70,11 @@
 
 #endif
 
+// 4 pixel kernel for the magnify scanline
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2) && defined(CMP_W) && defined(WRITE_W) && defined(INVERSE_W)
+	#define SPAN_SSE2
+#endif
+
 namespace irr
 {
 
@@ -98,6 +105,10 @@ private:
 
 	void fragmentShader();
 
+#ifdef SPAN_SSE2
+	s32 scanline_bilinear2_mag_sse2(tVideoSample* burning_restrict dst, fp24* burning_restrict z, s32 i, const s32 dx);
+#endif
+
 };
 
 //! constructor
@@ -117,8 +128,9 @@ void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	fp24 *z;
 
 	// apply top-left fill-convention, left
-	const s32 xStart = fill_convention_left(line.x[0]);
-	const s32 xEnd = fill_convention_right(line.x[1]);
+	s32 xStart = fill_convention_left(line.x[0]);
+	s32 xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 	s32 dx;
 	s32 i;
 
@@ -201,6 +213,11 @@ void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	tFixPoint r1, g1, b1;
 #endif
 
+#ifdef SPAN_SSE2
+	// vector kernel shades multiple of 4 pixel, the remaining pixel are done below
+	if (CpuFeature & CPU_FEATURE_SSE2)
+		i = scanline_bilinear2_mag_sse2(dst, z, i, dx);
+#endif
 
 	for ( ;i <= dx; i += SOFTWARE_DRIVER_2_STEP_X)
 	{
@@ -247,6 +264,55 @@ void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 
 }
 
+#ifdef SPAN_SSE2
+/*!
+	same as the loop of scanline_bilinear2_mag, 4 pixel per iteration starting at pixel i
+	returns the first pixel not shaded
+*/
+s32 CTRTextureLightMap2_M4::scanline_bilinear2_mag_sse2(tVideoSample* burning_restrict dst, fp24* burning_restrict z, s32 i, const s32 dx)
+{
+	sIpol4 ipolW;
+	sIpol4 ipolT[4];
+
+	ipol4_setup(ipolW, line.w[1]);
+	ipol4_setup(ipolT[0], line.t[0][1].x);
+	ipol4_setup(ipolT[1], line.t[0][1].y);
+	ipol4_setup(ipolT[2], line.t[1][1].x);
+	ipol4_setup(ipolT[3], line.t[1][1].y);
+
+	const __m128 fix_mul = _mm_set1_ps(FIX_POINT_F32_MUL);
+
+	for (; i + 3 <= dx; i += 4)
+	{
+		const __m128 w = ipol4_next(line.w[0], ipolW);
+		const __m128 t0x = ipol4_next(line.t[0][0].x, ipolT[0]);
+		const __m128 t0y = ipol4_next(line.t[0][0].y, ipolT[1]);
+		const __m128 t1x = ipol4_next(line.t[1][0].x, ipolT[2]);
+		const __m128 t1y = ipol4_next(line.t[1][0].y, ipolT[3]);
+
+		const __m128 zOld = _mm_loadu_ps(z + i);
+		const __m128 pass = _mm_cmpge_ps(w, zOld);
+		if (0 == _mm_movemask_ps(pass))
+			continue;
+		_mm_storeu_ps(z + i, _mm_or_ps(_mm_and_ps(pass, w), _mm_andnot_ps(pass, zOld)));
+
+		const __m128 inversew = _mm_div_ps(fix_mul, w);
+
+		__m128i r0, g0, b0;
+		__m128i r1, g1, b1;
+		getSample_texture4(r0, g0, b0, &IT[0], tofix4(t0x, inversew), tofix4(t0y, inversew));
+		getSample_texture4(r1, g1, b1, &IT[1], tofix4(t1x, inversew), tofix4(t1y, inversew));
+
+		const __m128i color = fix_to_sample4(imulFix_tex4_4(r0, r1), imulFix_tex4_4(g0, g1), imulFix_tex4_4(b0, b1));
+
+		__m128i* d = (__m128i*)(dst + i);
+		_mm_storeu_si128(d, select4(_mm_castps_si128(pass), color, _mm_loadu_si128(d)));
+	}
+
+	return i;
+}
+#endif
+
 
 #if defined (SOFTWARE_DRIVER_2_SCANLINE_MAG_MIN)
 void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
@@ -263,6 +329,7 @@ void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left(line.x[0]);
 	xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 	if ( dx < 0 )
@@ -483,6 +550,7 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex* burning_restric
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -643,6 +711,7 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex* burning_restric
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 
@@ -860,6 +929,7 @@ void CTRTextureLightMap2_M4::drawTriangle(const s4DVertex* burning_restrict a, c
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( a->Pos.y );
 		yEnd = fill_convention_right( b->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -1020,6 +1090,7 @@ void CTRTextureLightMap2_M4::drawTriangle(const s4DVertex* burning_restrict a, c
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left( b->Pos.y );
 		yEnd = fill_convention_right( c->Pos.y );
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 
@@ -0,0 +1,413 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+#include "irrArray.h"
+#include "os.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#define _IRR_THREADPOOL_WIN32_
+#elif defined(_IRR_POSIX_API_)
+	#include <pthread.h>
+	#include <unistd.h>
+	#define _IRR_THREADPOOL_PTHREAD_
+#endif
+
+namespace irr
+{
+
+struct CThreadPool::SPrivate
+{
+	struct SWorker
+	{
+		SPrivate* Pool;
+		u32 Nr;
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+		pthread_t Thread;
+#elif defined(_IRR_THREADPOOL_WIN32_)
+		HANDLE Thread;
+		DWORD ThreadId;
+#endif
+	};
+
+	SPrivate() : Job(0), Count(0), Next(0), Generation(0), Active(0), Quit(false), Started(false) {}
+
+	//! fetch the next unprocessed index and execute it until the range is empty
+	void runRange(u32 worker)
+	{
+		for (;;)
+		{
+			const u32 index = fetchNext();
+			if (index >= Count)
+				break;
+			Job->runJob(index, worker);
+		}
+	}
+
+	u32 fetchNext()
+	{
+#if defined(_IRR_THREADPOOL_WIN32_)
+		return (u32)InterlockedExchangeAdd(&Next, 1);
+#elif defined(__GNUC__)
+		return (u32)__sync_fetch_and_add(&Next, 1);
+#else
+		return Next++;
+#endif
+	}
+
+	void workerLoop(u32 worker);
+
+	//! let all workers process the current range
+	void wakeWorkers();
+
+	//! wait until all workers are done with the current range
+	void waitWorkers();
+
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+	static void* threadEntry(void* param)
+	{
+		SWorker* w = (SWorker*)param;
+		w->Pool->workerLoop(w->Nr);
+		return 0;
+	}
+#elif defined(_IRR_THREADPOOL_WIN32_)
+	static DWORD WINAPI threadEntry(LPVOID param)
+	{
+		SWorker* w = (SWorker*)param;
+		w->Pool->workerLoop(w->Nr);
+		return 0;
+	}
+#endif
+
+	IThreadPoolJob* Job;
+	u32 Count;
+#if defined(_IRR_THREADPOOL_WIN32_)
+	volatile LONG Next;
+#else
+	volatile s32 Next;
+#endif
+	u32 Generation;
+	u32 Active;
+	bool Quit;
+	//! the workers process a range of start() which was not waited for
+	bool Started;
+
+	core::array<SWorker*> Workers;
+
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+	//! thread which created the pool
+	pthread_t Owner;
+	pthread_mutex_t Mutex;
+	pthread_cond_t Wake;
+	pthread_cond_t Done;
+#elif defined(_IRR_THREADPOOL_WIN32_)
+	DWORD Owner;
+	CRITICAL_SECTION Mutex;
+	HANDLE Wake; // semaphore, one release per worker and generation
+	HANDLE Done; // auto reset event, signaled by the last finished worker
+#endif
+};
+
+
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+
+void CThreadPool::SPrivate::workerLoop(u32 worker)
+{
+	u32 seen = 0;
+	for (;;)
+	{
+		pthread_mutex_lock(&Mutex);
+		while (!Quit && seen == Generation)
+			pthread_cond_wait(&Wake, &Mutex);
+		if (Quit)
+		{
+			pthread_mutex_unlock(&Mutex);
+			break;
+		}
+		seen = Generation;
+		pthread_mutex_unlock(&Mutex);
+
+		runRange(worker);
+
+		pthread_mutex_lock(&Mutex);
+		if (--Active == 0)
+			pthread_cond_signal(&Done);
+		pthread_mutex_unlock(&Mutex);
+	}
+}
+
+void CThreadPool::SPrivate::wakeWorkers()
+{
+	pthread_mutex_lock(&Mutex);
+	Active = Workers.size();
+	Generation += 1;
+	pthread_cond_broadcast(&Wake);
+	pthread_mutex_unlock(&Mutex);
+}
+
+void CThreadPool::SPrivate::waitWorkers()
+{
+	pthread_mutex_lock(&Mutex);
+	while (Active)
+		pthread_cond_wait(&Done, &Mutex);
+	pthread_mutex_unlock(&Mutex);
+}
+
+#elif defined(_IRR_THREADPOOL_WIN32_)
+
+void CThreadPool::SPrivate::workerLoop(u32 worker)
+{
+	for (;;)
+	{
+		WaitForSingleObject(Wake, INFINITE);
+
+		EnterCriticalSection(&Mutex);
+		const bool quit = Quit;
+		LeaveCriticalSection(&Mutex);
+		if (quit)
+			break;
+
+		runRange(worker);
+
+		EnterCriticalSection(&Mutex);
+		if (--Active == 0)
+			SetEvent(Done);
+		LeaveCriticalSection(&Mutex);
+	}
+}
+
+void CThreadPool::SPrivate::wakeWorkers()
+{
+	EnterCriticalSection(&Mutex);
+	Active = Workers.size();
+	LeaveCriticalSection(&Mutex);
+	ReleaseSemaphore(Wake, Workers.size(), 0);
+}
+
+void CThreadPool::SPrivate::waitWorkers()
+{
+	WaitForSingleObject(Done, INFINITE);
+}
+
+#else
+
+void CThreadPool::SPrivate::wakeWorkers()
+{
+}
+
+void CThreadPool::SPrivate::waitWorkers()
+{
+}
+
+#endif
+
+
+//! constructor
+CThreadPool::CThreadPool(u32 threadCount)
+	: P(new SPrivate()), WorkerCount(1)
+{
+	#ifdef _DEBUG
+	setDebugName("CThreadPool");
+	#endif
+
+	if (threadCount == 0)
+		threadCount = getProcessorCount();
+
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+	P->Owner = pthread_self();
+	pthread_mutex_init(&P->Mutex, 0);
+	pthread_cond_init(&P->Wake, 0);
+	pthread_cond_init(&P->Done, 0);
+#elif defined(_IRR_THREADPOOL_WIN32_)
+	P->Owner = GetCurrentThreadId();
+	InitializeCriticalSection(&P->Mutex);
+	P->Wake = CreateSemaphore(0, 0, 0x7fffffff, 0);
+	P->Done = CreateEvent(0, FALSE, FALSE, 0);
+#else
+	threadCount = 1;
+#endif
+
+	for (u32 i = 1; i < threadCount; ++i)
+	{
+		SPrivate::SWorker* w = new SPrivate::SWorker;
+		w->Pool = P;
+		w->Nr = i;
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+		if (pthread_create(&w->Thread, 0, SPrivate::threadEntry, w) != 0)
+		{
+			delete w;
+			break;
+		}
+#elif defined(_IRR_THREADPOOL_WIN32_)
+		w->Thread = CreateThread(0, 0, SPrivate::threadEntry, w, 0, &w->ThreadId);
+		if (!w->Thread)
+		{
+			delete w;
+			break;
+		}
+#endif
+		P->Workers.push_back(w);
+	}
+
+	WorkerCount = P->Workers.size() + 1;
+	if (WorkerCount < threadCount)
+		os::Printer::log("Could not create all requested worker threads", ELL_WARNING);
+}
+
+
+//! destructor
+CThreadPool::~CThreadPool()
+{
+	wait();
+
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+	pthread_mutex_lock(&P->Mutex);
+	P->Quit = true;
+	pthread_cond_broadcast(&P->Wake);
+	pthread_mutex_unlock(&P->Mutex);
+
+	for (u32 i = 0; i < P->Workers.size(); ++i)
+	{
+		pthread_join(P->Workers[i]->Thread, 0);
+		delete P->Workers[i];
+	}
+
+	pthread_cond_destroy(&P->Done);
+	pthread_cond_destroy(&P->Wake);
+	pthread_mutex_destroy(&P->Mutex);
+#elif defined(_IRR_THREADPOOL_WIN32_)
+	EnterCriticalSection(&P->Mutex);
+	P->Quit = true;
+	LeaveCriticalSection(&P->Mutex);
+	if (P->Workers.size())
+		ReleaseSemaphore(P->Wake, P->Workers.size(), 0);
+
+	for (u32 i = 0; i < P->Workers.size(); ++i)
+	{
+		WaitForSingleObject(P->Workers[i]->Thread, INFINITE);
+		CloseHandle(P->Workers[i]->Thread);
+		delete P->Workers[i];
+	}
+
+	CloseHandle(P->Done);
+	CloseHandle(P->Wake);
+	DeleteCriticalSection(&P->Mutex);
+#endif
+
+	delete P;
+}
+
+
+u32 CThreadPool::getWorkerCount() const
+{
+	return WorkerCount;
+}
+
+
+void CThreadPool::parallelFor(IThreadPoolJob* job, u32 count)
+{
+	if (!job || !count)
+		return;
+
+	P->Job = job;
+	P->Count = count;
+	P->Next = 0;
+
+	// nothing to share
+	if (WorkerCount == 1 || count == 1)
+	{
+		P->runRange(0);
+		return;
+	}
+
+	P->wakeWorkers();
+	P->runRange(0);
+	P->waitWorkers();
+
+	P->Job = 0;
+}
+
+
+void CThreadPool::start(IThreadPoolJob* job, u32 count)
+{
+	if (!job || !count)
+		return;
+
+	P->Job = job;
+	P->Count = count;
+	P->Next = 0;
+
+	// nobody to hand the work to
+	if (WorkerCount == 1)
+	{
+		P->runRange(0);
+		P->Job = 0;
+		return;
+	}
+
+	P->wakeWorkers();
+	P->Started = true;
+}
+
+
+void CThreadPool::wait()
+{
+	if (!P->Started)
+		return;
+
+	P->waitWorkers();
+	P->Started = false;
+	P->Job = 0;
+}
+
+
+bool CThreadPool::isWorkerThread() const
+{
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+	const pthread_t self = pthread_self();
+	for (u32 i = 0; i < P->Workers.size(); ++i)
+	{
+		if (pthread_equal(P->Workers[i]->Thread, self))
+			return true;
+	}
+#elif defined(_IRR_THREADPOOL_WIN32_)
+	const DWORD self = GetCurrentThreadId();
+	for (u32 i = 0; i < P->Workers.size(); ++i)
+	{
+		if (P->Workers[i]->ThreadId == self)
+			return true;
+	}
+#endif
+	return false;
+}
+
+
+bool CThreadPool::isOwnerThread() const
+{
+#if defined(_IRR_THREADPOOL_PTHREAD_)
+	return pthread_equal(P->Owner, pthread_self()) != 0;
+#elif defined(_IRR_THREADPOOL_WIN32_)
+	return P->Owner == GetCurrentThreadId();
+#else
+	return true;
+#endif
+}
+
+
+u32 CThreadPool::getProcessorCount()
+{
+#if defined(_IRR_THREADPOOL_WIN32_)
+	SYSTEM_INFO sysinfo;
+	GetSystemInfo(&sysinfo);
+	return sysinfo.dwNumberOfProcessors > 0 ? (u32)sysinfo.dwNumberOfProcessors : 1;
+#elif defined(_IRR_THREADPOOL_PTHREAD_) && defined(_SC_NPROCESSORS_ONLN)
+	const long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (u32)n : 1;
+#else
+	return 1;
+#endif
+}
+
+} // end namespace irr
@@ -0,0 +1,90 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_THREAD_POOL_H_INCLUDED__
+#define __C_THREAD_POOL_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IReferenceCounted.h"
+#include "irrTypes.h"
+
+namespace irr
+{
+
+	//! Work item which is executed by CThreadPool::parallelFor
+	class IThreadPoolJob
+	{
+	public:
+		virtual ~IThreadPoolJob() {}
+
+		//! Called once for every index of the parallelFor range.
+		/** \param index Index in the range [0,count) passed to parallelFor.
+		\param worker Number of the executing thread in the range
+		[0,CThreadPool::getWorkerCount()). The calling thread of
+		parallelFor is always worker 0. Use it to select per thread
+		scratch data. */
+		virtual void runJob(u32 index, u32 worker) = 0;
+	};
+
+	//! Small fork/join pool of worker threads used by engine internals.
+	/** The pool is not meant as a general purpose task system. It only
+	distributes a range of independent indices over a fixed set of threads
+	and returns when all of them are done. Without thread support the
+	jobs are executed serially on the calling thread. */
+	class CThreadPool : public virtual IReferenceCounted
+	{
+	public:
+
+		//! Constructor
+		/** \param threadCount Number of threads including the calling
+		thread. 0 selects the number of processors. */
+		CThreadPool(u32 threadCount);
+
+		//! Destructor, joins all worker threads.
+		virtual ~CThreadPool();
+
+		//! Number of threads executing jobs, including the calling thread.
+		u32 getWorkerCount() const;
+
+		//! Runs job->runJob(index,worker) for every index in [0,count).
+		/** Blocks until all indices are processed. Indices are handed out
+		in increasing order to the next free thread. Must not be called
+		recursively from inside a job, and only by one thread at a time,
+		see isOwnerThread(). */
+		void parallelFor(IThreadPoolJob* job, u32 count);
+
+		//! Starts job->runJob(index,worker) for every index in [0,count) and returns at once.
+		/** Only the worker threads execute the jobs, the calling thread
+		may do other work meanwhile. Without worker threads the jobs are
+		executed before start returns. The job must stay valid until
+		wait() is called, which has to happen before the next start or
+		parallelFor. */
+		void start(IThreadPoolJob* job, u32 count);
+
+		//! Blocks until the jobs of the last start are processed.
+		/** Returns at once if nothing was started. */
+		void wait();
+
+		//! True if the calling thread is one of the worker threads of this pool.
+		/** The thread which created the pool is no worker thread. */
+		bool isWorkerThread() const;
+
+		//! True if the calling thread created the pool.
+		/** Users of a pool which may be called from several threads
+		only hand out jobs on this one and run serially on the others. */
+		bool isOwnerThread() const;
+
+		//! Number of processors available to the process.
+		static u32 getProcessorCount();
+
+	private:
+
+		struct SPrivate;
+		SPrivate* P;
+
+		u32 WorkerCount;
+	};
+
+} // end namespace irr
+
+#endif // __C_THREAD_POOL_H_INCLUDED__
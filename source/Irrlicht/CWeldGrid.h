@@ -0,0 +1,129 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_WELD_GRID_H_INCLUDED__
+#define __C_WELD_GRID_H_INCLUDED__
+
+#include "irrArray.h"
+#include "aabbox3d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Spatial hash of vertex positions, to find the ones equal within a tolerance
+	/** Positions are hashed into cells three times as large as the tolerance.
+	On each axis an equal position is in the same cell or in the neighbour
+	towards the nearer cell border, so the eight cells of getCells() hold
+	all candidates. Cells keep their vertices in the order they were added,
+	so searching them for the first equal vertex gives the same result as
+	comparing with all earlier vertices. */
+	class CWeldGrid
+	{
+	public:
+		//! value of getFirst() and getNext() when there is no vertex
+		static const u32 NONE = 0xffffffff;
+
+		//! grid for vertexCount positions inside box
+		CWeldGrid(u32 vertexCount, const core::aabbox3df& box, f32 tolerance)
+			: MinEdge(box.MinEdge)
+		{
+			// at most 2^20 cells per axis, so the coordinates never overflow
+			const core::vector3df extent = box.getExtent();
+			f32 cellSize = core::max_(tolerance*3.f, core::max_(extent.X, extent.Y, extent.Z) / 1048576.f);
+			if (cellSize <= 0.f)
+				cellSize = 1.f;
+			InvCellSize = 1.f / cellSize;
+
+			u32 size = 1;
+			while (size < vertexCount*2)
+				size <<= 1;
+			Mask = size-1;
+
+			SCell empty;
+			empty.X = empty.Y = empty.Z = 0;
+			empty.First = empty.Last = NONE;
+			Cells.set_used(size);
+			for (u32 i=0; i<size; ++i)
+				Cells[i] = empty;
+			Next.set_used(vertexCount);
+		}
+
+		//! cell of a position, and on each axis the neighbour towards the nearer cell border
+		/** Neighbour n of the eight candidate cells takes side[a] on the axes a whose bit is set in n. */
+		void getCells(const core::vector3df& pos, u32 cell[3], u32 side[3]) const
+		{
+			const core::vector3df p((pos - MinEdge) * InvCellSize);
+
+			// cell coordinates start at 1 to leave room for the neighbours
+			const f32 coord[3] = { p.X, p.Y, p.Z };
+			for (u32 a=0; a<3; ++a)
+			{
+				const u32 c = (u32)coord[a];
+				cell[a] = c + 1;
+				side[a] = (coord[a] - (f32)c < 0.5f) ? c : c + 2;
+			}
+		}
+
+		//! first vertex of a cell, NONE if it is empty
+		u32 getFirst(u32 x, u32 y, u32 z) const
+		{
+			const SCell& cell = Cells[find(x, y, z)];
+			return cell.First;
+		}
+
+		//! following vertex in the same cell
+		u32 getNext(u32 vertex) const
+		{
+			return Next[vertex];
+		}
+
+		//! appends a vertex, vertices have to be added in index order
+		void add(u32 x, u32 y, u32 z, u32 vertex)
+		{
+			SCell& cell = Cells[find(x, y, z)];
+			if (cell.First == NONE)
+			{
+				cell.X = x;
+				cell.Y = y;
+				cell.Z = z;
+				cell.First = vertex;
+			}
+			else
+				Next[cell.Last] = vertex;
+			cell.Last = vertex;
+			Next[vertex] = NONE;
+		}
+
+	private:
+
+		//! cell of the spatial hash, with its vertices linked in index order
+		struct SCell
+		{
+			u32 X, Y, Z;
+			u32 First;
+			u32 Last;
+		};
+
+		//! slot of the cell or the empty slot where it belongs
+		u32 find(u32 x, u32 y, u32 z) const
+		{
+			u32 slot = ((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u)) & Mask;
+			while (Cells[slot].First != NONE &&
+				(Cells[slot].X != x || Cells[slot].Y != y || Cells[slot].Z != z))
+				slot = (slot+1) & Mask;
+			return slot;
+		}
+
+		core::array<SCell> Cells;
+		core::array<u32> Next;
+		core::vector3df MinEdge;
+		f32 InvCellSize;
+		u32 Mask;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -10,11 +10,37 @@
 #include "CSoftwareDriver2.h"
 #include "IShaderConstantSetCallBack.h"
 
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#endif
+#endif
+
 namespace irr
 {
 namespace video
 {
 
+size_t burning_cpu_features()
+{
+	size_t features = 0;
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2)
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	if (info[3] & (1 << 26))
+		features |= CPU_FEATURE_SSE2;
+#elif defined(__GNUC__)
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2))
+		features |= CPU_FEATURE_SSE2;
+#endif
+#endif
+	return features;
+}
+
 const tFixPointu IBurningShader::dithermask[] =
 {
 	0x00,0x80,0x20,0xa0,
@@ -35,9 +61,8 @@ void IBurningShader::constructor_IBurningShader(CBurningVideoDriver* driver)
 		_IRR_DEBUG_BREAK_IF(1);
 	}
 
-	Interlaced.enable = 0;
-	Interlaced.bypass = 1;
-	Interlaced.nr = 0;
+	Interlaced = interlace_disabled();
+	CpuFeature = driver ? driver->getCpuFeature() : burning_cpu_features();
 
 	EdgeTestPass = edge_test_pass;
 	EdgeTestPass_stack = edge_test_pass;
@@ -45,12 +70,17 @@ void IBurningShader::constructor_IBurningShader(CBurningVideoDriver* driver)
 	for (u32 i = 0; i < BURNING_MATERIAL_MAX_TEXTURES; ++i)
 	{
 		IT[i].Texture = 0;
+		IT[i].tiled = 0;
 	}
 
 	Driver = driver;
 	CallBack = 0;
 
 	RenderTarget = 0;
+	RasterClip.x0 = 0;
+	RasterClip.y0 = 0;
+	RasterClip.x1 = -1;
+	RasterClip.y1 = -1;
 	ColorMask = COLOR_BRIGHT_WHITE;
 	DepthBuffer = (CDepthBuffer*)driver->getDepthBuffer();
 	if (DepthBuffer)
@@ -133,6 +163,11 @@ void IBurningShader::setRenderTarget(video::IImage* surface, const core::rect<s3
 {
 	Interlaced = interlaced;
 
+	RasterClip.x0 = viewPort.UpperLeftCorner.X;
+	RasterClip.y0 = viewPort.UpperLeftCorner.Y;
+	RasterClip.x1 = viewPort.LowerRightCorner.X - 1;
+	RasterClip.y1 = viewPort.LowerRightCorner.Y - 1;
+
 	if (RenderTarget)
 		RenderTarget->drop();
 
@@ -178,9 +213,50 @@ void IBurningShader::setTextureParam(const size_t stage, video::CSoftwareTexture
 		const core::dimension2d<u32>& dim = it->Texture->getSize();
 		it->textureXMask = s32_to_fixPoint(dim.Width - 1) & FIX_POINT_UNSIGNED_MASK;
 		it->textureYMask = s32_to_fixPoint(dim.Height - 1) & FIX_POINT_UNSIGNED_MASK;
+
+		// sample the 4x4 tiled copy of the level
+		it->tiled = 0;
+#if defined(SOFTWARE_DRIVER_2_TEXTURE_TILED)
+		const void* tiled = it->Texture->getTiledData(existing_level);
+		if (tiled)
+		{
+			it->data = (tVideoSample*)tiled;
+			it->tiled = 1;
+		}
+#endif
 	}
 }
 
+//! shares a texture setup prepared by another shader. no reference is held
+void IBurningShader::setTextureParamShared(const size_t stage, const sInternalTexture& source)
+{
+	sInternalTexture* it = &IT[stage];
+
+	if (it->Texture)
+		it->Texture->drop();
+
+	*it = source;
+	it->Texture = 0;
+}
+
+//! copies the driver controlled render states of another shader
+void IBurningShader::copyRenderState(const IBurningShader* source)
+{
+	ColorMask = source->ColorMask;
+	EdgeTestPass = source->EdgeTestPass;
+	EdgeTestPass_stack = source->EdgeTestPass_stack;
+	for (size_t i = 0; i < sizeof(stencilOp) / sizeof(stencilOp[0]); ++i)
+		stencilOp[i] = source->stencilOp[i];
+	AlphaRef = source->AlphaRef;
+	RenderPass_ShaderIsTransparent = source->RenderPass_ShaderIsTransparent;
+	PrimitiveColor = source->PrimitiveColor;
+	TL_Flag = source->TL_Flag;
+	for (size_t i = 0; i < 4; ++i)
+		fog_color[i] = source->fog_color[i];
+	fog_color_sample = source->fog_color_sample;
+	Scissor = source->Scissor;
+}
+
 //emulate a line with degenerate triangle and special shader mode (not perfect...)
 void IBurningShader::drawLine(const s4DVertex* a, const s4DVertex* b)
 {
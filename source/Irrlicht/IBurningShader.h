@@ -65,6 +65,15 @@ namespace video
 		TL_LIGHT0_IS_NORMAL_MAP	= 0x100		//sVec4 Light Vector is used as normal or specular
 	};
 
+	//! instruction sets usable by the span kernels
+	enum eBurningCpuFeature
+	{
+		CPU_FEATURE_SSE2		= 0x01
+	};
+
+	//! runtime cpu detection, eBurningCpuFeature. only features compiled in are reported
+	size_t burning_cpu_features();
+
 	struct SBurningShaderEyeSpace
 	{
 		SBurningShaderEyeSpace() {}
@@ -250,6 +259,16 @@ namespace video
 
 		//! sets the Texture
 		virtual void setTextureParam( const size_t stage, video::CSoftwareTexture2* texture, s32 lodFactor);
+
+		//! texture setup of the last setTextureParam
+		const sInternalTexture& getTextureParam(const size_t stage) const { return IT[stage]; }
+
+		//! uses the texture setup of another shader without holding a reference (tile rasterizer)
+		void setTextureParamShared(const size_t stage, const sInternalTexture& source);
+
+		//! copies the render states set by the driver (fog, scissor, stencil, edge test..) from another shader
+		void copyRenderState(const IBurningShader* source);
+
 		virtual void drawTriangle(const s4DVertex* burning_restrict a, const s4DVertex* burning_restrict b, const s4DVertex* burning_restrict c) {};
 		virtual void drawLine ( const s4DVertex *a,const s4DVertex *b);
 		virtual void drawPoint(const s4DVertex *a);
@@ -371,6 +390,7 @@ namespace video
 		size_t EdgeTestPass; //edge_test_flag
 		size_t EdgeTestPass_stack;
 		interlaced_control Interlaced; // passed from driver
+		size_t CpuFeature; // eBurningCpuFeature, dispatch of span kernels
 
 		eBurningStencilOp stencilOp[4];
 		tFixPoint AlphaRef;
@@ -385,6 +405,7 @@ namespace video
 		tVideoSample fog_color_sample;
 
 		AbsRectangle Scissor;
+		AbsRectangle RasterClip; // inclusive pixel bounds of the viewport, fill_convention_clip
 
 		inline tVideoSample color_to_sample(const video::SColor& color) const
 		{
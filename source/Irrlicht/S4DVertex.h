@@ -10,6 +10,7 @@
 #include "SoftwareDriver2_helper.h"
 #include "irrAllocator.h"
 #include "EPrimitiveTypes.h"
+#include "aabbox3d.h"
 
 namespace irr
 {
@@ -372,6 +373,7 @@ enum e4DVertexFlag
 	VERTEX4D_CLIP_BOTTOM			= 0x00000010,
 	VERTEX4D_CLIP_TOP				= 0x00000020,
 	VERTEX4D_INSIDE					= 0x0000003F,
+	VERTEX4D_GUARDBAND				= 0x00000040,	// inside near,far and the guard band. projected
 
 	VERTEX4D_PROJECTED				= 0x00000100,
 	VERTEX4D_VAL_ZERO				= 0x00000200,
@@ -721,6 +723,11 @@ struct SVertexCache
 	scene::E_PRIMITIVE_TYPE pType;		//scene::E_PRIMITIVE_TYPE
 	e4DIndexType iType;		//E_INDEX_TYPE iType
 
+	// source vertices are S3DVertexCompact, decoded into E4VT_STANDARD in the box
+	bool compact;
+	core::aabbox3df compactBox;
+	size_t vertexPitch;		// sizeof source Vertex
+
 };
 
 
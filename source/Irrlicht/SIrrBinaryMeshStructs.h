@@ -0,0 +1,83 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+// Layout of the .irrbin files written by CIrrBinaryMeshWriter and read by CIrrBinaryMeshFileLoader
+
+#ifndef __S_IRR_BINARY_MESH_STRUCTS_H_INCLUDED__
+#define __S_IRR_BINARY_MESH_STRUCTS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+/* A file starts with SIrrBinaryMeshHeader, followed by the mesh buffers.
+Each buffer is an SIrrBinaryMeshBufferHeader, its transformation as 16 f32
+for skinned meshes, the material, the vertices and the indices. Skinned
+meshes add the animation speed as f32, the joint count as u32 and the
+joints, each an SIrrBinaryMeshJointHeader followed by its name, child
+indices, attached buffers, position, scale and rotation keys and weights.
+
+All values are stored in the byte order of the writing machine, which the
+loader detects with ByteOrder. The vertex, index and key arrays are raw
+copies of the engine structures and start at file offsets aligned to
+IRRBIN_ARRAY_ALIGNMENT, so they can be read in one go or mapped into
+memory. Strings are a u32 length followed by the characters, padded to
+4 bytes. A material is a u32 attribute count followed by a u32 attribute
+type, the name and the value string of each attribute as created by
+IVideoDriver::createAttributesFromMaterial(). */
+
+const u32 IRRBIN_BYTE_ORDER = 0x01020304;
+const u32 IRRBIN_VERSION = 1;
+const u32 IRRBIN_ARRAY_ALIGNMENT = 16;
+
+//! the mesh is an ISkinnedMesh and the file contains its joints
+const u32 IRRBIN_FLAG_SKINNED = 0x1;
+
+struct SIrrBinaryMeshHeader
+{
+	c8 Magic[4]; // "IRRB"
+	u32 ByteOrder;
+	u32 Version;
+	u32 Flags;
+	u32 BufferCount;
+	f32 BoundingBox[6];
+};
+
+struct SIrrBinaryMeshBufferHeader
+{
+	u32 VertexType;
+	u32 IndexType;
+	u32 PrimitiveType;
+	u32 VertexCount;
+	u32 IndexCount;
+	f32 BoundingBox[6];
+};
+
+struct SIrrBinaryMeshJointHeader
+{
+	f32 LocalMatrix[16];
+	f32 GlobalInversedMatrix[16];
+	u32 ChildCount;
+	u32 AttachedMeshCount;
+	u32 PositionKeyCount;
+	u32 ScaleKeyCount;
+	u32 RotationKeyCount;
+	u32 WeightCount;
+};
+
+//! a weight of ISkinnedMesh::SJoint without the internal members
+struct SIrrBinaryMeshWeight
+{
+	u32 BufferID;
+	u32 VertexID;
+	f32 Strength;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
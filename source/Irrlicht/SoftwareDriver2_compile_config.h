@@ -143,6 +143,11 @@ struct interlaced_control
 	unsigned enable : 1;
 	unsigned bypass : 1;
 	unsigned nr : interlace_control_bit;
+
+	//multithreaded rasterizer. scanline belongs to band (y >> SOFTWARE_DRIVER_2_TILE_BAND_LOG2) % tile_count
+	unsigned tile_bypass : 1;
+	unsigned tile_nr : 8;
+	unsigned tile_count : 8;
 };
 struct interlace_scanline_data { unsigned int y; };
 
@@ -152,10 +157,21 @@ static inline interlaced_control interlace_disabled()
 	v.enable = 0;
 	v.bypass = 1;
 	v.nr = 0;
+	v.tile_bypass = 1;
+	v.tile_nr = 0;
+	v.tile_count = 1;
 	return v;
 }
 #if defined(SOFTWARE_DRIVER_2_INTERLACED)
-#define interlace_scanline if ( Interlaced.bypass | ((line.y & interlace_control_mask) == Interlaced.nr) )
+//the tile binned multithreaded rasterizer hands out scanlines through the interlace test
+#define SOFTWARE_DRIVER_2_MULTITHREADED
+#define SOFTWARE_DRIVER_2_TILE_BAND_LOG2 3
+#define SOFTWARE_DRIVER_2_TILE_GROUP_MAX 64
+#define SOFTWARE_DRIVER_2_TILE_TRIANGLE_MAX 2048
+#define SOFTWARE_DRIVER_2_TILE_MIN_PRIMITIVES 32
+
+#define interlace_scanline if ( (Interlaced.bypass | ((line.y & interlace_control_mask) == Interlaced.nr)) & \
+	(Interlaced.tile_bypass || (((line.y >> SOFTWARE_DRIVER_2_TILE_BAND_LOG2) % Interlaced.tile_count) == Interlaced.tile_nr)) )
 #define interlace_scanline_enabled if ( (line.y & interlace_control_mask) == Interlaced.nr )
 //#define interlace_scanline if ( Interlaced.disabled | (((line.y >> (interlace_control_bit-1) ) & 1) == (Interlaced.nr & 1)) )
 //#define interlace_scanline
@@ -174,6 +190,16 @@ static inline interlaced_control interlace_disabled()
 //#define fill_convention_left(x) 65536 - int(65536.0f - x)
 //#define fill_convention_right(x) 65535 - int(65536.0f - x)
 
+//! guard band (SIrrlichtCreationParameters::BurningVideoGuardBand). triangles inside near,far and SOFTWARE_DRIVER_2_GUARD_BAND_SIZE
+//! times the x,y ndc range are not clipped geometrically. the rasterizer cuts the span to IBurningShader::RasterClip instead
+#if defined(SOFTWARE_DRIVER_2_CLIPPING) && defined(SOFTWARE_DRIVER_2_SUBTEXEL)
+#define SOFTWARE_DRIVER_2_GUARD_BAND
+#define SOFTWARE_DRIVER_2_GUARD_BAND_SIZE 4.f
+#define fill_convention_clip(start,end,axis) if (start < RasterClip.axis##0) start = RasterClip.axis##0; if (end > RasterClip.axis##1) end = RasterClip.axis##1
+#else
+#define fill_convention_clip(start,end,axis)
+#endif
+
 
 //Check coordinates are in render target/window space
 //#define SOFTWARE_DRIVER_2_DO_CLIPCHECK
@@ -234,6 +260,24 @@ enum edge_test_flag
 #endif
 #endif
 
+//! coarse depth per tile of (1<<SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2) pixel in CDepthBuffer. rejects hidden triangles before scan conversion
+#if defined(SOFTWARE_DRIVER_2_USE_WBUFFER)
+#define SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+#define SOFTWARE_DRIVER_2_HIERARCHICAL_Z_LOG2 3
+#endif
+
+//! CSoftwareTexture2 keeps a copy of each mip level in 4x4 texel tiles (SIrrlichtCreationParameters::BurningVideoTiledTextures).
+//! a tile is one cache line, the texel fetch helpers address the copy if the sampled level has one
+#define SOFTWARE_DRIVER_2_TEXTURE_TILED
+
+//! 4 pixel span kernels (burning_shader_simd.h). selected at runtime by IBurningShader::CpuFeature, scalar scanline is the fallback
+//! also enables the batched 4 vertex transform and lighting in CBurningVideoDriver::VertexCache_fill_batch
+#if defined(SOFTWARE_DRIVER_2_32BIT) && defined(SOFTWARE_DRIVER_2_BILINEAR) && !defined(BURNINGVIDEO_RENDERER_FAST)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_MSC_VER) && defined(_M_IX86))
+#define SOFTWARE_DRIVER_2_SIMD_SSE2
+#endif
+#endif
+
 #if defined(ENV64BIT) && defined(BURNINGVIDEO_RENDERER_BEAUTIFUL)
 typedef float ipoltype;
 #else
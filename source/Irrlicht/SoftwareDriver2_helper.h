@@ -824,17 +824,42 @@ struct sInternalTexture
 
 	video::CSoftwareTexture2 *Texture;
 	s32 lodFactor; // magnify/minify
+	size_t tiled; // data is in 4x4 texel tiles (CSoftwareTexture2::getTiledData)
 };
 
+/*
+	byte offset of texel row ty and texel column tx, wraps positive.
+	row major: y * pitch + x * texelsize
+	4x4 tiles: tile rows of 4 * pitch, 16 texel per tile. tiled x and y parts don't share bits either.
+	tiled parts from the row major parts: y * pitch + (y & 3) * (4 texel - pitch) and x + (x & ~3) * 3
+*/
+static REALINLINE size_t texel_ofs_y(const sInternalTexture* t, const tFixPointu ty)
+{
+	const size_t y = (ty & t->textureYMask) >> FIX_POINT_PRE;
+#if defined(SOFTWARE_DRIVER_2_TEXTURE_TILED)
+	if (t->tiled)
+		return (y << t->pitchlog2) + (y & 3) * ((4 << SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY) - ((size_t)1 << t->pitchlog2));
+#endif
+	return y << t->pitchlog2;
+}
 
+static REALINLINE size_t texel_ofs_x(const sInternalTexture* t, const tFixPointu tx)
+{
+	const size_t x = (tx & t->textureXMask) >> (FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+#if defined(SOFTWARE_DRIVER_2_TEXTURE_TILED)
+	if (t->tiled)
+		return x + (x & ~(size_t)((4 << SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY) - 1)) * 3;
+#endif
+	return x;
+}
 
 // get video sample plain
 static inline tVideoSample getTexel_plain ( const sInternalTexture* t, const tFixPointu tx, const tFixPointu ty )
 {
 	size_t ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY );
+	ofs = texel_ofs_y(t, ty);
+	ofs |= texel_ofs_x(t, tx);
 
 	// texel
 	return *((tVideoSample*)( (u8*) t->data + ofs ));
@@ -847,8 +872,8 @@ inline void getTexel_fix ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 {
 	size_t ofs;
 
-	ofs = ( ((ty + FIX_POINT_ZERO_DOT_FIVE) & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ((tx + FIX_POINT_ZERO_DOT_FIVE) & t->textureXMask ) >> ( FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY );
+	ofs = texel_ofs_y(t, ty + FIX_POINT_ZERO_DOT_FIVE);
+	ofs |= texel_ofs_x(t, tx + FIX_POINT_ZERO_DOT_FIVE);
 
 	// texel
 	tVideoSample t00;
@@ -867,8 +892,8 @@ inline void getTexel_fix(tFixPoint &a, tFixPoint &r, tFixPoint &g, tFixPoint &b,
 {
 	size_t ofs;
 
-	ofs = (((ty+ FIX_POINT_ZERO_DOT_FIVE) & t->textureYMask) >> FIX_POINT_PRE) << t->pitchlog2;
-	ofs |= ((tx+ FIX_POINT_ZERO_DOT_FIVE) & t->textureXMask) >> (FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+	ofs = texel_ofs_y(t, ty + FIX_POINT_ZERO_DOT_FIVE);
+	ofs |= texel_ofs_x(t, tx + FIX_POINT_ZERO_DOT_FIVE);
 
 	// texel
 	tVideoSample t00;
@@ -1030,10 +1055,10 @@ static REALINLINE void getSample_texture(tFixPoint &r, tFixPoint &g, tFixPoint &
 	tVideoSample t[4];
 	{
 		size_t o0, o1, o2, o3;
-		o0 = (((ty) & tex->textureYMask) >> FIX_POINT_PRE) << tex->pitchlog2;
-		o1 = (((ty + FIX_POINT_ONE) & tex->textureYMask) >> FIX_POINT_PRE) << tex->pitchlog2;
-		o2 = ((tx)& tex->textureXMask) >> (unsigned)(FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
-		o3 = ((tx + FIX_POINT_ONE) & tex->textureXMask) >> (unsigned)(FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+		o0 = texel_ofs_y(tex, ty);
+		o1 = texel_ofs_y(tex, ty + FIX_POINT_ONE);
+		o2 = texel_ofs_x(tex, tx);
+		o3 = texel_ofs_x(tex, tx + FIX_POINT_ONE);
 
 		t[0] = *((tVideoSample*)((u8*)tex->data + (o0 + o2)));
 		t[1] = *((tVideoSample*)((u8*)tex->data + (o0 + o3)));
@@ -1073,10 +1098,10 @@ static REALINLINE void getSample_texture(tFixPoint &a, tFixPoint &r, tFixPoint &
 	size_t o0, o1, o2, o3;
 	tVideoSample t00;
 
-	o0 = (((ty)& tex->textureYMask) >> FIX_POINT_PRE) << tex->pitchlog2;
-	o1 = (((ty + FIX_POINT_ONE) & tex->textureYMask) >> FIX_POINT_PRE) << tex->pitchlog2;
-	o2 = ((tx)& tex->textureXMask) >> (FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
-	o3 = ((tx + FIX_POINT_ONE) & tex->textureXMask) >> (FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+	o0 = texel_ofs_y(tex, ty);
+	o1 = texel_ofs_y(tex, ty + FIX_POINT_ONE);
+	o2 = texel_ofs_x(tex, tx);
+	o3 = texel_ofs_x(tex, tx + FIX_POINT_ONE);
 
 	t00 = *((tVideoSample*)((u8*)tex->data + (o0 + o2)));
 	a00 = (t00 & MASK_A) >> SHIFT_A;
@@ -1146,8 +1171,8 @@ static REALINLINE void getSample_texture(tFixPoint &r, tFixPoint &g, tFixPoint &
 )
 {
 	size_t ofs;
-	ofs = (((ty + FIX_POINT_ZERO_DOT_FIVE) & t->textureYMask) >> FIX_POINT_PRE) << t->pitchlog2;
-	ofs += ((tx + FIX_POINT_ZERO_DOT_FIVE) & t->textureXMask) >> (FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+	ofs = texel_ofs_y(t, ty + FIX_POINT_ZERO_DOT_FIVE);
+	ofs += texel_ofs_x(t, tx + FIX_POINT_ZERO_DOT_FIVE);
 
 	// texel
 	const tVideoSample t00 = *((tVideoSample*)((u8*)t->data + ofs));
@@ -1162,8 +1187,8 @@ static REALINLINE void getSample_texture(tFixPoint &a, tFixPoint &r, tFixPoint &
 )
 {
 	size_t ofs;
-	ofs = (((ty + FIX_POINT_ZERO_DOT_FIVE) & t->textureYMask) >> FIX_POINT_PRE) << t->pitchlog2;
-	ofs += ((tx + FIX_POINT_ZERO_DOT_FIVE) & t->textureXMask) >> (FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+	ofs = texel_ofs_y(t, ty + FIX_POINT_ZERO_DOT_FIVE);
+	ofs += texel_ofs_x(t, tx + FIX_POINT_ZERO_DOT_FIVE);
 
 	// texel
 	const tVideoSample t00 = *((tVideoSample*)((u8*)t->data + ofs));
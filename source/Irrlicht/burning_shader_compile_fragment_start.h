@@ -34,6 +34,7 @@ void burning_shader_class::burning_shader_fragment()
 	// apply top-left fill-convention, left
 	xStart = fill_convention_left(line.x[0]);
 	xEnd = fill_convention_right(line.x[1]);
+	fill_convention_clip(xStart, xEnd, x);
 
 	dx = xEnd - xStart;
 	if (dx < 0)
@@ -104,6 +104,7 @@ void burning_shader_class::drawTriangle(const s4DVertex* burning_restrict a, con
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left(a->Pos.y);
 		yEnd = fill_convention_right(b->Pos.y);
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ((f32)yStart) - a->Pos.y;
@@ -266,6 +267,7 @@ void burning_shader_class::drawTriangle(const s4DVertex* burning_restrict a, con
 		// apply top-left fill convention, top part
 		yStart = fill_convention_left(b->Pos.y);
 		yEnd = fill_convention_right(c->Pos.y);
+		fill_convention_clip(yStart, yEnd, y);
 
 #ifdef SUBTEXEL
 		subPixel = ((f32)yStart) - b->Pos.y;
@@ -0,0 +1,261 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __BURNING_SHADER_SIMD_H_INCLUDED__
+#define __BURNING_SHADER_SIMD_H_INCLUDED__
+
+#include "SoftwareDriver2_helper.h"
+
+/*
+	4 pixel span kernels.
+	The helpers reproduce the scalar fixed point math of SoftwareDriver2_helper.h bit exact,
+	so a shader can shade any part of a scanline vectorized and the rest with the scalar loop.
+	Texel weights and color channels are packed to 16 bit for _mm_madd_epi16.
+*/
+#if defined(SOFTWARE_DRIVER_2_SIMD_SSE2) && FIX_POINT_PRE <= 14
+
+#include <emmintrin.h>
+
+namespace irr
+{
+namespace video
+{
+
+//! interpolation of a scanline attribute, 4 pixel per step
+struct sIpol4
+{
+	__m128 s1; // 0,s,s,s
+	__m128 s2; // 0,0,s,s
+	__m128 s3; // 0,0,0,s
+	f32 s;
+};
+
+static REALINLINE void ipol4_setup(sIpol4& p, const f32 slope)
+{
+	p.s = slope;
+	p.s1 = _mm_set_ps(slope, slope, slope, 0.f);
+	p.s2 = _mm_set_ps(slope, slope, 0.f, 0.f);
+	p.s3 = _mm_set_ps(slope, 0.f, 0.f, 0.f);
+}
+
+//! x, x+s, x+s+s, x+s+s+s. adds in the same order as the scalar x += s, x advances by 4 pixel
+static REALINLINE __m128 ipol4_next(f32& x, const sIpol4& p)
+{
+	__m128 v = _mm_set1_ps(x);
+	v = _mm_add_ps(v, p.s1);
+	v = _mm_add_ps(v, p.s2);
+	v = _mm_add_ps(v, p.s3);
+	x = _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))) + p.s;
+	return v;
+}
+
+//! advance x by 4 pixel without using the values
+static REALINLINE void ipol4_skip(f32& x, const sIpol4& p)
+{
+	x += p.s;
+	x += p.s;
+	x += p.s;
+	x += p.s;
+}
+
+//! tofix
+static REALINLINE __m128i tofix4(const __m128 x, const __m128 y)
+{
+	return _mm_cvttps_epi32(_mm_mul_ps(x, y));
+}
+
+//! lower 32 bit of x * y (_mm_mullo_epi32 is SSE4.1)
+static REALINLINE __m128i imul4(const __m128i x, const __m128i y)
+{
+	const __m128i even = _mm_mul_epu32(x, y);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+//! imulFix, imulFix_simple
+static REALINLINE __m128i imulFix4(const __m128i x, const __m128i y)
+{
+	return _mm_srai_epi32(imul4(x, y), FIX_POINT_PRE);
+}
+
+//! imulFix_tex4
+static REALINLINE __m128i imulFix_tex4_4(const __m128i x, const __m128i y)
+{
+	const __m128i cmax = _mm_set1_epi32(FIXPOINT_COLOR_MAX);
+	const __m128i a = _mm_srli_epi32(imul4(_mm_srli_epi32(x, 2),
+		_mm_srli_epi32(_mm_add_epi32(y, _mm_set1_epi32(FIX_POINT_ONE)), 2)), FIX_POINT_PRE + 2);
+	const __m128i mask = _mm_srai_epi32(_mm_sub_epi32(a, cmax), 31);
+	return _mm_or_si128(_mm_and_si128(a, mask), _mm_andnot_si128(mask, cmax));
+}
+
+//! clampfix_maxcolor
+static REALINLINE __m128i clampfix_maxcolor4(const __m128i a)
+{
+	const __m128i cmax = _mm_set1_epi32(FIXPOINT_COLOR_MAX);
+	const __m128i mask = _mm_srai_epi32(_mm_sub_epi32(a, cmax), 31);
+	return _mm_or_si128(_mm_and_si128(a, mask), _mm_andnot_si128(mask, cmax));
+}
+
+//! mask ? a : b
+static REALINLINE __m128i select4(const __m128i mask, const __m128i a, const __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+//! fix_to_sample
+static REALINLINE __m128i fix_to_sample4(const __m128i r, const __m128i g, const __m128i b)
+{
+	const __m128i cmax = _mm_set1_epi32(FIXPOINT_COLOR_MAX);
+	__m128i v = _mm_set1_epi32((s32)fix_to_sample(0, 0, 0));
+	v = _mm_or_si128(v, _mm_slli_epi32(_mm_and_si128(r, cmax), SHIFT_R - FIX_POINT_PRE));
+	v = _mm_or_si128(v, _mm_srli_epi32(_mm_and_si128(g, cmax), FIX_POINT_PRE - SHIFT_G));
+	v = _mm_or_si128(v, _mm_srli_epi32(_mm_and_si128(b, cmax), FIX_POINT_PRE - SHIFT_B));
+	return v;
+}
+
+//! fix4_to_sample
+static REALINLINE __m128i fix4_to_sample4(const __m128i a, const __m128i r, const __m128i g, const __m128i b)
+{
+	const __m128i cmax = _mm_set1_epi32(FIXPOINT_COLOR_MAX);
+	__m128i v = _mm_slli_epi32(_mm_and_si128(a, _mm_set1_epi32(FIX_POINT_FRACT_MASK - 1)), SHIFT_A - 1);
+	v = _mm_or_si128(v, _mm_slli_epi32(_mm_and_si128(r, cmax), SHIFT_R - FIX_POINT_PRE));
+	v = _mm_or_si128(v, _mm_srli_epi32(_mm_and_si128(g, cmax), FIX_POINT_PRE - SHIFT_G));
+	v = _mm_or_si128(v, _mm_srli_epi32(_mm_and_si128(b, cmax), FIX_POINT_PRE - SHIFT_B));
+	return v;
+}
+
+//! color_to_fix
+static REALINLINE void color_to_fix4(__m128i& r, __m128i& g, __m128i& b, const __m128i t)
+{
+	r = _mm_srli_epi32(_mm_and_si128(t, _mm_set1_epi32(MASK_R)), SHIFT_R - FIX_POINT_PRE);
+	g = _mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(MASK_G)), FIX_POINT_PRE - SHIFT_G);
+	b = _mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(MASK_B)), FIX_POINT_PRE - SHIFT_B);
+}
+
+//! 4 texel from byte offsets
+static REALINLINE __m128i getTexel4(const u8* burning_restrict data, const __m128i ofs)
+{
+	ALIGN(16) u32 o[4];
+	_mm_store_si128((__m128i*)o, ofs);
+	return _mm_set_epi32(
+		*(const s32*)(data + o[3]), *(const s32*)(data + o[2]),
+		*(const s32*)(data + o[1]), *(const s32*)(data + o[0]));
+}
+
+//! texel_ofs_y, texel_ofs_x for 4 pixel
+static REALINLINE __m128i texel_ofs4_y(const sInternalTexture* burning_restrict tex, const __m128i ty)
+{
+	const __m128i y = _mm_srli_epi32(_mm_and_si128(ty, _mm_set1_epi32((s32)tex->textureYMask)), FIX_POINT_PRE);
+	const __m128i pitchlog2 = _mm_cvtsi32_si128((int)tex->pitchlog2);
+#if defined(SOFTWARE_DRIVER_2_TEXTURE_TILED)
+	if (tex->tiled)
+	{
+		const __m128i lo = _mm_set1_epi32(3);
+		return _mm_or_si128(_mm_sll_epi32(_mm_andnot_si128(lo, y), pitchlog2),
+			_mm_slli_epi32(_mm_and_si128(y, lo), SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY + 2));
+	}
+#endif
+	return _mm_sll_epi32(y, pitchlog2);
+}
+
+static REALINLINE __m128i texel_ofs4_x(const sInternalTexture* burning_restrict tex, const __m128i tx)
+{
+	const __m128i x = _mm_srli_epi32(_mm_and_si128(tx, _mm_set1_epi32((s32)tex->textureXMask)), FIX_POINT_PRE - SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY);
+#if defined(SOFTWARE_DRIVER_2_TEXTURE_TILED)
+	if (tex->tiled)
+	{
+		const __m128i hi = _mm_andnot_si128(_mm_set1_epi32((4 << SOFTWARE_DRIVER_2_TEXTURE_GRANULARITY) - 1), x);
+		return _mm_add_epi32(_mm_add_epi32(x, hi), _mm_slli_epi32(hi, 1));
+	}
+#endif
+	return x;
+}
+
+//! weights and texel of the bilinear footprint of 4 pixel
+static REALINLINE void getFootprint4(__m128i& w01, __m128i& w23, __m128i& t0, __m128i& t1, __m128i& t2, __m128i& t3,
+	const sInternalTexture* burning_restrict tex, const __m128i tx, const __m128i ty)
+{
+	const __m128i one = _mm_set1_epi32(FIX_POINT_ONE);
+
+	//w00 w01 w10 w11, all <= FIX_POINT_ONE. w01 and w23 hold two weights in 16 bit each
+	{
+		const __m128i fract = _mm_set1_epi32(FIX_POINT_FRACT_MASK);
+		const __m128i fracx = _mm_and_si128(tx, fract);
+		const __m128i fracy = _mm_and_si128(ty, fract);
+		const __m128i invx = _mm_sub_epi32(one, fracx);
+		const __m128i invy = _mm_sub_epi32(one, fracy);
+
+		w01 = _mm_or_si128(_mm_srli_epi32(_mm_madd_epi16(invx, invy), FIX_POINT_PRE),
+			_mm_slli_epi32(_mm_srli_epi32(_mm_madd_epi16(fracx, invy), FIX_POINT_PRE), 16));
+		w23 = _mm_or_si128(_mm_srli_epi32(_mm_madd_epi16(invx, fracy), FIX_POINT_PRE),
+			_mm_slli_epi32(_mm_srli_epi32(_mm_madd_epi16(fracx, fracy), FIX_POINT_PRE), 16));
+	}
+
+	//wraps positive (ignoring negative)
+	{
+		const __m128i o0 = texel_ofs4_y(tex, ty);
+		const __m128i o1 = texel_ofs4_y(tex, _mm_add_epi32(ty, one));
+		const __m128i o2 = texel_ofs4_x(tex, tx);
+		const __m128i o3 = texel_ofs4_x(tex, _mm_add_epi32(tx, one));
+
+		const u8* data = (const u8*)tex->data;
+		t0 = getTexel4(data, _mm_add_epi32(o0, o2));
+		t1 = getTexel4(data, _mm_add_epi32(o0, o3));
+		t2 = getTexel4(data, _mm_add_epi32(o1, o2));
+		t3 = getTexel4(data, _mm_add_epi32(o1, o3));
+	}
+}
+
+//! filters the color channels of the footprint
+static REALINLINE void filter_rgb4(__m128i& r, __m128i& g, __m128i& b, const __m128i w01, const __m128i w23,
+	const __m128i t0, const __m128i t1, const __m128i t2, const __m128i t3)
+{
+	//channel of texel pair in 16 bit, t0|t1 * w0|w1 + t2|t3 * w2|w3
+	const __m128i lo = _mm_set1_epi32(0x000000FF);
+	const __m128i hi = _mm_set1_epi32(0x00FF0000);
+
+	r = _mm_add_epi32(
+		_mm_madd_epi16(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(t0, SHIFT_R), lo), _mm_and_si128(_mm_srli_epi32(t1, SHIFT_R - 16), hi)), w01),
+		_mm_madd_epi16(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(t2, SHIFT_R), lo), _mm_and_si128(_mm_srli_epi32(t3, SHIFT_R - 16), hi)), w23));
+	g = _mm_add_epi32(
+		_mm_madd_epi16(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(t0, SHIFT_G), lo), _mm_and_si128(_mm_slli_epi32(t1, 16 - SHIFT_G), hi)), w01),
+		_mm_madd_epi16(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(t2, SHIFT_G), lo), _mm_and_si128(_mm_slli_epi32(t3, 16 - SHIFT_G), hi)), w23));
+	b = _mm_add_epi32(
+		_mm_madd_epi16(_mm_or_si128(_mm_and_si128(t0, lo), _mm_and_si128(_mm_slli_epi32(t1, 16 - SHIFT_B), hi)), w01),
+		_mm_madd_epi16(_mm_or_si128(_mm_and_si128(t2, lo), _mm_and_si128(_mm_slli_epi32(t3, 16 - SHIFT_B), hi)), w23));
+}
+
+//! getSample_texture (bilinear) for 4 pixel
+static REALINLINE void getSample_texture4(__m128i& r, __m128i& g, __m128i& b,
+	const sInternalTexture* burning_restrict tex, const __m128i tx, const __m128i ty)
+{
+	__m128i w01, w23, t0, t1, t2, t3;
+	getFootprint4(w01, w23, t0, t1, t2, t3, tex, tx, ty);
+	filter_rgb4(r, g, b, w01, w23, t0, t1, t2, t3);
+}
+
+//! getSample_texture with alpha (bilinear) for 4 pixel
+static REALINLINE void getSample_texture4(__m128i& a, __m128i& r, __m128i& g, __m128i& b,
+	const sInternalTexture* burning_restrict tex, const __m128i tx, const __m128i ty)
+{
+	__m128i w01, w23, t0, t1, t2, t3;
+	getFootprint4(w01, w23, t0, t1, t2, t3, tex, tx, ty);
+	filter_rgb4(r, g, b, w01, w23, t0, t1, t2, t3);
+
+	//alpha is the top byte, no mask needed for the low texel
+	const __m128i hi = _mm_set1_epi32(0x00FF0000);
+	a = _mm_add_epi32(
+		_mm_madd_epi16(_mm_or_si128(_mm_srli_epi32(t0, SHIFT_A), _mm_and_si128(_mm_srli_epi32(t1, SHIFT_A - 16), hi)), w01),
+		_mm_madd_epi16(_mm_or_si128(_mm_srli_epi32(t2, SHIFT_A), _mm_and_si128(_mm_srli_epi32(t3, SHIFT_A - 16), hi)), w23));
+}
+
+} // end namespace video
+} // end namespace irr
+
+#else
+#undef SOFTWARE_DRIVER_2_SIMD_SSE2
+#endif // SOFTWARE_DRIVER_2_SIMD_SSE2
+
+#endif // __BURNING_SHADER_SIMD_H_INCLUDED__
@@ -0,0 +1,205 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+const u32 FileCount = 5;
+const c8* const Files[FileCount] =
+{
+	"../media/ninja.b3d",
+	"../media/dwarf.x",
+	"../media/sydney.md2",
+	"../media/room.3ds",
+	"../media/faerie.md2"
+};
+
+//! same buffers and textures as the mesh loaded at once
+bool sameMesh(IMesh* expected, IMesh* mesh)
+{
+	bool result = expected->getMeshBufferCount() == mesh->getMeshBufferCount();
+	for (u32 b=0; result && b<expected->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* e = expected->getMeshBuffer(b);
+		const IMeshBuffer* m = mesh->getMeshBuffer(b);
+		result &= m->getVertexCount() == e->getVertexCount();
+		result &= m->getIndexCount() == e->getIndexCount();
+		result &= m->getMaterial() == e->getMaterial();
+	}
+	return result;
+}
+
+//! pending requests are committed by the frame loop
+bool pollRequests(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	IMeshCache* cache = smgr->getMeshCache();
+
+	IMeshLoadRequest* requests[FileCount];
+	for (u32 i=0; i<FileCount; ++i)
+		requests[i] = smgr->getMeshAsync(Files[i]);
+
+	// nothing reaches the cache before commitLoadedMeshes
+	bool result = true;
+	for (u32 i=0; i<FileCount; ++i)
+	{
+		result &= !requests[i]->isDone() && !requests[i]->getMesh();
+		result &= !cache->isMeshLoaded(Files[i]);
+	}
+
+	// loading a file again gives the same request
+	IMeshLoadRequest* again = smgr->getMeshAsync(Files[0]);
+	result &= again == requests[0];
+	again->drop();
+
+	IMeshLoadRequest* missing = smgr->getMeshAsync("../media/missing.b3d");
+	result &= missing->isDone() && !missing->getMesh();
+	missing->drop();
+
+	// getMesh waits until the worker is out of the loaders
+	IAnimatedMesh* ninja = smgr->getMesh(Files[0], "sync ninja");
+	result &= ninja != 0;
+
+	u32 frames = 0;
+	while (smgr->commitLoadedMeshes() && frames < 20000)
+	{
+		device->sleep(1);
+		++frames;
+	}
+	const bool finished = smgr->commitLoadedMeshes() == 0;
+	if (!finished)
+		logTestString("background loading did not finish after %u frames\n", frames);
+	result &= finished;
+
+	for (u32 i=0; result && i<FileCount; ++i)
+	{
+		IAnimatedMesh* mesh = requests[i]->getMesh();
+		result &= requests[i]->isDone() && mesh;
+		result &= requests[i]->getName() == Files[i];
+		result &= mesh && cache->getMeshByName(Files[i]) == mesh;
+		if (!result)
+		{
+			logTestString("%s was not loaded in the background\n", Files[i]);
+			break;
+		}
+
+		// textures come from the same driver cache as with getMesh
+		IAnimatedMesh* expected = smgr->getMesh(Files[i], stringc("sync ") + Files[i]);
+		result &= expected && sameMesh(expected->getMesh(0), mesh->getMesh(0));
+		if (!result)
+			logTestString("%s differs from the mesh loaded at once\n", Files[i]);
+	}
+
+	result &= requests[0]->getMesh() && requests[0]->getMesh()->getMeshBuffer(0)->getMaterial().getTexture(0);
+
+	// cached meshes give requests which are done at once
+	IMeshLoadRequest* cached = smgr->getMeshAsync(Files[0]);
+	result &= cached->isDone() && cached->getMesh() == requests[0]->getMesh();
+	cached->drop();
+
+	for (u32 i=0; i<FileCount; ++i)
+		requests[i]->drop();
+
+	return result;
+}
+
+//! commitLoadedMeshes can wait for all requests
+bool waitForRequests(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+
+	IMeshLoadRequest* requests[2];
+	requests[0] = smgr->getMeshAsync(Files[1], "wait dwarf");
+	requests[1] = smgr->getMeshAsync(Files[2], "wait sydney");
+
+	bool result = smgr->commitLoadedMeshes(true) == 0;
+	for (u32 i=0; i<2; ++i)
+	{
+		result &= requests[i]->isDone() && requests[i]->getMesh();
+		requests[i]->drop();
+	}
+
+	result &= smgr->getMeshCache()->isMeshLoaded("wait dwarf");
+	result &= smgr->getMeshCache()->isMeshLoaded("wait sydney");
+	return result;
+}
+
+//! files of loaders which are not thread safe are loaded before getMeshAsync returns
+bool loadAtOnce(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	io::IFileSystem* fs = device->getFileSystem();
+	IMeshCache* cache = smgr->getMeshCache();
+
+	// the worker is busy meanwhile
+	IMeshLoadRequest* busy = smgr->getMeshAsync(Files[0], "busy ninja");
+
+	// the material file is another file of the uncompressed archive
+	bool result = fs->addFileArchive("media/objMtl.zip");
+	IMeshLoadRequest* obj = smgr->getMeshAsync("box.obj");
+	result &= obj->isDone() && obj->getMesh() && cache->isMeshLoaded("box.obj");
+	if (obj->getMesh())
+	{
+		const video::SColor diffuse = obj->getMesh()->getMeshBuffer(0)->getMaterial().DiffuseColor;
+		result &= diffuse == video::SColor(255, 127, 63, 255);
+	}
+	obj->drop();
+	fs->removeFileArchive(fs->getFileArchiveCount() - 1);
+
+	// the COLLADA loader adds scene nodes and further meshes to the cache
+	const u32 meshCount = cache->getMeshCount();
+	smgr->getParameters()->setAttribute(COLLADA_CREATE_SCENE_INSTANCES, true);
+	IMeshLoadRequest* dae = smgr->getMeshAsync("media/lights.dae");
+	result &= dae->isDone() && dae->getMesh();
+	logTestString("lights.dae added %u meshes to the cache\n", cache->getMeshCount() - meshCount);
+	result &= cache->getMeshCount() == meshCount + 3;
+	ISceneNode* light = smgr->getSceneNodeFromType(ESNT_LIGHT);
+	result &= light != 0;
+	if (light)
+		light->remove();
+	smgr->getParameters()->setAttribute(COLLADA_CREATE_SCENE_INSTANCES, false);
+	dae->drop();
+
+	result &= smgr->commitLoadedMeshes(true) == 0;
+	result &= busy->isDone() && busy->getMesh();
+	busy->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Meshes loaded with getMeshAsync are the same as with getMesh, and reach
+the mesh cache when they are committed on the main thread. Loaders which
+are not thread safe load at once. */
+bool asyncMeshLoading()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	bool result = true;
+	result &= pollRequests(device);
+	result &= waitForRequests(device);
+	result &= loadAtOnce(device);
+
+	// dropping the device finishes the requests which are still loading
+	IMeshLoadRequest* request = device->getSceneManager()->getMeshAsync(Files[3], "last room");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= request->isDone() && request->getMesh();
+	request->drop();
+
+	return result;
+}
+
@@ -7,6 +7,334 @@ using namespace irr;
 using namespace scene;
 using namespace video;
 
+/** Compares two screenshots pixel by pixel, each color channel may differ by tolerance.
+	Logs the first differing pixel with the name of the compared feature */
+static bool compareScreenshots(video::IImage* a, video::IImage* b, u32 tolerance, const char* name)
+{
+	if (!a || !b || a->getDimension() != b->getDimension())
+		return false;
+
+	const core::dimension2du& dim = a->getDimension();
+	for (u32 y = 0; y < dim.Height; ++y)
+	{
+		for (u32 x = 0; x < dim.Width; ++x)
+		{
+			const video::SColor ca = a->getPixel(x, y);
+			const video::SColor cb = b->getPixel(x, y);
+			if ((u32)core::abs_((s32)ca.getAlpha() - (s32)cb.getAlpha()) > tolerance ||
+				(u32)core::abs_((s32)ca.getRed() - (s32)cb.getRed()) > tolerance ||
+				(u32)core::abs_((s32)ca.getGreen() - (s32)cb.getGreen()) > tolerance ||
+				(u32)core::abs_((s32)ca.getBlue() - (s32)cb.getBlue()) > tolerance)
+			{
+				logTestString("%s differs at %d,%d\n", name, x, y);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/** Textured spheres, one lit and one transparent. timeMs is the time of all frames,
+	usedThreads the number of rasterizer threads the driver started */
+static video::IImage* renderSpheres(u32 threads, u32 frames, u32& timeMs, s32& usedThreads)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(320, 240);
+	params.BurningVideoThreads = threads;
+
+	timeMs = 0;
+	usedThreads = 0;
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	ITexture* texture = driver->getTexture("../media/wall.bmp");
+	for (u32 i = 0; i < 4; ++i)
+	{
+		ISceneNode* node = smgr->addSphereSceneNode(6.f, 32, 0, -1, core::vector3df(-9.f + i * 6.f, (i & 1) * 3.f, 20.f + i * 2.f));
+		node->setMaterialTexture(0, texture);
+		node->setMaterialFlag(video::EMF_LIGHTING, i == 0);
+		if (i == 2)
+			node->setMaterialType(video::EMT_TRANSPARENT_ADD_COLOR);
+	}
+	smgr->addLightSceneNode(0, core::vector3df(0.f, 20.f, 0.f), video::SColorf(1.f, 1.f, 1.f), 100.f);
+	smgr->addCameraSceneNode();
+
+	video::IImage* image = 0;
+	device->run();
+	const u32 start = device->getTimer()->getRealTime();
+	for (u32 i = 0; i < frames; ++i)
+	{
+		if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+		{
+			smgr->drawAll();
+			driver->endScene();
+		}
+	}
+	timeMs = device->getTimer()->getRealTime() - start;
+	usedThreads = driver->getDriverAttributes().getAttributeAsInt("RasterizerThreads");
+	image = driver->createScreenShot();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+/** The tile binned rasterizer has to produce exactly the same image with any number of threads.
+	Logs the time of each thread count, the speedup is bounded by the cores of the machine */
+static bool multithreadedRasterizer()
+{
+	const u32 frames = 8;
+	const u32 threadCounts[] = { 0, 2, 4, 32 };
+	const u32 count = sizeof(threadCounts) / sizeof(threadCounts[0]);
+
+	u32 singleMs;
+	s32 usedThreads;
+	video::IImage* single = renderSpheres(threadCounts[0], frames, singleMs, usedThreads);
+	logTestString("Rasterizer, %u frames: 1 thread %u ms\n", frames, singleMs);
+
+	bool result = single != 0;
+	for (u32 i = 1; i < count && result; ++i)
+	{
+		u32 threadedMs;
+		video::IImage* threaded = renderSpheres(threadCounts[i], frames, threadedMs, usedThreads);
+		logTestString("Rasterizer, %u frames: %u threads (%d started) %u ms, speedup %.2f\n", frames,
+			threadCounts[i], usedThreads, threadedMs, threadedMs ? (f32)singleMs / threadedMs : 0.f);
+
+		char name[64];
+		snprintf_irr(name, sizeof(name), "Rasterizer with %u threads", threadCounts[i]);
+		result = compareScreenshots(single, threaded, 0, name);
+
+		if (threaded)
+			threaded->drop();
+	}
+
+	if (single)
+		single->drop();
+
+	return result;
+}
+
+/** Textured floor seen at a steep angle and a magnified textured cube. timeMs is the time of all frames */
+static video::IImage* renderTextureScene(bool tiled, u32 frames, u32& timeMs)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(320, 240);
+	params.BurningVideoTiledTextures = tiled;
+
+	timeMs = 0;
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	IAnimatedMesh* plane = smgr->addHillPlaneMesh("burningsVideoFloor",
+		core::dimension2df(20.f, 20.f), core::dimension2du(16, 16), 0, 0.f,
+		core::dimension2df(0.f, 0.f), core::dimension2df(16.f, 16.f));
+	ISceneNode* node = smgr->addMeshSceneNode(plane->getMesh(0));
+	node->setMaterialTexture(0, driver->getTexture("../media/wall.bmp"));
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+
+	node = smgr->addCubeSceneNode(10.f, 0, -1, core::vector3df(-3.f, 12.f, 0.f), core::vector3df(30.f, 20.f, 0.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/fireball.bmp"));
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 10.f, -12.f), core::vector3df(0.f, 0.f, 160.f));
+
+	video::IImage* image = 0;
+	device->run();
+	const u32 start = device->getTimer()->getRealTime();
+	for (u32 i = 0; i < frames; ++i)
+	{
+		if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+		{
+			smgr->drawAll();
+			driver->endScene();
+		}
+	}
+	timeMs = device->getTimer()->getRealTime() - start;
+	image = driver->createScreenShot();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+/** Sampling the 4x4 tiled texel layout has to produce the same image as the row major layout.
+	Logs the time of both layouts */
+static bool tiledTextures()
+{
+	const u32 frames = 8;
+	u32 linearMs, tiledMs;
+	video::IImage* linear = renderTextureScene(false, frames, linearMs);
+	video::IImage* tiled = renderTextureScene(true, frames, tiledMs);
+
+	const bool result = compareScreenshots(linear, tiled, 0, "Tiled texture layout");
+	logTestString("Texel layout, %u frames: row major %u ms, 4x4 tiles %u ms\n", frames, linearMs, tiledMs);
+
+	if (linear)
+		linear->drop();
+	if (tiled)
+		tiled->drop();
+
+	return result;
+}
+
+/** Textured cube and spheres crossing the borders of the viewport, without mipmaps.
+	clipPaths receives the driver attributes ClipTriangles* of the frame: inside, outside, guard band, clipped */
+static video::IImage* renderBorderScene(bool guardBand, s32 clipPaths[4])
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	params.BurningVideoGuardBand = guardBand;
+
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, false);
+	ITexture* texture = driver->getTexture("../media/wall.bmp");
+
+	ISceneNode* node = smgr->addCubeSceneNode(10.f, 0, -1, core::vector3df(-4.f, 0.f, 9.f), core::vector3df(20.f, 35.f, 0.f));
+	node->setMaterialTexture(0, texture);
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+	for (u32 i = 0; i < 3; ++i)
+	{
+		node = smgr->addSphereSceneNode(5.f, 16, 0, -1, core::vector3df(-12.f + i * 12.f, 7.f - i * 7.f, 16.f));
+		node->setMaterialTexture(0, texture);
+		node->setMaterialFlag(video::EMF_LIGHTING, false);
+	}
+	smgr->addCameraSceneNode();
+
+	video::IImage* image = 0;
+	device->run();
+	if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+	{
+		smgr->drawAll();
+		driver->endScene();
+		image = driver->createScreenShot();
+	}
+
+	const io::IAttributes& attr = driver->getDriverAttributes();
+	clipPaths[0] = attr.getAttributeAsInt("ClipTrianglesInside");
+	clipPaths[1] = attr.getAttributeAsInt("ClipTrianglesOutside");
+	clipPaths[2] = attr.getAttributeAsInt("ClipTrianglesGuardBand");
+	clipPaths[3] = attr.getAttributeAsInt("ClipTrianglesClipped");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+/** Scissoring unclipped triangles in the rasterizer has to match geometric clipping up to rounding,
+	and the clip path counters have to show the moved triangles */
+static bool guardBand()
+{
+	s32 clip[4], guard[4];
+	video::IImage* clipped = renderBorderScene(false, clip);
+	video::IImage* scissored = renderBorderScene(true, guard);
+
+	logTestString("Clip paths (inside/outside/guard band/clipped): frustum %d/%d/%d/%d, guard band %d/%d/%d/%d\n",
+		clip[0], clip[1], clip[2], clip[3], guard[0], guard[1], guard[2], guard[3]);
+
+	bool result = clip[2] == 0 && clip[3] > 0;
+	result &= guard[2] > 0 && guard[3] < clip[3];
+	result &= guard[0] == clip[0] && guard[1] == clip[1];
+	result &= compareScreenshots(clipped, scissored, 2, "Guard band");
+
+	if (clipped)
+		clipped->drop();
+	if (scissored)
+		scissored->drop();
+
+	return result;
+}
+
+/** Lit specular floor vanishing in linear fog and a texture blended with its alpha channel */
+static video::IImage* renderFogBlendScene(bool simd)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	params.BurningVideoSimd = simd;
+
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	// the floor is turned, so scanlines run from the part completely inside the fog to the visible part
+	driver->setFog(video::SColor(0, 120, 140, 160), video::EFT_FOG_LINEAR, 10.f, 60.f);
+
+	IAnimatedMesh* plane = smgr->addHillPlaneMesh("burningsVideoFogFloor",
+		core::dimension2df(10.f, 10.f), core::dimension2du(16, 16), 0, 0.f,
+		core::dimension2df(0.f, 0.f), core::dimension2df(8.f, 8.f));
+	ISceneNode* node = smgr->addMeshSceneNode(plane->getMesh(0), 0, -1, core::vector3df(0.f, -5.f, 70.f), core::vector3df(0.f, 50.f, 0.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/wall.bmp"));
+	node->setMaterialFlag(video::EMF_FOG_ENABLE, true);
+	node->getMaterial(0).Shininess = 20.f;
+	node->getMaterial(0).SpecularColor.set(255, 255, 255, 255);
+
+	node = smgr->addCubeSceneNode(8.f, 0, -1, core::vector3df(2.f, 0.f, 14.f), core::vector3df(20.f, 30.f, 0.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/irrlichtlogoalpha2.tga"));
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+	node->setMaterialType(video::EMT_ONETEXTURE_BLEND);
+	node->getMaterial(0).MaterialTypeParam = video::pack_textureBlendFunc(video::EBF_SRC_ALPHA, video::EBF_ONE_MINUS_SRC_ALPHA);
+
+	smgr->addLightSceneNode(0, core::vector3df(0.f, 10.f, 10.f), video::SColorf(1.f, 1.f, 1.f), 60.f);
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 2.f, 0.f), core::vector3df(0.f, -2.f, 40.f));
+
+	video::IImage* image = 0;
+	device->run();
+	if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+	{
+		smgr->drawAll();
+		driver->endScene();
+		image = driver->createScreenShot();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+/** The SSE2 span kernels have to produce exactly the same image as the scalar code */
+static bool simdSpans()
+{
+	video::IImage* scalar = renderFogBlendScene(false);
+	video::IImage* simd = renderFogBlendScene(true);
+
+	const bool result = compareScreenshots(scalar, simd, 0, "SSE2 span kernels");
+
+	if (scalar)
+		scalar->drop();
+	if (simd)
+		simd->drop();
+
+	return result;
+}
+
 /** Tests the Burning Video driver */
 bool burningsVideo(void)
 {
@@ -36,5 +364,10 @@ bool burningsVideo(void)
 	device->run();
     device->drop();
 
+	result &= multithreadedRasterizer();
+	result &= tiledTextures();
+	result &= guardBand();
+	result &= simdSpans();
+
     return result;
 }
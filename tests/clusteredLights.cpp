@@ -0,0 +1,130 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+//! box which logs the lights switched on while it is rendered
+class CLightProbeNode : public ISceneNode
+{
+public:
+	CLightProbeNode(ISceneManager* smgr, const vector3df& position, const array<ILightSceneNode*>& lights)
+		: ISceneNode(smgr->getRootSceneNode(), smgr, -1, position), Lights(lights)
+	{
+		Box.reset(vector3df(-1.f, -1.f, -1.f));
+		Box.addInternalPoint(vector3df(1.f, 1.f, 1.f));
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		if (IsVisible)
+			SceneManager->registerNodeForRendering(this, ESNRP_SOLID);
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render()
+	{
+		On.clear();
+		for (u32 i=0; i<Lights.size(); ++i)
+		{
+			if (Lights[i]->isVisible())
+				On.push_back(i);
+		}
+	}
+
+	virtual const aabbox3d<f32>& getBoundingBox() const { return Box; }
+
+	bool isOn(u32 light) const { return On.linear_search(light) >= 0; }
+
+	array<u32> On;
+
+private:
+	const array<ILightSceneNode*>& Lights;
+	aabbox3d<f32> Box;
+};
+
+} // end anonymous namespace
+
+/** Many lights in a row, each probe may only get the nearest ones reaching
+it, at most as many as allowed per node. */
+bool clusteredLights()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+	bool result = true;
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, 0.f), vector3df(0.f, 0.f, 100.f));
+	cam->setFarValue(1000.f);
+
+	// light i is at x = 10*i - 200, lights 19 to 21 reach the middle probe
+	array<ILightSceneNode*> lights;
+	for (s32 i=0; i<41; ++i)
+		lights.push_back(smgr->addLightSceneNode(0, vector3df(10.f * i - 200.f, 0.f, 60.f), video::SColorf(1.f, 1.f, 1.f), 15.f));
+	// a light behind the camera for a probe outside of the clusters
+	lights.push_back(smgr->addLightSceneNode(0, vector3df(0.f, 0.f, -60.f), video::SColorf(1.f, 1.f, 1.f), 15.f));
+
+	CLightProbeNode* middle = new CLightProbeNode(smgr, vector3df(0.f, 0.f, 60.f), lights);
+	CLightProbeNode* left = new CLightProbeNode(smgr, vector3df(-150.f, 0.f, 60.f), lights);
+	CLightProbeNode* between = new CLightProbeNode(smgr, vector3df(0.f, 40.f, 60.f), lights);
+	CLightProbeNode* behind = new CLightProbeNode(smgr, vector3df(0.f, 0.f, -60.f), lights);
+	behind->setAutomaticCulling(EAC_OFF);
+
+	IClusteredLightManager* lightManager = smgr->createClusteredLightManager(2);
+	smgr->setLightManager(lightManager);
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	smgr->drawAll();
+	driver->endScene();
+
+	result &= lightManager->getClusterLightCount() > 0;
+	result &= middle->On.size() == 2 && middle->isOn(20) && (middle->isOn(19) || middle->isOn(21));
+	result &= left->On.size() == 2 && left->isOn(5) && (left->isOn(4) || left->isOn(6));
+	result &= between->On.empty();
+	result &= behind->On.size() == 1 && behind->isOn(41);
+	if (!result)
+		logTestString("middle %u, left %u, between %u, behind %u lights\n",
+			middle->On.size(), left->On.size(), between->On.size(), behind->On.size());
+
+	// lights have to register again in the next frame
+	for (u32 i=0; i<lights.size(); ++i)
+		result &= lights[i]->isVisible();
+
+	// directional lights reach every node
+	ILightSceneNode* sun = smgr->addLightSceneNode();
+	sun->setLightType(video::ELT_DIRECTIONAL);
+	lights.push_back(sun);
+	lightManager->setMaxLightsPerNode(4);
+	lightManager->setClusterGrid(4, 4, 4);
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	smgr->drawAll();
+	driver->endScene();
+
+	result &= middle->On.size() == 4 && middle->isOn(19) && middle->isOn(20) && middle->isOn(21) && middle->isOn(42);
+	result &= between->On.size() == 1 && between->isOn(42);
+
+	middle->drop();
+	left->drop();
+	between->drop();
+	behind->drop();
+
+	smgr->setLightManager(0);
+	lightManager->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,283 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+//! half floats keep 11 significant bits, denormals and the limits
+bool halfFloats()
+{
+	bool result = true;
+	const f32 exact[] = { 0.f, 1.f, -2.5f, 0.099975586f, 65504.f, -1.f/16384.f, 1.f/16777216.f };
+	for (u32 i=0; i<sizeof(exact)/sizeof(exact[0]); ++i)
+		result &= f16_to_f32(f32_to_f16(exact[i])) == exact[i];
+
+	// round to nearest, ties to even
+	result &= f16_to_f32(f32_to_f16(1.f + 1.f/2048.f)) == 1.f;
+	result &= f16_to_f32(f32_to_f16(1.f + 3.f/2048.f)) == 1.f + 1.f/512.f;
+	result &= f16_to_f32(f32_to_f16(0.1f)) == 0.099975586f;
+
+	// overflow to infinity
+	result &= f16_to_f32(f32_to_f16(70000.f)) > FLT_MAX;
+	result &= f16_to_f32(f32_to_f16(-FLT_MAX)) < -FLT_MAX;
+	const f32 nan = f16_to_f32(f32_to_f16(sqrtf(-1.f)));
+	result &= nan != nan;
+
+	if (!result)
+		logTestString("half float conversion failed\n");
+	return result;
+}
+
+//! maximum errors of the compact mesh against the source mesh
+bool matchesSource(IMesh* source, IMesh* compact, f32 positionError, f32 normalError, f32 tcoordError)
+{
+	bool result = source->getMeshBufferCount() == compact->getMeshBufferCount();
+	for (u32 b=0; result && b<source->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* s = source->getMeshBuffer(b);
+		const IMeshBuffer* c = compact->getMeshBuffer(b);
+		result &= c->getVertexType() == video::EVT_COMPACT;
+		result &= c->getVertexCount() == s->getVertexCount();
+		result &= c->getIndexCount() == s->getIndexCount();
+		for (u32 i=0; result && i<s->getIndexCount(); ++i)
+			result &= c->getIndices()[i] == s->getIndices()[i];
+
+		f32 maxPosition = 0.f;
+		f32 minNormal = 1.f;
+		f32 maxTCoords = 0.f;
+		for (u32 i=0; result && i<s->getVertexCount(); ++i)
+		{
+			maxPosition = max_(maxPosition, c->getPosition(i).getDistanceFrom(s->getPosition(i)));
+			// vertices of degenerated triangles only get no normal when recalculating
+			if (!s->getNormal(i).equals(vector3df(0.f)))
+				minNormal = min_(minNormal, c->getNormal(i).dotProduct(vector3df(s->getNormal(i)).normalize()));
+			maxTCoords = max_(maxTCoords, c->getTCoords(i).getDistanceFrom(s->getTCoords(i)));
+		}
+		if (maxPosition > positionError || minNormal < cosf(normalError * DEGTORAD) || maxTCoords > tcoordError)
+		{
+			logTestString("compact buffer %u: position error %f, normal error %f degrees, tcoord error %f\n",
+				b, maxPosition, acosf(min_(minNormal, 1.f)) * RADTODEG, maxTCoords);
+			result = false;
+		}
+	}
+	return result;
+}
+
+//! renders the mesh lit and textured with the Burning's video driver
+video::IImage* renderMesh(IMesh* mesh)
+{
+	IrrlichtDevice* device = createDevice(video::EDT_BURNINGSVIDEO, dimension2du(160, 120), 32);
+	if (!device)
+		return 0;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	IMeshSceneNode* node = smgr->addMeshSceneNode(mesh, 0, -1, vector3df(0.f, 0.f, 20.f), vector3df(20.f, 30.f, 0.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/wall.bmp"));
+	node->setMaterialFlag(video::EMF_LIGHTING, true);
+	smgr->addLightSceneNode(0, vector3df(10.f, 20.f, 0.f), video::SColorf(1.f, 1.f, 1.f), 100.f);
+	smgr->addCameraSceneNode();
+
+	video::IImage* image = 0;
+	device->run();
+	if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 80, 80, 80)))
+	{
+		smgr->drawAll();
+		driver->endScene();
+		image = driver->createScreenShot();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return image;
+}
+
+//! the compact mesh has to look like the source mesh, apart from a few edge pixels
+bool sameRendering(IMesh* source, IMesh* compact)
+{
+	video::IImage* expected = renderMesh(source);
+	video::IImage* image = renderMesh(compact);
+	if (!expected || !image)
+	{
+		if (expected)
+			expected->drop();
+		if (image)
+			image->drop();
+		return true;
+	}
+
+	const dimension2du& dim = expected->getDimension();
+	u32 different = 0;
+	u32 shaded = 0;
+	for (u32 y=0; y<dim.Height; ++y)
+	{
+		for (u32 x=0; x<dim.Width; ++x)
+		{
+			const video::SColor a = expected->getPixel(x, y);
+			const video::SColor b = image->getPixel(x, y);
+			if (a != video::SColor(255, 80, 80, 80))
+				++shaded;
+			if (abs_((s32)a.getRed() - (s32)b.getRed()) > 8 ||
+				abs_((s32)a.getGreen() - (s32)b.getGreen()) > 8 ||
+				abs_((s32)a.getBlue() - (s32)b.getBlue()) > 8)
+				++different;
+		}
+	}
+	expected->drop();
+	image->drop();
+
+	const bool result = shaded > dim.Width * dim.Height / 4 && different * 100 < shaded;
+	if (!result)
+		logTestString("compact rendering differs in %u of %u pixels\n", different, shaded);
+	return result;
+}
+
+} // end anonymous namespace
+
+//! checks the buffer has compact vertices and draws the same triangles in any order
+bool sameTriangles(const IMeshBuffer* source, const IMeshBuffer* reordered)
+{
+	bool result = reordered->getVertexType() == video::EVT_COMPACT;
+	result &= reordered->getIndexCount() == source->getIndexCount();
+	result &= reordered->getBoundingBox().MinEdge.equals(source->getBoundingBox().MinEdge);
+	result &= reordered->getBoundingBox().MaxEdge.equals(source->getBoundingBox().MaxEdge);
+	if (!result)
+		return false;
+
+	const video::S3DVertexCompact* s = (const video::S3DVertexCompact*)source->getVertices();
+	const video::S3DVertexCompact* r = (const video::S3DVertexCompact*)reordered->getVertices();
+	u32 sourceSum[3] = {0, 0, 0};
+	u32 reorderedSum[3] = {0, 0, 0};
+	for (u32 i=0; i<source->getIndexCount(); ++i)
+	{
+		for (u32 k=0; k<3; ++k)
+		{
+			sourceSum[k] += s[source->getIndices()[i]].Pos[k];
+			reorderedSum[k] += r[reordered->getIndices()[i]].Pos[k];
+		}
+	}
+	return sourceSum[0] == reorderedSum[0] && sourceSum[1] == reorderedSum[1] && sourceSum[2] == reorderedSum[2];
+}
+
+
+/** Compact vertices decode within the quantization steps, convert back to
+float vertices and draw like their source. */
+bool compactVertices()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IMeshManipulator* manipulator = device->getSceneManager()->getMeshManipulator();
+	const IGeometryCreator* geometry = device->getSceneManager()->getGeometryCreator();
+	bool result = true;
+
+	result &= sizeof(video::S3DVertexCompact) == 16;
+	result &= video::getVertexPitchFromType(video::EVT_COMPACT) == 16;
+	result &= halfFloats();
+
+	// positions in steps of 1/65535 of the box, tcoords in steps of 1/2048
+	IMesh* sphere = geometry->createSphereMesh(10.f, 32, 32);
+	IMesh* compact = manipulator->createMeshCompact(sphere);
+	result &= matchesSource(sphere, compact, 20.f / 65535.f, 0.7f, 1.f / 2048.f);
+	result &= compact->getBoundingBox().MinEdge.equals(sphere->getBoundingBox().MinEdge);
+	result &= compact->getBoundingBox().MaxEdge.equals(sphere->getBoundingBox().MaxEdge);
+
+	// float vertices again, and copies stay compact
+	IMesh* decoded = manipulator->createMeshWith1TCoords(compact);
+	result &= decoded->getMeshBuffer(0)->getVertexType() == video::EVT_STANDARD;
+	result &= matchesSource(decoded, compact, 0.f, 0.1f, 0.f);
+	IMesh* copy = manipulator->createMeshCopy(compact);
+	result &= matchesSource(decoded, copy, 0.f, 0.1f, 0.f);
+
+	// normals are encoded again after recalculating them
+	manipulator->recalculateNormals(decoded, true);
+	manipulator->recalculateNormals(copy, true);
+	result &= matchesSource(decoded, copy, 0.f, 0.7f, 0.f);
+	copy->drop();
+
+	// reordered meshes keep the compact vertices
+	IMesh* unique = manipulator->createMeshUniquePrimitives(compact);
+	result &= unique->getMeshBuffer(0)->getVertexCount() == compact->getMeshBuffer(0)->getIndexCount();
+	result &= sameTriangles(compact->getMeshBuffer(0), unique->getMeshBuffer(0));
+	unique->drop();
+	IMesh* optimized = manipulator->createForsythOptimizedMesh(compact);
+	result &= optimized->getMeshBuffer(0)->getVertexCount() <= compact->getMeshBuffer(0)->getVertexCount();
+	result &= sameTriangles(compact->getMeshBuffer(0), optimized->getMeshBuffer(0));
+	optimized->drop();
+
+	// the decoded copy of the accessors can be freed
+	SCompactMeshBuffer* compactBuffer = (SCompactMeshBuffer*)compact->getMeshBuffer(0);
+	const core::vector3df position = compactBuffer->getPosition(7);
+	compactBuffer->freeDecoded();
+	result &= compactBuffer->getPosition(7) == position;
+
+	// other buffers are encoded on append, into a box around all vertices
+	const IMeshBuffer* source = sphere->getMeshBuffer(0);
+	SCompactMeshBuffer* appended = new SCompactMeshBuffer();
+	appended->append(source);
+	appended->append(compactBuffer);
+	const u32 count = source->getVertexCount();
+	result &= appended->getVertexCount() == count*2;
+	result &= appended->getIndexCount() == source->getIndexCount()*2;
+	result &= appended->getIndices()[source->getIndexCount()] == source->getIndices()[0]+count;
+	result &= appended->getBoundingBox().MinEdge.equals(source->getBoundingBox().MinEdge, 0.001f);
+	result &= appended->getBoundingBox().MaxEdge.equals(source->getBoundingBox().MaxEdge, 0.001f);
+	result &= appended->getPosition(count+7).equals(position, 0.001f);
+	result &= ((const video::S3DVertexCompact*)appended->getVertices())[5].Color == ((const video::S3DVertex*)source->getVertices())[5].Color;
+
+	// writes through the accessors are encoded by setDirty
+	appended->getTCoords(3) = core::vector2df(0.25f, 0.5f);
+	appended->getNormal(3) = core::vector3df(0.f, 1.f, 0.f);
+	appended->setDirty(EBT_VERTEX);
+	appended->freeDecoded();
+	result &= appended->getTCoords(3) == core::vector2df(0.25f, 0.5f);
+	result &= appended->getNormal(3).equals(core::vector3df(0.f, 1.f, 0.f));
+
+	// positions outside of the box grow it and keep the other vertices in place
+	const core::vector3df outside = source->getBoundingBox().MaxEdge + core::vector3df(10.f, 0.f, 0.f);
+	appended->setPosition(0, outside);
+	result &= appended->getBoundingBox().isPointInside(outside);
+	result &= appended->getPosition(0).equals(outside, 0.001f);
+	result &= appended->getPosition(7).equals(position, 0.001f);
+	appended->setTCoords(4, core::vector2df(0.75f, 1.f));
+	result &= appended->getTCoords(4) == core::vector2df(0.75f, 1.f);
+
+	// and recalculating the box fits it to the vertices again
+	appended->setPosition(0, position);
+	appended->recalculateBoundingBox();
+	result &= appended->getBoundingBox().MaxEdge.equals(source->getBoundingBox().MaxEdge, 0.001f);
+	result &= appended->getPosition(7).equals(position, 0.001f);
+	appended->drop();
+
+	// 32 bit buffers are shared
+	SMesh* large = new SMesh();
+	CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(video::EVT_STANDARD, video::EIT_32BIT);
+	large->addMeshBuffer(buffer);
+	IMesh* shared = manipulator->createMeshCompact(large);
+	result &= shared->getMeshBuffer(0) == buffer;
+	shared->drop();
+	buffer->drop();
+	large->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= sameRendering(sphere, compact);
+
+	decoded->drop();
+	compact->drop();
+	sphere->drop();
+
+	return result;
+}
@@ -0,0 +1,120 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+//! moves a node one unit per update, the update waits for the frame to be drawn
+class CStepUpdater : public IFrameUpdater
+{
+public:
+	CStepUpdater(ISceneNode* node, ITimer* timer)
+		: Node(node), Timer(timer), Updates(0), Applies(0), BackTime(0), FrontTime(0),
+		Drawn(false), BackOverlapped(false), Overlapped(0)
+	{
+	}
+
+	virtual void update(u32 timeMs)
+	{
+		// only finishes early if run() returned while it was running
+		const u32 end = Timer->getRealTime() + 2000;
+		while (!Drawn && Timer->getRealTime() < end)
+		{
+		}
+		BackOverlapped = Drawn;
+
+		++Updates;
+		BackPosition.set((f32)Updates, 0.f, 0.f);
+		BackTime = timeMs;
+	}
+
+	virtual void apply()
+	{
+		Node->setPosition(BackPosition);
+		FrontTime = BackTime;
+		if (BackOverlapped)
+			++Overlapped;
+		Drawn = false;
+		++Applies;
+	}
+
+	ISceneNode* Node;
+	ITimer* Timer;
+	u32 Updates;
+	u32 Applies;
+	vector3df BackPosition;
+	u32 BackTime;
+	u32 FrontTime;
+	volatile bool Drawn;
+	bool BackOverlapped;
+	u32 Overlapped;
+};
+
+} // end anonymous namespace
+
+/** The update of the next frame runs while the application draws, run()
+applies the finished one before it starts another. */
+bool frameUpdater()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+	bool result = true;
+
+	ISceneNode* node = smgr->addEmptySceneNode();
+	CStepUpdater* updater = new CStepUpdater(node, device->getTimer());
+	device->setFrameUpdater(updater);
+	result &= device->getFrameUpdater() == updater;
+	result &= updater->getReferenceCount() == 2;
+
+	u32 times[3];
+	for (u32 frame=0; frame<3; ++frame)
+	{
+		device->run();
+		times[frame] = device->getTimer()->getTime();
+
+		// the results of the first update are not applied before the second frame
+		result &= updater->Applies == frame;
+		result &= equals(node->getPosition().X, (f32)frame);
+		if (frame)
+			result &= updater->FrontTime == times[frame-1];
+
+		driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+		smgr->drawAll();
+		driver->endScene();
+		updater->Drawn = true;
+	}
+	result &= updater->Overlapped == 2;
+
+	// switching off waits for the running update but does not apply it
+	device->setFrameUpdater(0);
+	result &= updater->Updates == 3;
+	result &= updater->Applies == 2;
+	result &= updater->getReferenceCount() == 1;
+	result &= device->getFrameUpdater() == 0;
+
+	device->run();
+	result &= updater->Applies == 2;
+
+	if (!result)
+		logTestString("%u updates, %u applies, %u overlapped\n",
+			updater->Updates, updater->Applies, updater->Overlapped);
+
+	updater->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,143 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+//! counts the instances whose world box is not completely outside of the camera frustum
+u32 countVisibleInstances(IInstancedMeshSceneNode* node, ICameraSceneNode* cam)
+{
+	const SViewFrustum* frustum = cam->getViewFrustum();
+	const matrix4& absolute = node->getAbsoluteTransformation();
+
+	u32 visible = 0;
+	for (u32 i=0; i<node->getInstanceCount(); ++i)
+	{
+		aabbox3df box = node->getMesh()->getBoundingBox();
+		(absolute * node->getInstanceTransformation(i)).transformBoxEx(box);
+
+		bool outside = false;
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			if (box.classifyPlaneRelation(frustum->planes[p]) == ISREL3D_FRONT)
+				outside = true;
+		}
+		if (!outside)
+			++visible;
+	}
+	return visible;
+}
+
+bool drawFrame(IrrlichtDevice* device, IInstancedMeshSceneNode* node, ICameraSceneNode* cam,
+	u32 trianglesPerInstance, const char* name)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+
+	const u32 expected = node->getAutomaticCulling() == EAC_OFF ? node->getInstanceCount() : countVisibleInstances(node, cam);
+	if (node->getVisibleInstanceCount() != expected)
+	{
+		logTestString("%s: %u visible instances, expected %u\n", name, node->getVisibleInstanceCount(), expected);
+		return false;
+	}
+
+	if (driver->getPrimitiveCountDrawn() != expected * trianglesPerInstance)
+	{
+		logTestString("%s: %u primitives drawn, expected %u\n", name, driver->getPrimitiveCountDrawn(), expected * trianglesPerInstance);
+		return false;
+	}
+
+	return true;
+}
+
+}
+
+/** The instances which are drawn have to be the ones whose boxes are not
+outside of the view frustum, after instances were added, moved or removed. */
+bool instancedMeshSceneNode()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(1.f, 1.f, 1.f));
+	IInstancedMeshSceneNode* node = smgr->addInstancedMeshSceneNode(cube, 0, -1, vector3df(5.f, 0.f, 3.f));
+	cube->drop();
+	assert_log(node);
+	if (!node)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	const u32 triangles = cube->getMeshBuffer(0)->getPrimitiveCount();
+
+	// more instances than fit into one batch
+	for (s32 x=0; x<60; ++x)
+	{
+		for (s32 z=0; z<60; ++z)
+		{
+			node->addInstance(vector3df(x * 3.f, (x*z % 5) * 0.5f, z * 3.f),
+				vector3df(0.f, (f32)(x*z % 90), 0.f), vector3df(1.f + (x % 3) * 0.5f, 1.f, 1.f),
+				video::SColor(255, x*4, z*4, 255));
+		}
+	}
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(-20.f, 30.f, -40.f), vector3df(60.f, 0.f, 80.f));
+	cam->setFarValue(120.f);
+
+	bool result = true;
+	result &= drawFrame(device, node, cam, triangles, "grid");
+	result &= (node->getVisibleInstanceCount() > 0 && node->getVisibleInstanceCount() < node->getInstanceCount());
+
+	// same view, batches are reused
+	result &= drawFrame(device, node, cam, triangles, "same view");
+
+	cam->setTarget(vector3df(150.f, 0.f, 20.f));
+	result &= drawFrame(device, node, cam, triangles, "turned");
+
+	for (u32 i=0; i<node->getInstanceCount(); i+=7)
+	{
+		matrix4 m = node->getInstanceTransformation(i);
+		m.setTranslation(m.getTranslation() + vector3df(-30.f, 5.f, 11.f));
+		node->setInstanceTransformation(i, m);
+	}
+	result &= drawFrame(device, node, cam, triangles, "moved");
+
+	for (u32 i=0; i<1000; ++i)
+		node->removeInstance((i * 37) % node->getInstanceCount());
+	result &= (node->getInstanceCount() == 2600);
+	result &= drawFrame(device, node, cam, triangles, "removed");
+
+	node->setAutomaticCulling(EAC_OFF);
+	result &= drawFrame(device, node, cam, triangles, "culling off");
+	node->setAutomaticCulling(EAC_BOX);
+
+	cam->setTarget(vector3df(-100.f, 30.f, -40.f));
+	result &= drawFrame(device, node, cam, triangles, "looking away");
+	result &= (node->getVisibleInstanceCount() == 0);
+
+	node->clearInstances();
+	cam->setTarget(vector3df(60.f, 0.f, 80.f));
+	result &= drawFrame(device, node, cam, triangles, "cleared");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
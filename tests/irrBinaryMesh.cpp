@@ -0,0 +1,365 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+array<c8> Data;
+
+//! writes the mesh into Data, returns the file size
+u32 writeMesh(IrrlichtDevice* device, IMesh* mesh)
+{
+	Data.set_used(4*1024*1024);
+	io::IWriteFile* file = device->getFileSystem()->createMemoryWriteFile(Data.pointer(), Data.size(), "mesh.irrbin");
+	IMeshWriter* writer = device->getSceneManager()->createMeshWriter(EMWT_IRR_BINARY_MESH);
+	const bool written = writer->writeMesh(file, mesh);
+	const u32 size = (u32)file->getPos();
+	writer->drop();
+	file->drop();
+	return written ? size : 0;
+}
+
+//! loads size bytes of Data, with a name which is not in the mesh cache yet
+IAnimatedMesh* loadMesh(IrrlichtDevice* device, u32 size)
+{
+	static u32 count = 0;
+	io::IReadFile* file = device->getFileSystem()->createMemoryReadFile(Data.const_pointer(), size,
+		stringc("mesh") + stringc(++count) + ".irrbin");
+	IAnimatedMesh* mesh = device->getSceneManager()->getMesh(file);
+	file->drop();
+	return mesh;
+}
+
+//! swaps the u32 at pos in Data, returns its value before swapping
+u32 swapWord(u32& pos)
+{
+	u32 value;
+	memcpy(&value, &Data[pos], 4);
+	const u32 swapped = (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+	memcpy(&Data[pos], &swapped, 4);
+	pos += 4;
+	return value;
+}
+
+void swapWords(u32& pos, u32 count)
+{
+	for (u32 i=0; i<count; ++i)
+		swapWord(pos);
+}
+
+void swapHalf(u32& pos)
+{
+	const c8 c = Data[pos];
+	Data[pos] = Data[pos+1];
+	Data[pos+1] = c;
+	pos += 2;
+}
+
+//! arrays start at offsets aligned to 16 bytes
+void skipPadding(u32& pos, u32 alignment)
+{
+	pos = (pos + alignment - 1) / alignment * alignment;
+}
+
+void swapString(u32& pos)
+{
+	const u32 length = swapWord(pos);
+	pos += length;
+	skipPadding(pos, 4);
+}
+
+//! converts the file in Data to the other byte order, following the layout documented in SIrrBinaryMeshStructs.h
+void swapFile()
+{
+	u32 pos = 4;
+	swapWord(pos);
+	swapWord(pos);
+	const bool skinned = (swapWord(pos) & 1) != 0;
+	const u32 bufferCount = swapWord(pos);
+	swapWords(pos, 6);
+
+	for (u32 b=0; b<bufferCount; ++b)
+	{
+		const u32 vertexType = swapWord(pos);
+		const u32 indexType = swapWord(pos);
+		swapWord(pos);
+		const u32 vertexCount = swapWord(pos);
+		const u32 indexCount = swapWord(pos);
+		swapWords(pos, 6);
+		if (skinned)
+			swapWords(pos, 16);
+
+		const u32 attributeCount = swapWord(pos);
+		for (u32 a=0; a<attributeCount; ++a)
+		{
+			swapWord(pos);
+			swapString(pos);
+			swapString(pos);
+		}
+
+		skipPadding(pos, 16);
+		if (vertexType == video::EVT_COMPACT)
+		{
+			for (u32 v=0; v<vertexCount; ++v)
+			{
+				swapHalf(pos);
+				swapHalf(pos);
+				swapHalf(pos);
+				pos += 2; // normal bytes
+				swapWord(pos);
+				swapHalf(pos);
+				swapHalf(pos);
+			}
+		}
+		else
+			swapWords(pos, vertexCount * video::getVertexPitchFromType((video::E_VERTEX_TYPE)vertexType) / 4);
+
+		skipPadding(pos, 16);
+		for (u32 i=0; i<indexCount; ++i)
+		{
+			if (indexType == video::EIT_32BIT)
+				swapWord(pos);
+			else
+				swapHalf(pos);
+		}
+	}
+
+	if (!skinned)
+		return;
+
+	swapWord(pos);
+	const u32 jointCount = swapWord(pos);
+	for (u32 j=0; j<jointCount; ++j)
+	{
+		swapWords(pos, 32);
+		const u32 childCount = swapWord(pos);
+		const u32 attachedCount = swapWord(pos);
+		const u32 positionCount = swapWord(pos);
+		const u32 scaleCount = swapWord(pos);
+		const u32 rotationCount = swapWord(pos);
+		const u32 weightCount = swapWord(pos);
+		swapString(pos);
+		swapWords(pos, childCount + attachedCount);
+
+		skipPadding(pos, 16);
+		swapWords(pos, positionCount * sizeof(ISkinnedMesh::SPositionKey) / 4);
+		skipPadding(pos, 16);
+		swapWords(pos, scaleCount * sizeof(ISkinnedMesh::SScaleKey) / 4);
+		skipPadding(pos, 16);
+		swapWords(pos, rotationCount * sizeof(ISkinnedMesh::SRotationKey) / 4);
+		swapWords(pos, weightCount * 3);
+	}
+}
+
+bool sameBuffers(IMesh* expected, IMesh* mesh)
+{
+	bool result = expected->getMeshBufferCount() == mesh->getMeshBufferCount();
+	for (u32 b=0; result && b<expected->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* e = expected->getMeshBuffer(b);
+		const IMeshBuffer* m = mesh->getMeshBuffer(b);
+		result &= m->getVertexType() == e->getVertexType();
+		result &= m->getIndexType() == e->getIndexType();
+		result &= m->getVertexCount() == e->getVertexCount();
+		result &= m->getIndexCount() == e->getIndexCount();
+		result &= m->getPrimitiveType() == e->getPrimitiveType();
+		result &= m->getMaterial() == e->getMaterial();
+		result &= m->getBoundingBox() == e->getBoundingBox();
+		if (!result)
+			break;
+
+		const u32 indexSize = e->getIndexType() == video::EIT_32BIT ? 4 : 2;
+		result &= !memcmp(m->getVertices(), e->getVertices(), e->getVertexCount() * video::getVertexPitchFromType(e->getVertexType()));
+		result &= !memcmp(m->getIndices(), e->getIndices(), e->getIndexCount() * indexSize);
+		if (!result)
+			logTestString("binary mesh buffer %u differs\n", b);
+	}
+	return result;
+}
+
+//! all vertex and index types, with materials and textures
+bool staticMesh(IrrlichtDevice* device)
+{
+	IMeshManipulator* manipulator = device->getSceneManager()->getMeshManipulator();
+	IMesh* sphere = device->getSceneManager()->getGeometryCreator()->createSphereMesh(10.f, 16, 16);
+	video::SMaterial& material = sphere->getMeshBuffer(0)->getMaterial();
+	material.setTexture(0, device->getVideoDriver()->getTexture("../media/wall.bmp"));
+	material.MaterialType = video::EMT_TRANSPARENT_ALPHA_CHANNEL;
+	material.DiffuseColor = video::SColor(128, 255, 0, 0);
+	material.Shininess = 20.f;
+	material.Lighting = false;
+
+	// colors which differ when the bytes are swapped
+	video::S3DVertex* vertices = static_cast<video::S3DVertex*>(sphere->getMeshBuffer(0)->getVertices());
+	for (u32 i=0; i<sphere->getMeshBuffer(0)->getVertexCount(); ++i)
+		vertices[i].Color.set(255 - i % 128, i % 256, (i * 3) % 256, (i * 7) % 256);
+
+	IMesh* lightMap = manipulator->createMeshWith2TCoords(sphere);
+	IMesh* tangents = manipulator->createMeshWithTangents(sphere);
+	IMesh* compact = manipulator->createMeshCompact(sphere);
+
+	CDynamicMeshBuffer* large = new CDynamicMeshBuffer(video::EVT_STANDARD, video::EIT_32BIT);
+	const IMeshBuffer* source = sphere->getMeshBuffer(0);
+	for (u32 i=0; i<source->getVertexCount(); ++i)
+		large->getVertexBuffer().push_back(static_cast<const video::S3DVertex*>(source->getVertices())[i]);
+	for (u32 i=0; i<source->getIndexCount(); ++i)
+		large->getIndexBuffer().push_back(source->getIndices()[i]);
+	large->setPrimitiveType(EPT_LINES);
+	large->recalculateBoundingBox();
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(sphere->getMeshBuffer(0));
+	mesh->addMeshBuffer(lightMap->getMeshBuffer(0));
+	mesh->addMeshBuffer(tangents->getMeshBuffer(0));
+	mesh->addMeshBuffer(compact->getMeshBuffer(0));
+	mesh->addMeshBuffer(large);
+	mesh->recalculateBoundingBox();
+	large->drop();
+	compact->drop();
+	tangents->drop();
+	lightMap->drop();
+	sphere->drop();
+
+	bool result = true;
+	const u32 size = writeMesh(device, mesh);
+	result &= size > 0;
+
+	IAnimatedMesh* loaded = loadMesh(device, size);
+	result &= loaded && loaded->getMeshType() == EAMT_UNKNOWN;
+	if (loaded)
+	{
+		result &= sameBuffers(mesh, loaded);
+		result &= loaded->getBoundingBox() == mesh->getBoundingBox();
+	}
+
+	// damaged files fail without reading too far
+	for (u32 s=0; loaded && s<size; s+=size/97+1)
+	{
+		if (loadMesh(device, s))
+		{
+			logTestString("binary mesh truncated to %u of %u bytes loaded\n", s, size);
+			result = false;
+		}
+	}
+
+	// the file of a machine with the other byte order loads the same buffers
+	swapFile();
+	IAnimatedMesh* swapped = loadMesh(device, size);
+	if (!swapped || !sameBuffers(mesh, swapped))
+	{
+		logTestString("byte swapped binary mesh differs\n");
+		result = false;
+	}
+
+	mesh->drop();
+	return result;
+}
+
+//! same joints, keys and weights, and the same animation
+bool sameSkinnedMesh(ISkinnedMesh* expected, ISkinnedMesh* skinned)
+{
+	// both in the same pose, the source may have been animated before
+	expected->getMesh(0);
+	skinned->getMesh(0);
+	bool result = sameBuffers(expected, skinned);
+	result &= skinned->getFrameCount() == expected->getFrameCount();
+	result &= skinned->getAnimationSpeed() == expected->getAnimationSpeed();
+	result &= skinned->getJointCount() == expected->getJointCount();
+	for (u32 i=0; result && i<expected->getJointCount(); ++i)
+	{
+		const ISkinnedMesh::SJoint* e = expected->getAllJoints()[i];
+		const ISkinnedMesh::SJoint* j = skinned->getAllJoints()[i];
+		result &= stringc(skinned->getJointName(i)) == expected->getJointName(i);
+		result &= j->Children.size() == e->Children.size();
+		result &= j->PositionKeys.size() == e->PositionKeys.size();
+		result &= j->RotationKeys.size() == e->RotationKeys.size();
+		result &= j->Weights.size() == e->Weights.size();
+		result &= j->LocalMatrix == e->LocalMatrix;
+		for (u32 k=0; result && k<e->PositionKeys.size(); ++k)
+			result &= j->PositionKeys[k].frame == e->PositionKeys[k].frame &&
+				j->PositionKeys[k].position == e->PositionKeys[k].position;
+		for (u32 k=0; result && k<e->RotationKeys.size(); ++k)
+			result &= j->RotationKeys[k].frame == e->RotationKeys[k].frame &&
+				j->RotationKeys[k].rotation == e->RotationKeys[k].rotation;
+		for (u32 k=0; result && k<e->Weights.size(); ++k)
+			result &= j->Weights[k].buffer_id == e->Weights[k].buffer_id &&
+				j->Weights[k].vertex_id == e->Weights[k].vertex_id &&
+				j->Weights[k].strength == e->Weights[k].strength;
+	}
+
+	for (f32 frame=0.f; result && frame<expected->getFrameCount(); frame+=7.5f)
+	{
+		IMesh* e = expected->getMesh((s32)frame);
+		IMesh* m = skinned->getMesh((s32)frame);
+		for (u32 b=0; b<e->getMeshBufferCount(); ++b)
+		{
+			for (u32 i=0; i<e->getMeshBuffer(b)->getVertexCount(); ++i)
+			{
+				result &= m->getMeshBuffer(b)->getPosition(i).equals(e->getMeshBuffer(b)->getPosition(i));
+				result &= m->getMeshBuffer(b)->getNormal(i).equals(e->getMeshBuffer(b)->getNormal(i));
+			}
+		}
+		if (!result)
+			logTestString("binary skinned mesh differs in frame %f\n", frame);
+	}
+
+	return result;
+}
+
+//! joints, keys and weights animate the loaded mesh like the source
+bool skinnedMesh(IrrlichtDevice* device)
+{
+	IAnimatedMesh* ninja = device->getSceneManager()->getMesh("../media/ninja.b3d");
+	if (!ninja || ninja->getMeshType() != EAMT_SKINNED)
+		return false;
+
+	const u32 size = writeMesh(device, ninja);
+	IAnimatedMesh* loaded = loadMesh(device, size);
+	if (!loaded || loaded->getMeshType() != EAMT_SKINNED)
+		return false;
+
+	ISkinnedMesh* expected = static_cast<ISkinnedMesh*>(ninja);
+	bool result = sameSkinnedMesh(expected, static_cast<ISkinnedMesh*>(loaded));
+
+	// the file of a machine with the other byte order has the same keys and weights
+	swapFile();
+	IAnimatedMesh* swapped = loadMesh(device, size);
+	if (!swapped || swapped->getMeshType() != EAMT_SKINNED ||
+		!sameSkinnedMesh(expected, static_cast<ISkinnedMesh*>(swapped)))
+	{
+		logTestString("byte swapped binary skinned mesh differs\n");
+		result = false;
+	}
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Meshes written as .irrbin load back with the same buffers, materials
+and skeletons. */
+bool irrBinaryMesh()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	bool result = true;
+	result &= staticMesh(device);
+	result &= skinnedMesh(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	Data.clear();
+	return result;
+}
+
@@ -0,0 +1,189 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 drawFrame(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+u32 getTriangleCount(const IMesh* mesh)
+{
+	u32 count = 0;
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+		count += mesh->getMeshBuffer(b)->getIndexCount() / 3;
+	return count;
+}
+
+// the remaining triangles of a sphere have to face outwards and stay close to the surface
+bool checkSphere(const IMesh* mesh, f32 radius)
+{
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		for (u32 i=0; i+2<mb->getIndexCount(); i+=3)
+		{
+			const vector3df& a = mb->getPosition(mb->getIndices()[i]);
+			const vector3df& c = mb->getPosition(mb->getIndices()[i+1]);
+			const vector3df& d = mb->getPosition(mb->getIndices()[i+2]);
+			vector3df center = (a + c + d) / 3.f;
+			vector3df normal = (c - a).crossProduct(d - a);
+
+			// the poles of the sphere mesh have degenerated triangles
+			if (normal.getLengthSQ() < 1e-8f)
+				continue;
+
+			const f32 distance = center.getLength();
+			if (normal.normalize().dotProduct(center.normalize()) < 0.3f || distance < radius * 0.6f)
+			{
+				logTestString("triangle %u of buffer %u is wrong, distance %f\n", i/3, b, distance);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+/** The simplified meshes have to keep borders and shape with fewer
+triangles, and the node has to switch to the smaller levels when it gets
+smaller on screen. */
+bool lodMeshSceneNode()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	IMeshManipulator* manipulator = smgr->getMeshManipulator();
+	bool result = true;
+
+	// a closed mesh with texture seams
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(5.f, 32, 32);
+	const u32 sphereCount = getTriangleCount(sphere);
+
+	IMesh* simplified = manipulator->createMeshSimplified(sphere, 0.25f);
+	const u32 simplifiedCount = getTriangleCount(simplified);
+	if (simplifiedCount == 0 || simplifiedCount > sphereCount / 2 ||
+		simplified->getMeshBufferCount() != sphere->getMeshBufferCount() ||
+		simplified->getMeshBuffer(0)->getVertexCount() >= sphere->getMeshBuffer(0)->getVertexCount())
+	{
+		logTestString("sphere simplified from %u to %u triangles\n", sphereCount, simplifiedCount);
+		result = false;
+	}
+	result &= checkSphere(simplified, 5.f);
+	result &= simplified->getMeshBuffer(0)->getMaterial() == sphere->getMeshBuffer(0)->getMaterial();
+	simplified->drop();
+
+	// flat interior and straight border collapse for free, the corners have to stay
+	IMesh* plane = smgr->getGeometryCreator()->createHillPlaneMesh(dimension2df(1.f, 1.f), dimension2du(16, 16),
+		0, 0.f, dimension2df(0.f, 0.f), dimension2df(1.f, 1.f));
+	IMesh* planeWelded = manipulator->createMeshWelded(plane);
+	simplified = manipulator->createMeshSimplified(planeWelded, 0.05f);
+	if (getTriangleCount(simplified) > getTriangleCount(planeWelded) / 4 ||
+		!simplified->getBoundingBox().MinEdge.equals(plane->getBoundingBox().MinEdge) ||
+		!simplified->getBoundingBox().MaxEdge.equals(plane->getBoundingBox().MaxEdge))
+	{
+		logTestString("plane simplified from %u to %u triangles\n", getTriangleCount(planeWelded), getTriangleCount(simplified));
+		result = false;
+	}
+	simplified->drop();
+	planeWelded->drop();
+	plane->drop();
+
+	// every level has fewer triangles than the one before
+	array<IMesh*> levels;
+	const u32 levelCount = manipulator->createMeshLODChain(sphere, levels, 4, 0.5f);
+	result &= levelCount >= 3 && levelCount == levels.size();
+	u32 previous = sphereCount;
+	for (u32 i=0; i<levels.size(); ++i)
+	{
+		const u32 count = getTriangleCount(levels[i]);
+		if (count >= previous || count < previous / 4)
+		{
+			logTestString("level %u has %u triangles, previous %u\n", i, count, previous);
+			result = false;
+		}
+		result &= checkSphere(levels[i], 5.f);
+		previous = count;
+		levels[i]->drop();
+	}
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, -20.f), vector3df(0.f, 0.f, 0.f));
+	cam->setFarValue(10000.f);
+
+	ILODMeshSceneNode* node = smgr->addLODMeshSceneNode(sphere, 3, 0.5f);
+	assert_log(node);
+	if (!node)
+	{
+		sphere->drop();
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+	result &= node->getLevelCount() == 4;
+	result &= node->getLevelMesh(0) == sphere;
+	result &= node->getLevelScreenSize(node->getLevelCount() - 1) == 0.f;
+
+	// moving the node away selects smaller levels with fewer triangles
+	s32 lastLevel = -1;
+	u32 lastCount = 0xFFFFFFFF;
+	const f32 distances[] = { 10.f, 30.f, 60.f, 120.f, 500.f };
+	for (u32 i=0; i<sizeof(distances)/sizeof(distances[0]); ++i)
+	{
+		node->setPosition(vector3df(0.f, 0.f, distances[i] - 20.f));
+		const u32 count = drawFrame(device);
+		const s32 level = node->getCurrentLevel();
+		if (level < lastLevel || count > lastCount || level < 0 ||
+			count != getTriangleCount(node->getLevelMesh(level)))
+		{
+			logTestString("distance %f: level %d with %u triangles\n", distances[i], level, count);
+			result = false;
+		}
+		lastLevel = level;
+		lastCount = count;
+	}
+	result &= lastLevel == (s32)node->getLevelCount() - 1;
+
+	node->setPosition(vector3df(0.f, 0.f, -10.f));
+	drawFrame(device);
+	result &= node->getCurrentLevel() == 0;
+
+	// custom levels are sorted in, nothing is drawn below the smallest size
+	ILODMeshSceneNode* custom = smgr->addLODMeshSceneNode(0);
+	custom->addLevel(sphere, 0.1f);
+	result &= custom->addLevel(sphere, 0.5f) == 0;
+	result &= custom->addLevel(sphere, 0.2f) == 1;
+	custom->setPosition(vector3df(0.f, 0.f, 5000.f));
+	node->setVisible(false);
+	result &= drawFrame(device) == 0;
+	result &= custom->getCurrentLevel() == -1;
+
+	ILODMeshSceneNode* copy = (ILODMeshSceneNode*)node->clone();
+	result &= copy->getLevelCount() == node->getLevelCount() && copy->getType() == ESNT_LOD_MESH;
+
+	sphere->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
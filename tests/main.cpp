@@ -87,6 +87,24 @@ int main(int argumentCount, char * arguments[])
 	TEST(meshLoaders);
 	TEST(testTimer);
 	TEST(testCoreutil);
+	TEST(parallelRenderList);
+	TEST(bvhRenderList);
+	TEST(transformationUpdate);
+	TEST(renderSortKey);
+	TEST(instancedMeshSceneNode);
+	TEST(staticBatchSceneNode);
+	TEST(quake3LevelSceneNode);
+	TEST(sceneNodeLookupIndex);
+	TEST(lodMeshSceneNode);
+	TEST(clusteredLights);
+	TEST(frameUpdater);
+	TEST(meshWelding);
+	TEST(meshNormals);
+	TEST(meshOptimization);
+	TEST(compactVertices);
+	TEST(irrBinaryMesh);
+	TEST(asyncMeshLoading);
+	TEST(meshClusters);
 	// software drivers only
 	TEST(softwareDevice);
 	TEST(b3dAnimation);
@@ -0,0 +1,344 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 drawFrame(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+//! triangle by its positions, starting with the smallest one to keep the winding
+struct STriangle
+{
+	vector3df P[3];
+
+	bool operator<(const STriangle& other) const
+	{
+		for (u32 k=0; k<3; ++k)
+		{
+			if (P[k].X != other.P[k].X)
+				return P[k].X < other.P[k].X;
+			if (P[k].Y != other.P[k].Y)
+				return P[k].Y < other.P[k].Y;
+			if (P[k].Z != other.P[k].Z)
+				return P[k].Z < other.P[k].Z;
+		}
+		return false;
+	}
+};
+
+u32 getIndex(const IMeshBuffer* mb, u32 i)
+{
+	if (mb->getIndexType() == video::EIT_32BIT)
+		return ((const u32*)mb->getIndices())[i];
+	return mb->getIndices()[i];
+}
+
+void getTriangles(const IMeshBuffer* mb, array<STriangle>& triangles)
+{
+	for (u32 i=0; i+2<mb->getIndexCount(); i+=3)
+	{
+		u32 first = 0;
+		vector3df p[3];
+		for (u32 k=0; k<3; ++k)
+		{
+			p[k] = mb->getPosition(getIndex(mb, i+k));
+			STriangle a, b;
+			a.P[0] = p[k];
+			b.P[0] = p[first];
+			if (a < b)
+				first = k;
+		}
+
+		STriangle triangle;
+		for (u32 k=0; k<3; ++k)
+			triangle.P[k] = p[(first + k) % 3];
+		triangles.push_back(triangle);
+	}
+	triangles.sort();
+}
+
+bool sameTriangles(const IMeshBuffer* a, const IMeshBuffer* b)
+{
+	array<STriangle> ta;
+	array<STriangle> tb;
+	getTriangles(a, ta);
+	getTriangles(b, tb);
+
+	bool result = ta.size() == tb.size();
+	for (u32 i=0; result && i<ta.size(); ++i)
+		result = !(ta[i] < tb[i]) && !(tb[i] < ta[i]);
+	return result;
+}
+
+//! normal of the triangle at index i, zero for degenerated ones
+vector3df getNormal(const IMeshBuffer* mb, u32 i, vector3df& p0)
+{
+	p0 = mb->getPosition(getIndex(mb, i));
+	const vector3df& p1 = mb->getPosition(getIndex(mb, i+1));
+	const vector3df& p2 = mb->getPosition(getIndex(mb, i+2));
+	return (p1 - p0).crossProduct(p2 - p0).normalize();
+}
+
+//! clusters cover all indices in order, contain their vertices and only cull back faces
+bool checkClusters(const IMeshBuffer* mb, const array<SMeshCluster>& clusters, u32 maxTriangles, f32 radius)
+{
+	u32 next = 0;
+	for (u32 c=0; c<clusters.size(); ++c)
+	{
+		const SMeshCluster& cluster = clusters[c];
+		if (cluster.IndexStart != next || cluster.IndexCount == 0 || cluster.IndexCount > maxTriangles * 3)
+		{
+			logTestString("cluster %u has indices %u to %u, expected start %u\n", c,
+				cluster.IndexStart, cluster.IndexStart + cluster.IndexCount, next);
+			return false;
+		}
+		next += cluster.IndexCount;
+
+		aabbox3df box(cluster.BoundingBox);
+		box.MinEdge -= vector3df(0.0001f);
+		box.MaxEdge += vector3df(0.0001f);
+		for (u32 i=cluster.IndexStart; i<next; ++i)
+		{
+			if (!box.isPointInside(mb->getPosition(getIndex(mb, i))))
+			{
+				logTestString("cluster %u misses vertex of index %u\n", c, i);
+				return false;
+			}
+		}
+	}
+	if (next != mb->getIndexCount())
+	{
+		logTestString("clusters end at %u of %u indices\n", next, mb->getIndexCount());
+		return false;
+	}
+
+	// viewers around and close to the mesh, and orthogonal views
+	u32 culled = 0;
+	u32 tests = 0;
+	for (u32 v=0; v<64; ++v)
+	{
+		const f32 angle = v * 0.7f;
+		const f32 height = (v % 16) / 8.f - 1.f;
+		vector3df direction(cosf(angle) * sqrtf(1.f - height * height), height, sinf(angle) * sqrtf(1.f - height * height));
+		const vector3df viewer = direction * radius * (v < 32 ? 1.2f : 4.f);
+		direction = -direction;
+
+		for (u32 c=0; c<clusters.size(); ++c)
+		{
+			const SMeshCluster& cluster = clusters[c];
+			const bool from = cluster.isBackFacingFrom(viewer);
+			const bool along = cluster.isBackFacingAlong(direction);
+			culled += from;
+			tests += 1;
+
+			for (u32 i=cluster.IndexStart; (from || along) && i<cluster.IndexStart+cluster.IndexCount; i+=3)
+			{
+				vector3df p0;
+				const vector3df normal = getNormal(mb, i, p0);
+				if ((from && (viewer - p0).dotProduct(normal) > 0.0001f) ||
+					(along && direction.dotProduct(normal) < -0.0001f))
+				{
+					logTestString("cluster %u culls a front face\n", c);
+					return false;
+				}
+			}
+		}
+	}
+
+	logTestString("%u clusters, %f of them culled as back facing\n", clusters.size(), (f32)culled / tests);
+	return culled * 4 > tests;
+}
+
+//! copies the sphere into a buffer with 32 bit indices
+IMeshBuffer* createLargeBuffer(const IMeshBuffer* mb)
+{
+	CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(video::EVT_STANDARD, video::EIT_32BIT);
+	for (u32 i=0; i<mb->getVertexCount(); ++i)
+		buffer->getVertexBuffer().push_back(((const video::S3DVertex*)mb->getVertices())[i]);
+	for (u32 i=0; i<mb->getIndexCount(); ++i)
+		buffer->getIndexBuffer().push_back(mb->getIndices()[i]);
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+bool buildClusters(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	IMeshManipulator* manipulator = smgr->getMeshManipulator();
+	bool result = true;
+
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(2.f, 64, 64);
+	IMesh* small = smgr->getGeometryCreator()->createCubeMesh();
+	IMeshBuffer* large = createLargeBuffer(sphere->getMeshBuffer(0));
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(sphere->getMeshBuffer(0));
+	mesh->addMeshBuffer(small->getMeshBuffer(0));
+	mesh->addMeshBuffer(large);
+	mesh->recalculateBoundingBox();
+	large->drop();
+
+	const u32 sizes[] = { 64, 128 };
+	for (u32 s=0; s<2; ++s)
+	{
+		SClusteredMesh* clustered = manipulator->createMeshClustered(mesh, sizes[s]);
+		result &= clustered->getMeshType() == EAMT_CLUSTERED;
+		result &= clustered->getMeshBufferCount() == 3 && clustered->Clusters.size() == 3;
+
+		// the cube is too small for clusters
+		result &= clustered->getMeshBuffer(1) == mesh->getMeshBuffer(1) && clustered->Clusters[1].empty();
+
+		for (u32 b=0; result && b<3; b+=2)
+		{
+			const IMeshBuffer* mb = clustered->getMeshBuffer(b);
+			result &= mb->getIndexType() == mesh->getMeshBuffer(b)->getIndexType();
+			result &= sameTriangles(mesh->getMeshBuffer(b), mb);
+			result &= checkClusters(mb, clustered->Clusters[b], sizes[s], 2.f);
+		}
+		clustered->drop();
+	}
+
+	mesh->drop();
+	small->drop();
+	sphere->drop();
+	return result;
+}
+
+//! the scene node draws only clusters which are in view and face the camera
+bool cullClusters(IrrlichtDevice* device)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	bool result = true;
+
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(2.f, 96, 96);
+	SClusteredMesh* clustered = smgr->getMeshManipulator()->createMeshClustered(sphere);
+	const u32 total = sphere->getMeshBuffer(0)->getIndexCount() / 3;
+
+	ICameraSceneNode* camera = smgr->addCameraSceneNode(0, vector3df(0, 0, -10), vector3df(0, 0, 0));
+	IMeshSceneNode* node = smgr->addMeshSceneNode(sphere);
+	result &= drawFrame(device) == total;
+
+	node->setMesh(clustered);
+	const u32 front = drawFrame(device);
+	logTestString("%u of %u triangles drawn from the front\n", front, total);
+	result &= front > total * 0.45f && front < total * 0.7f;
+
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, false);
+	result &= drawFrame(device) == total;
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, true);
+
+	// mirroring turns the cones around
+	node->setScale(vector3df(-1.f, 1.f, 1.f));
+	result &= drawFrame(device) == total;
+	node->setScale(vector3df(1.f, 1.f, 1.f));
+
+	// close to the surface most of the sphere is out of view
+	camera->setPosition(vector3df(0, 0, -2.5f));
+	camera->setTarget(vector3df(0, 2.f, -1.f));
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, false);
+	const u32 close = drawFrame(device);
+	logTestString("%u of %u triangles drawn close to the surface\n", close, total);
+	result &= close > 0 && close < total * 0.5f;
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, true);
+
+	matrix4 ortho;
+	ortho.buildProjectionMatrixOrthoLH(6.f, 6.f, 1.f, 100.f);
+	camera->setProjectionMatrix(ortho, true);
+	camera->setPosition(vector3df(0, 10, 0));
+	camera->setTarget(vector3df(0, 0, 0));
+	camera->setUpVector(vector3df(0, 0, 1));
+	const u32 top = drawFrame(device);
+	logTestString("%u of %u triangles drawn from the top\n", top, total);
+	result &= top > total * 0.45f && top < total * 0.7f;
+
+	node->remove();
+	camera->remove();
+	clustered->drop();
+	sphere->drop();
+	return result;
+}
+
+//! culled clusters are drawn with the hardware buffer of their mesh buffer
+bool shareHardwareBuffer()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_OPENGL, dimension2du(160, 120));
+	if (!device)
+		return true; // no error if the driver is not available
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+	bool result = true;
+
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(2.f, 96, 96);
+	SClusteredMesh* clustered = smgr->getMeshManipulator()->createMeshClustered(sphere);
+	clustered->setHardwareMappingHint(EHM_STATIC);
+	IMeshBuffer* mb = clustered->getMeshBuffer(0);
+	const u32 total = mb->getIndexCount() / 3;
+	const s32 references = mb->getReferenceCount();
+
+	smgr->addCameraSceneNode(0, vector3df(0, 0, -10), vector3df(0, 0, 0));
+	IMeshSceneNode* node = smgr->addMeshSceneNode(clustered);
+
+	const u32 front = drawFrame(device);
+	result &= front > total * 0.45f && front < total * 0.7f;
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, false);
+	result &= drawFrame(device) == total;
+
+	// the only reference added is the one of the hardware buffer link
+	logTestString("%d references to the mesh buffer after drawing, %d before\n", mb->getReferenceCount(), references);
+	result &= mb->getReferenceCount() == references + 1;
+	driver->removeHardwareBuffer(mb);
+	result &= mb->getReferenceCount() == references;
+
+	node->remove();
+	clustered->drop();
+	sphere->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Clustered meshes keep the triangles of the source, their cluster bounds
+contain the triangles and the cones cull back faces only. Mesh scene nodes
+draw only the clusters which can be seen, with the hardware buffers of the
+clustered mesh buffers. */
+bool meshClusters()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	bool result = true;
+	result &= buildClusters(device);
+	result &= cullClusters(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= shareHardwareBuffer();
+
+	return result;
+}
+
@@ -0,0 +1,227 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 1;
+
+f32 randomOffset(f32 range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return range * ((f32)((Seed >> 8) & 0xffff) / 65535.f * 2.f - 1.f);
+}
+
+//! bumpy grid of quads sharing their corners
+template <class T>
+CMeshBuffer<T>* createGrid(u32 quads)
+{
+	CMeshBuffer<T>* buffer = new CMeshBuffer<T>();
+	for (u32 y=0; y<=quads; ++y)
+	{
+		for (u32 x=0; x<=quads; ++x)
+		{
+			buffer->Vertices.push_back(T());
+			buffer->Vertices.getLast().Pos.set((f32)x, (f32)y, randomOffset(0.5f));
+			buffer->Vertices.getLast().TCoords.set(x * 0.1f, y * 0.1f);
+		}
+	}
+	for (u32 y=0; y<quads; ++y)
+	{
+		for (u32 x=0; x<quads; ++x)
+		{
+			const u16 i = (u16)(y * (quads+1) + x);
+			buffer->Indices.push_back(i);
+			buffer->Indices.push_back(i + 1);
+			buffer->Indices.push_back(i + quads + 2);
+			buffer->Indices.push_back(i);
+			buffer->Indices.push_back(i + quads + 2);
+			buffer->Indices.push_back(i + quads + 1);
+		}
+	}
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! the previous implementation, using the virtual accessors of the buffer
+void normalsReference(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
+{
+	const u32 vtxcnt = buffer->getVertexCount();
+	const u32 idxcnt = buffer->getIndexCount();
+	const u16* idx = buffer->getIndices();
+
+	if (!smooth)
+	{
+		for (u32 i=0; i<idxcnt; i+=3)
+		{
+			const vector3df normal = plane3d<f32>(buffer->getPosition(idx[i+0]),
+				buffer->getPosition(idx[i+1]), buffer->getPosition(idx[i+2])).Normal;
+			buffer->getNormal(idx[i+0]) = normal;
+			buffer->getNormal(idx[i+1]) = normal;
+			buffer->getNormal(idx[i+2]) = normal;
+		}
+		return;
+	}
+
+	for (u32 i=0; i!=vtxcnt; ++i)
+		buffer->getNormal(i).set(0.f, 0.f, 0.f);
+
+	for (u32 i=0; i<idxcnt; i+=3)
+	{
+		const vector3df& v1 = buffer->getPosition(idx[i+0]);
+		const vector3df& v2 = buffer->getPosition(idx[i+1]);
+		const vector3df& v3 = buffer->getPosition(idx[i+2]);
+		const vector3df normal = plane3d<f32>(v1, v2, v3).Normal;
+
+		vector3df weight(1.f,1.f,1.f);
+		if (angleWeighted)
+		{
+			// same as getAngleWeight of the mesh manipulator
+			const f32 a = v2.getDistanceFromSQ(v3);
+			const f32 asqrt = sqrtf(a);
+			const f32 b = v1.getDistanceFromSQ(v3);
+			const f32 bsqrt = sqrtf(b);
+			const f32 c = v1.getDistanceFromSQ(v2);
+			const f32 csqrt = sqrtf(c);
+			weight.set(acosf((b + c - a) / (2.f * bsqrt * csqrt)),
+				acosf((-b + c + a) / (2.f * asqrt * csqrt)),
+				acosf((b - c + a) / (2.f * bsqrt * asqrt)));
+		}
+
+		buffer->getNormal(idx[i+0]) += weight.X*normal;
+		buffer->getNormal(idx[i+1]) += weight.Y*normal;
+		buffer->getNormal(idx[i+2]) += weight.Z*normal;
+	}
+
+	for (u32 i=0; i!=vtxcnt; ++i)
+		buffer->getNormal(i).normalize();
+}
+
+SMesh* createMesh(u32 quads)
+{
+	SMesh* mesh = new SMesh();
+	IMeshBuffer* buffer = createGrid<video::S3DVertex>(quads);
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	buffer = createGrid<video::S3DVertex2TCoords>(quads);
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	buffer = createGrid<video::S3DVertexTangents>(quads);
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	buffer = createGrid<video::S3DVertex>(quads / 2);
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	mesh->recalculateBoundingBox();
+	return mesh;
+}
+
+bool sameVertices(IMesh* a, IMesh* b)
+{
+	for (u32 m=0; m<a->getMeshBufferCount(); ++m)
+	{
+		IMeshBuffer* ba = a->getMeshBuffer(m);
+		IMeshBuffer* bb = b->getMeshBuffer(m);
+		if (ba->getVertexType() != bb->getVertexType() || ba->getVertexCount() != bb->getVertexCount())
+			return false;
+		const u32 size = ba->getVertexCount() * video::getVertexPitchFromType(ba->getVertexType());
+		if (memcmp(ba->getVertices(), bb->getVertices(), size))
+		{
+			logTestString("buffer %u differs\n", m);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool sameAsReference(IMeshManipulator* manipulator, bool smooth, bool angleWeighted)
+{
+	SMesh* mesh = createMesh(16);
+	IMesh* reference = manipulator->createMeshCopy(mesh);
+	for (u32 m=0; m<reference->getMeshBufferCount(); ++m)
+		normalsReference(reference->getMeshBuffer(m), smooth, angleWeighted);
+
+	manipulator->recalculateNormals(mesh, smooth, angleWeighted);
+	const bool same = sameVertices(mesh, reference);
+	if (!same)
+		logTestString("normals differ, smooth %d, angle weighted %d, %u threads\n",
+			smooth, angleWeighted, manipulator->getThreadCount());
+
+	reference->drop();
+	mesh->drop();
+	return same;
+}
+
+} // end anonymous namespace
+
+/** Normals and tangents have to be the same as before, whether the mesh
+buffers are done serially or on threads. Large meshes are timed. */
+bool meshNormals()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IMeshManipulator* manipulator = device->getSceneManager()->getMeshManipulator();
+	bool result = manipulator->getThreadCount() == 1;
+
+	const u32 threads[] = { 1, 4, 0, 1 };
+	for (u32 t=0; t<4; ++t)
+	{
+		manipulator->setThreadCount(threads[t]);
+		result &= manipulator->getThreadCount() == threads[t];
+		result &= sameAsReference(manipulator, false, false);
+		result &= sameAsReference(manipulator, true, false);
+		result &= sameAsReference(manipulator, true, true);
+	}
+
+	// tangents, with and without normals
+	SMesh* mesh = createMesh(16);
+	manipulator->setThreadCount(1);
+	IMesh* serial = manipulator->createMeshWithTangents(mesh, true, true, true);
+	IMesh* serialKeep = manipulator->createMeshWithTangents(mesh, false, false, false);
+	manipulator->setThreadCount(4);
+	IMesh* threaded = manipulator->createMeshWithTangents(mesh, true, true, true);
+	IMesh* threadedKeep = manipulator->createMeshWithTangents(mesh, false, false, false);
+	result &= sameVertices(serial, threaded);
+	result &= sameVertices(serialKeep, threadedKeep);
+	serial->drop();
+	serialKeep->drop();
+	threaded->drop();
+	threadedKeep->drop();
+	mesh->drop();
+
+	// benchmark with buffers of almost 65536 vertices
+	mesh = new SMesh();
+	for (u32 b=0; b<8; ++b)
+	{
+		SMeshBuffer* buffer = createGrid<video::S3DVertex>(250);
+		mesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+	for (u32 t=1; t<=4; t*=4)
+	{
+		manipulator->setThreadCount(t);
+		const u32 start = device->getTimer()->getRealTime();
+		for (u32 i=0; i<10; ++i)
+			manipulator->recalculateNormals(mesh, true, true);
+		const u32 duration = device->getTimer()->getRealTime() - start;
+		logTestString("Recalculated normals of %u vertices 10 times in %u ms on %u threads.\n",
+			8 * 251 * 251, duration, t);
+	}
+	mesh->drop();
+	manipulator->setThreadCount(1);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,251 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 1;
+
+u32 randomIndex(u32 count)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return ((Seed >> 8) & 0xffff) % count;
+}
+
+//! grid of quads with the triangles in random order and an unused last vertex
+SMeshBuffer* createShuffledGrid(u32 quads)
+{
+	SMeshBuffer* buffer = new SMeshBuffer();
+	for (u32 y=0; y<=quads; ++y)
+	{
+		for (u32 x=0; x<=quads; ++x)
+			buffer->Vertices.push_back(video::S3DVertex((f32)x, (f32)y, 0.f, 0.f, 0.f, -1.f,
+				video::SColor(255, 255, 255, 255), x * 0.1f, y * 0.1f));
+	}
+	buffer->Vertices.push_back(video::S3DVertex());
+
+	array<u16> triangles;
+	for (u32 y=0; y<quads; ++y)
+	{
+		for (u32 x=0; x<quads; ++x)
+		{
+			const u16 i = (u16)(y * (quads+1) + x);
+			const u16 quad[6] = { i, (u16)(i + quads + 1), (u16)(i + quads + 2), i, (u16)(i + quads + 2), (u16)(i + 1) };
+			for (u32 k=0; k<6; ++k)
+				triangles.push_back(quad[k]);
+		}
+	}
+
+	const u32 triangleCount = triangles.size() / 3;
+	for (u32 t=triangleCount; t>1; --t)
+	{
+		const u32 other = randomIndex(t);
+		for (u32 k=0; k<3; ++k)
+			swap(triangles[(t-1)*3+k], triangles[other*3+k]);
+	}
+	buffer->Indices = triangles;
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! cache misses per triangle of a FIFO cache
+f32 missesPerTriangle(const IMeshBuffer* mb, u32 cacheSize)
+{
+	array<u16> cache;
+	u32 misses = 0;
+	for (u32 i=0; i<mb->getIndexCount(); ++i)
+	{
+		const u16 v = mb->getIndices()[i];
+		if (cache.linear_search(v) < 0)
+		{
+			++misses;
+			cache.push_back(v);
+			if (cache.size() > cacheSize)
+				cache.erase(0);
+		}
+	}
+	return (f32)misses / (mb->getIndexCount() / 3);
+}
+
+//! triangles by grid position, rotations of the same triangle are the same
+void getTriangles(const SMeshBuffer* mb, array<u32>& triangles)
+{
+	for (u32 i=0; i<mb->Indices.size(); i+=3)
+	{
+		u32 corners[3];
+		for (u32 k=0; k<3; ++k)
+		{
+			const vector3df& p = mb->Vertices[mb->Indices[i+k]].Pos;
+			corners[k] = (u32)p.Y * 1000 + (u32)p.X;
+		}
+		u32 first = 0;
+		for (u32 k=1; k<3; ++k)
+		{
+			if (corners[k] < corners[first])
+				first = k;
+		}
+		triangles.push_back(corners[first]);
+		triangles.push_back(corners[(first+1)%3]);
+		triangles.push_back(corners[(first+2)%3]);
+	}
+}
+
+bool sameTriangles(const SMeshBuffer* a, const SMeshBuffer* b)
+{
+	array<u32> ta;
+	array<u32> tb;
+	getTriangles(a, ta);
+	getTriangles(b, tb);
+	if (ta.size() != tb.size())
+		return false;
+
+	array<u64> ka;
+	array<u64> kb;
+	for (u32 i=0; i<ta.size(); i+=3)
+	{
+		ka.push_back(((u64)ta[i] << 40) | ((u64)ta[i+1] << 20) | ta[i+2]);
+		kb.push_back(((u64)tb[i] << 40) | ((u64)tb[i+1] << 20) | tb[i+2]);
+	}
+	ka.sort();
+	kb.sort();
+	return ka == kb;
+}
+
+//! vertices have to be in the order of their first use
+bool inFirstUseOrder(const IMeshBuffer* mb)
+{
+	u32 next = 0;
+	for (u32 i=0; i<mb->getIndexCount(); ++i)
+	{
+		const u16 v = mb->getIndices()[i];
+		if (v > next)
+			return false;
+		if (v == next)
+			++next;
+	}
+	return next == mb->getVertexCount();
+}
+
+//! appends the triangles of the buffer
+void append(SMeshBuffer* buffer, const IMeshBuffer* mb)
+{
+	const u16 base = (u16)buffer->Vertices.size();
+	for (u32 i=0; i<mb->getVertexCount(); ++i)
+		buffer->Vertices.push_back(static_cast<const video::S3DVertex*>(mb->getVertices())[i]);
+	for (u32 i=0; i<mb->getIndexCount(); ++i)
+		buffer->Indices.push_back(base + mb->getIndices()[i]);
+}
+
+} // end anonymous namespace
+
+/** The optimized mesh has to keep all triangles with their winding, store
+the vertices in the order of first use, miss the vertex cache less often
+and draw outer surfaces before inner ones. */
+bool meshOptimization()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	IMeshManipulator* manipulator = smgr->getMeshManipulator();
+	bool result = true;
+
+	SMeshBuffer* grid = createShuffledGrid(60);
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(grid);
+	mesh->recalculateBoundingBox();
+
+	const f32 before = missesPerTriangle(grid, 16);
+	const f32 thresholds[] = { 0.f, 1.05f };
+	for (u32 t=0; t<2; ++t)
+	{
+		IMesh* optimized = manipulator->createMeshOptimized(mesh, 16, thresholds[t]);
+		const SMeshBuffer* mb = static_cast<const SMeshBuffer*>(optimized->getMeshBuffer(0));
+		const f32 after = missesPerTriangle(mb, 16);
+		logTestString("Cache misses per triangle %f before, %f after with threshold %f.\n", before, after, thresholds[t]);
+
+		result &= sameTriangles(grid, mb);
+		result &= inFirstUseOrder(mb);
+		result &= mb->getVertexCount() == grid->getVertexCount() - 1;
+		result &= after < 0.8f && after < before * 0.5f;
+		optimized->drop();
+	}
+	mesh->drop();
+	grid->drop();
+
+	// a small sphere inside a large one, the large one has to be drawn earlier
+	IMesh* inner = smgr->getGeometryCreator()->createSphereMesh(1.f, 24, 24);
+	IMesh* outer = smgr->getGeometryCreator()->createSphereMesh(2.f, 24, 24);
+	SMeshBuffer* spheres = new SMeshBuffer();
+	append(spheres, inner->getMeshBuffer(0));
+	append(spheres, outer->getMeshBuffer(0));
+	spheres->recalculateBoundingBox();
+	inner->drop();
+	outer->drop();
+
+	mesh = new SMesh();
+	mesh->addMeshBuffer(spheres);
+	mesh->recalculateBoundingBox();
+	for (u32 t=0; t<2; ++t)
+	{
+		IMesh* optimized = manipulator->createMeshOptimized(mesh, 16, thresholds[t]);
+		const SMeshBuffer* mb = static_cast<const SMeshBuffer*>(optimized->getMeshBuffer(0));
+		result &= mb->Indices.size() == spheres->Indices.size();
+		result &= inFirstUseOrder(mb);
+
+		// mean position of the triangles of each sphere in the drawing order
+		u32 innerCount = 0;
+		u32 outerCount = 0;
+		f32 innerMean = 0.f;
+		f32 outerMean = 0.f;
+		for (u32 i=0; i<mb->Indices.size(); i+=3)
+		{
+			if (mb->Vertices[mb->Indices[i]].Pos.getLength() > 1.5f)
+			{
+				outerMean += i / 3;
+				++outerCount;
+			}
+			else
+			{
+				innerMean += i / 3;
+				++innerCount;
+			}
+		}
+		innerMean /= innerCount;
+		outerMean /= outerCount;
+		logTestString("Mean triangle position %f inner, %f outer with threshold %f.\n",
+			innerMean, outerMean, thresholds[t]);
+		// the cache order starts with the inner sphere
+		if (thresholds[t] > 0.f)
+			result &= outerMean < innerMean * 0.8f;
+		else
+			result &= outerMean > innerMean;
+		optimized->drop();
+	}
+	mesh->drop();
+	spheres->drop();
+
+	// buffers with 32 bit indices are shared
+	CDynamicMeshBuffer* large = new CDynamicMeshBuffer(video::EVT_STANDARD, video::EIT_32BIT);
+	mesh = new SMesh();
+	mesh->addMeshBuffer(large);
+	IMesh* optimized = manipulator->createMeshOptimized(mesh);
+	result &= optimized->getMeshBuffer(0) == large;
+	optimized->drop();
+	mesh->drop();
+	large->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,175 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 1;
+
+f32 randomOffset(f32 range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return range * ((f32)((Seed >> 8) & 0xffff) / 65535.f * 2.f - 1.f);
+}
+
+//! triangle soup of a grid of quads, positions are jittered by up to jitter
+SMeshBuffer* createSoup(u32 quads, f32 spacing, f32 jitter, bool splitNormals)
+{
+	SMeshBuffer* buffer = new SMeshBuffer();
+	const u32 corner[6][2] = { {0,0}, {1,0}, {1,1}, {0,0}, {1,1}, {0,1} };
+	for (u32 y=0; y<quads; ++y)
+	{
+		for (u32 x=0; x<quads; ++x)
+		{
+			// every other quad has a hard edge to its neighbours
+			const bool hard = splitNormals && ((x + y) & 1);
+			for (u32 c=0; c<6; ++c)
+			{
+				const u32 vx = x + corner[c][0];
+				const u32 vy = y + corner[c][1];
+				video::S3DVertex v(vx * spacing + randomOffset(jitter), vy * spacing + randomOffset(jitter), randomOffset(jitter),
+					0.f, hard ? 0.f : 1.f, hard ? 1.f : 0.f,
+					video::SColor(255, 255, 255, 255), vx * 0.1f, vy * 0.1f);
+				buffer->Indices.push_back((u16)buffer->Vertices.size());
+				buffer->Vertices.push_back(v);
+			}
+		}
+	}
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! the previous implementation, comparing every vertex with all earlier ones
+void weldReference(const SMeshBuffer* mb, f32 tolerance, array<video::S3DVertex>& vertices, array<u16>& indices)
+{
+	const array<video::S3DVertex>& v = mb->Vertices;
+	array<u16> redirects;
+	redirects.set_used(v.size());
+	for (u32 i=0; i<v.size(); ++i)
+	{
+		bool found = false;
+		for (u32 j=0; j<i; ++j)
+		{
+			if (v[i].Pos.equals(v[j].Pos, tolerance) &&
+				v[i].Normal.equals(v[j].Normal, tolerance) &&
+				v[i].TCoords.equals(v[j].TCoords) &&
+				(v[i].Color == v[j].Color))
+			{
+				redirects[i] = redirects[j];
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			redirects[i] = vertices.size();
+			vertices.push_back(v[i]);
+		}
+	}
+
+	for (u32 i=0; i<mb->Indices.size(); i+=3)
+	{
+		const u16 a = redirects[mb->Indices[i]];
+		const u16 b = redirects[mb->Indices[i+1]];
+		const u16 c = redirects[mb->Indices[i+2]];
+		if (a != b && b != c && a != c)
+		{
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(c);
+		}
+	}
+}
+
+bool sameAsReference(IMeshManipulator* manipulator, SMeshBuffer* buffer, f32 tolerance)
+{
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(buffer);
+
+	IMesh* welded = manipulator->createMeshWelded(mesh, tolerance);
+	const SMeshBuffer* result = static_cast<const SMeshBuffer*>(welded->getMeshBuffer(0));
+
+	array<video::S3DVertex> vertices;
+	array<u16> indices;
+	weldReference(buffer, tolerance, vertices, indices);
+
+	bool same = result->Vertices.size() == vertices.size() && result->Indices.size() == indices.size();
+	for (u32 i=0; same && i<vertices.size(); ++i)
+		same = result->Vertices[i] == vertices[i];
+	for (u32 i=0; same && i<indices.size(); ++i)
+		same = result->Indices[i] == indices[i];
+	if (!same)
+		logTestString("welded %u vertices %u indices, expected %u vertices %u indices\n",
+			result->Vertices.size(), result->Indices.size(), vertices.size(), indices.size());
+
+	welded->drop();
+	mesh->drop();
+	return same;
+}
+
+} // end anonymous namespace
+
+/** Welding has to find the same vertices as comparing all pairs, also with
+jittered positions close to the tolerance. Large meshes are timed. */
+bool meshWelding()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IMeshManipulator* manipulator = device->getSceneManager()->getMeshManipulator();
+	bool result = true;
+
+	// exact duplicates with the default tolerance
+	SMeshBuffer* buffer = createSoup(20, 1.f, 0.f, false);
+	result &= sameAsReference(manipulator, buffer, ROUNDING_ERROR_f32);
+	buffer->drop();
+
+	// jitter around the tolerance, so some corners weld and others don't
+	buffer = createSoup(20, 1.f, 0.02f, true);
+	result &= sameAsReference(manipulator, buffer, 0.02f);
+	buffer->drop();
+
+	// tolerance larger than the spacing welds whole rows
+	buffer = createSoup(12, 0.01f, 0.001f, false);
+	result &= sameAsReference(manipulator, buffer, 0.05f);
+	buffer->drop();
+
+	// benchmark with buffers of almost 65536 vertices, the grid corners remain
+	const u32 quads = 104;
+	const u32 buffers = 8;
+	SMesh* large = new SMesh();
+	for (u32 b=0; b<buffers; ++b)
+	{
+		buffer = createSoup(quads, 1.f, 0.f, false);
+		large->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+	large->recalculateBoundingBox();
+
+	const u32 start = device->getTimer()->getRealTime();
+	IMesh* welded = manipulator->createMeshWelded(large);
+	const u32 duration = device->getTimer()->getRealTime() - start;
+	logTestString("Welded %u vertices in %u ms.\n", buffers * quads * quads * 6, duration);
+
+	for (u32 b=0; b<welded->getMeshBufferCount(); ++b)
+	{
+		result &= welded->getMeshBuffer(b)->getVertexCount() == (quads+1) * (quads+1);
+		result &= welded->getMeshBuffer(b)->getIndexCount() == quads * quads * 6;
+	}
+	welded->drop();
+	large->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,173 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 drawFrame(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+//! triangles of all faces in leaves whose cluster can be seen from the cluster
+u32 countPotentiallyVisibleTriangles(const IQ3LevelMesh* level, s32 cluster)
+{
+	const array<quake3::SLeaf>& leafs = level->getLeafs();
+	array<bool> drawn;
+	drawn.set_used(level->getFaceIndices().size());
+	for (u32 i=0; i<drawn.size(); ++i)
+		drawn[i] = false;
+
+	u32 triangles = 0;
+	for (u32 i=0; i<leafs.size(); ++i)
+	{
+		if (!level->isClusterVisible(cluster, leafs[i].Cluster))
+			continue;
+
+		for (u32 f=leafs[i].FirstFace; f<leafs[i].FirstFace+leafs[i].FaceCount; ++f)
+		{
+			const u32 face = level->getLeafFaces()[f];
+			if (!drawn[face])
+				triangles += level->getFaceIndices()[face].IndexCount / 3;
+			drawn[face] = true;
+		}
+	}
+	return triangles;
+}
+
+}
+
+/** The bsp tree and the cluster visibility of a level have to be loaded, and
+the level node must only draw the faces which can be seen from the cluster of
+the camera. */
+bool quake3LevelSceneNode()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+
+	device->getFileSystem()->addFileArchive("../media/map-20kdm2.pk3");
+	IAnimatedMesh* mesh = smgr->getMesh("20kdm2.bsp");
+	assert_log(mesh && mesh->getMeshType() == EAMT_BSP);
+	if (!mesh || mesh->getMeshType() != EAMT_BSP)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	IQ3LevelMesh* level = (IQ3LevelMesh*)mesh;
+	IMesh* geometry = level->getMesh(quake3::E_Q3_MESH_GEOMETRY);
+
+	bool result = true;
+
+	result &= !level->getLeafs().empty() && !level->getFaceIndices().empty();
+
+	// faces have to be inside of their buffers
+	for (u32 i=0; i<level->getFaceIndices().size(); ++i)
+	{
+		const quake3::SFaceIndices& face = level->getFaceIndices()[i];
+		if (face.MeshBuffer >= geometry->getMeshBufferCount() ||
+			face.FirstIndex + face.IndexCount > geometry->getMeshBuffer(face.MeshBuffer)->getIndexCount())
+		{
+			logTestString("face %u is outside of its buffer\n", i);
+			result = false;
+			break;
+		}
+	}
+
+	const aabbox3df box = geometry->getBoundingBox();
+	const s32 inside = level->getClusterAt(vector3df(1350.f, 130.f, 1400.f));
+	const s32 outside = level->getClusterAt(box.MaxEdge + vector3df(1000.f, 1000.f, 1000.f));
+	if (inside < 0 || outside != -1)
+	{
+		logTestString("clusters %d inside, %d outside\n", inside, outside);
+		result = false;
+	}
+	result &= level->isClusterVisible(inside, inside);
+	result &= !level->isClusterVisible(inside, -1);
+	result &= level->isClusterVisible(-1, inside);
+
+	const vector3df offset(-1350.f, -130.f, -1400.f);
+	IMeshSceneNode* full = smgr->addMeshSceneNode(geometry, 0, -1, offset);
+	IMeshSceneNode* node = smgr->addQuake3LevelSceneNode(level, 0, -1, offset);
+	assert_log(node);
+	if (!node)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode();
+	cam->setFarValue(20000.f);
+
+	u32 culledViews = 0;
+	for (s32 k=0; k<8; ++k)
+	{
+		const vector3df pos = box.MinEdge + box.getExtent() * vector3df(0.1f + k * 0.1f, 0.3f, 0.5f);
+		cam->setPosition(pos + offset);
+		cam->setTarget(pos + offset + vector3df(sinf((f32)k), 0.f, cosf((f32)k)) * 100.f);
+
+		full->setVisible(true);
+		node->setVisible(false);
+		const u32 all = drawFrame(device);
+
+		full->setVisible(false);
+		node->setVisible(true);
+		node->setAutomaticCulling(EAC_BOX);
+		const u32 culled = drawFrame(device);
+
+		node->setAutomaticCulling(EAC_OFF);
+		const u32 potentiallyVisible = drawFrame(device);
+
+		const u32 expected = countPotentiallyVisibleTriangles(level, level->getClusterAt(pos));
+		if (potentiallyVisible != expected || culled > potentiallyVisible || potentiallyVisible > all)
+		{
+			logTestString("view %d: %u primitives culled, %u potentially visible (expected %u) of %u\n",
+				k, culled, potentiallyVisible, expected, all);
+			result = false;
+		}
+		if (culled < all)
+			++culledViews;
+	}
+	result &= culledViews > 0;
+
+	// everything is drawn from outside of the level
+	node->setAutomaticCulling(EAC_OFF);
+	cam->setPosition(box.MaxEdge + offset + vector3df(1000.f, 1000.f, 1000.f));
+	full->setVisible(true);
+	node->setVisible(false);
+	const u32 all = drawFrame(device);
+	full->setVisible(false);
+	node->setVisible(true);
+	const u32 fromOutside = drawFrame(device);
+	if (fromOutside != all)
+	{
+		logTestString("%u primitives drawn from outside, expected %u\n", fromOutside, all);
+		result = false;
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
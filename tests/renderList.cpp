@@ -0,0 +1,499 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+//! calls of CRenderOrderNode::OnRegisterSceneNode
+u32 RegisterCalls = 0;
+
+//! box which logs the order in which it is rendered
+class CRenderOrderNode : public ISceneNode
+{
+public:
+	CRenderOrderNode(ISceneNode* parent, ISceneManager* smgr, s32 id,
+			bool transparent, array<s32>& log)
+		: ISceneNode(parent, smgr, id), Log(log), Pass(ESNRP_NONE)
+	{
+		Box.reset(vector3df(-1.f, -1.f, -1.f));
+		Box.addInternalPoint(vector3df(1.f, 1.f, 1.f));
+		Material.MaterialType = transparent ? video::EMT_TRANSPARENT_ADD_COLOR : video::EMT_SOLID;
+		setAutomaticCulling(EAC_FRUSTUM_BOX);
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		RegisterCalls += 1;
+		if (IsVisible)
+		{
+			// effect nodes test a second list which is filled without material checks
+			if (Pass != ESNRP_NONE)
+				SceneManager->registerNodeForRendering(this, Pass);
+			else
+				SceneManager->registerNodeForRendering(this,
+					getID() % 7 == 0 ? ESNRP_TRANSPARENT_EFFECT : ESNRP_AUTOMATIC);
+		}
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render()
+	{
+		Log.push_back(getID());
+	}
+
+	virtual const aabbox3d<f32>& getBoundingBox() const { return Box; }
+	virtual u32 getMaterialCount() const { return 1; }
+	virtual video::SMaterial& getMaterial(u32 i) { return Material; }
+
+	//! register for this pass instead of choosing one by id
+	void setPass(E_SCENE_NODE_RENDER_PASS pass) { Pass = pass; }
+
+private:
+	array<s32>& Log;
+	E_SCENE_NODE_RENDER_PASS Pass;
+	aabbox3d<f32> Box;
+	video::SMaterial Material;
+};
+
+} // end anonymous namespace
+
+//! grid of size*size nodes, every 5th with a child
+static s32 addRenderOrderGrid(ISceneManager* smgr, s32 size, s32 firstId, array<s32>& log)
+{
+	s32 id = firstId;
+	for (s32 z = 0; z < size; ++z)
+	{
+		for (s32 x = 0; x < size; ++x)
+		{
+			CRenderOrderNode* node = new CRenderOrderNode(smgr->getRootSceneNode(),
+				smgr, id, (id % 3) == 0, log);
+			node->setPosition(vector3df((f32)(x - size / 2) * 6.f, 0.f, (f32)(z - size / 2) * 6.f));
+
+			// children are registered in the middle of the traversal
+			if ((id % 5) == 0)
+			{
+				CRenderOrderNode* child = new CRenderOrderNode(node, smgr, 100000 + id, (id % 2) == 0, log);
+				child->setPosition(vector3df(0.f, 3.f, 0.f));
+				child->drop();
+			}
+			node->drop();
+			id += 1;
+		}
+	}
+	return id - firstId;
+}
+
+static bool compareRenderOrder(const array<s32>& log, const array<s32>& reference, const c8* mode)
+{
+	if (log.size() != reference.size())
+	{
+		logTestString("%s drew %d nodes instead of %d\n", mode, log.size(), reference.size());
+		return false;
+	}
+
+	for (u32 n = 0; n < log.size(); ++n)
+	{
+		if (log[n] != reference[n])
+		{
+			logTestString("%s changed the draw order at %d\n", mode, n);
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Renders a scene with many culled and visible nodes with and without
+RENDER_LIST_THREADS. The nodes have to be drawn in the same order. */
+bool parallelRenderList()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	array<s32> log;
+	const s32 id = addRenderOrderGrid(smgr, 20, 0, log);
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(-20.f, 30.f, -40.f), vector3df(10.f, 0.f, 20.f));
+	cam->setFarValue(80.f);
+
+	bool result = true;
+
+	const s32 threads[] = { 0, 2, 4, 3 };
+	array<s32> reference;
+	for (u32 i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i)
+	{
+		smgr->getParameters()->setAttribute(RENDER_LIST_THREADS, threads[i]);
+
+		log.set_used(0);
+		driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+		smgr->drawAll();
+		driver->endScene();
+
+		if (i == 0)
+		{
+			reference = log;
+
+			// some, but not all nodes have to be culled
+			if (reference.empty() || reference.size() >= (u32)id + 80)
+			{
+				logTestString("Unexpected number of drawn nodes %d\n", reference.size());
+				result = false;
+			}
+			continue;
+		}
+
+		c8 mode[32];
+		snprintf_irr(mode, sizeof(mode), "%d threads", threads[i]);
+		result &= compareRenderOrder(log, reference, mode);
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+
+//! draws frames with and without SCENE_NODE_BVH_CULLING and logs the times
+static void benchmarkBVHRenderList(IrrlichtDevice* device, array<s32>& log)
+{
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	smgr->clear();
+	const s32 count = addRenderOrderGrid(smgr, 100, 0, log);
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(-20.f, 30.f, -40.f), vector3df(10.f, 0.f, 20.f));
+	cam->setFarValue(80.f);
+
+	const u32 frames = 50;
+	u32 duration[2];
+	for (u32 bvh = 0; bvh < 2; ++bvh)
+	{
+		smgr->getParameters()->setAttribute(SCENE_NODE_BVH_CULLING, bvh != 0);
+		smgr->getParameters()->setAttribute(RENDER_LIST_THREADS, 0);
+
+		const u32 start = device->getTimer()->getRealTime();
+		for (u32 f = 0; f < frames; ++f)
+		{
+			log.set_used(0);
+			driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+			smgr->drawAll();
+			driver->endScene();
+		}
+		duration[bvh] = device->getTimer()->getRealTime() - start;
+	}
+
+	logTestString("Drew %u frames of %d nodes in %u ms, with the bvh in %u ms.\n",
+		frames, count + count / 5, duration[0], duration[1]);
+}
+
+
+/** Nodes rejected by SCENE_NODE_BVH_CULLING have to be the same as
+the ones culled by EAC_FRUSTUM_BOX, also after nodes moved (refit),
+were added or removed (rebuild). Subtrees outside of the frustum must
+not be registered at all. */
+bool bvhRenderList()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	array<s32> log;
+	s32 id = addRenderOrderGrid(smgr, 30, 0, log);
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(-20.f, 30.f, -40.f), vector3df(10.f, 0.f, 20.f));
+	cam->setFarValue(80.f);
+
+	bool result = true;
+	array<s32> reference;
+
+	for (u32 frame = 0; frame < 5; ++frame)
+	{
+		if (frame == 1)
+		{
+			// refit
+			const list<ISceneNode*>& children = smgr->getRootSceneNode()->getChildren();
+			u32 n = 0;
+			for (list<ISceneNode*>::ConstIterator it = children.begin(); it != children.end(); ++it, ++n)
+			{
+				if ((n % 4) == 0)
+					(*it)->setPosition((*it)->getPosition() + vector3df(7.f, 0.f, -13.f));
+			}
+		}
+		else if (frame == 2)
+		{
+			// rebuild
+			id += addRenderOrderGrid(smgr, 8, id, log);
+		}
+		else if (frame == 3)
+		{
+			cam->setTarget(vector3df(-30.f, 0.f, 10.f));
+		}
+		else if (frame == 4)
+		{
+			// rebuild, and children which are never culled keep their parents registered
+			const list<ISceneNode*>& children = smgr->getRootSceneNode()->getChildren();
+			array<ISceneNode*> removed;
+			u32 n = 0;
+			for (list<ISceneNode*>::ConstIterator it = children.begin(); it != children.end(); ++it, ++n)
+			{
+				if ((n % 6) == 0)
+					removed.push_back(*it);
+				else if (!(*it)->getChildren().empty() && (n % 4) == 1)
+					(*(*it)->getChildren().begin())->setAutomaticCulling(EAC_OFF);
+			}
+			for (u32 r = 0; r < removed.size(); ++r)
+				removed[r]->remove();
+		}
+
+		const s32 mode[][2] = { { 0, 0 }, { 1, 0 }, { 1, 3 } };
+		u32 referenceCalls = 0;
+		for (u32 i = 0; i < sizeof(mode) / sizeof(mode[0]); ++i)
+		{
+			smgr->getParameters()->setAttribute(SCENE_NODE_BVH_CULLING, mode[i][0] != 0);
+			smgr->getParameters()->setAttribute(RENDER_LIST_THREADS, mode[i][1]);
+
+			log.set_used(0);
+			RegisterCalls = 0;
+			driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+			smgr->drawAll();
+			driver->endScene();
+
+			if (i == 0)
+			{
+				referenceCalls = RegisterCalls;
+				reference = log;
+				if (reference.empty() || reference.size() >= (u32)id)
+				{
+					logTestString("Unexpected number of drawn nodes %d in frame %d\n", reference.size(), frame);
+					result = false;
+				}
+				continue;
+			}
+
+			c8 name[64];
+			snprintf_irr(name, sizeof(name), "frame %d bvh with %d threads", frame, mode[i][1]);
+			result &= compareRenderOrder(log, reference, name);
+
+			if (RegisterCalls < log.size() || RegisterCalls * 2 > referenceCalls)
+			{
+				logTestString("%s registered %d of %d nodes\n", name, RegisterCalls, referenceCalls);
+				result = false;
+			}
+		}
+	}
+
+	benchmarkBVHRenderList(device, log);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+
+namespace
+{
+
+struct SSortTestEntry
+{
+	u64 Key;
+	u32 Index;
+};
+
+} // end anonymous namespace
+
+static bool testRadixSort(u32 size, u32 keyBits)
+{
+	array<SSortTestEntry> entries;
+	array<SSortTestEntry> temp;
+	u32 seed = 12345 + size;
+	for (u32 i = 0; i < size; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		SSortTestEntry e;
+		// few distinct values in the low bits to test the stability, some high bits
+		e.Key = ((u64)(seed >> 24) % 13) | ((u64)(seed % 3) << (keyBits - 2));
+		e.Index = i;
+		entries.push_back(e);
+		temp.push_back(e);
+	}
+
+	radixsort(entries.pointer(), temp.pointer(), size, &SSortTestEntry::Key);
+
+	for (u32 i = 1; i < size; ++i)
+	{
+		const SSortTestEntry& a = entries[i-1];
+		const SSortTestEntry& b = entries[i];
+		if (a.Key > b.Key || (a.Key == b.Key && a.Index > b.Index))
+		{
+			logTestString("radixsort of %d elements with %d bit keys failed at %d\n", size, keyBits, i);
+			return false;
+		}
+	}
+	return true;
+}
+
+static f32 getSortDistance(ISceneManager* smgr, s32 id, const vector3df& camera)
+{
+	return smgr->getSceneNodeFromId(id)->getAbsolutePosition().getDistanceFromSQ(camera);
+}
+
+/** The render passes are sorted by keys built from a configurable layout.
+Check the default order of the solid and transparent pass, a custom layout
+and the radix sort on its own. */
+bool renderSortKey()
+{
+	bool result = true;
+	result &= testRadixSort(20, 64);
+	result &= testRadixSort(1000, 64);
+	result &= testRadixSort(1000, 20);
+
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	video::IImage* image = driver->createImage(video::ECF_A8R8G8B8, dimension2du(4, 4));
+	video::ITexture* textures[3];
+	textures[0] = driver->addTexture("sort0", image);
+	textures[1] = driver->addTexture("sort1", image);
+	textures[2] = 0;
+	image->drop();
+
+	const vector3df camPos(0.f, 0.f, -50.f);
+	smgr->addCameraSceneNode(0, camPos, vector3df(0.f, 0.f, 0.f));
+
+	// ids of solid nodes are below 100, transparent ones above
+	array<s32> log;
+	const video::E_MATERIAL_TYPE types[] = { video::EMT_LIGHTMAP, video::EMT_SOLID, video::EMT_DETAIL_MAP };
+	for (s32 i = 0; i < 60; ++i)
+	{
+		const bool transparent = i >= 40;
+		CRenderOrderNode* node = new CRenderOrderNode(smgr->getRootSceneNode(), smgr,
+			transparent ? 100 + i : i, false, log);
+		node->setPass(transparent ? ESNRP_TRANSPARENT : ESNRP_SOLID);
+		node->setPosition(vector3df((f32)((i * 7) % 11) - 5.f, (f32)((i * 3) % 5) - 2.f, (f32)((i * 13) % 17)));
+		node->getMaterial(0).MaterialType = types[i % 3];
+		node->getMaterial(0).setTexture(0, textures[(i / 3) % 3]);
+		node->drop();
+	}
+
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+
+	if (log.size() != 60)
+	{
+		logTestString("Drew %d sorted nodes instead of 60\n", log.size());
+		result = false;
+	}
+
+	// solid: material type, then texture (each texture once per type), then registration order
+	for (u32 n = 1; n < log.size() && log[n] < 100; ++n)
+	{
+		ISceneNode* a = smgr->getSceneNodeFromId(log[n-1]);
+		ISceneNode* b = smgr->getSceneNodeFromId(log[n]);
+		const s32 typeA = a->getMaterial(0).MaterialType;
+		const s32 typeB = b->getMaterial(0).MaterialType;
+		const video::ITexture* texA = a->getMaterial(0).getTexture(0);
+		const video::ITexture* texB = b->getMaterial(0).getTexture(0);
+
+		bool ok = typeA <= typeB;
+		if (ok && typeA == typeB && texA != texB)
+		{
+			// the texture of a may not show up again in this material type
+			for (u32 k = n + 1; k < log.size() && log[k] < 100; ++k)
+			{
+				ISceneNode* c = smgr->getSceneNodeFromId(log[k]);
+				if (c->getMaterial(0).MaterialType == typeA && c->getMaterial(0).getTexture(0) == texA)
+					ok = false;
+			}
+		}
+		if (ok && typeA == typeB && texA == texB)
+			ok = log[n-1] < log[n];
+
+		if (!ok)
+		{
+			logTestString("Solid nodes %d and %d are in the wrong order\n", log[n-1], log[n]);
+			result = false;
+		}
+	}
+
+	// transparent: back to front
+	for (u32 n = 41; n < log.size(); ++n)
+	{
+		if (getSortDistance(smgr, log[n-1], camPos) < getSortDistance(smgr, log[n], camPos))
+		{
+			logTestString("Transparent nodes %d and %d are not drawn back to front\n", log[n-1], log[n]);
+			result = false;
+		}
+	}
+
+	// an empty layout keeps the registration order
+	smgr->setRenderSortKeyLayout(ESNRP_SOLID, SRenderSortKeyLayout());
+	log.set_used(0);
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	for (u32 n = 0; n < 40 && n < log.size(); ++n)
+	{
+		if (log[n] != (s32)n)
+		{
+			logTestString("Unsorted solid pass changed the order at %d\n", n);
+			result = false;
+			break;
+		}
+	}
+
+	// depth only, front to back
+	SRenderSortKeyLayout depth;
+	if (!depth.addField(ERSKF_DEPTH, 32) || depth.addField(ERSKF_TEXTURE, 33))
+	{
+		logTestString("Sort key layout accepted a field which does not fit\n");
+		result = false;
+	}
+	smgr->setRenderSortKeyLayout(ESNRP_SOLID, depth);
+	if (smgr->getRenderSortKeyLayout(ESNRP_SOLID) != depth)
+	{
+		logTestString("Sort key layout was not set\n");
+		result = false;
+	}
+	log.set_used(0);
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	for (u32 n = 1; n < 40 && n < log.size(); ++n)
+	{
+		if (getSortDistance(smgr, log[n-1], camPos) > getSortDistance(smgr, log[n], camPos))
+		{
+			logTestString("Solid nodes %d and %d are not drawn front to back\n", log[n-1], log[n]);
+			result = false;
+		}
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
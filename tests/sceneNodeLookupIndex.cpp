@@ -0,0 +1,244 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// the searches of the scene manager without index
+ISceneNode* walkFromId(ISceneNode* start, s32 id)
+{
+	if (start->getID() == id)
+		return start;
+	for (ISceneNodeList::ConstIterator it = start->getChildren().begin(); it != start->getChildren().end(); ++it)
+	{
+		ISceneNode* node = walkFromId(*it, id);
+		if (node)
+			return node;
+	}
+	return 0;
+}
+
+ISceneNode* walkFromName(ISceneNode* start, const c8* name)
+{
+	if (!strcmp(start->getName(), name))
+		return start;
+	for (ISceneNodeList::ConstIterator it = start->getChildren().begin(); it != start->getChildren().end(); ++it)
+	{
+		ISceneNode* node = walkFromName(*it, name);
+		if (node)
+			return node;
+	}
+	return 0;
+}
+
+ISceneNode* walkFromType(ISceneNode* start, ESCENE_NODE_TYPE type)
+{
+	if (start->getType() == type)
+		return start;
+	for (ISceneNodeList::ConstIterator it = start->getChildren().begin(); it != start->getChildren().end(); ++it)
+	{
+		ISceneNode* node = walkFromType(*it, type);
+		if (node)
+			return node;
+	}
+	return 0;
+}
+
+void walkAllFromType(ISceneNode* start, ESCENE_NODE_TYPE type, array<ISceneNode*>& out)
+{
+	if (start->getType() == type)
+		out.push_back(start);
+	for (ISceneNodeList::ConstIterator it = start->getChildren().begin(); it != start->getChildren().end(); ++it)
+		walkAllFromType(*it, type, out);
+}
+
+bool isInSubtree(const ISceneNode* node, const ISceneNode* root)
+{
+	for (; node; node = node->getParent())
+	{
+		if (node == root)
+			return true;
+	}
+	return false;
+}
+
+const c8* const Names[] = { "", "crate", "door", "lamp", "crate2" };
+const ESCENE_NODE_TYPE Types[] = { ESNT_EMPTY, ESNT_CUBE, ESNT_DUMMY_TRANSFORMATION, ESNT_SCENE_MANAGER };
+
+bool compareLookups(ISceneManager* smgr, ISceneNode* start, u32 step)
+{
+	ISceneNode* begin = start ? start : smgr->getRootSceneNode();
+	bool result = true;
+
+	for (s32 id=-1; id<6; ++id)
+	{
+		if (smgr->getSceneNodeFromId(id, start) != walkFromId(begin, id))
+		{
+			logTestString("step %u: wrong node for id %d\n", step, id);
+			result = false;
+		}
+	}
+
+	for (u32 i=0; i<sizeof(Names)/sizeof(Names[0]); ++i)
+	{
+		if (smgr->getSceneNodeFromName(Names[i], start) != walkFromName(begin, Names[i]))
+		{
+			logTestString("step %u: wrong node for name '%s'\n", step, Names[i]);
+			result = false;
+		}
+	}
+
+	for (u32 i=0; i<sizeof(Types)/sizeof(Types[0]); ++i)
+	{
+		if (smgr->getSceneNodeFromType(Types[i], start) != walkFromType(begin, Types[i]))
+		{
+			logTestString("step %u: wrong node for type %u\n", step, i);
+			result = false;
+		}
+
+		array<ISceneNode*> found;
+		array<ISceneNode*> expected;
+		smgr->getSceneNodesFromType(Types[i], found, start);
+		walkAllFromType(begin, Types[i], expected);
+		if (!(found == expected))
+		{
+			logTestString("step %u: %u nodes of type %u, expected %u\n", step, found.size(), i, expected.size());
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+}
+
+/** The lookups with the index have to return the same nodes as the walks
+over the graph while nodes are added, removed, moved, renamed and get new
+ids. */
+bool sceneNodeLookupIndex()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	smgr->setSceneNodeLookupIndexEnabled(true);
+	bool result = smgr->isSceneNodeLookupIndexEnabled();
+
+	// all nodes stay grabbed, so removed ones can be used as detached start nodes
+	array<ISceneNode*> nodes;
+	u32 seed = 12345;
+
+	for (u32 step=0; step<600; ++step)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const u32 r = seed >> 8;
+
+		ISceneNode* node = nodes.empty() ? 0 : nodes[r % nodes.size()];
+		ISceneNode* other = nodes.empty() ? 0 : nodes[(r >> 10) % nodes.size()];
+		ISceneNode* parent = (other && (r & 1)) ? other : smgr->getRootSceneNode();
+
+		switch (nodes.size() < 8 ? 0 : (r >> 4) % 7)
+		{
+		case 0:
+		case 1:
+			{
+				ISceneNode* added;
+				if ((r >> 6) % 3 == 0)
+					added = smgr->addCubeSceneNode(1.f, parent, (s32)((r >> 12) % 6));
+				else if ((r >> 6) % 3 == 1)
+					added = smgr->addDummyTransformationSceneNode(parent, (s32)((r >> 12) % 6));
+				else
+					added = smgr->addEmptySceneNode(parent, (s32)((r >> 12) % 6));
+				added->setName(Names[(r >> 16) % 5]);
+				added->grab();
+				nodes.push_back(added);
+			}
+			break;
+		case 2:
+			node->remove();
+			break;
+		case 3:
+			node->setName(Names[(r >> 16) % 5]);
+			break;
+		case 4:
+			node->setID((s32)((r >> 12) % 7) - 1);
+			break;
+		case 5:
+			// move, also detached nodes back into the graph
+			if (!isInSubtree(parent, node))
+				parent->addChild(node);
+			break;
+		case 6:
+			if (isInSubtree(node, smgr->getRootSceneNode()) && node->getParent())
+			{
+				ISceneNode* copy = node->clone();
+				copy->grab();
+				nodes.push_back(copy);
+			}
+			break;
+		}
+
+		result &= compareLookups(smgr, 0, step);
+		if (node)
+			result &= compareLookups(smgr, node, step);
+		if (other)
+			result &= compareLookups(smgr, other, step);
+		if (!result)
+			break;
+	}
+
+	// several added subtrees are numbered by the next search
+	if (result)
+	{
+		ISceneNode* middle = smgr->addEmptySceneNode(*smgr->getRootSceneNode()->getChildren().getLast(), 2);
+		ISceneNode* inner = smgr->addCubeSceneNode(1.f, middle, 3);
+		smgr->addDummyTransformationSceneNode(inner, 4)->setName("door");
+		ISceneNode* first = *smgr->getRootSceneNode()->getChildren().begin();
+		smgr->addEmptySceneNode(first, 5)->setName("lamp");
+		first->addChild(inner);
+		ISceneNode* removed = smgr->addCubeSceneNode(1.f, middle, 1);
+		removed->remove();
+		result &= compareLookups(smgr, 0, 900);
+		result &= compareLookups(smgr, middle, 901);
+		result &= compareLookups(smgr, first, 902);
+	}
+
+	// changes of a node in a detached subtree must not be seen from the root
+	if (result)
+	{
+		ISceneNode* detached = smgr->addEmptySceneNode();
+		ISceneNode* child = smgr->addEmptySceneNode(detached, 5);
+		detached->grab();
+		detached->remove();
+		child->setName("detachedChild");
+		result &= smgr->getSceneNodeFromName("detachedChild") == 0;
+		result &= smgr->getSceneNodeFromName("detachedChild", detached) == child;
+		smgr->getRootSceneNode()->addChild(detached);
+		result &= smgr->getSceneNodeFromName("detachedChild") == child;
+		result &= compareLookups(smgr, 0, 1000);
+		detached->drop();
+	}
+
+	smgr->clear();
+	result &= compareLookups(smgr, 0, 1001);
+
+	smgr->setSceneNodeLookupIndexEnabled(false);
+	result &= !smgr->isSceneNodeLookupIndexEnabled();
+
+	for (u32 i=0; i<nodes.size(); ++i)
+		nodes[i]->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,170 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 drawFrame(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255,0,0,0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+}
+
+/** The merged chunks have to contain the same triangles at the same world
+positions as the nodes they replace, grouped by material, and must still be
+culled when out of view. */
+bool staticBatchSceneNode()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+
+	ISceneNode* level = smgr->addEmptySceneNode();
+	level->setPosition(vector3df(10.f, -5.f, 0.f));
+	level->setRotation(vector3df(0.f, 15.f, 0.f));
+	level->updateAbsolutePosition();
+
+	array<IMeshSceneNode*> nodes;
+	aabbox3df levelBox;
+	for (s32 x=0; x<20; ++x)
+	{
+		for (s32 z=0; z<15; ++z)
+		{
+			IMeshSceneNode* node = smgr->addCubeSceneNode(2.f, level, -1, vector3df(x * 4.f, (x*z % 3) * 1.f, z * 4.f),
+				vector3df((f32)(x*7), (f32)(z*11), 0.f), vector3df(1.f, 1.f + (z % 4) * 0.5f, 1.f));
+			if ((x + z) % 3 == 1)
+				node->setMaterialFlag(video::EMF_LIGHTING, false);
+			else if ((x + z) % 3 == 2)
+				node->setMaterialType(video::EMT_TRANSPARENT_ADD_COLOR);
+			nodes.push_back(node);
+
+			node->updateAbsolutePosition();
+			const IMeshBuffer* mb = node->getMesh()->getMeshBuffer(0);
+			for (u32 i=0; i<mb->getVertexCount(); ++i)
+			{
+				vector3df pos = mb->getPosition(i);
+				node->getAbsoluteTransformation().transformVect(pos);
+				if (nodes.size() == 1 && i == 0)
+					levelBox.reset(pos);
+				else
+					levelBox.addInternalPoint(pos);
+			}
+		}
+	}
+
+	// those have to be skipped
+	IMeshSceneNode* animated = smgr->addCubeSceneNode(2.f, 0, -1, vector3df(200.f, 0.f, 0.f));
+	ISceneNodeAnimator* anim = smgr->createRotationAnimator(vector3df(0.f, 1.f, 0.f));
+	animated->addAnimator(anim);
+	anim->drop();
+	nodes.push_back(animated);
+	IMeshSceneNode* withChild = smgr->addCubeSceneNode(2.f, 0, -1, vector3df(210.f, 0.f, 0.f));
+	smgr->addEmptySceneNode(withChild);
+	nodes.push_back(withChild);
+
+	ICameraSceneNode* cam = smgr->addCameraSceneNode(0, vector3df(40.f, 150.f, -60.f), vector3df(40.f, 0.f, 30.f));
+	cam->setFarValue(1000.f);
+
+	const u32 before = drawFrame(device);
+	cam->setTarget(vector3df(-200.f, 0.f, 30.f));
+	const u32 partialBefore = drawFrame(device);
+	cam->setTarget(vector3df(40.f, 0.f, 30.f));
+
+	ISceneNode* batch = smgr->addStaticBatchSceneNode(nodes, 16.f);
+	assert_log(batch);
+	if (!batch)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	bool result = true;
+
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		const bool skipped = nodes[i] == animated || nodes[i] == withChild;
+		if (nodes[i]->isVisible() != skipped)
+		{
+			logTestString("node %u: visible %d\n", i, nodes[i]->isVisible());
+			result = false;
+		}
+	}
+
+	// chunks hold the buffers of several nodes, one per material
+	const list<ISceneNode*>& chunks = batch->getChildren();
+	u32 triangles = 0;
+	aabbox3df batchBox;
+	for (list<ISceneNode*>::ConstIterator it = chunks.begin(); it != chunks.end(); ++it)
+	{
+		IMesh* mesh = ((IMeshSceneNode*)(*it))->getMesh();
+		assert_log(mesh->getMeshBufferCount() >= 1 && mesh->getMeshBufferCount() <= 3);
+		result &= mesh->getMeshBufferCount() >= 1 && mesh->getMeshBufferCount() <= 3;
+		for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+		{
+			triangles += mesh->getMeshBuffer(b)->getPrimitiveCount();
+			if (it == chunks.begin() && b == 0)
+				batchBox = mesh->getMeshBuffer(b)->getBoundingBox();
+			else
+				batchBox.addInternalBox(mesh->getMeshBuffer(b)->getBoundingBox());
+		}
+	}
+	if (chunks.size() < 2 || chunks.size() >= 300 || triangles != 300*12)
+	{
+		logTestString("%u chunks with %u triangles\n", chunks.size(), triangles);
+		result = false;
+	}
+
+	// vertices have to be at the same world positions
+	if (!batchBox.MinEdge.equals(levelBox.MinEdge, 0.01f) || !batchBox.MaxEdge.equals(levelBox.MaxEdge, 0.01f))
+	{
+		logTestString("batch box (%f %f %f) (%f %f %f), expected (%f %f %f) (%f %f %f)\n",
+			batchBox.MinEdge.X, batchBox.MinEdge.Y, batchBox.MinEdge.Z,
+			batchBox.MaxEdge.X, batchBox.MaxEdge.Y, batchBox.MaxEdge.Z,
+			levelBox.MinEdge.X, levelBox.MinEdge.Y, levelBox.MinEdge.Z,
+			levelBox.MaxEdge.X, levelBox.MaxEdge.Y, levelBox.MaxEdge.Z);
+		result = false;
+	}
+
+	const u32 after = drawFrame(device);
+	if (after != before)
+	{
+		logTestString("%u primitives drawn, expected %u\n", after, before);
+		result = false;
+	}
+
+	// chunks are culled on their own, but less tight than the single nodes
+	cam->setTarget(vector3df(-200.f, 0.f, 30.f));
+	const u32 partialAfter = drawFrame(device);
+	if (partialAfter < partialBefore || partialAfter >= after)
+	{
+		logTestString("%u primitives drawn in partial view, before batching %u\n", partialAfter, partialBefore);
+		result = false;
+	}
+
+	// nothing left to merge
+	result &= (smgr->addStaticBatchSceneNode(nodes) == 0);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -49,6 +49,84 @@ static bool stencilShadow(video::E_DRIVER_TYPE driverType)
 	return result;
 }
 
+// the scene of stencilShadow, one frame per light position
+static video::IImage* renderShadowFrames(video::E_DRIVER_TYPE driverType, s32 threads, const core::vector3df* lightPositions, u32 frames)
+{
+	IrrlichtDevice *device = createDevice (driverType, core::dimension2d<u32>(160,120), 16, false, true);
+	if (!device)
+		return 0;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	smgr->getParameters()->setAttribute(scene::SHADOW_VOLUME_THREADS, threads);
+
+	scene::ICameraSceneNode* cam = smgr->addCameraSceneNodeFPS();
+	cam->setPosition(core::vector3df(-15,60,40));
+	cam->setTarget(core::vector3df(+25,-5,-25));
+
+	smgr->setAmbientLight(video::SColorf(.5f,.5f,.5f));
+	smgr->setShadowColor( video::SColor(255, 50, 0, 50));
+	smgr->addCubeSceneNode(100, 0, -1, core::vector3df(0,50,0), core::vector3df(), core::vector3df(-1,-1,-1));
+
+	scene::IAnimatedMeshSceneNode* node = smgr->addAnimatedMeshSceneNode(smgr->getMesh("../media/ninja.b3d"), 0, -1, core::vector3df(), core::vector3df(0.f, 230.f, 0.f),core::vector3df(5,5,5));
+	node->setMaterialFlag(video::EMF_NORMALIZE_NORMALS, true);
+	node->addShadowVolumeSceneNode(0, -1, true, 200.f);
+	node->setAnimationSpeed(0.f);
+
+	scene::IMeshSceneNode* cube2 = smgr->addCubeSceneNode(10, 0, -1, core::vector3df(40,0,0), core::vector3df(), core::vector3df(1,1,2.5f));
+	cube2->getMaterial(0).DiffuseColor = video::SColor(220, 0, 100, 100);
+	cube2->addShadowVolumeSceneNode(0, -1, false, 200.f);
+
+	scene::ILightSceneNode* light = smgr->addLightSceneNode();
+	light->setLightType(video::ELT_POINT);
+	light->setRadius(500.f);
+	light->getLightData().DiffuseColor.set(1,1,1);
+
+	for (u32 frame=0; frame<frames; ++frame)
+	{
+		light->setPosition(lightPositions[frame]);
+		device->getVideoDriver()->beginScene(video::ECBF_ALL, video::SColor(0,0,0,0));
+		smgr->drawAll();
+		device->getVideoDriver()->endScene();
+	}
+
+	video::IImage* image = device->getVideoDriver()->createScreenShot();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+// volumes built on worker threads, reused while the light stays and rebuilt
+// after it moved, have to give the image of volumes built once on this thread
+static bool cachedShadowVolumes(video::E_DRIVER_TYPE driverType)
+{
+	const core::vector3df positions[] = {
+		core::vector3df(-40,10,20), core::vector3df(-40,10,20),
+		core::vector3df(-20,30,40), core::vector3df(-20,30,40) };
+
+	video::IImage* built = renderShadowFrames(driverType, 0, positions + 3, 1);
+	if (!built)
+		return true; // No error if device does not exist
+	video::IImage* cached = renderShadowFrames(driverType, 4, positions, 4);
+
+	bool result = cached && cached->getDimension() == built->getDimension();
+	for (u32 y=0; result && y<built->getDimension().Height; ++y)
+	{
+		for (u32 x=0; result && x<built->getDimension().Width; ++x)
+			result = built->getPixel(x, y) == cached->getPixel(x, y);
+	}
+	if (!result)
+		logTestString("Cached shadow volumes differ from the single threaded ones\n");
+
+	built->drop();
+	if (cached)
+		cached->drop();
+
+	return result;
+}
+
 // test self-shadowing
 static bool selfShadowing(video::E_DRIVER_TYPE driverType)
 {
@@ -98,6 +176,9 @@ bool stencilShadow(void)
 //	passed &= stencilShadow(video::EDT_SOFTWARE);
 	passed &= stencilShadow(video::EDT_BURNINGSVIDEO);	// Note: cube has wrong color, if that gets ever changed just update the test-image.
 
+	passed &= cachedShadowVolumes(video::EDT_OPENGL);
+	passed &= cachedShadowVolumes(video::EDT_BURNINGSVIDEO);
+
 	passed &= selfShadowing(video::EDT_OPENGL);
 	passed &= selfShadowing(video::EDT_DIRECT3D9);
 	// no shadows in software renderer
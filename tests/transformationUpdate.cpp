@@ -0,0 +1,135 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+bool checkUpdated(ISceneNode* node, bool expected, const c8* step)
+{
+	if (node->isAbsoluteTransformationUpdated() != expected)
+	{
+		logTestString("%s: node %d %s updated\n", step, node->getID(), expected ? "not" : "wrongly");
+		return false;
+	}
+	return true;
+}
+
+bool checkPosition(ISceneNode* node, const vector3df& expected, const c8* step)
+{
+	if (!node->getAbsolutePosition().equals(expected))
+	{
+		const vector3df p = node->getAbsolutePosition();
+		logTestString("%s: node %d at %f %f %f instead of %f %f %f\n", step, node->getID(),
+			p.X, p.Y, p.Z, expected.X, expected.Y, expected.Z);
+		return false;
+	}
+	return true;
+}
+
+} // end anonymous namespace
+
+/** Absolute transformations are only recalculated for nodes whose relative
+transformation or parent changed. Check that moved subtrees are still
+updated correctly and reported by isAbsoluteTransformationUpdated. */
+bool transformationUpdate()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2du(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	ISceneNode* a = smgr->addEmptySceneNode(0, 1);
+	ISceneNode* b = smgr->addEmptySceneNode(a, 2);
+	ISceneNode* c = smgr->addEmptySceneNode(0, 3);
+	IDummyTransformationSceneNode* d = smgr->addDummyTransformationSceneNode(0, 4);
+	ISceneNode* e = smgr->addEmptySceneNode(d, 5);
+
+	a->setPosition(vector3df(10.f, 0.f, 0.f));
+	b->setPosition(vector3df(0.f, 5.f, 0.f));
+	c->setPosition(vector3df(0.f, 0.f, 7.f));
+	e->setPosition(vector3df(1.f, 0.f, 0.f));
+
+	bool result = true;
+
+	// first frame updates everything
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(a, true, "first frame");
+	result &= checkUpdated(b, true, "first frame");
+	result &= checkPosition(b, vector3df(10.f, 5.f, 0.f), "first frame");
+
+	// nothing moved
+	const u32 versionB = b->getAbsoluteTransformationVersion();
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(a, false, "static");
+	result &= checkUpdated(b, false, "static");
+	result &= checkUpdated(c, false, "static");
+	result &= checkUpdated(e, false, "static");
+	if (b->getAbsoluteTransformationVersion() != versionB)
+	{
+		logTestString("static: transformation recalculated\n");
+		result = false;
+	}
+
+	// moving the parent moves the child, but not the sibling subtree
+	a->setPosition(vector3df(20.f, 0.f, 0.f));
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(a, true, "moved parent");
+	result &= checkUpdated(b, true, "moved parent");
+	result &= checkUpdated(c, false, "moved parent");
+	result &= checkPosition(b, vector3df(20.f, 5.f, 0.f), "moved parent");
+
+	// small steps must not be swallowed
+	c->setPosition(vector3df(0.f, 0.f, 7.f + 1e-6f));
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(c, true, "small step");
+	result &= checkUpdated(a, false, "small step");
+
+	// reparenting
+	b->setParent(c);
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(b, true, "reparent");
+	result &= checkPosition(b, vector3df(0.f, 5.f, 7.f + 1e-6f), "reparent");
+
+	// explicit update right after a change, reported in the next frame
+	a->setPosition(vector3df(0.f, 0.f, 0.f));
+	a->updateAbsolutePosition();
+	result &= checkPosition(a, vector3df(0.f, 0.f, 0.f), "explicit update");
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(a, true, "explicit update");
+
+	// the dummy matrix is changed through a reference
+	d->getRelativeTransformationMatrix().setTranslation(vector3df(0.f, -3.f, 0.f));
+	driver->beginScene();
+	smgr->drawAll();
+	driver->endScene();
+	result &= checkUpdated(d, true, "dummy matrix");
+	result &= checkUpdated(e, true, "dummy matrix");
+	result &= checkPosition(e, vector3df(1.f, -3.f, 0.f), "dummy matrix");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}